@@ -0,0 +1,154 @@
+// AcousticFingerprint.cpp
+#include "AcousticFingerprint.h"
+#include <algorithm> // std::max
+#include <bitset>
+#include <cmath>
+#include <cstdlib>   // std::abs
+#include <numeric>   // std::iota
+#include <unordered_map>
+
+namespace {
+const size_t kMinWindows = 2 * AcousticFingerprint::kSegments;
+
+// Сходство: не больше ~10% разных битов и длительности в пределах 2 с или 2%
+const int kMaxDistance = 40;
+const uint32_t kDurationSlackMs = 2000;
+
+// LSH: 24 полосы по 16 бит. Копия с 5% отличий совпадает хотя бы в одной
+// полосе с вероятностью 1 - 1e-6. Переполненные корзины (одинаковые полосы
+// у многих треков - тишина, один аккорд) не раскрываются в пары
+const size_t kBandBits = 16;
+const size_t kBands = AcousticFingerprint::kBits / kBandBits;
+const size_t kMaxBucket = 256;
+
+// Система непересекающихся множеств для сборки групп из пар
+struct DisjointSets {
+    std::vector<size_t> parent;
+    explicit DisjointSets(size_t n) : parent(n) { std::iota(parent.begin(), parent.end(), 0); }
+    size_t find(size_t x) {
+        while (parent[x] != x) x = parent[x] = parent[parent[x]];
+        return x;
+    }
+    void unite(size_t a, size_t b) { parent[find(a)] = find(b); }
+};
+}
+
+AcousticFingerprint::Builder::Builder()
+    : frames_([this](const SpectralFrames::Frame& frame) {
+          // Доли энергии: громкость копии не влияет. Тишина - нулевой кадр (счет времени не сбивается)
+          std::array<float, 12> shares{};
+          if (frame.chromaEnergy > 1e-9f) {
+              for (size_t p = 0; p < 12; ++p) shares[p] = frame.chroma[p] / frame.chromaEnergy;
+          }
+          chroma_.push_back(shares);
+      }) {}
+
+void AcousticFingerprint::Builder::add(const float* samples, size_t count, uint32_t sampleRate) {
+    frames_.add(samples, count, sampleRate);
+}
+
+bool AcousticFingerprint::Builder::finish(AcousticFingerprint& fingerprint) {
+    fingerprint = AcousticFingerprint();
+    if (chroma_.size() < kMinWindows || frames_.sampleRate() == 0) return false;
+
+    const size_t frameCount = chroma_.size();
+    for (size_t s = 0; s < kSegments; ++s) {
+        const size_t first = s * frameCount / kSegments;
+        const size_t last = (s + 1) * frameCount / kSegments;
+        std::array<float, 12> average{};
+        for (size_t f = first; f < last; ++f) {
+            for (size_t p = 0; p < 12; ++p) average[p] += chroma_[f][p];
+        }
+        float mean = 0.0f;
+        for (float value : average) mean += value;
+        mean /= 12.0f;
+        for (size_t p = 0; p < 12; ++p) {
+            if (average[p] <= mean) continue;
+            const size_t bit = s * 12 + p;
+            fingerprint.bits_[bit / 64] |= uint64_t(1) << (bit % 64);
+        }
+    }
+    fingerprint.durationMs_ = static_cast<uint32_t>(
+        std::max<uint64_t>(1, frames_.sourceSamples() * 1000 / frames_.sampleRate()));
+    return true;
+}
+
+int AcousticFingerprint::distance(const AcousticFingerprint& other) const {
+    int bits = 0;
+    for (size_t w = 0; w < kWords; ++w) {
+        bits += static_cast<int>(std::bitset<64>(bits_[w] ^ other.bits_[w]).count());
+    }
+    return bits;
+}
+
+bool AcousticFingerprint::matches(const AcousticFingerprint& other) const {
+    if (!isValid() || !other.isValid()) return false;
+    const uint32_t longer = std::max(durationMs_, other.durationMs_);
+    const uint32_t slack = std::max(kDurationSlackMs, longer / 50);
+    if (uint32_t(std::abs(int64_t(durationMs_) - int64_t(other.durationMs_))) > slack) return false;
+    return distance(other) <= kMaxDistance;
+}
+
+std::string AcousticFingerprint::toHex() const {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(kWords * 16);
+    for (uint64_t word : bits_) {
+        for (int shift = 60; shift >= 0; shift -= 4) hex += digits[(word >> shift) & 0xF];
+    }
+    return hex;
+}
+
+bool AcousticFingerprint::fromHex(const std::string& hex, uint32_t durationMs, AcousticFingerprint& fingerprint) {
+    if (hex.size() != kWords * 16 || durationMs == 0) return false;
+    AcousticFingerprint parsed;
+    for (size_t i = 0; i < hex.size(); ++i) {
+        const char c = hex[i];
+        int digit;
+        if (c >= '0' && c <= '9') digit = c - '0';
+        else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+        else return false;
+        parsed.bits_[i / 16] = (parsed.bits_[i / 16] << 4) | uint64_t(digit);
+    }
+    parsed.durationMs_ = durationMs;
+    fingerprint = parsed;
+    return true;
+}
+
+std::vector<std::vector<size_t>> AcousticFingerprint::group(const std::vector<AcousticFingerprint>& prints) {
+    // Корзины LSH: ключ - номер полосы и ее 16 бит
+    std::unordered_map<uint32_t, std::vector<size_t>> buckets;
+    buckets.reserve(prints.size() * kBands);
+    for (size_t i = 0; i < prints.size(); ++i) {
+        if (!prints[i].isValid()) continue;
+        for (size_t band = 0; band < kBands; ++band) {
+            const size_t bit = band * kBandBits;
+            const uint32_t value = static_cast<uint32_t>((prints[i].bits_[bit / 64] >> (bit % 64)) & 0xFFFF);
+            buckets[(uint32_t(band) << kBandBits) | value].push_back(i);
+        }
+    }
+
+    DisjointSets sets(prints.size());
+    for (const auto& bucket : buckets) {
+        const std::vector<size_t>& members = bucket.second;
+        if (members.size() < 2 || members.size() > kMaxBucket) continue;
+        for (size_t a = 0; a < members.size(); ++a) {
+            for (size_t b = a + 1; b < members.size(); ++b) {
+                // Пара уже в одной группе (совпала в другой полосе) - не сравниваем
+                if (sets.find(members[a]) == sets.find(members[b])) continue;
+                if (prints[members[a]].matches(prints[members[b]])) sets.unite(members[a], members[b]);
+            }
+        }
+    }
+
+    std::unordered_map<size_t, std::vector<size_t>> byRoot;
+    for (size_t i = 0; i < prints.size(); ++i) {
+        if (prints[i].isValid()) byRoot[sets.find(i)].push_back(i);
+    }
+    std::vector<std::vector<size_t>> groups;
+    for (auto& entry : byRoot) {
+        if (entry.second.size() >= 2) groups.push_back(std::move(entry.second));
+    }
+    std::sort(groups.begin(), groups.end());  // Порядок входа, а не хэш-таблицы
+    return groups;
+}
@@ -0,0 +1,59 @@
+// AcousticFingerprint.h
+#pragma once
+#include <array>
+#include <cstddef> // size_t
+#include <cstdint> // uint32_t, uint64_t
+#include <string>
+#include <vector>
+
+#include "SpectralFrames.h"  // Прореживание и окна БПФ
+
+// Компактный акустический отпечаток для поиска близких копий одной записи
+// (другой битрейт, кодек, громкость). По окнам SpectralFrames считается
+// хрома - доли энергии 12 классов высоты тона (громкость не влияет). Хрома
+// усредняется по kSegments равным долям трека, и каждый класс каждой доли
+// дает бит "выше среднего по доле": 384 бита и длительность. Сходство -
+// расстояние Хэмминга. Кандидаты в пары ищутся LSH: отпечатки раскладываются
+// по корзинам полос из 16 бит, и сравниваются только совпавшие хотя бы в
+// одной полосе - вместо сравнения каждого с каждым
+class AcousticFingerprint {
+public:
+    static constexpr size_t kSegments = 32;
+    static constexpr size_t kBits = kSegments * 12;
+    static constexpr size_t kWords = kBits / 64;
+
+    // Накопление отсчетов без знания длины трека (блоками декодера)
+    class Builder {
+    public:
+        Builder();
+        Builder(const Builder&) = delete;  // Обработчик окон ссылается на this
+        Builder& operator=(const Builder&) = delete;
+
+        void add(const float* samples, size_t count, uint32_t sampleRate);  // Моно, -1..1
+        bool finish(AcousticFingerprint& fingerprint);  // false - трек слишком короткий
+
+    private:
+        SpectralFrames frames_;
+        std::vector<std::array<float, 12>> chroma_;  // Доли хромы окон
+    };
+
+    bool isValid() const { return durationMs_ > 0; }
+    uint32_t durationMs() const { return durationMs_; }
+
+    // Число несовпадающих битов
+    int distance(const AcousticFingerprint& other) const;
+    // Та же запись: близкие биты и длительность
+    bool matches(const AcousticFingerprint& other) const;
+
+    // Биты - шестнадцатеричной строкой (для файла кэша)
+    std::string toHex() const;
+    static bool fromHex(const std::string& hex, uint32_t durationMs, AcousticFingerprint& fingerprint);
+
+    // Группы совпадающих отпечатков: индексы во входном массиве, в группе
+    // не меньше двух; невалидные отпечатки пропускаются
+    static std::vector<std::vector<size_t>> group(const std::vector<AcousticFingerprint>& prints);
+
+private:
+    std::array<uint64_t, kWords> bits_{};
+    uint32_t durationMs_ = 0;
+};
@@ -0,0 +1,331 @@
+// AudioFeatures.cpp
+#include "AudioFeatures.h"
+#include <algorithm> // std::clamp, std::max, std::min
+#include <cctype>    // std::tolower
+#include <cmath>
+#include <locale>    // Точка в числах кэша при любой локали
+#include <sstream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h> // SSE2: автокорреляция огибающей по 4 отсчета
+#define ALEXMUSIC_FEATURES_SSE2 1
+#endif
+
+namespace {
+const size_t kOnsetHop = 128;          // Шаг огибающей атак, прореженных отсчетов (~12 мс)
+const double kSilenceDb = -60.0;       // Окна тише не входят в статистику
+const double kAudibleLevel = 1e-6;     // Средний квадрат блока границ звука: -60 dBFS
+const uint32_t kBlocksPerSecond = 100; // Блоки границ звука по 10 мс
+const size_t kMinFrames = 32;          // ~3 с звука
+const double kMinBpm = 60.0;
+const double kMaxBpm = 200.0;
+const double kPreferredBpm = 120.0;    // Середина априорного распределения темпа (октава в обе стороны)
+const double kMinKeyCorrelation = 0.3; // Слабее - хрома почти ровная (шум, ударные), тональности нет
+
+// Профили тональностей Крумханзля-Кесслера, от тоники по полутонам
+const double kMajorProfile[12] = {6.35, 2.23, 3.48, 2.33, 4.38, 4.09, 2.52, 5.19, 2.39, 3.66, 2.29, 2.88};
+const double kMinorProfile[12] = {6.33, 2.68, 3.52, 5.38, 2.60, 3.53, 2.54, 4.75, 3.98, 2.69, 3.34, 3.17};
+const char* const kNoteNames[12] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+const size_t kChromaOfC = 3;           // Хрома считается от ля, тональности - от до
+
+// Сумма a[i] * b[i]: произведения по 4 в float, накопление в double (огибающая - десятки тысяч шагов)
+double dotProduct(const float* a, const float* b, size_t count) {
+    size_t i = 0;
+    double sum = 0.0;
+#ifdef ALEXMUSIC_FEATURES_SSE2
+    __m128d low = _mm_setzero_pd();
+    __m128d high = _mm_setzero_pd();
+    for (; i + 4 <= count; i += 4) {
+        const __m128 product = _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+        low = _mm_add_pd(low, _mm_cvtps_pd(product));
+        high = _mm_add_pd(high, _mm_cvtps_pd(_mm_movehl_ps(product, product)));
+    }
+    const __m128d total = _mm_add_pd(low, high);
+    sum = _mm_cvtsd_f64(total) + _mm_cvtsd_f64(_mm_unpackhi_pd(total, total));
+#endif
+    for (; i < count; ++i) sum += double(a[i]) * b[i];
+    return sum;
+}
+}
+
+AudioFeatures::Builder::Builder()
+    : frames_([this](const SpectralFrames::Frame& frame) { onFrame(frame); }) {}
+
+void AudioFeatures::Builder::add(const float* samples, size_t count, uint32_t sampleRate) {
+    scanSilence(samples, count, sampleRate);
+    frames_.add(samples, count, sampleRate);
+}
+
+// Границы звука - по исходным отсчетам: точность блока не зависит от прореживания
+void AudioFeatures::Builder::scanSilence(const float* samples, size_t count, uint32_t sampleRate) {
+    if (sampleRate == 0) return;
+    if (sampleRate != blockRate_) {
+        blockRate_ = sampleRate;
+        blockSize_ = std::max<size_t>(1, sampleRate / kBlocksPerSecond);
+        blockFill_ = 0;
+        blockSquares_ = 0.0;
+    }
+    const double blockMs = 1000.0 * blockSize_ / sampleRate;
+
+    while (count > 0) {
+        const size_t take = std::min(count, blockSize_ - blockFill_);
+        blockSquares_ += dotProduct(samples, samples, take);
+        blockFill_ += take;
+        samples += take;
+        count -= take;
+        if (blockFill_ < blockSize_) break;
+
+        if (blockSquares_ / blockSize_ > kAudibleLevel) {
+            if (firstAudibleMs_ < 0.0) firstAudibleMs_ = scannedMs_;
+            lastAudibleMs_ = scannedMs_ + blockMs;
+        }
+        scannedMs_ += blockMs;
+        blockFill_ = 0;
+        blockSquares_ = 0.0;
+    }
+}
+
+void AudioFeatures::Builder::onFrame(const SpectralFrames::Frame& frame) {
+    ++frameCount_;
+    onsetRate_ = frame.rate / kOnsetHop;
+
+    // Огибающая атак и переходы через ноль - только по новым отсчетам окна
+    const float* fresh = frame.samples + (SpectralFrames::kWindow - frame.fresh);
+    for (size_t block = 0; block + kOnsetHop <= frame.fresh; block += kOnsetHop) {
+        float energy = 0.0f;
+        for (size_t i = block; i < block + kOnsetHop; ++i) {
+            const float difference = fresh[i] - previousSample_;  // Разность подчеркивает атаки
+            energy += difference * difference;
+            if ((fresh[i] >= 0.0f) != (previousSample_ >= 0.0f)) crossings_ += 1.0;
+            previousSample_ = fresh[i];
+        }
+        onsetEnergy_.push_back(std::log(1e-10f + energy / kOnsetHop));
+    }
+
+    // Громкость окна
+    double squares = 0.0;
+    for (size_t i = 0; i < SpectralFrames::kWindow; ++i) squares += double(frame.samples[i]) * frame.samples[i];
+    const double loudness = 10.0 * std::log10(1e-12 + squares / SpectralFrames::kWindow);
+    if (loudness < kSilenceDb) return;
+    ++soundFrames_;
+    loudnessSum_ += loudness;
+    loudnessSquares_ += loudness * loudness;
+
+    // Спектральный центроид (в октавах от 100 Гц) и хрома
+    const std::vector<float>& power = *frame.power;
+    double weighted = 0.0, total = 0.0;
+    for (size_t k = 1; k < power.size(); ++k) {
+        weighted += k * frame.binHz * power[k];
+        total += power[k];
+    }
+    if (total > 0.0) {
+        const double octaves = std::log2(std::max(weighted / total, 1.0) / 100.0);
+        centroidSum_ += octaves;
+        centroidSquares_ += octaves * octaves;
+    }
+    if (frame.chromaEnergy > 1e-9f) {
+        for (size_t p = 0; p < 12; ++p) chroma_[p] += frame.chroma[p] / frame.chromaEnergy;
+    }
+}
+
+bool AudioFeatures::Builder::finish(AudioFeatures& features) {
+    features = AudioFeatures();
+    if (frameCount_ < kMinFrames || soundFrames_ < kMinFrames / 2) return false;
+
+    const double n = double(soundFrames_);
+    const double centroid = centroidSum_ / n;
+    features.centroidHz_ = float(100.0 * std::exp2(centroid));
+    features.centroidSpread_ = float(std::sqrt(std::max(0.0, centroidSquares_ / n - centroid * centroid)));
+    features.loudnessDb_ = float(loudnessSum_ / n);
+    features.dynamicsDb_ = float(std::sqrt(std::max(0.0, loudnessSquares_ / n - double(features.loudnessDb_) * features.loudnessDb_)));
+    features.noisiness_ = float(crossings_ / std::max<size_t>(1, onsetEnergy_.size() * kOnsetHop));
+
+    double chromaTotal = 0.0;
+    for (double value : chroma_) chromaTotal += value;
+    for (size_t p = 0; p < 12; ++p) {
+        features.chroma_[p] = chromaTotal > 0.0 ? float(chroma_[p] / chromaTotal) : 0.0f;
+    }
+
+    // Огибающая атак: положительный прирост лог. энергии, без среднего
+    std::vector<float> flux(onsetEnergy_.size(), 0.0f);
+    double fluxSum = 0.0;
+    for (size_t i = 1; i < onsetEnergy_.size(); ++i) {
+        flux[i] = std::max(0.0f, onsetEnergy_[i] - onsetEnergy_[i - 1]);
+        fluxSum += flux[i];
+    }
+    const double fluxMean = flux.empty() ? 0.0 : fluxSum / flux.size();
+    features.onsetDensity_ = float(fluxMean);
+    for (float& value : flux) value -= float(fluxMean);
+
+    // Темп: сдвиг с наибольшей автокорреляцией огибающей среди 60..200 уд/мин,
+    // с мягким предпочтением темпов около 120 (против ошибок на октаву)
+    const size_t minLag = std::max<size_t>(2, size_t(std::floor(60.0 * onsetRate_ / kMaxBpm)));
+    const size_t maxLag = size_t(std::ceil(60.0 * onsetRate_ / kMinBpm)) + 1;
+    if (flux.size() > 2 * maxLag) {
+        auto autocorrelation = [&flux](size_t lag) {
+            const size_t count = flux.size() - lag;
+            return dotProduct(flux.data(), flux.data() + lag, count) / count;
+        };
+        std::vector<double> ac(maxLag + 2, 0.0);
+        for (size_t lag = minLag - 1; lag <= maxLag + 1; ++lag) ac[lag] = autocorrelation(lag);
+        const double zero = autocorrelation(0);
+
+        size_t best = 0;
+        double bestScore = 0.0;
+        for (size_t lag = minLag; lag <= maxLag; ++lag) {
+            const double bpm = 60.0 * onsetRate_ / lag;
+            if (bpm < kMinBpm || bpm > kMaxBpm) continue;
+            const double octaves = std::log2(bpm / kPreferredBpm);
+            const double score = ac[lag] * std::exp(-0.5 * octaves * octaves);
+            if (score > bestScore) {
+                bestScore = score;
+                best = lag;
+            }
+        }
+        if (best > 0 && zero > 0.0) {
+            // Уточнение сдвига параболой по соседям
+            const double left = ac[best - 1], center = ac[best], right = ac[best + 1];
+            const double curvature = left - 2.0 * center + right;
+            const double offset = curvature < 0.0 ? std::clamp(0.5 * (left - right) / curvature, -0.5, 0.5) : 0.0;
+            features.bpm_ = float(60.0 * onsetRate_ / (best + offset));
+            features.pulse_ = float(std::clamp(center / zero, 0.0, 1.0));
+        }
+    }
+
+    features.detectKey();
+    if (firstAudibleMs_ >= 0.0) {
+        features.audibleStartMs_ = static_cast<uint32_t>(firstAudibleMs_);
+        features.audibleEndMs_ = static_cast<uint32_t>(std::ceil(lastAudibleMs_));
+    }
+    features.valid_ = true;
+    return true;
+}
+
+// Тональность - профиль, лучше всего коррелирующий со средней хромой
+void AudioFeatures::detectKey() {
+    key_ = -1;
+    double mean = 0.0;
+    for (float value : chroma_) mean += value;
+    mean /= 12.0;
+    double spread = 0.0;
+    for (float value : chroma_) spread += (value - mean) * (value - mean);
+    if (spread < 1e-12) return;
+
+    double best = kMinKeyCorrelation;
+    for (int mode = 0; mode < 2; ++mode) {
+        const double* profile = mode == 0 ? kMajorProfile : kMinorProfile;
+        double profileMean = 0.0;
+        for (size_t i = 0; i < 12; ++i) profileMean += profile[i];
+        profileMean /= 12.0;
+        double profileSpread = 0.0;
+        for (size_t i = 0; i < 12; ++i) profileSpread += (profile[i] - profileMean) * (profile[i] - profileMean);
+
+        for (size_t tonic = 0; tonic < 12; ++tonic) {
+            double covariance = 0.0;
+            for (size_t i = 0; i < 12; ++i) {
+                covariance += (chroma_[(tonic + kChromaOfC + i) % 12] - mean) * (profile[i] - profileMean);
+            }
+            const double correlation = covariance / std::sqrt(spread * profileSpread);
+            if (correlation > best) {
+                best = correlation;
+                key_ = mode * 12 + int(tonic);
+            }
+        }
+    }
+}
+
+std::string AudioFeatures::keyName(int key) {
+    if (key < 0 || key >= kKeyCount) return std::string();
+    return std::string(kNoteNames[key % 12]) + (key >= 12 ? "m" : "");
+}
+
+int AudioFeatures::keyFromName(const std::string& name) {
+    std::string text;
+    for (char c : name) {
+        if (c != ' ') text += char(std::tolower(static_cast<unsigned char>(c)));
+    }
+    if (text.empty()) return -1;
+
+    static const int kLetterPitch[7] = {9, 11, 0, 2, 4, 5, 7};  // a..g
+    if (text[0] < 'a' || text[0] > 'g') return -1;
+    int pitch = kLetterPitch[text[0] - 'a'];
+    size_t i = 1;
+    if (i < text.size() && text[i] == '#') {
+        pitch += 1;
+        ++i;
+    } else if (i < text.size() && text[i] == 'b') {
+        pitch += 11;
+        ++i;
+    }
+
+    const std::string mode = text.substr(i);
+    bool minor;
+    if (mode.empty() || mode == "maj" || mode == "major") minor = false;
+    else if (mode == "m" || mode == "min" || mode == "minor") minor = true;
+    else return -1;
+    return (pitch % 12) + (minor ? 12 : 0);
+}
+
+int AudioFeatures::camelotOrder(int key) {
+    if (key < 0 || key >= kKeyCount) return -1;
+    const bool minor = key >= 12;
+    // Минор стоит на одном номере с параллельным мажором (на малую терцию выше), номера идут по квинтам
+    const int major = minor ? (key % 12 + 3) % 12 : key;
+    const int number = (major * 7 + 7) % 12;  // До мажор - 8B
+    return number * 2 + (minor ? 0 : 1);
+}
+
+AudioFeatures::Vector AudioFeatures::vector() const {
+    Vector v{};
+    v[0] = bpm_ > 0.0f ? std::clamp((bpm_ - 60.0f) / 140.0f, 0.0f, 1.0f) : 0.5f;
+    v[1] = pulse_;
+    v[2] = float(std::log2(std::max(centroidHz_, 1.0f) / 100.0f) / 6.0);
+    v[3] = centroidSpread_;
+    v[4] = (loudnessDb_ + 60.0f) / 60.0f;
+    v[5] = dynamicsDb_ / 20.0f;
+    v[6] = onsetDensity_;
+    v[7] = noisiness_;
+    for (size_t p = 0; p < 12; ++p) v[8 + p] = chroma_[p];
+    return v;
+}
+
+std::string AudioFeatures::serialize() const {
+    std::ostringstream out;
+    out.imbue(std::locale::classic());
+    out.precision(9);  // float восстанавливается точно
+    out << bpm_ << ',' << pulse_ << ',' << centroidHz_ << ',' << centroidSpread_ << ','
+        << loudnessDb_ << ',' << dynamicsDb_ << ',' << onsetDensity_ << ',' << noisiness_;
+    for (float value : chroma_) out << ',' << value;
+    out << ',' << audibleStartMs_ << ',' << audibleEndMs_;
+    return out.str();
+}
+
+bool AudioFeatures::parse(const std::string& text, AudioFeatures& features) {
+    std::istringstream in(text);
+    in.imbue(std::locale::classic());
+    std::array<float, 8 + 12> values{};
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0 && in.get() != ',') return false;
+        if (!(in >> values[i])) return false;
+    }
+    // Границы звука - в конце строки; в кэше прежней версии их нет
+    uint32_t audibleStart = 0, audibleEnd = 0;
+    if (in.get() == ',' && !(in >> audibleStart && in.get() == ',' && in >> audibleEnd)) return false;
+
+    AudioFeatures parsed;
+    parsed.bpm_ = values[0];
+    parsed.pulse_ = values[1];
+    parsed.centroidHz_ = values[2];
+    parsed.centroidSpread_ = values[3];
+    parsed.loudnessDb_ = values[4];
+    parsed.dynamicsDb_ = values[5];
+    parsed.onsetDensity_ = values[6];
+    parsed.noisiness_ = values[7];
+    for (size_t p = 0; p < 12; ++p) parsed.chroma_[p] = values[8 + p];
+    parsed.detectKey();
+    parsed.audibleStartMs_ = audibleStart;
+    parsed.audibleEndMs_ = audibleEnd;
+    parsed.valid_ = true;
+    features = parsed;
+    return true;
+}
@@ -0,0 +1,103 @@
+// AudioFeatures.h
+#pragma once
+#include <array>
+#include <cstddef> // size_t
+#include <cstdint> // uint32_t
+#include <string>
+#include <vector>
+
+#include "SpectralFrames.h"  // Прореживание и окна БПФ
+
+// Признаки звучания трека для подбора похожих: темп, яркость (спектральный
+// центроид), громкость и ее разброс, плотность атак, шумность и средняя
+// хрома (тональная окраска). Считаются за один проход по окнам
+// SpectralFrames; темп - по автокорреляции огибающей атак с шагом ~12 мс,
+// тональность - по корреляции средней хромы с профилями Крумханзля.
+// Попутно по исходным отсчетам ищутся границы звука: первый и последний
+// блок ~10 мс с RMS выше порога тишины.
+// vector() - kDims чисел в сопоставимых шкалах (около 0..1), из них
+// SimilarityIndex строит нормированные строки для косинусной близости
+class AudioFeatures {
+public:
+    static constexpr size_t kDims = 20;  // 8 скалярных признаков + 12 классов хромы (5 регистров SSE)
+    using Vector = std::array<float, kDims>;
+
+    // Накопление отсчетов без знания длины трека (блоками декодера)
+    class Builder {
+    public:
+        Builder();
+        Builder(const Builder&) = delete;  // Обработчик окон ссылается на this
+        Builder& operator=(const Builder&) = delete;
+
+        void add(const float* samples, size_t count, uint32_t sampleRate);  // Моно, -1..1
+        bool finish(AudioFeatures& features);  // false - трек слишком короткий или тишина
+
+    private:
+        void onFrame(const SpectralFrames::Frame& frame);
+        void scanSilence(const float* samples, size_t count, uint32_t sampleRate);
+
+        SpectralFrames frames_;
+        uint32_t blockRate_ = 0;             // Частота, под которую посчитан blockSize_
+        size_t blockSize_ = 0;               // Отсчетов в блоке поиска тишины
+        size_t blockFill_ = 0;
+        double blockSquares_ = 0.0;
+        double scannedMs_ = 0.0;             // Конец последнего полного блока
+        double firstAudibleMs_ = -1.0;       // Начало первого блока со звуком
+        double lastAudibleMs_ = -1.0;        // Конец последнего блока со звуком
+        double onsetRate_ = 0.0;             // Шагов огибающей атак в секунду
+        float previousSample_ = 0.0f;
+        std::vector<float> onsetEnergy_;     // Лог. энергия разности отсчетов по шагам
+        double centroidSum_ = 0.0, centroidSquares_ = 0.0;
+        double loudnessSum_ = 0.0, loudnessSquares_ = 0.0;
+        double crossings_ = 0.0;             // Переходы через ноль (шумность)
+        std::array<double, 12> chroma_{};    // Сумма долей хромы
+        size_t soundFrames_ = 0;             // Окна громче порога тишины
+        size_t frameCount_ = 0;
+    };
+
+    bool isValid() const { return valid_; }
+
+    float bpm() const { return bpm_; }                    // Ударов в минуту
+    float centroidHz() const { return centroidHz_; }
+    float loudnessDb() const { return loudnessDb_; }      // Средний RMS звучащих окон
+    const std::array<float, 12>& chroma() const { return chroma_; }  // Доли, сумма 1 (0 - ля)
+
+    // Тональность: 0..11 - мажор от до (C, C#, ... B), 12..23 - минор; -1 - не определена.
+    // Выводится из хромы, поэтому в кэше отдельно не хранится
+    int key() const { return key_; }
+    static constexpr int kKeyCount = 24;
+    static std::string keyName(int key);                 // "C", "F#m"; пусто для -1
+    static int keyFromName(const std::string& name);     // "Am", "Bb", "f#min", "a minor"; -1 - не тональность
+    // Место на круге Camelot (1A, 1B, 2A, ...): соседние - гармонично сводимые
+    static int camelotOrder(int key);                    // 0..23; -1 для -1
+
+    // Первая и последняя слышимая миллисекунда (до них и после них - тишина);
+    // нет границ - признаки из кэша прежней версии
+    bool hasAudibleRange() const { return audibleEndMs_ > 0; }
+    uint32_t audibleStartMs() const { return audibleStartMs_; }
+    uint32_t audibleEndMs() const { return audibleEndMs_; }
+
+    // Признаки для поиска похожих
+    Vector vector() const;
+
+    // Текстовое представление для файла кэша (числа через запятую)
+    std::string serialize() const;
+    static bool parse(const std::string& text, AudioFeatures& features);
+
+private:
+    void detectKey();
+
+    bool valid_ = false;
+    int key_ = -1;
+    float bpm_ = 0.0f;
+    float pulse_ = 0.0f;          // Выраженность ритма: пик автокорреляции к нулевому сдвигу
+    float centroidHz_ = 0.0f;
+    float centroidSpread_ = 0.0f; // Разброс центроида, октав
+    float loudnessDb_ = 0.0f;
+    float dynamicsDb_ = 0.0f;     // Разброс громкости окон
+    float onsetDensity_ = 0.0f;   // Средний положительный прирост энергии за шаг
+    float noisiness_ = 0.0f;      // Доля переходов через ноль
+    std::array<float, 12> chroma_{};
+    uint32_t audibleStartMs_ = 0;
+    uint32_t audibleEndMs_ = 0;
+};
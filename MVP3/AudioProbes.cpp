@@ -0,0 +1,384 @@
+// AudioProbes.cpp
+#include "AudioProbes.h"
+#include <cstring> // std::memcmp
+
+#include "Id3Reader.h"    // Теги MP3
+#include "Mp3Frame.h"     // Подпись потока MP3
+#include "Mp3SeekIndex.h" // Длительность MP3 по кадрам
+
+namespace {
+// Пределы чтения: заголовки и теги небольшие, звуковые данные не читаются вовсе
+const qint64 kMaxCommentBytes = 1024 * 1024;      // Блок комментариев Vorbis/FLAC
+const qint64 kOggHeadBytes = 256 * 1024;          // Заголовочные пакеты Ogg
+const qint64 kOggTailBytes = 64 * 1024;           // Поиск последней страницы Ogg
+const qint64 kMaxMoovBytes = 64 * 1024 * 1024;    // Атом moov с таблицами сэмплов
+const qint64 kMaxListBytes = 64 * 1024;           // Чанк LIST/INFO
+
+uint32_t le16(const unsigned char* p) { return uint32_t(p[0]) | (uint32_t(p[1]) << 8); }
+uint32_t le32(const unsigned char* p) { return le16(p) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24); }
+uint64_t le64(const unsigned char* p) { return uint64_t(le32(p)) | (uint64_t(le32(p + 4)) << 32); }
+uint32_t be32(const unsigned char* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+uint64_t be64(const unsigned char* p) { return (uint64_t(be32(p)) << 32) | be32(p + 4); }
+
+bool startsWith(ByteView data, size_t offset, const char* magic) {
+    const size_t n = std::strlen(magic);
+    return offset + n <= data.size && std::memcmp(data.data + offset, magic, n) == 0;
+}
+
+QString utf8(ByteView text) {
+    return QString::fromUtf8(reinterpret_cast<const char*>(text.data), static_cast<qsizetype>(text.size)).trimmed();
+}
+
+// Комментарии Vorbis (FLAC и Ogg): вендор, затем пары "КЛЮЧ=значение" в UTF-8
+void readVorbisComments(ByteView data, ProbeResult& result) {
+    size_t pos = 0;
+    auto readLength = [&](uint32_t& value) {
+        if (pos + 4 > data.size) return false;
+        value = le32(data.data + pos);
+        pos += 4;
+        return value <= data.size - pos;
+    };
+
+    uint32_t length = 0;
+    if (!readLength(length)) return;
+    pos += length;  // Вендор
+    uint32_t count = 0;
+    if (pos + 4 > data.size) return;
+    count = le32(data.data + pos);
+    pos += 4;
+
+    for (uint32_t i = 0; i < count && readLength(length); ++i) {
+        const QString comment = utf8(data.mid(pos, length));
+        pos += length;
+        const int eq = comment.indexOf('=');
+        if (eq <= 0) continue;
+        const QString key = comment.left(eq).toUpper();
+        const QString value = comment.mid(eq + 1);
+        if (key == "TITLE" && result.title.isEmpty()) result.title = value;
+        else if (key == "ARTIST" && result.artist.isEmpty()) result.artist = value;
+        else if (key == "ALBUM" && result.album.isEmpty()) result.album = value;
+    }
+}
+}
+
+// MP3
+
+bool Mp3Probe::sniff(ByteView head) const {
+    if (startsWith(head, 0, "ID3")) return true;
+    Mp3FrameHeader header;
+    return mp3FindSync(head.data, head.size, 0, header) < head.size;
+}
+
+ProbeResult Mp3Probe::probe(MappedFile& file, bool withDuration) const {
+    ProbeResult result;
+    Id3Reader::Tags tags = Id3Reader(file.fileName()).tags();
+    result.title = tags.title;
+    result.artist = tags.artist;
+    result.album = tags.album;
+
+    if (!withDuration) {
+        result.valid = true;  // Подпись уже совпала
+        return result;
+    }
+    ByteView data = file.all();
+    Mp3SeekIndex index;
+    if (!index.build(data.data, data.size)) {
+        result.error = "В файле нет кадров MPEG audio";
+        return result;
+    }
+    result.valid = true;
+    result.durationMs = index.durationMs();
+    return result;
+}
+
+// FLAC
+
+bool FlacProbe::sniff(ByteView head) const {
+    return startsWith(head, 0, "fLaC");
+}
+
+ProbeResult FlacProbe::probe(MappedFile& file, bool withDuration) const {
+    Q_UNUSED(withDuration);  // Длительность лежит в STREAMINFO - она дешевая
+    ProbeResult result;
+
+    // Блоки метаданных: 1 байт (флаг последнего + тип), 3 байта длины
+    qint64 offset = 4;
+    bool last = false;
+    bool haveStreamInfo = false;
+    while (!last && offset + 4 <= file.size()) {
+        ByteView header = file.map(offset, 4);
+        if (header.size < 4) break;
+        last = header.data[0] & 0x80;
+        const int type = header.data[0] & 0x7F;
+        const qint64 length = (qint64(header.data[1]) << 16) | (qint64(header.data[2]) << 8) | header.data[3];
+        offset += 4;
+
+        if (type == 0 && length >= 34) {
+            ByteView info = file.map(offset, 34);
+            if (info.size < 34) break;
+            // 20 бит частоты, 3 - каналов, 5 - разрядности, 36 - числа сэмплов
+            const uint32_t sampleRate = (uint32_t(info.data[10]) << 12) | (uint32_t(info.data[11]) << 4) |
+                                        (info.data[12] >> 4);
+            const uint64_t totalSamples = (uint64_t(info.data[13] & 0x0F) << 32) | be32(info.data + 14);
+            if (sampleRate > 0) {
+                haveStreamInfo = true;
+                result.durationMs = static_cast<qint64>(totalSamples * 1000 / sampleRate);
+            }
+        } else if (type == 4 && length <= kMaxCommentBytes) {
+            readVorbisComments(file.map(offset, length), result);
+        }
+        offset += length;
+    }
+
+    if (!haveStreamInfo) {
+        result.error = "Нет блока STREAMINFO";
+        return result;
+    }
+    if (offset >= file.size()) {
+        result.error = "Нет звуковых данных после метаданных";
+        return result;
+    }
+    result.valid = true;
+    return result;
+}
+
+// Ogg
+
+bool OggProbe::sniff(ByteView head) const {
+    return startsWith(head, 0, "OggS");
+}
+
+ProbeResult OggProbe::probe(MappedFile& file, bool withDuration) const {
+    ProbeResult result;
+    ByteView head = file.head(kOggHeadBytes);
+
+    // Сборка первых двух пакетов логического потока из страниц
+    QByteArray packets[2];
+    int packet = 0;
+    uint32_t serial = 0;
+    size_t pos = 0;
+    while (packet < 2 && startsWith(head, pos, "OggS") && pos + 27 <= head.size) {
+        const unsigned char* page = head.data + pos;
+        if (pos == 0) serial = le32(page + 14);
+        const size_t segments = page[26];
+        if (pos + 27 + segments > head.size) break;
+        size_t body = pos + 27 + segments;
+        for (size_t i = 0; i < segments && packet < 2; ++i) {
+            const size_t lacing = page[27 + i];
+            ByteView chunk = head.mid(body, lacing);
+            if (chunk.size < lacing) break;  // Страница обрезана границей чтения
+            if (le32(page + 14) == serial) {
+                packets[packet].append(reinterpret_cast<const char*>(chunk.data), static_cast<qsizetype>(chunk.size));
+                if (lacing < 255) ++packet;  // Пакет закончился
+            }
+            body += lacing;
+        }
+        pos = body;
+    }
+
+    const ByteView id{reinterpret_cast<const unsigned char*>(packets[0].constData()),
+                      static_cast<size_t>(packets[0].size())};
+    const ByteView tags{reinterpret_cast<const unsigned char*>(packets[1].constData()),
+                        static_cast<size_t>(packets[1].size())};
+
+    uint32_t rate = 0;
+    uint64_t preSkip = 0;
+    if (startsWith(id, 0, "\x01vorbis") && id.size >= 16) {
+        rate = le32(id.data + 12);
+        if (startsWith(tags, 0, "\x03vorbis")) readVorbisComments(tags.mid(7, tags.size), result);
+    } else if (startsWith(id, 0, "OpusHead") && id.size >= 12) {
+        rate = 48000;  // Позиции Opus всегда в сэмплах 48 кГц
+        preSkip = le16(id.data + 10);
+        if (startsWith(tags, 0, "OpusTags")) readVorbisComments(tags.mid(8, tags.size), result);
+    } else {
+        result.error = "Поток Ogg не содержит Vorbis или Opus";
+        return result;
+    }
+    if (rate == 0) {
+        result.error = "Неверный заголовок потока Ogg";
+        return result;
+    }
+
+    result.valid = true;
+    if (!withDuration) return result;
+
+    // Длительность: granule position последней страницы этого потока
+    ByteView tail = file.tail(kOggTailBytes);
+    for (size_t i = tail.size >= 27 ? tail.size - 27 : 0; ; --i) {
+        if (startsWith(tail, i, "OggS") && i + 27 <= tail.size && le32(tail.data + i + 14) == serial) {
+            const uint64_t granule = le64(tail.data + i + 6);
+            if (granule != ~uint64_t(0) && granule > preSkip) {
+                result.durationMs = static_cast<qint64>((granule - preSkip) * 1000 / rate);
+                break;
+            }
+        }
+        if (i == 0) break;
+    }
+    if (result.durationMs <= 0) {
+        result.valid = false;
+        result.error = "Не удалось определить длительность потока Ogg";
+    }
+    return result;
+}
+
+// MP4
+
+bool Mp4Probe::sniff(ByteView head) const {
+    return startsWith(head, 4, "ftyp");
+}
+
+namespace {
+// Обход дочерних атомов: fn(тип, содержимое) для каждого целого атома
+template <typename Fn>
+void forEachAtom(ByteView data, Fn&& fn) {
+    size_t pos = 0;
+    while (pos + 8 <= data.size) {
+        uint64_t size = be32(data.data + pos);
+        size_t header = 8;
+        if (size == 1) {
+            if (pos + 16 > data.size) return;
+            size = be64(data.data + pos + 8);
+            header = 16;
+        } else if (size == 0) {
+            size = data.size - pos;  // До конца родителя
+        }
+        if (size < header || size > data.size - pos) return;  // Атом обрезан
+        fn(data.mid(pos + 4, 4), data.mid(pos + header, size - header));
+        pos += size;
+    }
+}
+
+bool isAtom(ByteView type, const char* name) {
+    return type.size == 4 && std::memcmp(type.data, name, 4) == 0;
+}
+
+// Значение элемента ilst: атом data (тип, локаль, затем текст)
+QString ilstText(ByteView item) {
+    QString text;
+    forEachAtom(item, [&text](ByteView type, ByteView body) {
+        if (text.isEmpty() && isAtom(type, "data") && body.size > 8) {
+            text = utf8(body.mid(8, body.size));
+        }
+    });
+    return text;
+}
+}
+
+ProbeResult Mp4Probe::probe(MappedFile& file, bool withDuration) const {
+    Q_UNUSED(withDuration);  // Длительность лежит в mvhd
+    ProbeResult result;
+
+    // Верхний уровень читается по заголовкам атомов: mdat пропускается, не читаясь
+    qint64 offset = 0;
+    ByteView moov;
+    bool haveMdat = false;
+    while (offset + 8 <= file.size()) {
+        ByteView header = file.map(offset, 16);
+        if (header.size < 8) break;
+        qint64 size = be32(header.data);
+        qint64 headerSize = 8;
+        if (size == 1) {
+            if (header.size < 16) break;
+            size = static_cast<qint64>(be64(header.data + 8));
+            headerSize = 16;
+        } else if (size == 0) {
+            size = file.size() - offset;
+        }
+        if (size < headerSize) break;
+
+        const ByteView type = header.mid(4, 4);
+        if (isAtom(type, "mdat")) haveMdat = true;
+        if (isAtom(type, "moov") && size <= kMaxMoovBytes) {
+            moov = file.map(offset + headerSize, size - headerSize);
+        }
+        offset += size;
+    }
+
+    if (moov.empty()) {
+        result.error = "Нет атома moov";
+        return result;
+    }
+
+    forEachAtom(moov, [&result](ByteView type, ByteView body) {
+        if (isAtom(type, "mvhd") && body.size >= 20) {
+            // Версия 1 - 64-битные времена
+            const bool v1 = body.data[0] == 1;
+            if (v1 && body.size < 32) return;
+            const uint32_t timescale = be32(body.data + (v1 ? 20 : 12));
+            const uint64_t duration = v1 ? be64(body.data + 24) : be32(body.data + 16);
+            if (timescale > 0) result.durationMs = static_cast<qint64>(duration * 1000 / timescale);
+        } else if (isAtom(type, "udta")) {
+            forEachAtom(body, [&result](ByteView type, ByteView body) {
+                if (!isAtom(type, "meta") || body.size < 4) return;
+                forEachAtom(body.mid(4, body.size), [&result](ByteView type, ByteView body) {  // meta - полный атом
+                    if (!isAtom(type, "ilst")) return;
+                    forEachAtom(body, [&result](ByteView type, ByteView item) {
+                        if (isAtom(type, "\xA9nam")) result.title = ilstText(item);
+                        else if (isAtom(type, "\xA9" "ART")) result.artist = ilstText(item);
+                        else if (isAtom(type, "\xA9" "alb")) result.album = ilstText(item);
+                    });
+                });
+            });
+        }
+    });
+
+    if (!haveMdat || result.durationMs <= 0) {
+        result.error = haveMdat ? "Не удалось определить длительность" : "Нет звуковых данных (mdat)";
+        return result;
+    }
+    result.valid = true;
+    return result;
+}
+
+// WAV
+
+bool WavProbe::sniff(ByteView head) const {
+    return startsWith(head, 0, "RIFF") && startsWith(head, 8, "WAVE");
+}
+
+ProbeResult WavProbe::probe(MappedFile& file, bool withDuration) const {
+    Q_UNUSED(withDuration);
+    ProbeResult result;
+
+    uint32_t byteRate = 0;
+    qint64 dataSize = -1;
+    qint64 offset = 12;
+    while (offset + 8 <= file.size()) {
+        ByteView header = file.map(offset, 8);
+        if (header.size < 8) break;
+        const qint64 size = le32(header.data + 4);
+        const qint64 body = offset + 8;
+
+        if (startsWith(header, 0, "fmt ") && size >= 16) {
+            ByteView fmt = file.map(body, 16);
+            if (fmt.size == 16) byteRate = le32(fmt.data + 8);
+        } else if (startsWith(header, 0, "data")) {
+            dataSize = qMin(size, file.size() - body);  // Обрезанный файл - считаем, что есть
+        } else if (startsWith(header, 0, "LIST") && size >= 4 && size <= kMaxListBytes) {
+            ByteView list = file.map(body, size);
+            if (startsWith(list, 0, "INFO")) {
+                // Подчанки INFO: строки с нулем в конце
+                size_t pos = 4;
+                while (pos + 8 <= list.size) {
+                    const size_t length = le32(list.data + pos + 4);
+                    const QString value = utf8(list.mid(pos + 8, length)).remove(QChar(0));
+                    if (startsWith(list, pos, "INAM")) result.title = value;
+                    else if (startsWith(list, pos, "IART")) result.artist = value;
+                    else if (startsWith(list, pos, "IPRD")) result.album = value;
+                    pos += 8 + length + (length & 1);
+                }
+            }
+        }
+        offset = body + size + (size & 1);  // Чанки выровнены по 2 байтам
+    }
+
+    if (byteRate == 0 || dataSize <= 0) {
+        result.error = byteRate == 0 ? "Нет чанка fmt" : "Нет звуковых данных (data)";
+        return result;
+    }
+    result.durationMs = dataSize * 1000 / byteRate;
+    result.valid = true;
+    return result;
+}
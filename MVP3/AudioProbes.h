@@ -0,0 +1,50 @@
+// AudioProbes.h
+#pragma once
+#include "FormatProbe.h"
+
+// Встроенные разборщики контейнеров (регистрируются в ProbeRegistry)
+
+// MPEG audio: ID3v2 или синхронизация кадров; теги - ID3, длительность - по кадрам
+class Mp3Probe : public FormatProbe {
+public:
+    AudioFormat format() const override { return AudioFormat::Mp3; }
+    QStringList extensions() const override { return {"mp3"}; }
+    bool sniff(ByteView head) const override;
+    ProbeResult probe(MappedFile& file, bool withDuration) const override;
+};
+
+// FLAC: "fLaC", STREAMINFO и VORBIS_COMMENT среди блоков метаданных
+class FlacProbe : public FormatProbe {
+public:
+    AudioFormat format() const override { return AudioFormat::Flac; }
+    QStringList extensions() const override { return {"flac"}; }
+    bool sniff(ByteView head) const override;
+    ProbeResult probe(MappedFile& file, bool withDuration) const override;
+};
+
+// Ogg Vorbis / Opus: заголовочные пакеты в начале, длительность - по granule последней страницы
+class OggProbe : public FormatProbe {
+public:
+    AudioFormat format() const override { return AudioFormat::Ogg; }
+    QStringList extensions() const override { return {"ogg", "oga", "opus"}; }
+    bool sniff(ByteView head) const override;
+    ProbeResult probe(MappedFile& file, bool withDuration) const override;
+};
+
+// MP4/M4A: атом moov (mvhd - длительность, udta/meta/ilst - теги), где бы он ни лежал
+class Mp4Probe : public FormatProbe {
+public:
+    AudioFormat format() const override { return AudioFormat::Mp4; }
+    QStringList extensions() const override { return {"m4a", "mp4"}; }
+    bool sniff(ByteView head) const override;
+    ProbeResult probe(MappedFile& file, bool withDuration) const override;
+};
+
+// WAV (RIFF/WAVE): чанки fmt и data, теги - LIST/INFO
+class WavProbe : public FormatProbe {
+public:
+    AudioFormat format() const override { return AudioFormat::Wav; }
+    QStringList extensions() const override { return {"wav"}; }
+    bool sniff(ByteView head) const override;
+    ProbeResult probe(MappedFile& file, bool withDuration) const override;
+};
@@ -0,0 +1,55 @@
+// AudioTap.h
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef> // size_t
+#include <cstdint> // uint32_t, uint64_t
+
+// Отвод PCM из потока воспроизведения для визуализатора.
+// Кольцо фиксированного размера: поток воспроизведения пишет кадры блока
+// и публикует их одним commit(), анализ в пуле читает последние кадры.
+// Без блокировок и без выделения памяти. Писатель не ждет читателя: если
+// чтение отстало на целое кольцо, окно частично перезапишется - для
+// картинки это незаметно, а воспроизведение никогда не тормозится
+class AudioTap {
+public:
+    static constexpr size_t kCapacity = 8192;  // Кадров (степень двойки)
+
+    // Поток воспроизведения: i-й кадр текущего блока
+    void put(size_t i, float left, float right) {
+        const size_t index = (written_.load(std::memory_order_relaxed) + i) & kMask;
+        left_[index].store(left, std::memory_order_relaxed);
+        right_[index].store(right, std::memory_order_relaxed);
+    }
+    // Публикация frames записанных кадров
+    void commit(size_t frames, uint32_t sampleRate) {
+        sampleRate_.store(sampleRate, std::memory_order_relaxed);
+        written_.fetch_add(frames, std::memory_order_release);
+    }
+
+    // Всего записано кадров (для проверки, появились ли новые)
+    uint64_t written() const { return written_.load(std::memory_order_acquire); }
+    uint32_t sampleRate() const { return sampleRate_.load(std::memory_order_relaxed); }
+
+    // Последние frames кадров (frames <= kCapacity); false - столько еще не записано
+    bool read(float* left, float* right, size_t frames) const {
+        const uint64_t end = written();
+        if (frames > kCapacity || end < frames) return false;
+        const uint64_t start = end - frames;
+        for (size_t i = 0; i < frames; ++i) {
+            const size_t index = (start + i) & kMask;
+            left[i] = left_[index].load(std::memory_order_relaxed);
+            right[i] = right_[index].load(std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+private:
+    static constexpr size_t kMask = kCapacity - 1;
+    static_assert((kCapacity & kMask) == 0, "Емкость кольца должна быть степенью двойки");
+
+    std::array<std::atomic<float>, kCapacity> left_{};
+    std::array<std::atomic<float>, kCapacity> right_{};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint32_t> sampleRate_{0};
+};
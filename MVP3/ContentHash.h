@@ -0,0 +1,9 @@
+// ContentHash.h
+#pragma once
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t
+
+// XXH64 - быстрый некриптографический 64-битный хэш (алгоритм xxHash,
+// совместимые значения). Для отпечатков содержимого треков: несколько
+// ГБ/с на ядро, хорошо перемешивает и короткие, и длинные данные
+uint64_t xxh64(const void* data, size_t size, uint64_t seed = 0);
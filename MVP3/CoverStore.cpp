@@ -0,0 +1,68 @@
+// CoverStore.cpp
+#include "CoverStore.h"
+#include "Id3Reader.h" // Байты APIC прямо из отображения файла
+#include "Track.h"     // Обложка по умолчанию
+
+namespace {
+const int kCacheBytes = 32 * 1024 * 1024;  // Сотня-другая обложек размером с метку
+
+// FNV-1a, 64 бита: для различения картинок этого достаточно
+quint64 hashBytes(ByteView bytes) {
+    quint64 hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < bytes.size; ++i) {
+        hash ^= bytes.data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash ? hash : 1;  // 0 занят под "обложки нет"
+}
+}
+
+CoverStore::CoverStore(QSize size) : size_(size) {
+    images_.setMaxCost(kCacheBytes);
+}
+
+CoverStore::CoverId CoverStore::hashCover(const QString& path) {
+    Id3Reader reader(path);
+    Id3Reader::Picture picture = reader.picture();
+    return picture.isNull() ? 0 : hashBytes(picture.bytes);
+}
+
+void CoverStore::setTrackCover(const QString& path, CoverId id) {
+    trackCovers_.insert(path, id);
+}
+
+QImage CoverStore::cover(const QString& path) {
+    // Обложка уже известна и декодирована (например, у другого трека альбома)
+    auto known = trackCovers_.constFind(path);
+    if (known != trackCovers_.cend()) {
+        if (*known == 0) return defaultCover();
+        if (const QImage* cached = images_.object(*known)) return *cached;
+    }
+
+    Id3Reader reader(path);
+    Id3Reader::Picture picture = reader.picture();
+    const CoverId id = picture.isNull() ? 0 : hashBytes(picture.bytes);
+    trackCovers_.insert(path, id);
+    if (id == 0) return defaultCover();
+    if (const QImage* cached = images_.object(id)) return *cached;
+
+    QImage image;
+    if (!image.loadFromData(picture.bytes.data, static_cast<int>(picture.bytes.size))) {
+        trackCovers_.insert(path, 0);  // Картинка не декодируется - больше не пробуем
+        return defaultCover();
+    }
+    image = scaled(image);
+    images_.insert(id, new QImage(image), static_cast<int>(image.sizeInBytes()));
+    return image;
+}
+
+QImage CoverStore::scaled(const QImage& image) const {
+    return image.scaled(size_, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+}
+
+QImage CoverStore::defaultCover() {
+    if (defaultCover_.isNull()) {
+        defaultCover_ = scaled(Track::loadDefaultCover());
+    }
+    return defaultCover_;
+}
@@ -0,0 +1,41 @@
+// CoverStore.h
+#pragma once
+#include <QCache>  // Декодированные обложки с вытеснением давно не нужных
+#include <QHash>
+#include <QImage>
+#include <QSize>
+#include <QString>
+
+// Хранилище обложек с адресацией по содержимому.
+// Треки одного альбома обычно несут одинаковые байты APIC: идентификатор
+// обложки - хэш этих байтов, и на каждую уникальную обложку держится одна
+// декодированная и уже масштабированная копия. Хэши считаются при
+// сканировании (в пуле потоков), поэтому смена трека того же альбома
+// не требует ни чтения тега, ни декодирования. Используется из GUI потока,
+// кроме hashCover()
+class CoverStore {
+public:
+    using CoverId = quint64;  // 0 - у трека нет встроенной обложки
+
+    explicit CoverStore(QSize size);
+
+    // Хэш сырых байтов встроенной обложки (из любого потока)
+    static CoverId hashCover(const QString& path);
+
+    // Результат сканирования: трек -> обложка
+    void setTrackCover(const QString& path, CoverId id);
+    bool hasTrack(const QString& path) const { return trackCovers_.contains(path); }
+
+    // Обложка трека, масштабированная под размер хранилища;
+    // без встроенной - обложка по умолчанию
+    QImage cover(const QString& path);
+
+private:
+    QImage scaled(const QImage& image) const;
+    QImage defaultCover();
+
+    QSize size_;
+    QHash<QString, CoverId> trackCovers_;
+    QCache<CoverId, QImage> images_;  // Стоимость - размер картинки в байтах
+    QImage defaultCover_;             // Загружается один раз
+};
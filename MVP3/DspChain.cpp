@@ -0,0 +1,277 @@
+// DspChain.cpp
+#include "DspChain.h"
+#include <algorithm> // std::clamp, std::max, std::fill
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h> // SSE2: левый и правый канал в одном регистре
+#define ALEXMUSIC_DSP_SSE2 1
+#endif
+
+namespace {
+const double kPi = 3.14159265358979323846;
+const float kSmoothing = 0.3f;            // Доля пути к цели за блок (~50 мс до цели)
+const double kLimiterCeiling = 0.977;     // -0.2 dBFS
+const double kLimiterReleaseSec = 0.15;
+const double kDenormal = 1e-30;           // Меньшее состояние фильтра обнуляется
+
+// Октавные частоты полос по умолчанию
+const float kDefaultFrequencies[DspChain::kBands] = {
+    31.0f, 62.0f, 125.0f, 250.0f, 500.0f, 1000.0f, 2000.0f, 4000.0f, 8000.0f, 16000.0f};
+
+double dbToGain(float db) {
+    return std::pow(10.0, db / 20.0);
+}
+
+// Шаг к цели; true - цель достигнута (значение подтянуто точно)
+bool approach(float& value, float target, float epsilon) {
+    if (std::fabs(target - value) <= epsilon) {
+        value = target;
+        return true;
+    }
+    value += (target - value) * kSmoothing;
+    return false;
+}
+
+// Частота и добротность сглаживаются в логарифмическом масштабе
+bool approachRatio(float& value, float target) {
+    if (std::fabs(target / value - 1.0f) <= 0.001f) {
+        value = target;
+        return true;
+    }
+    value *= std::pow(target / value, kSmoothing);
+    return false;
+}
+}
+
+DspChain::Settings::Settings() {
+    for (int b = 0; b < kBands; ++b) {
+        bands[b].frequency = kDefaultFrequencies[b];
+        bands[b].q = (b == 0 || b == kBands - 1) ? 0.71f : 1.41f;
+        bands[b].gainDb = 0.0f;
+    }
+}
+
+DspChain::DspChain()
+    : work_(kBlockFrames * kMaxChannels),
+      z1_(kBands * kMaxChannels),
+      z2_(kBands * kMaxChannels) {
+    setSettings(Settings());
+    reset(sampleRate_, channels_);
+}
+
+void DspChain::setSettings(const Settings& settings) {
+    for (int b = 0; b < kBands; ++b) {
+        const Band& band = settings.bands[b];
+        targets_[b * 3].store(std::clamp(band.frequency, 10.0f, 24000.0f), std::memory_order_relaxed);
+        targets_[b * 3 + 1].store(std::clamp(band.q, 0.1f, 10.0f), std::memory_order_relaxed);
+        targets_[b * 3 + 2].store(std::clamp(band.gainDb, -kMaxGainDb, kMaxGainDb), std::memory_order_relaxed);
+    }
+    targetPreampDb_.store(std::clamp(settings.preampDb, -kMaxGainDb, kMaxGainDb), std::memory_order_relaxed);
+    targetLimiter_.store(settings.limiter, std::memory_order_relaxed);
+    version_.fetch_add(1, std::memory_order_release);  // Поток вывода перечитает цели
+}
+
+DspChain::Settings DspChain::settings() const {
+    Settings settings;
+    for (int b = 0; b < kBands; ++b) {
+        settings.bands[b].frequency = targets_[b * 3].load(std::memory_order_relaxed);
+        settings.bands[b].q = targets_[b * 3 + 1].load(std::memory_order_relaxed);
+        settings.bands[b].gainDb = targets_[b * 3 + 2].load(std::memory_order_relaxed);
+    }
+    settings.preampDb = targetPreampDb_.load(std::memory_order_relaxed);
+    settings.limiter = targetLimiter_.load(std::memory_order_relaxed);
+    return settings;
+}
+
+void DspChain::reset(double sampleRate, int channels) {
+    sampleRate_ = sampleRate > 0.0 ? sampleRate : 44100.0;
+    channels_ = std::clamp(channels, 1, kMaxChannels);
+    limiterRelease_ = 1.0 - std::exp(-1.0 / (kLimiterReleaseSec * sampleRate_));
+    limiterGain_ = 1.0;
+
+    // После разрыва потока сглаживать нечего - сразу целевые параметры
+    seenVersion_ = ~0u;
+    pullTargets();
+    current_ = target_;
+    preamp_ = targetPreamp_;
+    for (int b = 0; b < kBands; ++b) {
+        coefficients_[b] = design(b, current_[b]);
+        active_[b] = current_[b].gainDb != 0.0f;
+    }
+    std::fill(z1_.begin(), z1_.end(), 0.0);
+    std::fill(z2_.begin(), z2_.end(), 0.0);
+    settled_ = true;
+}
+
+void DspChain::pullTargets() {
+    const uint32_t version = version_.load(std::memory_order_acquire);
+    if (version == seenVersion_) return;
+    seenVersion_ = version;
+
+    for (int b = 0; b < kBands; ++b) {
+        target_[b].frequency = targets_[b * 3].load(std::memory_order_relaxed);
+        target_[b].q = targets_[b * 3 + 1].load(std::memory_order_relaxed);
+        target_[b].gainDb = targets_[b * 3 + 2].load(std::memory_order_relaxed);
+    }
+    targetPreamp_ = dbToGain(targetPreampDb_.load(std::memory_order_relaxed));
+    const bool limiter = targetLimiter_.load(std::memory_order_relaxed);
+    if (!limiter) limiterGain_ = 1.0;
+    limiter_ = limiter;
+    settled_ = false;
+}
+
+void DspChain::smooth() {
+    bool settled = true;
+    for (int b = 0; b < kBands; ++b) {
+        Band& band = current_[b];
+        const Band before = band;
+        const bool converged = approach(band.gainDb, target_[b].gainDb, 0.01f) &
+                               approachRatio(band.frequency, target_[b].frequency) &
+                               approachRatio(band.q, target_[b].q);
+        settled = settled && converged;
+
+        if (band.gainDb != before.gainDb || band.frequency != before.frequency || band.q != before.q) {
+            coefficients_[b] = design(b, band);
+        }
+        // Ровная полоса - тождественный фильтр, ее можно не считать. При возврате
+        // состояние начинается с нуля: усиление в этот момент еще близко к 0 дБ
+        const bool active = !(converged && band.gainDb == 0.0f);
+        if (active && !active_[b]) {
+            std::fill(z1_.begin() + b * kMaxChannels, z1_.begin() + (b + 1) * kMaxChannels, 0.0);
+            std::fill(z2_.begin() + b * kMaxChannels, z2_.begin() + (b + 1) * kMaxChannels, 0.0);
+        }
+        active_[b] = active;
+    }
+    settled_ = settled && preamp_ == targetPreamp_;
+}
+
+DspChain::Coefficients DspChain::design(int band, const Band& params) const {
+    const double A = std::pow(10.0, params.gainDb / 40.0);
+    const double frequency = std::clamp<double>(params.frequency, 10.0, 0.45 * sampleRate_);
+    const double w0 = 2.0 * kPi * frequency / sampleRate_;
+    const double cosW = std::cos(w0);
+    const double alpha = std::sin(w0) / (2.0 * params.q);
+    const double sqrtA2alpha = 2.0 * std::sqrt(A) * alpha;
+
+    double b0, b1, b2, a0, a1, a2;
+    if (band == 0) {
+        // Низкая полка
+        b0 = A * ((A + 1) - (A - 1) * cosW + sqrtA2alpha);
+        b1 = 2 * A * ((A - 1) - (A + 1) * cosW);
+        b2 = A * ((A + 1) - (A - 1) * cosW - sqrtA2alpha);
+        a0 = (A + 1) + (A - 1) * cosW + sqrtA2alpha;
+        a1 = -2 * ((A - 1) + (A + 1) * cosW);
+        a2 = (A + 1) + (A - 1) * cosW - sqrtA2alpha;
+    } else if (band == kBands - 1) {
+        // Высокая полка
+        b0 = A * ((A + 1) + (A - 1) * cosW + sqrtA2alpha);
+        b1 = -2 * A * ((A - 1) + (A + 1) * cosW);
+        b2 = A * ((A + 1) + (A - 1) * cosW - sqrtA2alpha);
+        a0 = (A + 1) - (A - 1) * cosW + sqrtA2alpha;
+        a1 = 2 * ((A - 1) - (A + 1) * cosW);
+        a2 = (A + 1) - (A - 1) * cosW - sqrtA2alpha;
+    } else {
+        // Колокол
+        b0 = 1 + alpha * A;
+        b1 = -2 * cosW;
+        b2 = 1 - alpha * A;
+        a0 = 1 + alpha / A;
+        a1 = -2 * cosW;
+        a2 = 1 - alpha / A;
+    }
+    return {b0 / a0, b1 / a0, b2 / a0, a1 / a0, a2 / a0};
+}
+
+void DspChain::process(float* samples, size_t frames) {
+    while (frames > 0) {
+        const size_t block = std::min(frames, kBlockFrames);
+        pullTargets();
+        if (!settled_) smooth();
+        processBlock(samples, block);
+        samples += block * channels_;
+        frames -= block;
+    }
+}
+
+void DspChain::processBlock(float* samples, size_t frames) {
+    const int channels = channels_;
+    const size_t count = frames * channels;
+    double* work = work_.data();
+
+    // Предусилитель - с линейным переходом внутри блока
+    double gain = preamp_;
+    double next = preamp_ + (targetPreamp_ - preamp_) * kSmoothing;
+    if (std::fabs(targetPreamp_ - next) < 1e-4) next = targetPreamp_;
+    const double step = (next - preamp_) / frames;
+    for (size_t i = 0; i < frames; ++i) {
+        gain += step;
+        for (int c = 0; c < channels; ++c) {
+            work[i * channels + c] = samples[i * channels + c] * gain;
+        }
+    }
+    preamp_ = next;
+
+    // Биквады (транспонированная прямая форма II)
+    for (int b = 0; b < kBands; ++b) {
+        if (!active_[b]) continue;
+        const Coefficients& k = coefficients_[b];
+        double* z1 = z1_.data() + b * kMaxChannels;
+        double* z2 = z2_.data() + b * kMaxChannels;
+#ifdef ALEXMUSIC_DSP_SSE2
+        if (channels == 2) {
+            const __m128d b0 = _mm_set1_pd(k.b0), b1 = _mm_set1_pd(k.b1), b2 = _mm_set1_pd(k.b2);
+            const __m128d a1 = _mm_set1_pd(k.a1), a2 = _mm_set1_pd(k.a2);
+            __m128d s1 = _mm_loadu_pd(z1);
+            __m128d s2 = _mm_loadu_pd(z2);
+            for (size_t i = 0; i < frames; ++i) {
+                const __m128d x = _mm_loadu_pd(work + 2 * i);
+                const __m128d y = _mm_add_pd(_mm_mul_pd(b0, x), s1);
+                s1 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(b1, x), _mm_mul_pd(a1, y)), s2);
+                s2 = _mm_sub_pd(_mm_mul_pd(b2, x), _mm_mul_pd(a2, y));
+                _mm_storeu_pd(work + 2 * i, y);
+            }
+            _mm_storeu_pd(z1, s1);
+            _mm_storeu_pd(z2, s2);
+        } else
+#endif
+        {
+            for (int c = 0; c < channels; ++c) {
+                double s1 = z1[c];
+                double s2 = z2[c];
+                for (size_t i = 0; i < frames; ++i) {
+                    double& x = work[i * channels + c];
+                    const double y = k.b0 * x + s1;
+                    s1 = k.b1 * x - k.a1 * y + s2;
+                    s2 = k.b2 * x - k.a2 * y;
+                    x = y;
+                }
+                z1[c] = s1;
+                z2[c] = s2;
+            }
+        }
+        // Затухающее состояние в тишине не должно уходить в денормализованные числа
+        for (int c = 0; c < channels; ++c) {
+            if (std::fabs(z1[c]) < kDenormal) z1[c] = 0.0;
+            if (std::fabs(z2[c]) < kDenormal) z2[c] = 0.0;
+        }
+    }
+
+    // Лимитер: общее для каналов усиление, мгновенная атака, плавное отпускание
+    if (limiter_) {
+        double limiterGain = limiterGain_;
+        for (size_t i = 0; i < frames; ++i) {
+            double* frame = work + i * channels;
+            double peak = 0.0;
+            for (int c = 0; c < channels; ++c) peak = std::max(peak, std::fabs(frame[c]));
+            const double target = peak > kLimiterCeiling ? kLimiterCeiling / peak : 1.0;
+            limiterGain = target < limiterGain ? target : limiterGain + (target - limiterGain) * limiterRelease_;
+            for (int c = 0; c < channels; ++c) frame[c] *= limiterGain;
+        }
+        limiterGain_ = limiterGain;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        samples[i] = static_cast<float>(work[i]);
+    }
+}
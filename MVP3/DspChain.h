@@ -0,0 +1,84 @@
+// DspChain.h
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef> // size_t
+#include <cstdint> // uint32_t
+#include <vector>
+
+// Обработка звука перед выводом: предусилитель, 10-полосный параметрический
+// эквалайзер и лимитер. Полоса 0 - низкая полка, последняя - высокая полка,
+// остальные - колоколообразные (формулы RBJ), у каждой своя частота, добротность
+// и усиление. Биквады считаются в double на заранее выделенном блоке; стерео
+// обрабатывается парой каналов за инструкцию (SSE2, где он есть).
+//
+// Параметры меняются из любого потока без блокировок: setSettings() пишет
+// атомарные целевые значения, поток вывода подхватывает их в начале блока
+// и плавно подводит к ним усиления и частоты (коэффициенты пересчитываются
+// каждые kBlockFrames кадров), поэтому движение ползунка не дает щелчков.
+// process() памяти не выделяет и вызывается одним потоком
+class DspChain {
+public:
+    static constexpr int kBands = 10;
+    static constexpr size_t kBlockFrames = 256;  // Кадров между пересчетами коэффициентов
+    static constexpr int kMaxChannels = 8;
+    static constexpr float kMaxGainDb = 12.0f;   // Предел усиления полосы и предусилителя
+
+    struct Band {
+        float frequency = 1000.0f;  // Гц
+        float q = 1.41f;            // Добротность (для полок - крутизна)
+        float gainDb = 0.0f;
+    };
+
+    struct Settings {
+        std::array<Band, kBands> bands;
+        float preampDb = 0.0f;
+        bool limiter = true;  // Не дает подъему полос выйти за 0 dBFS
+
+        Settings();  // Ровная АЧХ на октавных частотах 31 Гц - 16 кГц
+    };
+
+    DspChain();
+
+    // Из любого потока
+    void setSettings(const Settings& settings);
+    Settings settings() const;
+
+    // Поток вывода: новый формат или разрыв потока (перемотка) - сброс состояния фильтров
+    void reset(double sampleRate, int channels);
+    // Чередующиеся отсчеты frames кадров, обработка на месте
+    void process(float* samples, size_t frames);
+
+private:
+    struct Coefficients { double b0, b1, b2, a1, a2; };
+
+    void pullTargets();                 // Атомарные цели -> рабочие копии (при смене версии)
+    void smooth();                      // Шаг сглаживания и пересчет коэффициентов
+    void processBlock(float* samples, size_t frames);
+    Coefficients design(int band, const Band& params) const;
+
+    // Цели, записываемые снаружи
+    std::array<std::atomic<float>, kBands * 3> targets_;  // Частота, добротность, усиление
+    std::atomic<float> targetPreampDb_{0.0f};
+    std::atomic<bool> targetLimiter_{true};
+    std::atomic<uint32_t> version_{0};
+
+    // Состояние потока вывода
+    uint32_t seenVersion_ = ~0u;
+    double sampleRate_ = 44100.0;
+    int channels_ = 2;
+    std::array<Band, kBands> target_;
+    std::array<Band, kBands> current_;
+    std::array<Coefficients, kBands> coefficients_;
+    std::array<bool, kBands> active_{};  // Ровная сошедшаяся полоса пропускается
+    double targetPreamp_ = 1.0;
+    double preamp_ = 1.0;               // Текущее линейное усиление
+    bool limiter_ = true;
+    double limiterGain_ = 1.0;
+    double limiterRelease_ = 0.0;
+    bool settled_ = false;              // Все параметры достигли целей
+
+    std::vector<double> work_;          // Блок в double (kBlockFrames * kMaxChannels)
+    std::vector<double> z1_;            // Состояние биквадов: [полоса][канал]
+    std::vector<double> z2_;
+};
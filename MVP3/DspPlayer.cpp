@@ -0,0 +1,402 @@
+// DspPlayer.cpp
+#include "DspPlayer.h"
+#include <QAudioBuffer>
+#include <QAudioDecoder>
+#include <QAudioDevice>
+#include <QAudioSink>
+#include <QFile>
+#include <QIODevice>
+#include <QMediaDevices>
+
+#include <algorithm> // std::min
+#include <cstring>   // std::memcpy, std::memset
+
+namespace {
+const int kChannels = 2;
+const size_t kRingFrames = 131072;  // ~3 с при 44.1-48 кГц (степень двойки)
+const int kPumpIntervalMs = 20;
+// Запас перед позицией при старте с опорной точки: первые кадры после
+// произвольного места декодируются неполно (резервуар битов) и отбрасываются
+const qint64 kSeekPrerollMs = 300;
+}
+
+// Файл MP3 начиная с опорной точки индекса: декодер видит поток, который
+// начинается с нужного кадра, и не декодирует все, что до него
+class FileWindow : public QIODevice {
+public:
+    FileWindow(const QString& path, qint64 offset) : file_(path), offset_(offset) {}
+
+    bool openFile() {
+        if (!file_.open(QIODevice::ReadOnly) || offset_ >= file_.size()) return false;
+        return QIODevice::open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    }
+    qint64 size() const override { return file_.size() - offset_; }
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override {
+        if (!file_.seek(offset_ + pos())) return -1;
+        return file_.read(data, maxSize);
+    }
+    qint64 writeData(const char*, qint64) override { return -1; }
+
+private:
+    QFile file_;
+    const qint64 offset_;
+};
+
+// Кольцо декодированного звука для QAudioSink: один писатель (поток
+// контроллера) и один читатель (поток вывода), без блокировок.
+// Цепочка обработки применяется к уже скопированному в буфер устройства
+// блоку - отдельной памяти на нее не выделяется
+class DspStream : public QIODevice {
+public:
+    DspStream(DspChain& chain, int sampleRate)
+        : chain_(chain), sampleRate_(sampleRate), ring_(kRingFrames * kChannels) {}
+
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override {
+        return QIODevice::bytesAvailable() + qint64(bufferedFrames()) * kFrameBytes;
+    }
+
+    size_t bufferedFrames() const {
+        return written_.load(std::memory_order_acquire) - read_.load(std::memory_order_acquire);
+    }
+
+    // Поток контроллера: сколько кадров поместилось
+    size_t push(const float* samples, size_t frames) {
+        const size_t written = written_.load(std::memory_order_relaxed);
+        const size_t space = kRingFrames - (written - read_.load(std::memory_order_acquire));
+        frames = std::min(frames, space);
+        for (size_t i = 0; i < frames; ++i) {
+            const size_t index = ((written + i) & kMask) * kChannels;
+            ring_[index] = samples[i * kChannels];
+            ring_[index + 1] = samples[i * kChannels + 1];
+        }
+        written_.store(written + frames, std::memory_order_release);
+        return frames;
+    }
+
+    // Только при остановленном выводе
+    void clear() {
+        read_.store(written_.load(std::memory_order_relaxed), std::memory_order_release);
+        finished_.store(false, std::memory_order_release);
+    }
+
+    // Декодер закончил: после опустошения кольца - конец потока
+    void setFinished() { finished_.store(true, std::memory_order_release); }
+    void setTap(AudioTap* tap) { tap_.store(tap, std::memory_order_release); }
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override {
+        float* out = reinterpret_cast<float*>(data);
+        const size_t wanted = static_cast<size_t>(maxSize / kFrameBytes);
+        const size_t read = read_.load(std::memory_order_relaxed);
+        const bool finished = finished_.load(std::memory_order_acquire);
+        size_t frames = std::min(wanted, written_.load(std::memory_order_acquire) - read);
+
+        for (size_t i = 0; i < frames; ++i) {
+            const size_t index = ((read + i) & kMask) * kChannels;
+            out[i * kChannels] = ring_[index];
+            out[i * kChannels + 1] = ring_[index + 1];
+        }
+        read_.store(read + frames, std::memory_order_release);
+
+        if (frames < wanted && !finished) {
+            // Декодер не успел - тишина вместо остановки устройства
+            std::memset(out + frames * kChannels, 0, (wanted - frames) * kFrameBytes);
+            frames = wanted;
+        }
+        if (frames == 0) return 0;
+
+        chain_.process(out, frames);
+
+        if (AudioTap* tap = tap_.load(std::memory_order_acquire)) {
+            const size_t tapped = std::min(frames, AudioTap::kCapacity);
+            for (size_t i = 0; i < tapped; ++i) {
+                tap->put(i, out[i * kChannels], out[i * kChannels + 1]);
+            }
+            tap->commit(tapped, static_cast<uint32_t>(sampleRate_));
+        }
+        return qint64(frames) * kFrameBytes;
+    }
+
+    qint64 writeData(const char*, qint64) override { return -1; }
+
+private:
+    static constexpr qint64 kFrameBytes = kChannels * sizeof(float);
+    static constexpr size_t kMask = kRingFrames - 1;
+    static_assert((kRingFrames & kMask) == 0, "Емкость кольца должна быть степенью двойки");
+
+    DspChain& chain_;
+    const int sampleRate_;
+    std::vector<float> ring_;
+    std::atomic<size_t> written_{0};
+    std::atomic<size_t> read_{0};
+    std::atomic<bool> finished_{false};
+    std::atomic<AudioTap*> tap_{nullptr};
+};
+
+DspPlayer::DspPlayer(DspChain& chain, QObject* parent) : QObject(parent), chain_(chain) {
+    const QAudioDevice device = QMediaDevices::defaultAudioOutput();
+    const int sampleRate = device.preferredFormat().sampleRate();
+    format_.setSampleRate(sampleRate > 0 ? sampleRate : 48000);
+    format_.setChannelCount(kChannels);
+    format_.setSampleFormat(QAudioFormat::Float);
+
+    decoder_ = new QAudioDecoder(this);
+    decoder_->setAudioFormat(format_);  // Декодер сам приводит частоту и каналы
+    connect(decoder_, &QAudioDecoder::bufferReady, this, &DspPlayer::pump);
+    connect(decoder_, &QAudioDecoder::finished, this, [this]() {
+        decoderDone_ = true;
+        pump();
+    });
+    connect(decoder_, &QAudioDecoder::durationChanged, this, [this](qint64 duration) {
+        if (window_) return;  // Длительность остатка файла, а не трека
+        duration_ = duration;
+        emit durationChanged(duration);
+    });
+    connect(decoder_, qOverload<QAudioDecoder::Error>(&QAudioDecoder::error), this, [this](QAudioDecoder::Error) {
+        if (window_) {
+            // Поток с опорной точки не разобран - перемотка по-старому, с начала файла
+            seekIndex_.reset();
+            startDecoder(basePosition_);
+            return;
+        }
+        stopOutput();
+        playRequested_ = false;
+        pumpTimer_->stop();
+        setState(QMediaPlayer::StoppedState);
+        setStatus(QMediaPlayer::InvalidMedia);
+    });
+
+    stream_ = std::make_unique<DspStream>(chain_, format_.sampleRate());
+    stream_->open(QIODevice::ReadOnly);
+    sink_ = new QAudioSink(device, format_, this);
+
+    // Подкачка декодера и позиция - пока есть что декодировать или играть
+    pumpTimer_ = new QTimer(this);
+    pumpTimer_->setInterval(kPumpIntervalMs);
+    connect(pumpTimer_, &QTimer::timeout, this, &DspPlayer::pump);
+}
+
+DspPlayer::~DspPlayer() {
+    // Вывод останавливается до удаления кольца, из которого он читает
+    delete sink_;
+    sink_ = nullptr;
+    decoder_->stop();
+    decoder_->setSourceDevice(nullptr);  // Окно файла (член) удаляется раньше декодера (дочерний объект)
+}
+
+void DspPlayer::setSource(const QUrl& source) {
+    stopOutput();
+    decoder_->stop();
+    if (window_) {
+        decoder_->setSource(QUrl());  // Декодер больше не читает окно прежнего файла
+        window_.reset();
+    }
+    playRequested_ = false;
+    source_ = source;
+    seekIndex_.reset();
+    basePosition_ = 0;
+    duration_ = 0;
+    emit sourceChanged(source);
+    emit durationChanged(0);
+    emit positionChanged(0);
+    setState(QMediaPlayer::StoppedState);
+
+    if (source.isEmpty()) {
+        pumpTimer_->stop();
+        setStatus(QMediaPlayer::NoMedia);
+        return;
+    }
+    setStatus(QMediaPlayer::LoadingMedia);
+    decoder_->setSource(source);
+    startDecoder(0);
+}
+
+void DspPlayer::play() {
+    if (source_.isEmpty() || status_ == QMediaPlayer::InvalidMedia || state_ == QMediaPlayer::PlayingState) return;
+
+    if (status_ == QMediaPlayer::EndOfMedia) {
+        basePosition_ = 0;
+        startDecoder(0);
+        setStatus(QMediaPlayer::LoadedMedia);
+    }
+    setState(QMediaPlayer::PlayingState);
+    if (sink_->state() == QAudio::SuspendedState) {
+        sink_->resume();
+    } else {
+        playRequested_ = true;
+    }
+    pumpTimer_->start();
+    pump();
+}
+
+void DspPlayer::pause() {
+    if (source_.isEmpty() || state_ == QMediaPlayer::PausedState) return;
+    playRequested_ = false;
+    if (sink_->state() == QAudio::ActiveState || sink_->state() == QAudio::IdleState) {
+        sink_->suspend();
+    }
+    setState(QMediaPlayer::PausedState);
+    emit positionChanged(currentPosition());
+}
+
+void DspPlayer::stop() {
+    if (state_ == QMediaPlayer::StoppedState && basePosition_ == 0) return;
+    stopOutput();
+    playRequested_ = false;
+    basePosition_ = 0;
+    if (!source_.isEmpty() && status_ != QMediaPlayer::InvalidMedia) {
+        startDecoder(0);  // Как QMediaPlayer: трек остается загруженным с начала
+        if (status_ == QMediaPlayer::EndOfMedia) setStatus(QMediaPlayer::LoadedMedia);
+    }
+    setState(QMediaPlayer::StoppedState);
+    emit positionChanged(0);
+}
+
+void DspPlayer::setPosition(qint64 position) {
+    if (source_.isEmpty() || status_ == QMediaPlayer::InvalidMedia) return;
+    position = qMax<qint64>(0, duration_ > 0 ? qMin(position, duration_) : position);
+
+    stopOutput();
+    basePosition_ = position;
+    startDecoder(position);
+    if (state_ == QMediaPlayer::PlayingState) playRequested_ = true;
+    if (status_ == QMediaPlayer::EndOfMedia) setStatus(QMediaPlayer::BufferedMedia);
+    emit positionChanged(position);
+}
+
+void DspPlayer::setVolume(float volume) {
+    volume_ = volume;
+    sink_->setVolume(volume);
+}
+
+void DspPlayer::setAudioTap(AudioTap* tap) {
+    stream_->setTap(tap);
+}
+
+void DspPlayer::startDecoder(qint64 position) {
+    decoder_->stop();
+    carry_.clear();
+    carryOffset_ = 0;
+
+    // Ближайшая опорная точка до позиции (с запасом): пропускаются только
+    // отсчеты от нее, а не от начала файла
+    Mp3SeekIndex::SeekPoint point;
+    if (seekIndex_ && position > kSeekPrerollMs) {
+        point = seekIndex_->seekPoint(position - kSeekPrerollMs);
+    }
+    std::unique_ptr<FileWindow> window;
+    if (point.timeMs > 0) {
+        window = std::make_unique<FileWindow>(source_.toLocalFile(), point.offset);
+        if (!window->openFile()) {
+            window.reset();
+            point = Mp3SeekIndex::SeekPoint();
+        }
+    }
+    if (window) {
+        decoder_->setSourceDevice(window.get());
+    } else if (window_) {
+        decoder_->setSource(source_);
+    }
+    window_ = std::move(window);  // Прежнее окно - после переключения декодера
+
+    skipFrames_ = (position - point.timeMs) * format_.sampleRate() / 1000;
+    decoderDone_ = false;
+    decoder_->start();
+    pumpTimer_->start();
+}
+
+void DspPlayer::stopOutput() {
+    if (sink_->state() != QAudio::StoppedState) {
+        basePosition_ = currentPosition();
+        sink_->stop();
+    }
+    stream_->clear();
+    carry_.clear();
+    carryOffset_ = 0;
+}
+
+void DspPlayer::startOutput() {
+    playRequested_ = false;
+    chain_.reset(format_.sampleRate(), kChannels);  // Вывод остановлен - гонки с ним нет
+    sink_->setVolume(volume_);
+    sink_->start(stream_.get());
+}
+
+qint64 DspPlayer::currentPosition() const {
+    qint64 position = basePosition_;
+    if (sink_->state() != QAudio::StoppedState) {
+        position += sink_->processedUSecs() / 1000;
+    }
+    return duration_ > 0 ? qMin(position, duration_) : position;
+}
+
+void DspPlayer::pump() {
+    // Декодированные блоки - в кольцо, пока есть место
+    for (;;) {
+        if (carryOffset_ < carry_.size()) {
+            const size_t frames = (carry_.size() - carryOffset_) / kChannels;
+            carryOffset_ += stream_->push(carry_.data() + carryOffset_, frames) * kChannels;
+            if (carryOffset_ < carry_.size()) break;  // Кольцо заполнено
+        }
+        if (!decoder_->bufferAvailable()) break;
+
+        const QAudioBuffer buffer = decoder_->read();
+        const QAudioFormat format = buffer.format();
+        if (!buffer.isValid() || format.sampleFormat() != QAudioFormat::Float ||
+            format.channelCount() != kChannels) {
+            continue;  // Декодер обязан отдавать запрошенный формат
+        }
+        const float* data = buffer.constData<float>();
+        qint64 frames = buffer.frameCount();
+        if (skipFrames_ > 0) {
+            const qint64 skip = qMin(skipFrames_, frames);
+            data += skip * kChannels;
+            frames -= skip;
+            skipFrames_ -= skip;
+        }
+        carry_.assign(data, data + frames * kChannels);
+        carryOffset_ = 0;
+    }
+
+    const bool drained = decoderDone_ && carryOffset_ >= carry_.size();
+    if (drained) stream_->setFinished();
+
+    const size_t prebuffer = static_cast<size_t>(format_.sampleRate() / 4);
+    const bool ready = drained || stream_->bufferedFrames() >= prebuffer;
+    if (ready && status_ == QMediaPlayer::LoadingMedia) {
+        setStatus(QMediaPlayer::LoadedMedia);
+    }
+    if (ready && playRequested_) {
+        startOutput();
+    }
+
+    if (state_ != QMediaPlayer::PlayingState) {
+        if (decoderDone_) pumpTimer_->stop();  // Пауза и все декодировано - будить незачем
+        return;
+    }
+    emit positionChanged(currentPosition());
+
+    // Кольцо опустело, устройство доиграло - конец трека
+    if (drained && stream_->bufferedFrames() == 0 && sink_->state() == QAudio::IdleState) {
+        stopOutput();
+        basePosition_ = duration_;
+        pumpTimer_->stop();
+        setState(QMediaPlayer::StoppedState);
+        setStatus(QMediaPlayer::EndOfMedia);
+    }
+}
+
+void DspPlayer::setState(QMediaPlayer::PlaybackState state) {
+    if (state_ == state) return;
+    state_ = state;
+    emit playbackStateChanged(state);
+}
+
+void DspPlayer::setStatus(QMediaPlayer::MediaStatus status) {
+    if (status_ == status) return;
+    status_ = status;
+    emit mediaStatusChanged(status);
+}
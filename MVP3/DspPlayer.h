@@ -0,0 +1,87 @@
+// DspPlayer.h
+#pragma once
+#include <QObject>
+#include <QAudioFormat>
+#include <QMediaPlayer>  // Состояния - те же, что у QMediaPlayer
+#include <QTimer>
+#include <QUrl>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "AudioTap.h"
+#include "DspChain.h"
+#include "Mp3SeekIndex.h"
+
+class QAudioDecoder;
+class QAudioSink;
+class DspStream;
+class FileWindow;
+
+// Воспроизведение через QAudioDecoder -> DspChain -> QAudioSink для
+// эквалайзера: QMediaPlayer не дает доступа к звуку до вывода. Интерфейс
+// повторяет нужную PlaybackController часть QMediaPlayer (команды, сигналы,
+// состояния), поэтому контроллер переключается между ними без различий
+// в логике. Декодер всегда выдает стерео float на частоте устройства.
+// Декодированный звук идет через кольцо на пару секунд: поток контроллера
+// дописывает его, устройство вывода забирает (в любом потоке) и там же
+// обрабатывает цепочкой на месте. Перемотка перезапускает декодер с
+// пропуском отсчетов до нужной позиции; с индексом кадров MP3 декодер
+// начинает с ближайшей опорной точки, а не с начала файла.
+// Живет в потоке контроллера
+class DspPlayer : public QObject {
+    Q_OBJECT
+
+public:
+    DspPlayer(DspChain& chain, QObject* parent = nullptr);
+    ~DspPlayer() override;
+
+    void setSource(const QUrl& source);
+    QUrl source() const { return source_; }
+    void play();
+    void pause();
+    void stop();
+    void setPosition(qint64 position);
+    void setVolume(float volume);
+    void setAudioTap(AudioTap* tap);  // nullptr - звук не копируется
+    // Индекс кадров текущего источника (сбрасывается при смене источника)
+    void setSeekIndex(std::shared_ptr<const Mp3SeekIndex> index) { seekIndex_ = std::move(index); }
+
+signals:
+    void sourceChanged(const QUrl& source);
+    void positionChanged(qint64 position);
+    void durationChanged(qint64 duration);
+    void playbackStateChanged(QMediaPlayer::PlaybackState state);
+    void mediaStatusChanged(QMediaPlayer::MediaStatus status);
+
+private:
+    void startDecoder(qint64 position);  // Декодирование с позиции (кольцо должно быть пустым)
+    void stopOutput();                   // Остановка вывода и очистка кольца
+    void startOutput();
+    void pump();                         // Декодер -> кольцо, позиция, конец трека
+    qint64 currentPosition() const;
+    void setState(QMediaPlayer::PlaybackState state);
+    void setStatus(QMediaPlayer::MediaStatus status);
+
+    DspChain& chain_;
+    QAudioFormat format_;
+    QAudioDecoder* decoder_ = nullptr;
+    QAudioSink* sink_ = nullptr;
+    std::unique_ptr<DspStream> stream_;
+    std::unique_ptr<FileWindow> window_; // Файл с опорной точки (декодер читает его вместо source_)
+    std::shared_ptr<const Mp3SeekIndex> seekIndex_;
+    QTimer* pumpTimer_ = nullptr;
+
+    QUrl source_;
+    std::vector<float> carry_;           // Остаток блока декодера, не поместившийся в кольцо
+    size_t carryOffset_ = 0;
+    qint64 skipFrames_ = 0;              // Пропуск после перезапуска декодера (перемотка)
+    qint64 basePosition_ = 0;            // Позиция начала вывода, мс
+    qint64 duration_ = 0;
+    bool decoderDone_ = false;
+    bool playRequested_ = false;         // Запуск вывода, как только накопится звук
+    float volume_ = 1.0f;
+    QMediaPlayer::PlaybackState state_ = QMediaPlayer::StoppedState;
+    QMediaPlayer::MediaStatus status_ = QMediaPlayer::NoMedia;
+};
@@ -0,0 +1,205 @@
+// DuplicateFinder.cpp
+#include "DuplicateFinder.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>   // Атомарная запись кэша
+#include <QSet>
+#include <QTextStream>
+
+#include <algorithm> // std::stable_sort
+
+#include "PcmDecoder.h"
+#include "TrackIdStore.h"
+
+namespace {
+// Заголовок формата; при смене формата старый кэш просто игнорируется
+const char* const kHeader = "ALEXMUSIC-FINGERPRINTS 1";
+const int kBatchSize = 4;  // Файлов в задаче: декодирование долгое - мелкие пачки равномернее делят ядра
+}
+
+DuplicateFinder::DuplicateFinder(QString filePath, const TrackIdStore* trackIds, QObject* parent)
+    : QObject(parent), filePath_(std::move(filePath)), trackIds_(trackIds) {}
+
+// Строка кэша: идентификатор|длительность|биты (длительность 0 - файл не декодировался)
+void DuplicateFinder::load() {
+    QFile file(filePath_);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return;
+
+    QTextStream in(&file);
+    if (in.readLine() != QLatin1String(kHeader)) return;
+
+    while (!in.atEnd()) {
+        const QStringList fields = in.readLine().split('|');
+        if (fields.size() < 3 || fields[0].isEmpty()) continue;
+
+        AcousticFingerprint fingerprint;
+        const uint32_t durationMs = fields[1].toUInt();
+        if (durationMs > 0 && !AcousticFingerprint::fromHex(fields[2].toStdString(), durationMs, fingerprint)) {
+            continue;
+        }
+        fingerprints_.insert(fields[0], fingerprint);
+    }
+}
+
+void DuplicateFinder::save() {
+    if (!dirty_) return;
+
+    QSaveFile file(filePath_);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) return;
+
+    QTextStream out(&file);
+    out << kHeader << '\n';
+    for (auto it = fingerprints_.cbegin(); it != fingerprints_.cend(); ++it) {
+        out << it.key() << '|' << it->durationMs() << '|'
+            << (it->isValid() ? QString::fromStdString(it->toHex()) : QString()) << '\n';
+    }
+    out.flush();
+    if (file.commit()) {
+        dirty_ = false;
+    }
+}
+
+void DuplicateFinder::start(const QStringList& paths) {
+    cancel();
+    token_ = CancellationToken();
+    paths_ = paths;
+    ids_.clear();
+    done_ = 0;
+
+    // Готовые файлы (идентификатор и отпечаток уже известны) в пул не идут;
+    // копии с одинаковым идентификатором декодируются один раз
+    QStringList pending;
+    QSet<QString> scheduled;
+    for (const QString& path : paths_) {
+        const QString id = trackIds_->id(path);
+        if (!id.isEmpty()) {
+            ids_.insert(path, id);
+            if (fingerprints_.contains(id) || scheduled.contains(id)) continue;
+            scheduled.insert(id);
+        }
+        pending << path;
+    }
+
+    const int total = pending.size();
+    emit progress(0, total);
+    if (pending.isEmpty()) {
+        buildGroups();
+        emit finished();
+        return;
+    }
+
+    // Известные отпечатки - копией для потоков пула (только чтение)
+    QSet<QString> known;
+    for (auto it = fingerprints_.cbegin(); it != fingerprints_.cend(); ++it) known.insert(it.key());
+
+    for (int first = 0; first < pending.size(); first += kBatchSize) {
+        const QStringList batch = pending.mid(first, kBatchSize);
+        std::vector<std::pair<QString, QString>> items;  // Путь и известный идентификатор
+        for (const QString& path : batch) items.emplace_back(path, ids_.value(path));
+
+        ++pendingBatches_;
+        TaskScheduler::instance().run(
+            TaskPriority::BulkScan, this,
+            [items, known](const CancellationToken& token) {
+                std::vector<Result> results;
+                results.reserve(items.size());
+                for (const auto& item : items) {
+                    if (token.isCancelled()) break;
+                    Result result;
+                    result.path = item.first;
+                    result.id = item.second.isEmpty() ? TrackIdStore::compute(item.first, token).id : item.second;
+                    if (result.id.isEmpty()) continue;  // Файл не читается
+
+                    if (!known.contains(result.id)) {
+                        AcousticFingerprint::Builder builder;
+                        const bool decoded = PcmDecoder::decodeMono(
+                            result.path, token, [&builder](const float* samples, size_t count, uint32_t rate) {
+                                builder.add(samples, count, rate);
+                            });
+                        if (token.isCancelled()) break;
+                        if (decoded) builder.finish(result.fingerprint);
+                        result.computed = true;
+                    }
+                    results.push_back(std::move(result));
+                }
+                return results;
+            },
+            [this, total, size = int(batch.size())](std::vector<Result> results) {
+                for (Result& result : results) {
+                    ids_.insert(result.path, result.id);
+                    if (result.computed) {
+                        fingerprints_.insert(result.id, result.fingerprint);
+                        dirty_ = true;
+                    }
+                }
+                done_ += size;
+                emit progress(done_, total);
+                if (--pendingBatches_ == 0) {
+                    save();
+                    buildGroups();
+                    emit finished();
+                }
+            },
+            token_);
+    }
+}
+
+void DuplicateFinder::cancel() {
+    if (!isRunning()) return;
+    token_.cancel();  // Результаты отмененных пачек не доставляются
+    pendingBatches_ = 0;
+    save();           // Уже посчитанное сохраняем
+}
+
+void DuplicateFinder::buildGroups() {
+    groups_.clear();
+
+    // Файлы по идентификатору, в порядке библиотеки
+    QStringList ids;
+    QHash<QString, QStringList> pathsById;
+    for (const QString& path : paths_) {
+        const QString id = ids_.value(path);
+        if (id.isEmpty()) continue;
+        QStringList& copies = pathsById[id];
+        if (copies.isEmpty()) ids << id;
+        copies << path;
+    }
+
+    // Близкие копии: по одному отпечатку на идентификатор, группы - через LSH
+    QStringList printIds;
+    std::vector<AcousticFingerprint> prints;
+    for (const QString& id : ids) {
+        const AcousticFingerprint fingerprint = fingerprints_.value(id);
+        if (!fingerprint.isValid()) continue;
+        printIds << id;
+        prints.push_back(fingerprint);
+    }
+    QSet<QString> grouped;
+    for (const std::vector<size_t>& cluster : AcousticFingerprint::group(prints)) {
+        Group group;
+        for (size_t index : cluster) {
+            group.paths << pathsById.value(printIds[int(index)]);
+            grouped.insert(printIds[int(index)]);
+        }
+        groups_.push_back(group);
+    }
+
+    // Точные копии, не вошедшие в группы близких (например, файл не декодируется)
+    for (const QString& id : ids) {
+        const QStringList& copies = pathsById[id];
+        if (copies.size() < 2 || grouped.contains(id)) continue;
+        Group group;
+        group.paths = copies;
+        group.exact = true;
+        groups_.push_back(group);
+    }
+
+    // Первым идет самый крупный файл: при одной записи это обычно лучшее качество
+    for (Group& group : groups_) {
+        QHash<QString, qint64> sizes;
+        for (const QString& path : group.paths) sizes.insert(path, QFileInfo(path).size());
+        std::stable_sort(group.paths.begin(), group.paths.end(), [&sizes](const QString& a, const QString& b) {
+            return sizes.value(a) > sizes.value(b);
+        });
+    }
+}
@@ -0,0 +1,67 @@
+// DuplicateFinder.h
+#pragma once
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include <vector>
+
+#include "AcousticFingerprint.h"
+#include "TaskScheduler.h" // Отпечатки считаются в общем пуле потоков
+
+class TrackIdStore;
+
+// Поиск копий одной записи в библиотеке. Точные копии - одинаковый
+// идентификатор содержимого (TrackIdStore), близкие - совпадающий
+// акустический отпечаток (другой битрейт или кодек). Отпечатки требуют
+// полного декодирования, поэтому считаются по запросу пачками в пуле и
+// хранятся в fingerprints.txt по идентификатору содержимого: перенесенный
+// файл заново не декодируется
+class DuplicateFinder : public QObject {
+    Q_OBJECT
+
+public:
+    struct Group {
+        QStringList paths;   // Сначала самый крупный файл (обычно лучшее качество)
+        bool exact = false;  // Все файлы - одинаковый звук побайтно
+    };
+
+    DuplicateFinder(QString filePath, const TrackIdStore* trackIds, QObject* parent = nullptr);
+
+    void load();
+    void save();
+
+    // Недостающие отпечатки для paths и группировка по готовности
+    void start(const QStringList& paths);
+    void cancel();
+    bool isRunning() const { return pendingBatches_ > 0; }
+
+    const std::vector<Group>& groups() const { return groups_; }
+
+signals:
+    void progress(int done, int total);
+    void finished();
+
+private:
+    // Результат обработки одного файла в пуле
+    struct Result {
+        QString path;
+        QString id;
+        AcousticFingerprint fingerprint;
+        bool computed = false;  // Отпечаток считался (неудача тоже запоминается)
+    };
+
+    void buildGroups();
+
+    QString filePath_;
+    const TrackIdStore* trackIds_;
+    QHash<QString, AcousticFingerprint> fingerprints_;  // Идентификатор -> отпечаток (невалидный - не декодируется)
+    QStringList paths_;
+    QHash<QString, QString> ids_;                       // Путь -> идентификатор текущего поиска
+    std::vector<Group> groups_;
+    CancellationToken token_;
+    int pendingBatches_ = 0;
+    int done_ = 0;
+    bool dirty_ = false;
+};
@@ -0,0 +1,135 @@
+// DuplicatesDialog.cpp
+#include "DuplicatesDialog.h"
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QVBoxLayout>
+
+DuplicatesDialog::DuplicatesDialog(DuplicateFinder* finder, QStringList paths, int hiddenCount, QWidget* parent)
+    : QDialog(parent), finder_(finder), paths_(std::move(paths)) {
+    setWindowTitle("Копии треков");
+    resize(760, 520);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    mainLayout->setContentsMargins(15, 15, 15, 15);
+    mainLayout->setSpacing(10);
+
+    summaryLabel = new QLabel;
+    summaryLabel->setWordWrap(true);
+    summaryLabel->setStyleSheet("QLabel { font-size: 12px; padding: 5px; }");
+    mainLayout->addWidget(summaryLabel);
+
+    progressBar = new QProgressBar;
+    progressBar->setRange(0, 1);
+    progressBar->setValue(0);
+    mainLayout->addWidget(progressBar);
+
+    // Группа - узел дерева, файлы группы - отмечаемые строки под ним
+    groupTree = new QTreeWidget;
+    groupTree->setColumnCount(3);
+    groupTree->setHeaderLabels({"Файл", "Размер", "Папка"});
+    groupTree->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    groupTree->header()->setSectionResizeMode(2, QHeaderView::Stretch);
+    groupTree->setSelectionMode(QAbstractItemView::NoSelection);
+    mainLayout->addWidget(groupTree);
+
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+
+    restoreButton = new QPushButton(QString("Вернуть скрытые (%1)").arg(hiddenCount));
+    restoreButton->setEnabled(hiddenCount > 0);
+    restoreButton->setStyleSheet("QPushButton { padding: 8px 15px; }");
+    buttonLayout->addWidget(restoreButton);
+    buttonLayout->addStretch();
+
+    startButton = new QPushButton("Найти");
+    startButton->setDefault(true);
+    startButton->setStyleSheet("QPushButton { padding: 8px 15px; font-weight: bold; }");
+    buttonLayout->addWidget(startButton);
+
+    hideButton = new QPushButton("Скрыть отмеченные");
+    hideButton->setStyleSheet("QPushButton { padding: 8px 15px; }");
+    buttonLayout->addWidget(hideButton);
+
+    closeButton = new QPushButton("Закрыть");
+    closeButton->setStyleSheet("QPushButton { padding: 8px 15px; }");
+    buttonLayout->addWidget(closeButton);
+
+    mainLayout->addLayout(buttonLayout);
+
+    connect(startButton, &QPushButton::clicked, this, &DuplicatesDialog::startSearch);
+    connect(hideButton, &QPushButton::clicked, this, &QDialog::accept);
+    connect(restoreButton, &QPushButton::clicked, this, [this]() { done(RestoreHidden); });
+    connect(closeButton, &QPushButton::clicked, this, &QDialog::reject);
+    connect(finder_, &DuplicateFinder::progress, this, &DuplicatesDialog::onProgress);
+    connect(finder_, &DuplicateFinder::finished, this, [this]() {
+        startButton->setEnabled(true);
+        fillGroups();
+    });
+    // Закрытие окна не отменяет поиск - отпечатки досчитаются в фоне
+
+    fillGroups();  // Результаты прошлого поиска
+    if (finder_->groups().empty() && !finder_->isRunning()) {
+        summaryLabel->setText(QString("Поиск копий среди %1 файлов: точные - по содержимому, "
+                                      "близкие (другой битрейт) - по акустическому отпечатку. "
+                                      "Первый поиск декодирует каждый трек.").arg(paths_.size()));
+    }
+}
+
+QStringList DuplicatesDialog::checkedPaths() const {
+    QStringList paths;
+    for (int g = 0; g < groupTree->topLevelItemCount(); ++g) {
+        const QTreeWidgetItem* group = groupTree->topLevelItem(g);
+        for (int i = 0; i < group->childCount(); ++i) {
+            const QTreeWidgetItem* file = group->child(i);
+            if (file->checkState(0) == Qt::Checked) paths << file->data(0, Qt::UserRole).toString();
+        }
+    }
+    return paths;
+}
+
+void DuplicatesDialog::startSearch() {
+    startButton->setEnabled(false);
+    finder_->start(paths_);
+}
+
+void DuplicatesDialog::onProgress(int done, int total) {
+    progressBar->setRange(0, qMax(1, total));
+    progressBar->setValue(done);
+    summaryLabel->setText(QString("Отпечатки: %1 из %2").arg(done).arg(total));
+}
+
+void DuplicatesDialog::fillGroups() {
+    groupTree->clear();
+
+    int copies = 0;
+    for (const DuplicateFinder::Group& group : finder_->groups()) {
+        QTreeWidgetItem* groupItem = new QTreeWidgetItem(groupTree);
+        groupItem->setText(0, QString("%1 - файлов: %2")
+                                  .arg(group.exact ? "Точные копии" : "Та же запись")
+                                  .arg(group.paths.size()));
+        groupItem->setFirstColumnSpanned(true);
+
+        for (int i = 0; i < group.paths.size(); ++i) {
+            const QFileInfo info(group.paths[i]);
+            QTreeWidgetItem* fileItem = new QTreeWidgetItem(groupItem);
+            fileItem->setText(0, info.fileName());
+            fileItem->setToolTip(0, group.paths[i]);
+            fileItem->setData(0, Qt::UserRole, group.paths[i]);
+            fileItem->setText(1, QString("%1 МБ").arg(info.size() / (1024.0 * 1024.0), 0, 'f', 1));
+            fileItem->setText(2, info.absolutePath());
+            // Первый (самый крупный) файл остается в плейлисте
+            fileItem->setCheckState(0, i == 0 ? Qt::Unchecked : Qt::Checked);
+        }
+        copies += group.paths.size() - 1;
+    }
+    groupTree->expandAll();
+
+    hideButton->setEnabled(copies > 0);
+    if (!finder_->groups().empty()) {
+        summaryLabel->setText(QString("Групп: %1, лишних копий: %2. Отмеченные файлы будут скрыты "
+                                      "из плейлиста, сами файлы не удаляются.")
+                                  .arg(finder_->groups().size()).arg(copies));
+    } else if (!finder_->isRunning()) {
+        summaryLabel->setText("Копий не найдено");
+    }
+}
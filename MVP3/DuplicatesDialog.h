@@ -0,0 +1,38 @@
+// DuplicatesDialog.h
+#pragma once
+#include <QDialog>
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QStringList>
+#include <QTreeWidget>
+
+#include "DuplicateFinder.h"
+
+// Копии одной записи: поиск с прогрессом и группы файлов. Отмеченные файлы
+// скрываются из плейлиста (сами файлы не трогаются); по умолчанию отмечено
+// все, кроме самого крупного файла группы
+class DuplicatesDialog : public QDialog {
+    Q_OBJECT
+public:
+    enum Outcome { RestoreHidden = QDialog::Accepted + 1 };  // Вернуть все скрытые
+
+    DuplicatesDialog(DuplicateFinder* finder, QStringList paths, int hiddenCount, QWidget* parent = nullptr);
+
+    QStringList checkedPaths() const;  // Файлы, которые нужно скрыть
+
+private:
+    void startSearch();
+    void onProgress(int done, int total);
+    void fillGroups();
+
+    DuplicateFinder* finder_;
+    QStringList paths_;
+    QLabel* summaryLabel;
+    QProgressBar* progressBar;
+    QTreeWidget* groupTree;
+    QPushButton* startButton;
+    QPushButton* hideButton;
+    QPushButton* restoreButton;
+    QPushButton* closeButton;
+};
@@ -0,0 +1,310 @@
+// EqualizerDialog.cpp
+#include "EqualizerDialog.h"
+#include <QFrame>
+#include <QGridLayout>
+#include <QHBoxLayout>
+#include <QInputDialog>
+#include <QLineEdit>
+#include <QVBoxLayout>
+
+#include <cmath> // std::lround
+
+namespace {
+const QString kPresetGroup = "equalizerPresets";
+const int kSliderScale = 10;  // Шаг ползунка - 0.1 дБ
+
+// Встроенные пресеты: усиления полос на стандартных частотах
+struct BuiltinPreset {
+    const char* name;
+    float gains[DspChain::kBands];
+};
+const BuiltinPreset kBuiltinPresets[] = {
+    {"Ровно",    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0}},
+    {"Бас",      { 6,  5,  4,  2,  0,  0,  0,  0,  0,  0}},
+    {"Рок",      { 4,  3,  2,  0, -1, -1,  0,  2,  3,  4}},
+    {"Поп",      {-1,  0,  2,  3,  4,  3,  1,  0, -1, -1}},
+    {"Джаз",     { 3,  2,  1,  2, -1, -1,  0,  1,  2,  3}},
+    {"Классика", { 3,  2,  1,  0,  0,  0, -1, -1,  1,  2}},
+    {"Вокал",    {-2, -2, -1,  1,  3,  4,  3,  1,  0, -1}},
+    {"Высокие",  { 0,  0,  0,  0,  0,  0,  2,  4,  5,  6}},
+};
+
+QString formatGain(int tenths) {
+    return QString("%1%2").arg(tenths > 0 ? "+" : "").arg(tenths / double(kSliderScale), 0, 'f', 1);
+}
+
+QString formatFrequency(float frequency) {
+    return frequency >= 1000.0f ? QString("%1k").arg(frequency / 1000.0f) : QString::number(frequency);
+}
+
+// Имя пресета - ключ QSettings: без разделителей групп
+QString presetKey(QString name) {
+    return name.replace('/', '_').replace('\\', '_');
+}
+}
+
+EqualizerDialog::EqualizerDialog(const DspChain::Settings& settings, bool enabled, QWidget* parent)
+    : QDialog(parent) {
+    setWindowTitle("Эквалайзер");
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    mainLayout->setContentsMargins(15, 15, 15, 15);
+    mainLayout->setSpacing(10);
+
+    // Включение и пресеты
+    QHBoxLayout* topLayout = new QHBoxLayout();
+    enabledCheckBox = new QCheckBox("Включить эквалайзер");
+    enabledCheckBox->setChecked(enabled);
+    enabledCheckBox->setToolTip("Звук идет через эквалайзер, предусилитель и лимитер");
+    topLayout->addWidget(enabledCheckBox);
+    topLayout->addStretch();
+
+    topLayout->addWidget(new QLabel("Пресет:"));
+    presetComboBox = new QComboBox();
+    presetComboBox->setMinimumWidth(140);
+    topLayout->addWidget(presetComboBox);
+
+    savePresetButton = new QPushButton("Сохранить...");
+    topLayout->addWidget(savePresetButton);
+    deletePresetButton = new QPushButton("Удалить");
+    topLayout->addWidget(deletePresetButton);
+    mainLayout->addLayout(topLayout);
+
+    // Полосы: усиление, ползунок, частота, добротность; справа - предусилитель
+    QGridLayout* bandsLayout = new QGridLayout();
+    bandsLayout->setHorizontalSpacing(6);
+    bandsLayout->addWidget(new QLabel("дБ"), 0, 0);
+    bandsLayout->addWidget(new QLabel("Гц"), 2, 0);
+    bandsLayout->addWidget(new QLabel("Q"), 3, 0);
+
+    const int gainRange = int(DspChain::kMaxGainDb) * kSliderScale;
+    for (int b = 0; b < DspChain::kBands; ++b) {
+        QLabel* gainLabel = new QLabel();
+        gainLabel->setAlignment(Qt::AlignCenter);
+        gainLabel->setMinimumWidth(40);
+        bandsLayout->addWidget(gainLabel, 0, b + 1);
+        gainLabels.append(gainLabel);
+
+        QSlider* slider = new QSlider(Qt::Vertical);
+        slider->setRange(-gainRange, gainRange);
+        slider->setPageStep(kSliderScale);
+        slider->setMinimumHeight(160);
+        slider->setTickPosition(QSlider::TicksBothSides);
+        slider->setTickInterval(3 * kSliderScale);
+        bandsLayout->addWidget(slider, 1, b + 1, Qt::AlignHCenter);
+        gainSliders.append(slider);
+
+        QSpinBox* frequency = new QSpinBox();
+        frequency->setRange(20, 20000);
+        frequency->setButtonSymbols(QAbstractSpinBox::NoButtons);
+        frequency->setAlignment(Qt::AlignCenter);
+        bandsLayout->addWidget(frequency, 2, b + 1);
+        frequencySpinBoxes.append(frequency);
+
+        QDoubleSpinBox* q = new QDoubleSpinBox();
+        q->setRange(0.1, 10.0);
+        q->setDecimals(2);
+        q->setSingleStep(0.1);
+        q->setButtonSymbols(QAbstractSpinBox::NoButtons);
+        q->setAlignment(Qt::AlignCenter);
+        bandsLayout->addWidget(q, 3, b + 1);
+        qSpinBoxes.append(q);
+
+        connect(slider, &QSlider::valueChanged, this, &EqualizerDialog::onControlChanged);
+        connect(frequency, qOverload<int>(&QSpinBox::valueChanged), this, &EqualizerDialog::onControlChanged);
+        connect(q, qOverload<double>(&QDoubleSpinBox::valueChanged), this, &EqualizerDialog::onControlChanged);
+    }
+
+    QFrame* separator = new QFrame();
+    separator->setFrameShape(QFrame::VLine);
+    separator->setFrameShadow(QFrame::Sunken);
+    bandsLayout->addWidget(separator, 0, DspChain::kBands + 1, 4, 1);
+
+    preampLabel = new QLabel();
+    preampLabel->setAlignment(Qt::AlignCenter);
+    preampLabel->setMinimumWidth(40);
+    bandsLayout->addWidget(preampLabel, 0, DspChain::kBands + 2);
+    preampSlider = new QSlider(Qt::Vertical);
+    preampSlider->setRange(-gainRange, gainRange);
+    preampSlider->setPageStep(kSliderScale);
+    preampSlider->setTickPosition(QSlider::TicksBothSides);
+    preampSlider->setTickInterval(3 * kSliderScale);
+    bandsLayout->addWidget(preampSlider, 1, DspChain::kBands + 2, Qt::AlignHCenter);
+    QLabel* preampTitle = new QLabel("Пред.");
+    preampTitle->setAlignment(Qt::AlignCenter);
+    preampTitle->setToolTip("Предусилитель");
+    bandsLayout->addWidget(preampTitle, 2, DspChain::kBands + 2);
+    connect(preampSlider, &QSlider::valueChanged, this, &EqualizerDialog::onControlChanged);
+
+    mainLayout->addLayout(bandsLayout);
+
+    // Лимитер и кнопки
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    limiterCheckBox = new QCheckBox("Лимитер");
+    limiterCheckBox->setToolTip("Не дает подъему полос перегрузить звук");
+    connect(limiterCheckBox, &QCheckBox::toggled, this, &EqualizerDialog::onControlChanged);
+    buttonLayout->addWidget(limiterCheckBox);
+    buttonLayout->addStretch();
+
+    resetButton = new QPushButton("Сбросить");
+    resetButton->setStyleSheet("QPushButton { padding: 8px 15px; }");
+    buttonLayout->addWidget(resetButton);
+
+    closeButton = new QPushButton("Закрыть");
+    closeButton->setDefault(true);
+    closeButton->setStyleSheet("QPushButton { padding: 8px 15px; font-weight: bold; }");
+    buttonLayout->addWidget(closeButton);
+    mainLayout->addLayout(buttonLayout);
+
+    connect(enabledCheckBox, &QCheckBox::toggled, this, &EqualizerDialog::enabledChanged);
+    connect(presetComboBox, qOverload<int>(&QComboBox::activated), this, &EqualizerDialog::applyPreset);
+    connect(savePresetButton, &QPushButton::clicked, this, &EqualizerDialog::savePreset);
+    connect(deletePresetButton, &QPushButton::clicked, this, &EqualizerDialog::deletePreset);
+    connect(resetButton, &QPushButton::clicked, this, [this]() {
+        setControls(DspChain::Settings());
+        onControlChanged();
+    });
+    connect(closeButton, &QPushButton::clicked, this, &QDialog::accept);
+
+    fillPresets();
+    setControls(settings);
+}
+
+DspChain::Settings EqualizerDialog::settings() const {
+    DspChain::Settings settings;
+    for (int b = 0; b < DspChain::kBands; ++b) {
+        settings.bands[b].gainDb = gainSliders[b]->value() / float(kSliderScale);
+        settings.bands[b].frequency = float(frequencySpinBoxes[b]->value());
+        settings.bands[b].q = float(qSpinBoxes[b]->value());
+    }
+    settings.preampDb = preampSlider->value() / float(kSliderScale);
+    settings.limiter = limiterCheckBox->isChecked();
+    return settings;
+}
+
+bool EqualizerDialog::isEqualizerEnabled() const {
+    return enabledCheckBox->isChecked();
+}
+
+void EqualizerDialog::setControls(const DspChain::Settings& settings) {
+    updating_ = true;
+    for (int b = 0; b < DspChain::kBands; ++b) {
+        const DspChain::Band& band = settings.bands[b];
+        gainSliders[b]->setValue(int(std::lround(band.gainDb * kSliderScale)));
+        frequencySpinBoxes[b]->setValue(int(std::lround(band.frequency)));
+        qSpinBoxes[b]->setValue(band.q);
+        gainSliders[b]->setToolTip(formatFrequency(band.frequency) + " Гц");
+    }
+    preampSlider->setValue(int(std::lround(settings.preampDb * kSliderScale)));
+    limiterCheckBox->setChecked(settings.limiter);
+    updating_ = false;
+    updateGainLabels();
+}
+
+void EqualizerDialog::onControlChanged() {
+    updateGainLabels();
+    if (updating_) return;
+    presetComboBox->setCurrentIndex(0);  // Ручная правка - уже не пресет
+    deletePresetButton->setEnabled(false);
+    emit settingsChanged(settings());
+}
+
+void EqualizerDialog::updateGainLabels() {
+    for (int b = 0; b < DspChain::kBands; ++b) {
+        gainLabels[b]->setText(formatGain(gainSliders[b]->value()));
+    }
+    preampLabel->setText(formatGain(preampSlider->value()));
+}
+
+// Первый пункт - ручные настройки, затем встроенные пресеты, затем свои
+void EqualizerDialog::fillPresets() {
+    presetComboBox->clear();
+    presetComboBox->addItem("Свои настройки");
+    for (const BuiltinPreset& preset : kBuiltinPresets) {
+        presetComboBox->addItem(QString::fromUtf8(preset.name));
+    }
+    QSettings store("AlexMusic", "Player");
+    store.beginGroup(kPresetGroup);
+    for (const QString& name : store.childGroups()) {
+        presetComboBox->addItem(name, name);  // Свой пресет - с именем в данных
+    }
+    store.endGroup();
+    deletePresetButton->setEnabled(false);
+}
+
+void EqualizerDialog::applyPreset(int index) {
+    const QString userPreset = presetComboBox->itemData(index).toString();
+    deletePresetButton->setEnabled(!userPreset.isEmpty());
+    if (index <= 0) return;
+
+    DspChain::Settings preset = settings();
+    if (!userPreset.isEmpty()) {
+        QSettings store("AlexMusic", "Player");
+        preset = readSettings(store, kPresetGroup + "/" + userPreset);
+    } else {
+        // Встроенный: стандартные полосы, предусилитель и лимитер - как были
+        const DspChain::Settings defaults;
+        for (int b = 0; b < DspChain::kBands; ++b) {
+            preset.bands[b] = defaults.bands[b];
+            preset.bands[b].gainDb = kBuiltinPresets[index - 1].gains[b];
+        }
+    }
+    setControls(preset);
+    emit settingsChanged(preset);
+}
+
+void EqualizerDialog::savePreset() {
+    bool ok = false;
+    const QString name = presetKey(QInputDialog::getText(this, "Сохранить пресет", "Название:",
+                                                         QLineEdit::Normal, QString(), &ok).trimmed());
+    if (!ok || name.isEmpty()) return;
+
+    QSettings store("AlexMusic", "Player");
+    writeSettings(store, kPresetGroup + "/" + name, settings());
+    fillPresets();
+    const int index = presetComboBox->findData(name);
+    presetComboBox->setCurrentIndex(index);
+    deletePresetButton->setEnabled(index > 0);
+}
+
+void EqualizerDialog::deletePreset() {
+    const QString name = presetComboBox->currentData().toString();
+    if (name.isEmpty()) return;
+    QSettings store("AlexMusic", "Player");
+    store.remove(kPresetGroup + "/" + name);
+    fillPresets();
+}
+
+DspChain::Settings EqualizerDialog::readSettings(QSettings& store, const QString& group) {
+    DspChain::Settings settings;
+    store.beginGroup(group);
+    const QVariantList frequencies = store.value("frequencies").toList();
+    const QVariantList qs = store.value("q").toList();
+    const QVariantList gains = store.value("gains").toList();
+    for (int b = 0; b < DspChain::kBands; ++b) {
+        DspChain::Band& band = settings.bands[b];
+        if (b < frequencies.size()) band.frequency = frequencies[b].toFloat();
+        if (b < qs.size()) band.q = qs[b].toFloat();
+        if (b < gains.size()) band.gainDb = gains[b].toFloat();
+    }
+    settings.preampDb = store.value("preamp", 0.0f).toFloat();
+    settings.limiter = store.value("limiter", true).toBool();
+    store.endGroup();
+    return settings;
+}
+
+void EqualizerDialog::writeSettings(QSettings& store, const QString& group, const DspChain::Settings& settings) {
+    QVariantList frequencies, qs, gains;
+    for (const DspChain::Band& band : settings.bands) {
+        frequencies << band.frequency;
+        qs << band.q;
+        gains << band.gainDb;
+    }
+    store.beginGroup(group);
+    store.setValue("frequencies", frequencies);
+    store.setValue("q", qs);
+    store.setValue("gains", gains);
+    store.setValue("preamp", settings.preampDb);
+    store.setValue("limiter", settings.limiter);
+    store.endGroup();
+}
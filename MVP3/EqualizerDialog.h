@@ -0,0 +1,59 @@
+// EqualizerDialog.h
+#pragma once
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDialog>
+#include <QDoubleSpinBox>
+#include <QLabel>
+#include <QPushButton>
+#include <QSettings>
+#include <QSlider>
+#include <QSpinBox>
+#include <QVector>
+
+#include "DspChain.h"
+
+// Эквалайзер: усиление, частота и добротность каждой полосы, предусилитель,
+// лимитер и пресеты. Изменения сразу уходят сигналом settingsChanged -
+// цепочка подхватывает их без остановки звука. Встроенные пресеты задают
+// только усиления, свои сохраняются в QSettings целиком
+class EqualizerDialog : public QDialog {
+    Q_OBJECT
+public:
+    EqualizerDialog(const DspChain::Settings& settings, bool enabled, QWidget* parent = nullptr);
+
+    DspChain::Settings settings() const;
+    bool isEqualizerEnabled() const;
+
+    // Настройки цепочки в группе QSettings (текущие и пресеты - в одном формате)
+    static DspChain::Settings readSettings(QSettings& store, const QString& group);
+    static void writeSettings(QSettings& store, const QString& group, const DspChain::Settings& settings);
+
+signals:
+    void settingsChanged(const DspChain::Settings& settings);
+    void enabledChanged(bool enabled);
+
+private:
+    void setControls(const DspChain::Settings& settings);  // Без сигналов об изменении
+    void onControlChanged();
+    void fillPresets();
+    void applyPreset(int index);
+    void savePreset();
+    void deletePreset();
+    void updateGainLabels();
+
+    QCheckBox* enabledCheckBox;
+    QComboBox* presetComboBox;
+    QPushButton* savePresetButton;
+    QPushButton* deletePresetButton;
+    QVector<QSlider*> gainSliders;           // Десятые доли дБ
+    QVector<QLabel*> gainLabels;
+    QVector<QSpinBox*> frequencySpinBoxes;
+    QVector<QDoubleSpinBox*> qSpinBoxes;
+    QSlider* preampSlider;
+    QLabel* preampLabel;
+    QCheckBox* limiterCheckBox;
+    QPushButton* resetButton;
+    QPushButton* closeButton;
+    bool updating_ = false;                  // Заполнение элементов из кода
+};
@@ -0,0 +1,144 @@
+// FeatureStore.cpp
+#include "FeatureStore.h"
+#include <QFile>
+#include <QSaveFile>   // Атомарная запись кэша
+#include <QSet>
+#include <QTextStream>
+
+#include "PcmDecoder.h"
+#include "TrackIdStore.h"
+
+namespace {
+// Заголовок формата; при смене формата старый кэш просто игнорируется
+const char* const kHeader = "ALEXMUSIC-FEATURES 1";
+const int kBatchSize = 4;        // Файлов в задаче: декодирование долгое - мелкие пачки равномернее делят ядра
+const int kSaveEveryBatches = 16; // Промежуточное сохранение: выход не теряет много работы
+}
+
+FeatureStore::FeatureStore(QString filePath, const TrackIdStore* trackIds, QObject* parent)
+    : QObject(parent), filePath_(std::move(filePath)), trackIds_(trackIds) {}
+
+// Строка кэша: идентификатор|признаки (пусто - трек не декодируется)
+void FeatureStore::load() {
+    QFile file(filePath_);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return;
+
+    QTextStream in(&file);
+    if (in.readLine() != QLatin1String(kHeader)) return;
+
+    while (!in.atEnd()) {
+        const QString line = in.readLine();
+        const int separator = line.indexOf('|');
+        if (separator <= 0) continue;
+
+        AudioFeatures features;
+        const QString values = line.mid(separator + 1);
+        if (!values.isEmpty() && !AudioFeatures::parse(values.toStdString(), features)) continue;
+        features_.insert(line.left(separator), features);
+    }
+}
+
+void FeatureStore::save() {
+    if (!dirty_) return;
+
+    QSaveFile file(filePath_);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) return;
+
+    QTextStream out(&file);
+    out << kHeader << '\n';
+    for (auto it = features_.cbegin(); it != features_.cend(); ++it) {
+        out << it.key() << '|' << (it->isValid() ? QString::fromStdString(it->serialize()) : QString()) << '\n';
+    }
+    out.flush();
+    if (file.commit()) {
+        dirty_ = false;
+        unsavedBatches_ = 0;
+    }
+}
+
+void FeatureStore::start(const QStringList& paths) {
+    cancel();
+    token_ = CancellationToken();
+    done_ = 0;
+
+    // Копии с одинаковым идентификатором анализируются один раз
+    QStringList pending;
+    QSet<QString> scheduled;
+    for (const QString& path : paths) {
+        const QString id = trackIds_->id(path);
+        if (!id.isEmpty()) {
+            if (isComplete(id) || scheduled.contains(id)) continue;
+            scheduled.insert(id);
+        }
+        pending << path;
+    }
+
+    const int total = pending.size();
+    emit progress(0, total);
+    if (pending.isEmpty()) {
+        emit finished();
+        return;
+    }
+
+    QSet<QString> known;  // Для файлов без идентификатора (посчитается в пуле)
+    for (auto it = features_.cbegin(); it != features_.cend(); ++it) {
+        if (isComplete(it.key())) known.insert(it.key());
+    }
+
+    for (int first = 0; first < pending.size(); first += kBatchSize) {
+        std::vector<std::pair<QString, QString>> items;  // Путь и известный идентификатор
+        for (const QString& path : pending.mid(first, kBatchSize)) items.emplace_back(path, trackIds_->id(path));
+
+        ++pendingBatches_;
+        TaskScheduler::instance().run(
+            TaskPriority::Maintenance, this,
+            [items, known](const CancellationToken& token) {
+                std::vector<Result> results;
+                results.reserve(items.size());
+                for (const auto& item : items) {
+                    if (token.isCancelled()) break;
+                    Result result;
+                    result.id = item.second.isEmpty() ? TrackIdStore::compute(item.first, token).id : item.second;
+                    if (result.id.isEmpty() || known.contains(result.id)) continue;
+
+                    AudioFeatures::Builder builder;
+                    const bool decoded = PcmDecoder::decodeMono(
+                        item.first, token, [&builder](const float* samples, size_t count, uint32_t rate) {
+                            builder.add(samples, count, rate);
+                        });
+                    if (token.isCancelled()) break;
+                    if (decoded) builder.finish(result.features);
+                    results.push_back(std::move(result));
+                }
+                return results;
+            },
+            [this, total, size = int(items.size())](std::vector<Result> results) {
+                for (Result& result : results) {
+                    features_.insert(result.id, result.features);
+                    dirty_ = true;
+                }
+                done_ += size;
+                emit progress(done_, total);
+                if (--pendingBatches_ == 0) {
+                    save();
+                    emit finished();
+                } else if (++unsavedBatches_ >= kSaveEveryBatches) {
+                    save();
+                }
+            },
+            token_);
+    }
+}
+
+// Признаки из кэша прежней версии (без границ звука) пересчитываются; до тех пор ими пользуются как есть
+bool FeatureStore::isComplete(const QString& id) const {
+    auto it = features_.constFind(id);
+    return it != features_.cend() && (!it->isValid() || it->hasAudibleRange());
+}
+
+void FeatureStore::cancel() {
+    if (!isRunning()) return;
+    token_.cancel();  // Результаты отмененных пачек не доставляются
+    pendingBatches_ = 0;
+    save();           // Уже посчитанное сохраняем
+}
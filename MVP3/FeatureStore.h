@@ -0,0 +1,55 @@
+// FeatureStore.h
+#pragma once
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include "AudioFeatures.h"
+#include "TaskScheduler.h" // Анализ идет в общем пуле потоков
+
+class TrackIdStore;
+
+// Признаки звучания треков (features.txt) по идентификатору содержимого:
+// перенесенный файл заново не анализируется. Анализ требует полного
+// декодирования, поэтому идет фоном с самым низким приоритетом, пачками в
+// пуле, и сохраняется по ходу: прерванный выходом продолжается со следующего
+// запуска с недостающих треков
+class FeatureStore : public QObject {
+    Q_OBJECT
+
+public:
+    FeatureStore(QString filePath, const TrackIdStore* trackIds, QObject* parent = nullptr);
+
+    void load();
+    void save();
+
+    // Анализ треков, для которых признаков еще нет
+    void start(const QStringList& paths);
+    void cancel();
+    bool isRunning() const { return pendingBatches_ > 0; }
+
+    // Признаки по идентификатору содержимого; невалидные - не посчитаны или не декодируются
+    AudioFeatures features(const QString& id) const { return features_.value(id); }
+
+signals:
+    void progress(int done, int total);
+    void finished();
+
+private:
+    struct Result {
+        QString id;
+        AudioFeatures features;
+    };
+
+    bool isComplete(const QString& id) const;  // Анализ не нужен
+
+    QString filePath_;
+    const TrackIdStore* trackIds_;
+    QHash<QString, AudioFeatures> features_;  // Невалидные - трек не декодируется (не повторяем)
+    CancellationToken token_;
+    int pendingBatches_ = 0;
+    int done_ = 0;
+    int unsavedBatches_ = 0;
+    bool dirty_ = false;
+};
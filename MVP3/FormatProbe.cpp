@@ -0,0 +1,74 @@
+// FormatProbe.cpp
+#include "FormatProbe.h"
+#include <QFileInfo>
+
+#include "AudioProbes.h"
+
+ProbeRegistry& ProbeRegistry::instance() {
+    static ProbeRegistry registry = [] {
+        ProbeRegistry r;
+        // Форматы с однозначной подписью - раньше MP3, у которого подписи нет
+        r.add(std::make_unique<FlacProbe>());
+        r.add(std::make_unique<OggProbe>());
+        r.add(std::make_unique<Mp4Probe>());
+        r.add(std::make_unique<WavProbe>());
+        r.add(std::make_unique<Mp3Probe>());
+        return r;
+    }();
+    return registry;
+}
+
+void ProbeRegistry::add(std::unique_ptr<FormatProbe> probe) {
+    probes_.push_back(std::move(probe));
+}
+
+const FormatProbe* ProbeRegistry::detect(MappedFile& file) const {
+    ByteView head = file.head(kSniffBytes);
+    if (head.empty()) return nullptr;
+    for (const auto& probe : probes_) {
+        if (probe->sniff(head)) return probe.get();
+    }
+    return nullptr;
+}
+
+ProbeResult ProbeRegistry::probe(const QString& path, bool withDuration) const {
+    MappedFile file(path);
+    if (!file.isOpen()) {
+        ProbeResult result;
+        result.error = "Файл не открывается";
+        return result;
+    }
+    if (file.size() == 0) {
+        ProbeResult result;
+        result.error = "Файл пустой (0 байт)";
+        return result;
+    }
+
+    const FormatProbe* probe = detect(file);
+    if (!probe) {
+        ProbeResult result;
+        result.error = "Неизвестный формат файла";
+        return result;
+    }
+    ProbeResult result = probe->probe(file, withDuration);
+    result.format = probe->format();
+    return result;
+}
+
+QStringList ProbeRegistry::nameFilters() const {
+    QStringList filters;
+    for (const auto& probe : probes_) {
+        for (const QString& extension : probe->extensions()) {
+            filters << "*." + extension;
+        }
+    }
+    return filters;
+}
+
+bool ProbeRegistry::isSupportedFile(const QString& path) const {
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    for (const auto& probe : probes_) {
+        if (probe->extensions().contains(suffix)) return true;
+    }
+    return false;
+}
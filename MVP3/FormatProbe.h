@@ -0,0 +1,59 @@
+// FormatProbe.h
+#pragma once
+#include <QString>
+#include <QStringList>
+
+#include <memory> // std::unique_ptr
+#include <vector>
+
+#include "MappedFile.h"
+
+// Поддерживаемые контейнеры
+enum class AudioFormat { Unknown, Mp3, Flac, Ogg, Mp4, Wav };
+
+// Что удалось узнать о файле без медиаплеера
+struct ProbeResult {
+    AudioFormat format = AudioFormat::Unknown;
+    bool valid = false;       // Контейнер разобран и в нем есть звук
+    qint64 durationMs = 0;    // 0 - не определялась или неизвестна
+    QString title;
+    QString artist;
+    QString album;
+    QString error;            // Почему файл не годится
+};
+
+// Разборщик одного контейнера. sniff() смотрит только первые байты файла,
+// probe() читает ограниченные участки через отображение файла
+class FormatProbe {
+public:
+    virtual ~FormatProbe() = default;
+
+    virtual AudioFormat format() const = 0;
+    virtual QStringList extensions() const = 0;          // Без точки, в нижнем регистре
+    virtual bool sniff(ByteView head) const = 0;          // Подпись формата в начале файла
+    // withDuration = false - только теги (длительность MP3 требует прохода по кадрам)
+    virtual ProbeResult probe(MappedFile& file, bool withDuration) const = 0;
+};
+
+// Реестр разборщиков: формат определяется по содержимому, а не по расширению,
+// поэтому файл с чужим расширением разбирается своим разборщиком.
+// Заполняется один раз при первом обращении, дальше только читается -
+// пользоваться можно из любого потока
+class ProbeRegistry {
+public:
+    static constexpr qint64 kSniffBytes = 4096;
+
+    static ProbeRegistry& instance();  // Со всеми встроенными разборщиками
+
+    void add(std::unique_ptr<FormatProbe> probe);
+
+    // Разборщик по первым байтам файла (nullptr - формат не распознан)
+    const FormatProbe* detect(MappedFile& file) const;
+    ProbeResult probe(const QString& path, bool withDuration = true) const;
+
+    QStringList nameFilters() const;                   // "*.mp3", "*.flac", ... для обхода папок
+    bool isSupportedFile(const QString& path) const;   // По расширению - для быстрых проверок
+
+private:
+    std::vector<std::unique_ptr<FormatProbe>> probes_;  // В порядке проверки подписей
+};
@@ -0,0 +1,136 @@
+// FuzzyMatcher.cpp
+#include "FuzzyMatcher.h"
+#include <algorithm> // std::reverse, std::find_if, std::max
+
+FuzzyMatcher::FuzzyMatcher(const std::u16string& pattern, int maxErrors) {
+    // Образец длиннее машинного слова обрезаем - для поиска по тегам этого достаточно
+    std::u16string p = pattern.substr(0, MaxPatternLength);
+    length_ = p.size();
+
+    maxErrors_ = maxErrors < 0 ? defaultMaxErrors(length_) : maxErrors;
+    if (maxErrors_ >= static_cast<int>(length_)) {
+        maxErrors_ = length_ > 0 ? static_cast<int>(length_) - 1 : 0;
+    }
+
+    signature_ = signatureOf(p.data(), p.size());
+
+    forward_.build(p);
+    std::reverse(p.begin(), p.end());
+    backward_.build(p);
+}
+
+int FuzzyMatcher::defaultMaxErrors(size_t n) {
+    if (n <= 3) return 0;   // Короткие образцы - только точное совпадение
+    if (n <= 5) return 1;   // Одна опечатка
+    return 2;               // "beatels" -> "beatles" (перестановка = 2 правки)
+}
+
+uint64_t FuzzyMatcher::signatureOf(const char16_t* text, size_t n) {
+    uint64_t sig = 0;
+    for (size_t i = 0; i < n; ++i) {
+        sig |= signatureBit(text[i]);
+    }
+    return sig;
+}
+
+bool FuzzyMatcher::mayMatch(uint64_t textSignature) const {
+    // Каждая группа символов образца, которой нет в тексте, стоит минимум одну правку
+    return popcount(signature_ & ~textSignature) <= maxErrors_;
+}
+
+void FuzzyMatcher::PeqTable::build(const std::u16string& pattern) {
+    ascii.fill(0);
+    other.clear();
+
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        char16_t c = pattern[i];
+        uint64_t bit = uint64_t(1) << i;
+        if (c < 128) {
+            ascii[c] |= bit;
+            continue;
+        }
+        auto it = std::find_if(other.begin(), other.end(),
+                               [c](const auto& entry) { return entry.first == c; });
+        if (it != other.end()) {
+            it->second |= bit;
+        } else {
+            other.emplace_back(c, bit);
+        }
+    }
+}
+
+uint64_t FuzzyMatcher::PeqTable::lookup(char16_t c) const {
+    if (c < 128) return ascii[c];
+    for (const auto& entry : other) {
+        if (entry.first == c) return entry.second;
+    }
+    return 0;
+}
+
+template <typename TextAt>
+void FuzzyMatcher::scan(const PeqTable& peq, TextAt at, size_t n, int stopAt,
+                        int& bestScore, int& bestPos) const {
+    const uint64_t high = uint64_t(1) << (length_ - 1);
+
+    uint64_t pv = ~uint64_t(0);  // Вертикальные положительные приращения
+    uint64_t mv = 0;             // Вертикальные отрицательные приращения
+    int score = static_cast<int>(length_);
+
+    bestScore = score;
+    bestPos = -1;
+
+    for (size_t j = 0; j < n; ++j) {
+        uint64_t eq = peq.lookup(at(j));
+        uint64_t xv = eq | mv;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+
+        if (ph & high) {
+            ++score;
+        } else if (mh & high) {
+            --score;
+        }
+
+        // Поиск подстроки: верхняя строка матрицы нулевая, поэтому без "| 1"
+        ph <<= 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        if (score < bestScore) {
+            bestScore = score;
+            bestPos = static_cast<int>(j);
+        } else if (score == bestScore && bestPos >= 0 && bestPos == static_cast<int>(j) - 1) {
+            bestPos = static_cast<int>(j);  // Растягиваем вхождение, пока ошибка не растёт
+        }
+        if (stopAt >= 0 && score <= stopAt) {
+            bestScore = score;
+            bestPos = static_cast<int>(j);
+            return;
+        }
+    }
+}
+
+FuzzyMatch FuzzyMatcher::find(const char16_t* text, size_t n) const {
+    FuzzyMatch match;
+    if (length_ == 0 || n == 0) return match;
+
+    // 1. Прямой проход: минимальная ошибка и позиция конца вхождения
+    int bestScore = 0;
+    int endPos = -1;
+    scan(forward_, [text](size_t j) { return text[j]; }, n, -1, bestScore, endPos);
+
+    if (endPos < 0 || bestScore > maxErrors_) return match;
+
+    // 2. Обратный проход от конца вхождения перевёрнутым образцом - находим начало
+    int startScore = 0;
+    int back = -1;
+    scan(backward_, [text, endPos](size_t j) { return text[endPos - j]; },
+         static_cast<size_t>(endPos) + 1, bestScore, startScore, back);
+
+    match.errors = bestScore;
+    match.end = endPos + 1;
+    match.start = back >= 0 ? endPos - back : std::max(0, match.end - static_cast<int>(length_));
+    return match;
+}
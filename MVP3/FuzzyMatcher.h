@@ -0,0 +1,76 @@
+// FuzzyMatcher.h
+#pragma once
+#include <array>    // Таблица масок для ASCII символов
+#include <cstdint>  // Целые типы фиксированного размера
+#include <string>   // std::u16string - свёрнутый текст
+#include <utility>  // std::pair
+#include <vector>   // Маски для не-ASCII символов
+
+// Найденное нечёткое вхождение образца: [start, end) в тексте и число ошибок
+struct FuzzyMatch {
+    int start = -1;   // Начало вхождения (-1 - не найдено)
+    int end = -1;     // Конец вхождения (не включительно)
+    int errors = 0;   // Расстояние редактирования (Левенштейн)
+
+    bool found() const { return start >= 0; }
+};
+
+// Нечёткий поиск подстроки с опечатками (bit-parallel алгоритм Майерса).
+// Образец до 64 символов обрабатывается одним 64-битным словом на символ текста.
+// Текст и образец должны быть заранее свёрнуты (см. SearchIndex::fold)
+class FuzzyMatcher {
+public:
+    static constexpr size_t MaxPatternLength = 64;
+
+    // maxErrors < 0 - допустимое число ошибок выбирается по длине образца
+    explicit FuzzyMatcher(const std::u16string& pattern, int maxErrors = -1);
+
+    size_t length() const { return length_; }
+    int maxErrors() const { return maxErrors_; }
+
+    // Битовый набор символов образца (для быстрого отсева кандидатов)
+    uint64_t signature() const { return signature_; }
+
+    // Можно ли вообще найти образец в тексте с такой сигнатурой (не более maxErrors ошибок)
+    bool mayMatch(uint64_t textSignature) const;
+
+    // Лучшее вхождение образца в текст (минимум ошибок, при равенстве - самое левое)
+    FuzzyMatch find(const char16_t* text, size_t n) const;
+
+    // Сигнатура текста: по биту на группу символов
+    static uint64_t signatureOf(const char16_t* text, size_t n);
+    static uint64_t signatureBit(char16_t c) { return uint64_t(1) << ((c ^ (c >> 6)) & 63); }
+
+    // Допустимое число ошибок для образца длины n
+    static int defaultMaxErrors(size_t n);
+
+    // Число единичных битов (без ветвлений - цикл по кандидатам векторизуется компилятором)
+    static int popcount(uint64_t x) {
+        x = x - ((x >> 1) & 0x5555555555555555ULL);
+        x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+        x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return static_cast<int>((x * 0x0101010101010101ULL) >> 56);
+    }
+
+private:
+    // Таблица Peq: для каждого символа - маска позиций в образце
+    struct PeqTable {
+        std::array<uint64_t, 128> ascii{};                  // Быстрый путь для ASCII
+        std::vector<std::pair<char16_t, uint64_t>> other;   // Остальные символы (их мало)
+
+        void build(const std::u16string& pattern);
+        uint64_t lookup(char16_t c) const;
+    };
+
+    // Один проход Майерса: возвращает минимальную ошибку и позицию её конца.
+    // При stopAt >= 0 останавливается на первой позиции с ошибкой <= stopAt
+    template <typename TextAt>
+    void scan(const PeqTable& peq, TextAt at, size_t n, int stopAt,
+              int& bestScore, int& bestPos) const;
+
+    size_t length_ = 0;
+    int maxErrors_ = 0;
+    uint64_t signature_ = 0;
+    PeqTable forward_;   // Маски образца
+    PeqTable backward_;  // Маски перевёрнутого образца (для поиска начала вхождения)
+};
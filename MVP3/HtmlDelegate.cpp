@@ -1,25 +1,64 @@
-
 // HtmlDelegate.cpp
 #include "HtmlDelegate.h"
 #include <QPainter>
 #include <QTextDocument>
 #include <QApplication>
 #include <QAbstractTextDocumentLayout>
+#include <QPoint>
+#include <algorithm>
 
 HtmlDelegate::HtmlDelegate(QObject* parent)
     : QStyledItemDelegate(parent) {
 }
 
+QString HtmlDelegate::highlightRanges(const QString& text, const QVariantList& ranges) {
+    // Сортируем участки по началу, чтобы собрать HTML за один проход
+    QList<QPoint> sorted;
+    for (const QVariant& range : ranges) {
+        sorted.append(range.toPoint());
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const QPoint& a, const QPoint& b) { return a.x() < b.x(); });
+
+    QString result;
+    int pos = 0;
+    for (const QPoint& range : sorted) {
+        int start = qBound(0, range.x(), int(text.size()));
+        int end = qBound(start, range.x() + range.y(), int(text.size()));
+        if (end <= pos) continue;      // Участок уже подсвечен
+        start = qMax(start, pos);      // Пересекающиеся участки склеиваем
+
+        result += text.mid(pos, start - pos).toHtmlEscaped();
+        result += QString("<span style='background-color:#5ac3ff;color:black;font-weight:bold;'>%1</span>")
+                      .arg(text.mid(start, end - start).toHtmlEscaped());
+        pos = end;
+    }
+    result += text.mid(pos).toHtmlEscaped();
+    return result;
+}
+
+QString HtmlDelegate::htmlFor(const QModelIndex& index) const {
+    QString text = index.data(Qt::DisplayRole).toString();
+
+    // Подсветка по найденным участкам (нечёткий поиск)
+    QVariant ranges = index.data(HighlightRangesRole);
+    if (ranges.isValid() && !ranges.toList().isEmpty()) {
+        return highlightRanges(text, ranges.toList());
+    }
+
+    // Проверяем, содержит ли элемент HTML
+    bool isHtml = text.contains("<") && text.contains(">");
+    return isHtml ? text : QString();
+}
+
 void HtmlDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option,
                          const QModelIndex& index) const {
     QStyleOptionViewItem options = option;
     initStyleOption(&options, index);
 
-    // Проверяем, содержит ли элемент HTML
-    QString text = index.data(Qt::DisplayRole).toString();
-    bool isHtml = text.contains("<") && text.contains(">");
+    QString html = htmlFor(index);
 
-    if (!isHtml) {
+    if (html.isEmpty()) {
         // Обычный текст - используем стандартный делегат
         QStyledItemDelegate::paint(painter, option, index);
         return;
@@ -28,7 +67,7 @@ void HtmlDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option,
     painter->save();
 
     QTextDocument doc;
-    doc.setHtml(text);
+    doc.setHtml(html);
     doc.setDefaultFont(options.font);
     doc.setTextWidth(options.rect.width());
 
@@ -48,15 +87,14 @@ void HtmlDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option,
 
 QSize HtmlDelegate::sizeHint(const QStyleOptionViewItem& option,
                              const QModelIndex& index) const {
-    QString text = index.data(Qt::DisplayRole).toString();
-    bool isHtml = text.contains("<") && text.contains(">");
+    QString html = htmlFor(index);
 
-    if (!isHtml) {
+    if (html.isEmpty()) {
         return QStyledItemDelegate::sizeHint(option, index);
     }
 
     QTextDocument doc;
-    doc.setHtml(text);
+    doc.setHtml(html);
     doc.setDefaultFont(option.font);
     doc.setTextWidth(option.rect.width());
 
@@ -1,15 +1,26 @@
 // HtmlDelegate.h
 #pragma once
 #include <QStyledItemDelegate>
+#include <QVariant>
 
 class HtmlDelegate : public QStyledItemDelegate {
     Q_OBJECT
 public:
+    // Роль с участками для подсветки: QVariantList из QPoint(начало, длина) в тексте элемента
+    static constexpr int HighlightRangesRole = Qt::UserRole + 1;
+
     explicit HtmlDelegate(QObject* parent = nullptr);
 
+    // Собирает HTML из обычного текста, подсвечивая указанные участки
+    static QString highlightRanges(const QString& text, const QVariantList& ranges);
+
 protected:
     void paint(QPainter* painter, const QStyleOptionViewItem& option,
                const QModelIndex& index) const override;
     QSize sizeHint(const QStyleOptionViewItem& option,
                    const QModelIndex& index) const override;
+
+private:
+    // HTML для отрисовки элемента (пустая строка - обычный текст)
+    QString htmlFor(const QModelIndex& index) const;
 };
@@ -0,0 +1,306 @@
+// Id3Reader.cpp
+#include "Id3Reader.h"
+#include <cstring> // std::memcmp, std::memchr
+
+namespace {
+const qint64 kId3v1Size = 128;
+const uint32_t kMaxInflatedSize = 32 * 1024 * 1024;  // Защита от подделанного размера сжатого кадра
+
+// Целое из 4 байт по 7 бит (syncsafe); false - если старший бит где-то установлен
+bool readSyncsafe(const unsigned char* p, uint32_t& value) {
+    if ((p[0] | p[1] | p[2] | p[3]) & 0x80) return false;
+    value = (uint32_t(p[0]) << 21) | (uint32_t(p[1]) << 14) | (uint32_t(p[2]) << 7) | uint32_t(p[3]);
+    return true;
+}
+
+uint32_t readBigEndian(const unsigned char* p, int bytes) {
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; ++i) value = (value << 8) | p[i];
+    return value;
+}
+
+// Снятие unsynchronisation: после каждого 0xFF вставленный 0x00 удаляется
+QByteArray removeUnsync(ByteView data) {
+    QByteArray out;
+    out.reserve(static_cast<qsizetype>(data.size));
+    for (size_t i = 0; i < data.size; ++i) {
+        out.append(static_cast<char>(data.data[i]));
+        if (data.data[i] == 0xFF && i + 1 < data.size && data.data[i + 1] == 0x00) ++i;
+    }
+    return out;
+}
+
+ByteView viewOf(const QByteArray& bytes) {
+    return {reinterpret_cast<const unsigned char*>(bytes.constData()), static_cast<size_t>(bytes.size())};
+}
+
+// Распаковка zlib: qUncompress ждет перед потоком 4 байта ожидаемого размера
+bool inflate(ByteView zlib, uint32_t expectedSize, QByteArray& out) {
+    if (zlib.empty() || expectedSize > kMaxInflatedSize) return false;
+    QByteArray buffer;
+    buffer.reserve(static_cast<qsizetype>(zlib.size + 4));
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        buffer.append(static_cast<char>((expectedSize >> shift) & 0xFF));
+    }
+    buffer.append(reinterpret_cast<const char*>(zlib.data), static_cast<qsizetype>(zlib.size));
+    out = qUncompress(buffer);
+    return !out.isEmpty();
+}
+
+// Строка ID3v1 фиксированной длины: до первого нуля, без хвостовых пробелов
+QString v1Field(const unsigned char* p, size_t length) {
+    const void* nul = std::memchr(p, 0, length);
+    size_t n = nul ? static_cast<size_t>(static_cast<const unsigned char*>(nul) - p) : length;
+    return QString::fromLatin1(reinterpret_cast<const char*>(p), static_cast<qsizetype>(n)).trimmed();
+}
+
+// Длина строки до терминатора в кодировке ID3 (для UTF-16 - два нуля на четной позиции)
+size_t terminatedLength(unsigned char encoding, ByteView text, size_t& terminator) {
+    const bool wide = encoding == 1 || encoding == 2;
+    terminator = wide ? 2 : 1;
+    for (size_t i = 0; i + terminator <= text.size; i += terminator) {
+        if (text.data[i] == 0 && (!wide || text.data[i + 1] == 0)) return i;
+    }
+    terminator = 0;  // Терминатора нет - строка до конца данных
+    return text.size;
+}
+}
+
+Id3Reader::Id3Reader(const QString& path) : file_(path) {
+    parseHeader();
+
+    ByteView tail = file_.tail(kId3v1Size);
+    if (tail.size == kId3v1Size && std::memcmp(tail.data, "TAG", 3) == 0) {
+        hasV1_ = true;
+        v1_.title = v1Field(tail.data + 3, 30);
+        v1_.artist = v1Field(tail.data + 33, 30);
+        v1_.album = v1Field(tail.data + 63, 30);
+    }
+}
+
+void Id3Reader::parseHeader() {
+    ByteView header = file_.head(10);
+    if (header.size < 10 || std::memcmp(header.data, "ID3", 3) != 0) return;
+
+    const int version = header.data[3];
+    const unsigned char flags = header.data[5];
+    uint32_t tagSize = 0;
+    if (version < 2 || version > 4 || !readSyncsafe(header.data + 6, tagSize)) return;
+    version_ = version;
+
+    // Обрезанный файл: тег заканчивается вместе с файлом
+    ByteView tag = file_.head(10 + qint64(tagSize)).mid(10, tagSize);
+    if (version_ == 2 && (flags & 0x40)) return;  // Сжатие всего тега в 2.2 не было стандартизовано
+
+    tagUnsync_ = flags & 0x80;
+    if (tagUnsync_ && version_ < 4) {
+        // До 2.4 unsynchronisation применяется ко всему тегу сразу
+        tagStorage_ = removeUnsync(tag);
+        tag = viewOf(tagStorage_);
+    }
+
+    size_t skip = 0;
+    if (version_ >= 3 && (flags & 0x40) && tag.size >= 4) {
+        uint32_t extended = 0;
+        if (version_ == 3) {
+            extended = 4 + readBigEndian(tag.data, 4);  // Размер без самого поля
+        } else if (!readSyncsafe(tag.data, extended)) {
+            return;
+        }
+        skip = extended;
+    }
+    frames_ = tag.mid(skip, tag.size);
+}
+
+template <typename Fn>
+void Id3Reader::forEachFrame(Fn&& fn) const {
+    const size_t headerSize = version_ == 2 ? 6 : 10;
+    const int idLength = version_ == 2 ? 3 : 4;
+
+    size_t pos = 0;
+    while (pos + headerSize <= frames_.size) {
+        const unsigned char* p = frames_.data + pos;
+        if (p[0] == 0) break;  // Началось заполнение нулями
+
+        uint32_t size = 0;
+        unsigned char formatFlags = 0;
+        if (version_ == 2) {
+            size = readBigEndian(p + 3, 3);
+        } else if (version_ == 3) {
+            size = readBigEndian(p + 4, 4);
+            formatFlags = p[9];
+        } else {
+            if (!readSyncsafe(p + 4, size)) break;
+            formatFlags = p[9];
+        }
+
+        ByteView raw = frames_.mid(pos + headerSize, size);
+        if (raw.size < size) break;  // Кадр обрезан вместе с файлом
+        pos += headerSize + size;
+
+        Frame frame;
+        frame.id = QByteArray(reinterpret_cast<const char*>(p), idLength);
+        if (!decodeFrame(raw, formatFlags, frame)) continue;
+        if (!fn(frame)) break;
+    }
+}
+
+// Снятие флагов формата кадра: группировка, длина данных, unsync, сжатие.
+// Без флагов данные остаются в отображении файла
+bool Id3Reader::decodeFrame(ByteView raw, unsigned char flags, Frame& frame) const {
+    if (version_ == 2) {
+        frame.data = raw;
+        return true;
+    }
+
+    if (version_ == 3) {
+        const bool compressed = flags & 0x80;
+        if (flags & 0x40) return false;  // Шифрование не поддерживаем
+        // Дополнительные поля идут в порядке флагов: размер до сжатия, группа
+        const size_t extra = (compressed ? 4 : 0) + ((flags & 0x20) ? 1 : 0);
+        if (raw.size < extra) return false;
+        ByteView payload = raw.mid(extra, raw.size);
+        if (!compressed) {
+            frame.data = payload;
+            return true;
+        }
+        if (!inflate(payload, readBigEndian(raw.data, 4), frame.storage)) return false;
+        frame.data = viewOf(frame.storage);
+        return true;
+    }
+
+    // ID3v2.4
+    if (flags & 0x04) return false;  // Шифрование
+    size_t skip = (flags & 0x40) ? 1 : 0;  // Байт группы
+    uint32_t dataLength = 0;
+    if (flags & 0x01) {
+        if (raw.size < skip + 4 || !readSyncsafe(raw.data + skip, dataLength)) return false;
+        skip += 4;
+    }
+    if (raw.size < skip) return false;
+    ByteView payload = raw.mid(skip, raw.size);
+
+    // Unsynchronisation снимается до распаковки - она применялась последней
+    const bool unsync = (flags & 0x02) || tagUnsync_;
+    QByteArray unsynced;
+    if (unsync) {
+        unsynced = removeUnsync(payload);
+        payload = viewOf(unsynced);
+    }
+    if (flags & 0x08) {
+        if (!inflate(payload, dataLength, frame.storage)) return false;
+    } else if (unsync) {
+        frame.storage = unsynced;
+    } else {
+        frame.data = payload;
+        return true;
+    }
+    frame.data = viewOf(frame.storage);
+    return true;
+}
+
+QString Id3Reader::decodeText(unsigned char encoding, ByteView text) {
+    size_t terminator = 0;
+    const size_t length = terminatedLength(encoding, text, terminator);
+    const char* chars = reinterpret_cast<const char*>(text.data);
+
+    switch (encoding) {
+    case 0:
+        return QString::fromLatin1(chars, static_cast<qsizetype>(length)).trimmed();
+    case 3:
+        return QString::fromUtf8(chars, static_cast<qsizetype>(length)).trimmed();
+    case 1:
+    case 2: {
+        // UTF-16: с BOM (1) или big-endian без BOM (2); данные не выровнены - собираем вручную
+        bool bigEndian = encoding == 2;
+        size_t i = 0;
+        if (encoding == 1 && length >= 2) {
+            if (text.data[0] == 0xFE && text.data[1] == 0xFF) { bigEndian = true; i = 2; }
+            else if (text.data[0] == 0xFF && text.data[1] == 0xFE) { i = 2; }
+        }
+        QString result;
+        result.reserve(static_cast<qsizetype>(length / 2));
+        for (; i + 1 < length; i += 2) {
+            const char16_t c = bigEndian ? char16_t((text.data[i] << 8) | text.data[i + 1])
+                                         : char16_t(text.data[i] | (text.data[i + 1] << 8));
+            result.append(QChar(c));
+        }
+        return result.trimmed();
+    }
+    default:
+        return QString();
+    }
+}
+
+Id3Reader::Tags Id3Reader::tags() const {
+    Tags result;
+    forEachFrame([&result](const Frame& frame) {
+        if (frame.data.empty()) return true;
+        QString* field = nullptr;
+        if (frame.id == "TIT2" || frame.id == "TT2") field = &result.title;
+        else if (frame.id == "TPE1" || frame.id == "TP1") field = &result.artist;
+        else if (frame.id == "TALB" || frame.id == "TAL") field = &result.album;
+        if (field && field->isEmpty()) {
+            *field = decodeText(frame.data.data[0], frame.data.mid(1, frame.data.size));
+        }
+        return true;
+    });
+
+    // Чего нет в ID3v2 - берем из ID3v1
+    if (result.title.isEmpty()) result.title = v1_.title;
+    if (result.artist.isEmpty()) result.artist = v1_.artist;
+    if (result.album.isEmpty()) result.album = v1_.album;
+    return result;
+}
+
+Id3Reader::Picture Id3Reader::picture() const {
+    Picture best;
+    forEachFrame([&best](const Frame& frame) {
+        const bool pic = frame.id == "PIC";  // ID3v2.2: формат картинки - 3 символа вместо MIME
+        if (frame.id != "APIC" && !pic) return true;
+
+        ByteView data = frame.data;
+        if (data.size < 4) return true;
+        const unsigned char encoding = data.data[0];
+        size_t pos = 1;
+        if (pic) {
+            pos += 3;
+        } else {
+            const void* nul = std::memchr(data.data + pos, 0, data.size - pos);
+            if (!nul) return true;
+            pos = static_cast<size_t>(static_cast<const unsigned char*>(nul) - data.data) + 1;
+        }
+        if (pos >= data.size) return true;
+        const unsigned char pictureType = data.data[pos++];
+
+        size_t terminator = 0;
+        pos += terminatedLength(encoding, data.mid(pos, data.size), terminator);
+        if (terminator == 0) return true;  // Описание без конца - кадр поврежден
+        pos += terminator;
+
+        ByteView image = data.mid(pos, data.size);
+        if (image.empty()) return true;
+        if (best.isNull() || pictureType == 3) {
+            best.type = pictureType;
+            best.storage = frame.storage;
+            best.bytes = image;
+            if (!frame.storage.isEmpty()) {
+                // Данные в буфере кадра - указываем в копию, которая переживет кадр
+                const size_t offset = static_cast<size_t>(image.data - frame.data.data);
+                best.bytes = viewOf(best.storage).mid(offset, image.size);
+            }
+        }
+        return pictureType != 3;  // Передняя обложка найдена - дальше не ищем
+    });
+    return best;
+}
+
+QImage Id3Reader::cover() const {
+    Picture picture = this->picture();
+    QImage image;
+    if (!picture.isNull()) {
+        // Декодер читает байты прямо из отображения файла (или из буфера распакованного кадра)
+        image.loadFromData(picture.bytes.data, static_cast<int>(picture.bytes.size));
+    }
+    return image;
+}
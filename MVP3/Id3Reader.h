@@ -0,0 +1,65 @@
+// Id3Reader.h
+#pragma once
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+
+#include "MappedFile.h"
+
+// Чтение тегов ID3v2 (2.2-2.4) и ID3v1 и обложки (APIC/PIC) без QMediaPlayer.
+// Отображает в память только тег в начале файла и 128 байт в конце;
+// кадры разбираются на месте, байты картинки передаются декодеру прямо из
+// отображения. Копия делается лишь там, где без нее нельзя: снятие
+// unsynchronisation и распаковка сжатых кадров. Все смещения проверяются
+// по границам - обрезанный файл дает пустой результат, а не чтение за концом
+class Id3Reader {
+public:
+    struct Tags {
+        QString title;
+        QString artist;
+        QString album;
+        bool isEmpty() const { return title.isEmpty() && artist.isEmpty() && album.isEmpty(); }
+    };
+
+    explicit Id3Reader(const QString& path);
+
+    bool hasTag() const { return version_ != 0 || hasV1_; }
+
+    // Текстовые поля: ID3v2, недостающие - из ID3v1
+    Tags tags() const;
+
+    // Сырые байты картинки (без декодирования): на месте в отображении файла
+    // или в буфере после снятия unsync/распаковки
+    struct Picture {
+        ByteView bytes;
+        unsigned char type = 0;  // Тип по ID3: 3 - передняя обложка
+        QByteArray storage;
+        bool isNull() const { return bytes.empty(); }
+    };
+    // Передняя обложка (тип 3), иначе первая картинка тега; действительна, пока жив Id3Reader
+    Picture picture() const;
+
+    // Декодированная обложка; пустая - если ее нет
+    QImage cover() const;
+
+private:
+    // Кадр ID3v2: данные на месте или (после снятия unsync/распаковки) в буфере
+    struct Frame {
+        QByteArray id;
+        ByteView data;
+        QByteArray storage;  // Владеет данными, если пришлось их преобразовать
+    };
+
+    void parseHeader();
+    template <typename Fn> void forEachFrame(Fn&& fn) const; // fn(const Frame&) -> false - остановить
+    bool decodeFrame(ByteView raw, unsigned char flags, Frame& frame) const;
+    static QString decodeText(unsigned char encoding, ByteView text);
+
+    MappedFile file_;
+    int version_ = 0;        // Старшая версия ID3v2 (2, 3, 4); 0 - тега нет
+    ByteView frames_;        // Область кадров (без заголовков тега)
+    QByteArray tagStorage_;  // Весь тег после снятия unsynchronisation (ID3v2.3)
+    bool tagUnsync_ = false; // Флаг unsynchronisation всего тега
+    bool hasV1_ = false;
+    Tags v1_;
+};
@@ -0,0 +1,163 @@
+// LibraryAudit.cpp
+#include "LibraryAudit.h"
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <vector>
+
+#include "FormatProbe.h" // Не-MP3 контейнеры проверяются своим разборщиком
+#include "MappedFile.h"
+
+namespace {
+// Заголовок формата; при смене формата старый отчет просто игнорируется
+const char* const kHeader = "ALEXMUSIC-AUDIT 1";
+const int kBatchSize = 16;  // Файлов в одной задаче пула
+
+qint64 modifiedMs(const QFileInfo& info) {
+    return info.lastModified().toMSecsSinceEpoch();
+}
+}
+
+LibraryAudit::LibraryAudit(QString filePath, QObject* parent)
+    : QObject(parent), filePath_(std::move(filePath)) {}
+
+// Строка: размер|время|проблемы|кадры|длительность|CRC проверено|ошибок CRC|разрывов|путь
+void LibraryAudit::load() {
+    QFile file(filePath_);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return;
+
+    QTextStream in(&file);
+    if (in.readLine() != QLatin1String(kHeader)) return;
+
+    while (!in.atEnd()) {
+        const QString line = in.readLine();
+        const QStringList fields = line.split('|');
+        if (fields.size() < 9) continue;
+
+        Entry entry;
+        entry.size = fields[0].toLongLong();
+        entry.modified = fields[1].toLongLong();
+        entry.result.issues = fields[2].toUInt();
+        entry.result.frames = fields[3].toUInt();
+        entry.result.durationMs = fields[4].toLongLong();
+        entry.result.crcChecked = fields[5].toUInt();
+        entry.result.crcErrors = fields[6].toUInt();
+        entry.result.syncErrors = fields[7].toUInt();
+        entry.path = fields.mid(8).join('|');
+        entries_.insert(entry.path, entry);
+    }
+}
+
+void LibraryAudit::save() const {
+    QSaveFile file(filePath_);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) return;
+
+    QTextStream out(&file);
+    out << kHeader << '\n';
+    for (const Entry& entry : entries_) {
+        const Mp3Audit::Result& r = entry.result;
+        out << entry.size << '|' << entry.modified << '|' << r.issues << '|' << r.frames << '|'
+            << r.durationMs << '|' << r.crcChecked << '|' << r.crcErrors << '|' << r.syncErrors << '|'
+            << entry.path << '\n';
+    }
+    out.flush();
+    file.commit();
+}
+
+void LibraryAudit::start(const QStringList& paths) {
+    cancel();
+    token_ = CancellationToken();
+    done_ = 0;
+    total_ = paths.size();
+    emit progress(0, total_);
+    if (paths.isEmpty()) {
+        emit finished();
+        return;
+    }
+
+    // Пачки по kBatchSize: задач достаточно для всех ядер, а накладные расходы малы
+    for (int first = 0; first < paths.size(); first += kBatchSize) {
+        const QStringList batch = paths.mid(first, kBatchSize);
+        ++pendingBatches_;
+        TaskScheduler::instance().run(
+            TaskPriority::BulkScan, this,
+            [batch](const CancellationToken& token) {
+                std::vector<Entry> results;
+                results.reserve(batch.size());
+                for (const QString& path : batch) {
+                    if (token.isCancelled()) break;
+                    results.push_back(checkFile(path));
+                }
+                return results;
+            },
+            [this](std::vector<Entry> results) {
+                for (Entry& entry : results) {
+                    entries_.insert(entry.path, entry);
+                }
+                done_ += static_cast<int>(results.size());
+                emit progress(done_, total_);
+                if (--pendingBatches_ == 0) {
+                    save();
+                    emit finished();
+                }
+            },
+            token_);
+    }
+}
+
+void LibraryAudit::cancel() {
+    if (!isRunning()) return;
+    token_.cancel();  // Результаты отмененных пачек не доставляются
+    pendingBatches_ = 0;
+    save();           // Уже проверенное сохраняем
+}
+
+bool LibraryAudit::isKnownBad(const QString& path) const {
+    auto it = entries_.constFind(path);
+    if (it == entries_.cend() || !it->result.isBroken()) return false;
+
+    QFileInfo info(path);
+    if (!info.exists()) return true;  // Файла нет - тем более не воспроизвести
+    return info.size() == it->size && modifiedMs(info) == it->modified;
+}
+
+LibraryAudit::Entry LibraryAudit::checkFile(const QString& path) {
+    Entry entry;
+    entry.path = path;
+
+    QFileInfo info(path);
+    entry.size = info.size();
+    entry.modified = modifiedMs(info);
+
+    MappedFile file(path);
+    const FormatProbe* probe = ProbeRegistry::instance().detect(file);
+    if (probe && probe->format() != AudioFormat::Mp3) {
+        // Для FLAC/Ogg/MP4/WAV глубокой проверки кадров нет: достаточно целого контейнера
+        ProbeResult probed = probe->probe(file, true);
+        entry.result.durationMs = probed.durationMs;
+        if (!probed.valid) entry.result.issues |= Mp3Audit::NoAudio;
+        return entry;
+    }
+
+    ByteView data = file.all();
+    entry.result = Mp3Audit::check(data.data, data.size);
+    return entry;
+}
+
+QString LibraryAudit::describe(const Mp3Audit::Result& result) {
+    QStringList problems;
+    if (result.issues & Mp3Audit::Unreadable) problems << "файл не читается";
+    if (result.issues & Mp3Audit::NoAudio) problems << "нет звуковых данных";
+    if (result.issues & Mp3Audit::BogusId3Size) problems << "неверный размер тега ID3";
+    if (result.issues & Mp3Audit::TruncatedTail) problems << "файл обрезан";
+    if (result.issues & Mp3Audit::SyncLost) {
+        problems << QString("разрывы потока: %1").arg(result.syncErrors);
+    }
+    if (result.issues & Mp3Audit::CrcMismatch) {
+        problems << QString("ошибки CRC: %1 из %2").arg(result.crcErrors).arg(result.crcChecked);
+    }
+    return problems.join(", ");
+}
@@ -0,0 +1,56 @@
+// LibraryAudit.h
+#pragma once
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include "Mp3Audit.h"
+#include "TaskScheduler.h" // Проверка идет в общем пуле потоков
+
+// Проверка целостности всей библиотеки. Файлы делятся на пачки, пачки
+// проверяются параллельно в пуле (Mp3Audit по отображению файла), результаты
+// собираются в GUI потоке и сохраняются в audit.txt. По ним навигация
+// пропускает заведомо битые треки без диалога; результат действителен,
+// пока у файла те же размер и время изменения
+class LibraryAudit : public QObject {
+    Q_OBJECT
+
+public:
+    struct Entry {
+        QString path;
+        Mp3Audit::Result result;
+        qint64 size = -1;
+        qint64 modified = 0;  // мс с эпохи
+    };
+
+    explicit LibraryAudit(QString filePath, QObject* parent = nullptr);
+
+    void load();
+    void save() const;
+
+    void start(const QStringList& paths);
+    void cancel();
+    bool isRunning() const { return pendingBatches_ > 0; }
+
+    // Трек проверен, с тех пор не менялся и воспроизвести его нельзя
+    bool isKnownBad(const QString& path) const;
+    const QHash<QString, Entry>& entries() const { return entries_; }
+
+    // Проверка одного файла (из любого потока)
+    static Entry checkFile(const QString& path);
+    // Описание проблем для отчета
+    static QString describe(const Mp3Audit::Result& result);
+
+signals:
+    void progress(int done, int total);
+    void finished();
+
+private:
+    QString filePath_;
+    QHash<QString, Entry> entries_;
+    CancellationToken token_;
+    int pendingBatches_ = 0;
+    int done_ = 0;
+    int total_ = 0;
+};
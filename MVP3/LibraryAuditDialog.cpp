@@ -0,0 +1,127 @@
+// LibraryAuditDialog.cpp
+#include "LibraryAuditDialog.h"
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QTime>
+#include <QVBoxLayout>
+
+namespace {
+// Ячейка с числовым ключом сортировки (длительность, серьезность)
+class SortableItem : public QTableWidgetItem {
+public:
+    SortableItem(const QString& text, qint64 key) : QTableWidgetItem(text) {
+        setData(Qt::UserRole, key);
+    }
+    bool operator<(const QTableWidgetItem& other) const override {
+        return data(Qt::UserRole).toLongLong() < other.data(Qt::UserRole).toLongLong();
+    }
+};
+}
+
+LibraryAuditDialog::LibraryAuditDialog(LibraryAudit* audit, QStringList paths, QWidget* parent)
+    : QDialog(parent), audit_(audit), paths_(std::move(paths)) {
+    setWindowTitle("Проверка библиотеки");
+    resize(720, 480);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    mainLayout->setContentsMargins(15, 15, 15, 15);
+    mainLayout->setSpacing(10);
+
+    summaryLabel = new QLabel;
+    summaryLabel->setWordWrap(true);
+    summaryLabel->setStyleSheet("QLabel { font-size: 12px; padding: 5px; }");
+    mainLayout->addWidget(summaryLabel);
+
+    progressBar = new QProgressBar;
+    progressBar->setRange(0, qMax(1, static_cast<int>(paths_.size())));
+    progressBar->setValue(0);
+    mainLayout->addWidget(progressBar);
+
+    // Отчет: сортируется щелчком по заголовку столбца
+    reportTable = new QTableWidget(0, 4);
+    reportTable->setHorizontalHeaderLabels({"Файл", "Состояние", "Проблемы", "Длительность"});
+    reportTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    reportTable->horizontalHeader()->setSectionResizeMode(2, QHeaderView::Stretch);
+    reportTable->verticalHeader()->setVisible(false);
+    reportTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    reportTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    reportTable->setSortingEnabled(true);
+    mainLayout->addWidget(reportTable);
+
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    buttonLayout->addStretch();
+
+    startButton = new QPushButton("Проверить");
+    startButton->setDefault(true);
+    startButton->setStyleSheet("QPushButton { padding: 8px 15px; font-weight: bold; }");
+    buttonLayout->addWidget(startButton);
+
+    closeButton = new QPushButton("Закрыть");
+    closeButton->setStyleSheet("QPushButton { padding: 8px 15px; }");
+    buttonLayout->addWidget(closeButton);
+
+    mainLayout->addLayout(buttonLayout);
+
+    connect(startButton, &QPushButton::clicked, this, &LibraryAuditDialog::startAudit);
+    connect(closeButton, &QPushButton::clicked, this, &QDialog::accept);
+    connect(audit_, &LibraryAudit::progress, this, &LibraryAuditDialog::onProgress);
+    connect(audit_, &LibraryAudit::finished, this, [this]() {
+        startButton->setEnabled(true);
+        fillReport();
+    });
+    // Закрытие окна не отменяет проверку - она допишет отчет в фоне
+
+    fillReport();  // Результаты прошлой проверки
+}
+
+void LibraryAuditDialog::startAudit() {
+    startButton->setEnabled(false);
+    audit_->start(paths_);
+}
+
+void LibraryAuditDialog::onProgress(int done, int total) {
+    progressBar->setRange(0, qMax(1, total));
+    progressBar->setValue(done);
+    summaryLabel->setText(QString("Проверено файлов: %1 из %2").arg(done).arg(total));
+}
+
+void LibraryAuditDialog::fillReport() {
+    reportTable->setSortingEnabled(false);  // Иначе строки пересортировываются при каждой вставке
+    reportTable->setRowCount(0);
+
+    int checked = 0, broken = 0, damaged = 0;
+    for (const QString& path : paths_) {
+        auto it = audit_->entries().constFind(path);
+        if (it == audit_->entries().cend()) continue;
+        const Mp3Audit::Result& result = it->result;
+        ++checked;
+
+        // Серьезность: 2 - не воспроизводится, 1 - есть повреждения, 0 - в порядке
+        int severity = result.isBroken() ? 2 : (result.isClean() ? 0 : 1);
+        if (severity == 0) continue;  // В отчете только проблемные файлы
+        severity == 2 ? ++broken : ++damaged;
+
+        const int row = reportTable->rowCount();
+        reportTable->insertRow(row);
+
+        QTableWidgetItem* fileItem = new QTableWidgetItem(QFileInfo(path).fileName());
+        fileItem->setToolTip(path);
+        reportTable->setItem(row, 0, fileItem);
+        reportTable->setItem(row, 1, new SortableItem(severity == 2 ? "Битый" : "Поврежден", severity));
+        reportTable->setItem(row, 2, new QTableWidgetItem(LibraryAudit::describe(result)));
+        const QString duration = QTime(0, 0).addMSecs(static_cast<int>(result.durationMs)).toString("mm:ss");
+        reportTable->setItem(row, 3, new SortableItem(duration, result.durationMs));
+    }
+
+    reportTable->setSortingEnabled(true);
+    reportTable->sortByColumn(1, Qt::DescendingOrder);  // Сначала битые
+
+    if (checked == 0) {
+        summaryLabel->setText(QString("Библиотека еще не проверялась (%1 файлов)").arg(paths_.size()));
+    } else {
+        summaryLabel->setText(QString("Проверено: %1 из %2. Битых: %3, с повреждениями: %4. "
+                                      "Битые треки пропускаются без диалога.")
+                                  .arg(checked).arg(paths_.size()).arg(broken).arg(damaged));
+    }
+}
@@ -0,0 +1,31 @@
+// LibraryAuditDialog.h
+#pragma once
+#include <QDialog>
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QStringList>
+#include <QTableWidget>
+
+#include "LibraryAudit.h"
+
+// Проверка библиотеки: прогресс и единый сортируемый отчет вместо
+// отдельного диалога на каждый битый файл
+class LibraryAuditDialog : public QDialog {
+    Q_OBJECT
+public:
+    LibraryAuditDialog(LibraryAudit* audit, QStringList paths, QWidget* parent = nullptr);
+
+private:
+    void startAudit();
+    void onProgress(int done, int total);
+    void fillReport();      // Таблица по результатам проверки текущих файлов
+
+    LibraryAudit* audit_;
+    QStringList paths_;
+    QLabel* summaryLabel;
+    QProgressBar* progressBar;
+    QTableWidget* reportTable;
+    QPushButton* startButton;
+    QPushButton* closeButton;
+};
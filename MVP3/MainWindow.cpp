@@ -17,10 +17,21 @@
 #include <QMessageBox>
 #include <QKeyEvent>
 #include <QMenuBar>
+#include <QActionGroup>   // Взаимоисключающие режимы в меню
+#include <QPoint>         // Участки подсветки в списке
+#include <QDateTime>      // Дата последнего прослушивания
+#include <QFile>          // Кэш списка библиотеки
+#include <QTextStream>
+#include <QStandardPaths> // Локальная папка кэша копий
+#include <algorithm>      // std::remove_if (скрытие копий)
 
 #include "HtmlDelegate.h"
 #include "TrackValidator.h"
 #include "BadTrackDialog.h"
+#include "LibraryAuditDialog.h"
+#include "DuplicatesDialog.h"
+#include "AudioFeatures.h"   // Названия тональностей, порядок Camelot
+#include "FormatProbe.h"     // Форматы по содержимому и теги для файлов без исполнителя в имени
 
 // Windows API headers (только для Windows)
 #ifdef Q_OS_WIN
@@ -30,9 +41,45 @@
 #endif
 
 // Конструктор главного окна
-MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
+MainWindow::MainWindow(QWidget* parent)
+    : QMainWindow(parent),
+      playHistory_((QCoreApplication::applicationDirPath() + "/history.log").toStdString()),
+      sessionStore_((QCoreApplication::applicationDirPath() + "/session.txt").toStdString()),
+      seekIndexStore_(QCoreApplication::applicationDirPath() + "/seekindex.txt"),
+      // Кэш копий - в локальной папке пользователя: рядом с exe может быть тот же сетевой диск
+      stagingCache_(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/staging",
+                    kDefaultStagingMb * 1024 * 1024),
+      waveformStore_(QCoreApplication::applicationDirPath() + "/peaks") {
     setWindowTitle("AlexMusic");  // Установка заголовока окна
 
+    // Результаты проверки библиотеки (загружаются после первого кадра)
+    libraryAudit_ = new LibraryAudit(QCoreApplication::applicationDirPath() + "/audit.txt", this);
+
+    // Идентификаторы по содержимому нужны уже при заполнении плейлиста (рейтинги)
+    trackIds_ = new TrackIdStore(QCoreApplication::applicationDirPath() + "/trackids.txt", this);
+    trackIds_->load();
+    connect(trackIds_, &TrackIdStore::finished, this, [this](int changed) {
+        if (changed > 0) applyTrackIds();
+        // Признаки ищутся по идентификаторам - анализ после их подсчета
+        startFeatureAnalysis();
+    });
+    duplicateFinder_ = new DuplicateFinder(QCoreApplication::applicationDirPath() + "/fingerprints.txt",
+                                           trackIds_, this);
+
+    // Признаки звучания: темп, тональность, shuffle по звучанию (загружаются после первого кадра)
+    featureStore_ = new FeatureStore(QCoreApplication::applicationDirPath() + "/features.txt", trackIds_, this);
+    connect(featureStore_, &FeatureStore::progress, this, [this](int done, int total) {
+        if (similarMenu_) {
+            similarMenu_->setTitle(QString("Shuffle по звучанию (анализ: %1 из %2)").arg(done).arg(total));
+        }
+        if (done > 0 && done % kMusicInfoStep == 0) applyMusicInfo();  // Темп и тональность видны по ходу анализа
+    });
+    connect(featureStore_, &FeatureStore::finished, this, [this]() {
+        if (similarMenu_) similarMenu_->setTitle("Shuffle по звучанию");
+        applyMusicInfo();
+        rebuildSimilarity();
+    });
+
     // Попытка поиска и установки иконки несколькими способами
     // QIcon appIcon;
     // // Список возможных путей к иконке
@@ -85,11 +132,29 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
             this, &MainWindow::handleInvalidTrack);
 
 
+    // Планировщик перерисовки: не чаще одного раза за кадр
+    uiScheduler_ = new UiUpdateScheduler(this);
+    connect(uiScheduler_, &UiUpdateScheduler::flush, this, &MainWindow::flushUi);
+
     // Инициализация медиаплеера и аудиовыхода
-    player = new QMediaPlayer(this);
-    audioOutput = new QAudioOutput(this);
-    player->setAudioOutput(audioOutput);  // Связь плеера с выводом
-    audioOutput->setVolume(volumeBeforeMute_ / 100.0);  // Установка начальной громкости
+    // (без родителя - контроллер живет в своем потоке и удаляется в деструкторе)
+    player = new PlaybackController();
+    player->setStagingCache(&stagingCache_);  // Контроллер удаляется раньше кэша (в деструкторе)
+    // Незапущенные копирования и сканирования не должны задерживать выход:
+    // пул при остановке ждет задачи, которые уже выполняются
+    connect(qApp, &QCoreApplication::aboutToQuit, this, [this]() {
+        stagingCache_.cancel();
+        waveformToken_.cancel();  // Полное декодирование трека выход не ждет
+        trackIds_->cancel();
+        duplicateFinder_->cancel();
+        featureStore_->cancel();  // Посчитанное сохраняется, остальное - при следующем запуске
+        libraryAudit_->cancel();
+        scanToken_.cancel();      // Обход папки на сетевом диске может идти минутами
+        coverScanToken_.cancel();
+        tagScanToken_.cancel();
+        searchIndexToken_.cancel();
+    });
+    player->setVolume(volumeBeforeMute_ / 100.0);  // Установка начальной громкости
 
     // Создание центрального виджета (основная область окна)
     QWidget* centralWidget = new QWidget(this);
@@ -131,6 +196,18 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
         );
     topBar->addWidget(searchEdit);
 
+    // Переключатель нечёткого поиска (находит треки с опечатками в запросе)
+    fuzzySearchBtn = new QPushButton("≈");
+    fuzzySearchBtn->setCheckable(true);
+    fuzzySearchBtn->setFixedSize(35, 35);
+    fuzzySearchBtn->setToolTip("Нечёткий поиск: учитывает опечатки в исполнителе, названии и альбоме");
+    fuzzySearchBtn->setStyleSheet(
+        "QPushButton { background: #333; border: 1px solid #444; border-radius: 8px; color: #fff; font-size: 16px; }"
+        "QPushButton:hover { background: #444; }"
+        "QPushButton:checked { background: #0078d4; border: 1px solid #0078d4; }"  // Синий когда включён
+        );
+    topBar->addWidget(fuzzySearchBtn);
+
     // Кнопки сортировки
     sortAlphabeticalBtn = new QPushButton("А-Я");
     sortAlphabeticalBtn->setFixedSize(50, 35);
@@ -144,13 +221,18 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
     sortReverseBtn->setFixedSize(50, 35);
     sortReverseBtn->setToolTip("Обратный порядок");
 
+    sortMusicBtn = new QPushButton("♩");
+    sortMusicBtn->setFixedSize(50, 35);
+    sortMusicBtn->setToolTip("Сортировка по темпу");
+
     // Добавляем кнопки сортировки в верхнюю панель
     topBar->addWidget(sortAlphabeticalBtn);
     topBar->addWidget(sortStandardBtn);
     topBar->addWidget(sortReverseBtn);
+    topBar->addWidget(sortMusicBtn);
 
-    // // Инициализируем диалог (в конструкторе после setupShortcuts):
-    settingsDialog = new SettingsDialog(this);
+    // Диалог настроек создается отложенно - после первого кадра или при первом открытии
+    settingsDialog = nullptr;
 
     // Добавляем верхнюю панель в основную компоновку
     mainLayout->addLayout(topBar);
@@ -225,6 +307,11 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
     leftLayout->addWidget(artistLabel);
     leftLayout->addWidget(ratingWidget);
 
+    // Визуализатор спектра и уровней (PCM из потока воспроизведения)
+    spectrumWidget_ = new SpectrumWidget(player->audioTap());
+    spectrumWidget_->setFixedHeight(90);
+    leftLayout->addWidget(spectrumWidget_);
+
     // Добавляем левую панель в основную компоновку контента
     contentLayout->addWidget(leftPanel);
 
@@ -301,21 +388,65 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
     connect(controls, &PlayerControls::muteToggled, this, &MainWindow::onMuteToggled);
 
     // Подключаем сигналы медиаплеера
-    connect(player, &QMediaPlayer::positionChanged, this, &MainWindow::onPositionChanged);
-    connect(player, &QMediaPlayer::durationChanged, this, &MainWindow::onDurationChanged);
-    connect(player, &QMediaPlayer::mediaStatusChanged, this, &MainWindow::onMediaStatusChanged);
+    // (сигналы приходят из потока плеера через очередь событий)
+    connect(player, &PlaybackController::positionChanged, this, &MainWindow::onPositionChanged);
+    connect(player, &PlaybackController::durationChanged, this, &MainWindow::onDurationChanged);
+    connect(player, &PlaybackController::mediaStatusChanged, this, &MainWindow::onMediaStatusChanged);
+    connect(player, &PlaybackController::sourceChanged, this, &MainWindow::onSourceChanged);
+    connect(player, &PlaybackController::trackFinished, this, &MainWindow::onTrackFinished);
+    connect(player, &PlaybackController::playbackStateChanged, this, [this](QMediaPlayer::PlaybackState state) {
+        spectrumWidget_->setPlaying(state == QMediaPlayer::PlayingState);
+    });
+
+    // Журнал прослушиваний: счетчики доступны сразу после загрузки
+    playHistory_.load();
 
     // Подключаем сигналы поиска и сортировки
     connect(searchEdit, &QLineEdit::textChanged, this, &MainWindow::onSearchTextChanged);
+    connect(fuzzySearchBtn, &QPushButton::toggled, this, [this](bool checked) {
+        fuzzySearch_ = checked;
+        saveSettings();
+        onSearchTextChanged(searchEdit->text());  // Перефильтровываем в новом режиме
+    });
     connect(sortAlphabeticalBtn, &QPushButton::clicked, this, &MainWindow::onSortAlphabeticalClicked);
     connect(sortStandardBtn, &QPushButton::clicked, this, &MainWindow::onSortStandardClicked);
     connect(sortReverseBtn, &QPushButton::clicked, this, &MainWindow::onSortReverseClicked);
+    connect(sortMusicBtn, &QPushButton::clicked, this, &MainWindow::onSortMusicClicked);
+
+    startupProfiler_.mark("Интерфейс");
 
-    // Автоматически сканируем папку Music если она существует
-    QString defaultFolder = "C:\\Users\\User\\Music";
-    if (QDir(defaultFolder).exists()) {
-        scanFolder(defaultFolder);
+    // Прошлая сессия: трек запускается сразу, еще до сканирования библиотеки
+    startupFolder_ = restoreSession("C:\\Users\\User\\Music");
+    startupProfiler_.mark("Сессия");
+
+    // loadLibrary берет режимы с кнопок: без этого очередь shuffle из снимка
+    // отбрасывалась бы при выключенном (еще не загруженном) shuffle
+    loadPlaybackModes();
+
+    // Список треков из кэша - окно показывается с библиотекой, а сканирование
+    // папки Music выполняется уже после первого кадра (runDeferredStartup)
+    QStringList cachedFiles;
+    if (loadLibraryCache(startupFolder_, cachedFiles)) {
+        loadLibrary(startupFolder_, cachedFiles);
+        libraryFromCache_ = true;
     }
+    startupProfiler_.mark("Кэш библиотеки");
+
+    // Периодическое сохранение сессии (на случай аварийного завершения)
+    sessionTimer_ = new QTimer(this);
+    sessionTimer_->setInterval(15000);
+    connect(sessionTimer_, &QTimer::timeout, this, &MainWindow::saveSession);
+    sessionTimer_->start();
+
+    // Автоповтор стрелок дает ~30 нажатий в секунду - плееру уходит только последняя цель
+    seekTimer_ = new QTimer(this);
+    seekTimer_->setSingleShot(true);
+    seekTimer_->setInterval(120);
+    connect(seekTimer_, &QTimer::timeout, this, [this]() {
+        if (seekTarget_ < 0) return;
+        player->setPosition(seekTarget_);
+        seekTarget_ = -1;
+    });
 
     // Инициализируем переменные для thumbnail toolbar
     thumbnailToolbarInitialized = false;
@@ -326,11 +457,59 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
     setupShortcuts();  // Настраиваем горячие клавиши
     loadSettings(); // Загружаем сохранённые настройки
     updateMenuBar();
+    startupProfiler_.mark("Меню и настройки");
+}
 
-    if (settingsDialog) {
-        settingsDialog->setAlwaysSkipBadTracks(alwaysSkipBadTracks_);
-        settingsDialog->setDefaultVolume(volumeBeforeMute_);
-    }
+// Отложенные этапы запуска - по одному за итерацию цикла событий, в порядке важности,
+// чтобы окно оставалось отзывчивым между ними
+void MainWindow::runDeferredStartup() {
+    startupProfiler_.markFirstFrame();
+
+    // 1. Обложка текущего трека (при запуске не загружалась, чтобы не задерживать первый кадр)
+    QTimer::singleShot(0, this, [this]() {
+        startupInProgress_ = false;
+        updateUI();
+        startupProfiler_.mark("Обложка");
+
+        seekIndexStore_.load();
+        libraryAudit_->load();
+        duplicateFinder_->load();
+        featureStore_->load();
+        applyMusicInfo();
+        if (similarMode_ != Playlist::SimilarMode::Off) rebuildSimilarity();
+        stagingCache_.load();
+        if (!currentSeekIndex_ && !player->source().isEmpty()) {
+            currentSeekIndex_ = seekIndexStore_.find(player->source().toLocalFile());
+        }
+
+        // 2. Диалог настроек - нужен только по запросу пользователя
+        QTimer::singleShot(0, this, [this]() {
+            ensureSettingsDialog();
+            startupProfiler_.mark("Диалог настроек");
+        });
+
+        // 3. Обход папки - в пуле потоков; список из кэша обновится, если состав изменился
+        const QString folder = startupFolder_;
+        scanToken_ = TaskScheduler::instance().run(
+            TaskPriority::BulkScan, this,
+            [folder](const CancellationToken&) { return collectTracks(folder); },
+            [this, folder](QStringList files) {
+                if (QDir(folder).exists()) {
+                    rescanLibrary(folder, files);
+                }
+                startupProfiler_.mark("Сканирование библиотеки");
+                startupProfiler_.report();
+            });
+    });
+}
+
+// Диалог настроек создается при первом обращении
+void MainWindow::ensureSettingsDialog() {
+    if (settingsDialog) return;
+    settingsDialog = new SettingsDialog(this);
+    settingsDialog->setAlwaysSkipBadTracks(alwaysSkipBadTracks_);
+    settingsDialog->setDefaultVolume(volumeBeforeMute_);
+    settingsDialog->setStagingCacheMb(stagingCacheMb_);
 }
 
 // Настройка горячих клавиш приложения
@@ -377,20 +556,14 @@ void MainWindow::setupShortcuts() {
     // 7. Перематывание назад - Left (на 5 секунд)
     QShortcut* seekBackShortcut = new QShortcut(QKeySequence(Qt::Key_Left), this);
     connect(seekBackShortcut, &QShortcut::activated, this, [this]() {
-        qint64 currentPosition = player->position();
-        qint64 newPosition = qMax(0LL, currentPosition - 5000); // 5 секунд назад
-        player->setPosition(newPosition);
-        controls->setPosition(newPosition, player->duration()); // Обновляем UI
+        // Отсчет от еще не отправленной цели - серия нажатий складывается
+        seekTo(qMax(0LL, seekBase() - 5000), true); // 5 секунд назад
     });
 
     // 8. Перематывание вперед - Right (на 5 секунд)
     QShortcut* seekForwardShortcut = new QShortcut(QKeySequence(Qt::Key_Right), this);
     connect(seekForwardShortcut, &QShortcut::activated, this, [this]() {
-        qint64 currentPosition = player->position();
-        qint64 duration = player->duration();
-        qint64 newPosition = qMin(duration, currentPosition + 5000); // 5 секунд вперед
-        player->setPosition(newPosition);
-        controls->setPosition(newPosition, duration);
+        seekTo(qMin(player->duration(), seekBase() + 5000), true); // 5 секунд вперед
     });
 
     // 9. Выключить звук - M (M(ute))
@@ -402,16 +575,18 @@ void MainWindow::setupShortcuts() {
     // 10. (Fn) Home - перемотка в начало трека
     QShortcut* seekStartShortcut = new QShortcut(QKeySequence(Qt::Key_Home), this);
     connect(seekStartShortcut, &QShortcut::activated, this, [this]() {
-        player->setPosition(0);  // В начало трека
-        controls->setPosition(0, player->duration());
+        seekTo(0, false);  // В начало трека
     });
 
     // 11. (Fn) End - перемотка в конец трека
     QShortcut* seekEndShortcut = new QShortcut(QKeySequence(Qt::Key_End), this);
     connect(seekEndShortcut, &QShortcut::activated, this, [this]() {
         qint64 duration = player->duration();
-        player->setPosition(duration - 1000); // За 1 секунду до конца
-        controls->setPosition(duration - 1000, duration);
+        if (currentSeekIndex_) {
+            // Оценка длительности VBR без оглавления бывает больше настоящей
+            duration = qMin(duration, currentSeekIndex_->durationMs());
+        }
+        seekTo(duration - 1000, false); // За 1 секунду до конца
     });
 
     // 12. Включение редима "Повтор трека"
@@ -479,9 +654,9 @@ void MainWindow::playSelectedTrack() {
                         player->setSource(QUrl::fromLocalFile(filePath));
                         player->play();
                         controls->setPlaying(true);
-                        updateThumbnailButtons();
-                        updateUI();
-                        highlightCurrentTrack();
+                        uiScheduler_->markDirty(UiUpdateScheduler::Thumbnail);
+                        uiScheduler_->markDirty(UiUpdateScheduler::NowPlaying);
+                        uiScheduler_->markDirty(UiUpdateScheduler::ListHighlight);
 
                         qDebug() << "Воспроизводится трек:" << QString::fromStdString(current->title());
                     }
@@ -492,8 +667,85 @@ void MainWindow::playSelectedTrack() {
     }
 }
 
-// Сканирование папки и добавление MP3 файлов в плейлист
+// Обход папки: все поддерживаемые аудиофайлы во вложенных папках
+QStringList MainWindow::collectTracks(const QString& path) {
+    QStringList files;
+    QDirIterator it(path, ProbeRegistry::instance().nameFilters(), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        files << it.next();
+    }
+    return files;
+}
+
+// Сканирование папки и добавление аудиофайлов в плейлист
 void MainWindow::scanFolder(const QString& path) {
+    scanToken_.cancel();  // Фоновое сканирование при запуске больше не актуально
+    QStringList files = collectTracks(path);
+    loadLibrary(path, files);
+    saveLibraryCache(path, files);
+}
+
+// Результат повторного сканирования папки, список которой уже загружен (из кэша):
+// плейлист перестраивается, только если состав файлов изменился
+void MainWindow::rescanLibrary(const QString& path, const QStringList& files) {
+    if (libraryFromCache_ && QDir(libraryRoot_) == QDir(path)) {
+        QStringList loaded;
+        loaded.reserve(static_cast<int>(playlist.size()));
+        for (const Track& track : playlist.all()) {
+            loaded << QString::fromStdString(track.path());
+        }
+        // Скрытые копии в плейлист не попадают - сравниваем без них
+        QStringList visible;
+        visible.reserve(files.size());
+        for (const QString& file : files) {
+            if (!hiddenTracks_.contains(file)) visible << file;
+        }
+        if (loaded == visible) {
+            libraryFromCache_ = false;
+            return;  // Кэш актуален
+        }
+
+        // Сохраняем текущую навигацию - она применится к новому списку
+        if (!sessionPending_) {
+            pendingSession_.libraryRoot = libraryRoot_.toStdString();
+            pendingSession_.playlist = playlist.session();
+            sessionPending_ = true;
+        }
+    }
+    libraryFromCache_ = false;
+    loadLibrary(path, files);
+    saveLibraryCache(path, files);
+}
+
+// Кэш списка файлов библиотеки (library.txt): первая строка - папка, далее пути
+bool MainWindow::loadLibraryCache(const QString& path, QStringList& files) const {
+    QFile file(QCoreApplication::applicationDirPath() + "/library.txt");
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return false;
+
+    QTextStream in(&file);
+    if (QDir(in.readLine()) != QDir(path)) return false;  // Кэш другой папки
+
+    files.clear();
+    while (!in.atEnd()) {
+        QString line = in.readLine();
+        if (!line.isEmpty()) files << line;
+    }
+    return !files.isEmpty();
+}
+
+void MainWindow::saveLibraryCache(const QString& path, const QStringList& files) const {
+    QFile file(QCoreApplication::applicationDirPath() + "/library.txt");
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) return;
+
+    QTextStream out(&file);
+    out << path << '\n';
+    for (const QString& filePath : files) {
+        out << filePath << '\n';
+    }
+}
+
+// Заполнение плейлиста и списка по готовому перечню файлов
+void MainWindow::loadLibrary(const QString& path, const QStringList& files) {
     // Сохраняем текущие состояния перед очисткой
     savedShuffleState_ = controls->isShuffleEnabled();
     savedRepeatMode_ = static_cast<Playlist::RepeatMode>(controls->getRepeatState());
@@ -501,30 +753,44 @@ void MainWindow::scanFolder(const QString& path) {
     playlist.clear();
     trackList->clear();
     originalTracks_.clear();
+    searchIndexDirty_ = true;
+    libraryRoot_ = path;
 
-    // Сканирование файлов...
-    QDirIterator it(path, {"*.mp3"}, QDir::Files, QDirIterator::Subdirectories);
     int index = 1;
+    QStringList untagged;  // Имя не в формате "Исполнитель - Название" - поля возьмем из тега, фоном
+
+    for (const QString& filePath : files) {
+        if (hiddenTracks_.contains(filePath)) continue;  // Скрытая копия другого трека
 
-    while (it.hasNext()) {
-        QString filePath = it.next();
         QFileInfo fileInfo(filePath);
         QString baseName = fileInfo.baseName();
         QStringList parts = baseName.split(" - ", Qt::SkipEmptyParts);
         QString artist = parts.value(0, "Unknown Artist");
         QString title = parts.value(1, baseName);
+        QString album = "Music for imaginary movies";
+
+        if (parts.size() < 2) untagged << filePath;
 
         Track track(filePath.toStdString(), artist.toStdString(),
-                    title.toStdString(), "Music for imaginary movies", 0.0);
+                    title.toStdString(), album.toStdString(), 0.0);
+        const QString contentId = trackIds_->id(filePath);
+        track.setContentId(contentId.toStdString());  // Пустой - еще не посчитан
+        const AudioFeatures features = featureStore_->features(contentId);  // Кэш признаков мог еще не загрузиться
+        if (features.isValid()) track.setMusicInfo(features.bpm(), features.key());
 
-        playlist.add(track);
         originalTracks_.push_back(track);
 
         QString displayText = QString("%1. %2 - %3").arg(index++).arg(artist).arg(title);
         trackList->addItem(displayText);
     }
 
+    playlist.assign(originalTracks_);  // Одна версия библиотеки вместо версии на каждый трек
     playlist.loadRatings();
+    rebuildSearchIndexAsync();
+    scanCovers();
+    readTagsAsync(untagged);
+    trackIds_->start(files);  // Отпечатки новых и измененных файлов - в фоне
+    if (similarMode_ != Playlist::SimilarMode::Off) rebuildSimilarity();  // Признаки уже посчитанных
 
     if (!playlist.all().empty()) {
         playlist.setCurrent(0);
@@ -537,11 +803,21 @@ void MainWindow::scanFolder(const QString& path) {
         controls->setRepeatState(static_cast<int>(savedRepeatMode_));
         controls->setShuffleState(savedShuffleState_);
 
-        updateUI();
+        // Навигация прошлой сессии (трек уже играет - восстановлен до сканирования)
+        if (sessionPending_) {
+            applyPendingSession();
+        }
+        // Без истории из снимка - переходы назад по журналу прослушиваний
+        playlist.seedBackHistory(playHistory_.recentStarts(Playlist::HistoryCapacity));
+        updateUpNext();
+
+        uiScheduler_->markDirty(UiUpdateScheduler::NowPlaying);
     }
 
     isAlphabeticalSort_ = false;
     isReverseSort_ = false;
+    isBpmSort_ = false;
+    isKeySort_ = false;
     updateSortButtonsStyle();
 
     loadSettings();
@@ -549,6 +825,11 @@ void MainWindow::scanFolder(const QString& path) {
 
 // Метод проверки трека (добавьте после других методов)
 bool MainWindow::validateTrack(const QString& filePath) {
+    // Проверка библиотеки уже признала файл битым - плеер не запускаем
+    if (libraryAudit_->isKnownBad(filePath)) {
+        return false;
+    }
+
     if (!trackValidator) {
         // Создаем валидатор если его нет
         trackValidator = new TrackValidator(this);
@@ -664,8 +945,10 @@ void MainWindow::handleInvalidTrack(const QString& filePath, const QString& erro
 // Обработчик изменения рейтинга
 void MainWindow::onRatingChanged(int rating) {
     // Устанавливаем рейтинг текущему треку и сохраняем в файл
-    playlist.setCurrentTrackRating(static_cast<double>(rating));
-    updateUI();  // Обновляем отображение звезд
+    if (playlist.setCurrentTrackRating(static_cast<double>(rating)) && !searchIndexDirty_) {
+        searchIndex_.setRating(playlist.currentIndex(), rating);  // Колонка рейтингов для rating>=N
+    }
+    uiScheduler_->markDirty(UiUpdateScheduler::Rating);  // Только звезды - обложка и текст не менялись
 }
 
 // Воспроизведение текущего трека
@@ -696,9 +979,9 @@ void MainWindow::playCurrentTrack() {
     player->setSource(QUrl::fromLocalFile(filePath));
     player->play();
     controls->setPlaying(true);
-    updateThumbnailButtons();
-    updateUI();
-    highlightCurrentTrack();
+    uiScheduler_->markDirty(UiUpdateScheduler::Thumbnail);
+    uiScheduler_->markDirty(UiUpdateScheduler::NowPlaying);
+    uiScheduler_->markDirty(UiUpdateScheduler::ListHighlight);
 }
 
 // Перезапуск текущего трека (с начала)
@@ -709,18 +992,29 @@ void MainWindow::restartCurrentTrack() {
 
 // Обновление пользовательского интерфейса
 void MainWindow::updateUI() {
+    updateCover();
+    updateTrackText();
+    updateRatingStars();
+    updateListSelection();
+}
+
+// Части панели "сейчас играет" пересчитываются, только если сменились их входные данные:
+// клик по звезде не трогает обложку, сортировка не перечитывает ее из файла
+
+// Обложка: перечитывается и масштабируется только при смене трека или размера метки
+void MainWindow::updateCover() {
     auto current = playlist.current();  // Получаем текущий трек
     if (!current) return;  // Если трека нет - выходим
 
-    // Получаем обложку трека
-    QImage coverImage = current->getCoverImage();
+    QString coverKey = QString::fromStdString(current->path());  // Обложки привязаны к файлам
+    if (coverKey == shownCoverKey_ && coverLabel->size() == shownCoverSize_) return;
+
+    // Получаем обложку трека (во время запуска - после первого кадра)
+    // Хранилище отдает уже масштабированную копию, общую для всего альбома
+    QImage coverImage = startupInProgress_ ? QImage() : coverStore_.cover(coverKey);
 
     if (!coverImage.isNull()) {
-        // Масштабируем обложку под размер метки с сохранением пропорций
-        QPixmap coverPixmap = QPixmap::fromImage(coverImage)
-                                  .scaled(coverLabel->width(), coverLabel->height(),
-                                          Qt::KeepAspectRatio, Qt::SmoothTransformation);
-        coverLabel->setPixmap(coverPixmap);  // Устанавливаем обложку
+        coverLabel->setPixmap(QPixmap::fromImage(coverImage));  // Устанавливаем обложку
         coverLabel->setText("");             // Убираем текст "No Cover"
     } else {
         // Если обложки нет - создаем серый квадрат
@@ -731,12 +1025,51 @@ void MainWindow::updateUI() {
         coverLabel->setStyleSheet("QLabel { background: #222; border: 2px solid #444; border-radius: 10px; color: #fff; font-size: 12px; }");
     }
 
+    // Заглушка на время запуска не запоминается - настоящая обложка загрузится позже
+    shownCoverKey_ = startupInProgress_ ? QString() : coverKey;
+    shownCoverSize_ = coverLabel->size();
+}
+
+// Название, исполнитель и статистика прослушиваний
+void MainWindow::updateTrackText() {
+    auto current = playlist.current();
+    if (!current) return;
+
     // Устанавливаем информацию о треке
-    albumLabel->setText(QString::fromStdString(current->title()));
-    artistLabel->setText(QString::fromStdString(current->artist()));
+    QString title = QString::fromStdString(current->title());
+    QString artist = QString::fromStdString(current->artist());
+    if (albumLabel->text() != title) albumLabel->setText(title);
+    if (artistLabel->text() != artist) artistLabel->setText(artist);
+
+    // Статистика прослушиваний - во всплывающей подсказке
+    PlayHistory::Stats stats = playHistory_.stats(current->getID());
+    QString statsText = QString("Прослушиваний: %1\nПропусков: %2").arg(stats.playCount).arg(stats.skipCount);
+    if (stats.lastPlayed > 0) {
+        statsText += "\nПоследний раз: " +
+                     QDateTime::fromMSecsSinceEpoch(stats.lastPlayed).toString("dd.MM.yyyy HH:mm");
+    }
+    if (current->bpm() > 0.0f) {
+        statsText += QString("\nТемп: %1 уд/мин").arg(qRound(current->bpm()));
+    }
+    const int camelot = AudioFeatures::camelotOrder(current->key());
+    if (camelot >= 0) {
+        statsText += QString("\nТональность: %1 (%2%3)")
+                         .arg(QString::fromStdString(AudioFeatures::keyName(current->key())))
+                         .arg(camelot / 2 + 1)
+                         .arg(camelot % 2 ? 'B' : 'A');
+    }
+    if (albumLabel->toolTip() != statsText) albumLabel->setToolTip(statsText);
+}
+
+// Звезды рейтинга - перерисовываются только при смене рейтинга
+void MainWindow::updateRatingStars() {
+    auto current = playlist.current();
+    if (!current) return;
 
-    // Обновляем отображение звезд рейтинга
     double rating = current->rating();
+    if (rating == shownRating_) return;
+    shownRating_ = rating;
+
     for (int i = 0; i < 5; ++i) {
         if (i < rating) {
             starButtons[i]->setText("★");  // Заполненная звезда
@@ -744,16 +1077,17 @@ void MainWindow::updateUI() {
             starButtons[i]->setText("☆");  // Пустая звезда
         }
     }
+}
 
-    // Подсвечиваем текущий трек в списке
+// Выделение текущего трека в списке (без прокрутки)
+void MainWindow::updateListSelection() {
     int currentRow = static_cast<int>(playlist.currentIndex());
     if (currentRow >= 0 && currentRow < trackList->count()) {
         QListWidgetItem* item = trackList->item(currentRow);
-        if (item && !item->isHidden()) {
+        if (item && !item->isHidden() && !item->isSelected()) {
             item->setSelected(true);  // Выделяем элемент
         }
     }
-    // highlightCurrentTrack();
 }
 
 // Обработчик кнопки Play/Pause
@@ -771,7 +1105,7 @@ void MainWindow::onPlayPauseClicked() {
             controls->setPlaying(true); // Меняем иконку на "pause"
         }
     }
-    updateThumbnailButtons();  // Обновляем кнопки в thumbnail toolbar
+    uiScheduler_->markDirty(UiUpdateScheduler::Thumbnail);  // Обновляем кнопки в thumbnail toolbar
 }
 
 // Обработчик кнопки "Следующий трек"
@@ -813,6 +1147,7 @@ void MainWindow::onRepeatClicked() {
 
     // Сохраняем состояние для будущих папок
     savedRepeatMode_ = newMode;
+    updateUpNext();
 }
 
 // Обработчик кнопки перемешивания
@@ -823,82 +1158,359 @@ void MainWindow::onShuffleClicked() {
 
     // Сохраняем состояние для будущих папок
     savedShuffleState_ = newShuffleState;
+    updateUpNext();
 }
 
 // Обработчик перемотки трека
 void MainWindow::onSeek(qint64 position) {
-    player->setPosition(position);  // Устанавливаем новую позицию
+    seekTo(position, false);  // Слайдер отпущен - перематываем сразу
+}
+
+// Перемотка с выравниванием цели по началу кадра MP3.
+// coalesce - команда откладывается, и серия вызовов отправляет плееру только последнюю цель
+void MainWindow::seekTo(qint64 position, bool coalesce) {
+    position = qMax(0LL, position);
+    if (currentSeekIndex_) {
+        position = currentSeekIndex_->frameStartMs(position);
+    }
+
+    controls->setPosition(position, player->duration());  // Ползунок двигается сразу
+    if (coalesce) {
+        seekTarget_ = position;
+        seekTimer_->start();
+        return;
+    }
+    seekTimer_->stop();
+    seekTarget_ = -1;
+    player->setPosition(position);
+}
+
+qint64 MainWindow::seekBase() const {
+    return seekTarget_ >= 0 ? seekTarget_ : player->position();
+}
+
+// Индекс перемотки строится в пуле: при первом воспроизведении - с приоритетом
+// упреждающей работы, для следующего трека - вместе с фоновым анализом
+void MainWindow::requestSeekIndex(const QString& path, TaskPriority priority) {
+    if (!SeekIndexStore::isIndexable(path) || seekIndexPending_.contains(path)) return;
+    if (seekIndexStore_.find(path)) return;
+
+    seekIndexPending_.insert(path);
+    TaskScheduler::instance().run(
+        priority, this,
+        [path](const CancellationToken&) { return SeekIndexStore::build(path); },
+        [this, path](SeekIndexStore::Entry entry) {
+            seekIndexPending_.remove(path);
+            seekIndexStore_.insert(path, entry);
+            if (entry.index && player->source() == QUrl::fromLocalFile(path)) {
+                currentSeekIndex_ = entry.index;
+                player->setSeekIndex(player->source(), currentSeekIndex_);
+            }
+        });
+}
+
+// Обзор формы волны требует декодирования всего трека - только в пуле и только
+// один раз на трек: текущий с приоритетом упреждающей работы, следующий - фоном
+void MainWindow::requestWaveform(const QString& path, TaskPriority priority) {
+    if (waveformPending_.contains(path)) return;
+
+    waveformPending_.insert(path);
+    const WaveformStore* store = &waveformStore_;  // Задачи отменяются при выходе раньше удаления окна
+    const QString contentId = trackIds_->id(path);
+    TaskScheduler::instance().run(
+        priority, this,
+        [store, path, contentId](const CancellationToken& token) { return store->build(path, contentId, token); },
+        [this, path](WaveformStore::PeaksPtr peaks) {
+            waveformPending_.remove(path);
+            if (peaks && player->source() == QUrl::fromLocalFile(path)) {
+                controls->setWaveform(peaks);
+            }
+        },
+        waveformToken_);
 }
 
 // Обработчик изменения громкости
 void MainWindow::onVolumeChanged(int volume) {
-    audioOutput->setVolume(volume / 100.0);  // Устанавливаем громкость (0.0 - 1.0)
+    player->setVolume(volume / 100.0);  // Устанавливаем громкость (0.0 - 1.0)
     volumeBeforeMute_ = volume;              // Сохраняем для восстановления
 }
 
 // Обработчик изменения позиции воспроизведения
 void MainWindow::onPositionChanged(qint64 position) {
-    // Обновляем позицию в элементах управления
-    controls->setPosition(position, player->duration());
+    // Позиция перерисуется в ближайшем кадре - тики чаще кадров схлопываются
+    uiScheduler_->markDirty(UiUpdateScheduler::Progress | UiUpdateScheduler::TimeLabel);
+    lastPosition_ = position;  // Для записи пропуска при смене трека
+}
+
+// Смена источника плеера - граница между треками в истории прослушиваний
+void MainWindow::onSourceChanged(const QUrl& source) {
+    // Предыдущий трек сменили, не дослушав - это пропуск
+    if (!historyTrackId_.empty() && !historyTrackFinished_) {
+        playHistory_.record(PlayHistory::Event::Skip, historyTrackId_, lastPosition_);
+    }
+    historyTrackId_.clear();
+    historyTrackFinished_ = false;
+    lastPosition_ = 0;
+
+    // Отложенная перемотка относилась к прежнему треку
+    seekTimer_->stop();
+    seekTarget_ = -1;
+    currentSeekIndex_.reset();
+    controls->setWaveform(nullptr);
+
+    if (source.isEmpty()) return;
+
+    const QString filePath = source.toLocalFile();
+    currentSeekIndex_ = seekIndexStore_.find(filePath);
+    if (currentSeekIndex_) {
+        player->setSeekIndex(source, currentSeekIndex_);  // Перемотка по опорным точкам
+    } else {
+        requestSeekIndex(filePath, TaskPriority::LookAhead);
+    }
+    // Готовый обзор - чтение файла в несколько килобайт, иначе строится в пуле
+    if (auto peaks = waveformStore_.load(filePath, trackIds_->id(filePath))) {
+        controls->setWaveform(peaks);
+    } else {
+        requestWaveform(filePath, TaskPriority::LookAhead);
+    }
+
+    // Идентификатор берём у текущего трека плейлиста, если это он
+    const std::string path = source.toLocalFile().toStdString();
+    auto current = playlist.current();
+    historyTrackId_ = (current && current->path() == path) ? current->getID() : path;
+
+    updateUpNext();  // Следующий трек - для перехода без участия GUI
+
+    // Продолжение трека из прошлой сессии - не новый запуск
+    if (pendingSeek_ > 0) return;
+    playHistory_.record(PlayHistory::Event::Start, historyTrackId_, 0);
 }
 
 // Обработчик изменения длительности трека
 void MainWindow::onDurationChanged(qint64 duration) {
-    // Обновляем позицию в элементах управления
-    controls->setPosition(player->position(), duration);
+    Q_UNUSED(duration);
+    uiScheduler_->markDirty(UiUpdateScheduler::Progress | UiUpdateScheduler::TimeLabel);
+}
+
+// Перерисовка областей, накопленных планировщиком за кадр
+void MainWindow::flushUi(unsigned regions) {
+    if (regions & UiUpdateScheduler::Cover) {
+        updateCover();
+    }
+    if (regions & UiUpdateScheduler::TrackText) {
+        updateTrackText();
+    }
+    if (regions & UiUpdateScheduler::Rating) {
+        updateRatingStars();
+    }
+    if (regions & UiUpdateScheduler::Selection) {
+        updateListSelection();
+    }
+    if (regions & UiUpdateScheduler::ListHighlight) {
+        highlightCurrentTrack();
+    }
+    if (regions & UiUpdateScheduler::Progress) {
+        controls->updateProgress(seekBase(), player->duration());  // Во время серии перемоток - ее цель
+    }
+    if (regions & UiUpdateScheduler::TimeLabel) {
+        controls->updateTimeLabel(seekBase(), player->duration());
+    }
+    if (regions & UiUpdateScheduler::Thumbnail) {
+        updateThumbnailButtons();
+    }
+}
+
+// Сворачивание/разворачивание окна - приостановка обновлений интерфейса
+void MainWindow::changeEvent(QEvent* event) {
+    QMainWindow::changeEvent(event);
+    if (event->type() == QEvent::WindowStateChange) {
+        uiScheduler_->setSuspended(isMinimized() || !isVisible());
+    }
+}
+
+void MainWindow::hideEvent(QHideEvent* event) {
+    QMainWindow::hideEvent(event);
+    uiScheduler_->setSuspended(true);
 }
 
 // Обработчик изменения статуса медиа
 void MainWindow::onMediaStatusChanged(QMediaPlayer::MediaStatus status) {
-    if (status == QMediaPlayer::EndOfMedia) {  // Если трек закончился
-        if (playlist.repeatMode() == Playlist::RepeatMode::One) {
-            // Режим повтора одного трека - перезапускаем текущий
-            player->setPosition(0);
-            player->play();
-            return;
+    // Трек из прошлой сессии загружен - переходим на сохраненную позицию
+    if (pendingSeek_ >= 0 && (status == QMediaPlayer::LoadedMedia || status == QMediaPlayer::BufferedMedia)) {
+        player->setPosition(pendingSeek_);
+        pendingSeek_ = -1;
+    }
+
+    // Плеер не смог открыть текущий трек - обрабатываем как битый
+    if (status == QMediaPlayer::InvalidMedia) {
+        auto current = playlist.current();
+        if (current && player->source() == QUrl::fromLocalFile(QString::fromStdString(current->path()))) {
+            QString filePath = QString::fromStdString(current->path());
+            if (alwaysSkipBadTracks_) {
+                if (!navigateAutoSkip(true)) {
+                    player->stop();
+                    controls->setPlaying(false);
+                }
+            } else {
+                showBadTrackDialog(filePath, true);
+            }
         }
+    }
+
+    uiScheduler_->markDirty(UiUpdateScheduler::Thumbnail);  // Обновляем кнопки в thumbnail toolbar
+}
+
+// Трек доигран. Если плеер уже перешел к заранее сообщенному треку,
+// GUI только догоняет плейлист; иначе выбирает следующий трек сам
+void MainWindow::onTrackFinished(const QUrl& finished, const QUrl& next) {
+    Q_UNUSED(finished);
+
+    // Трек дослушан - записываем окончание в историю
+    if (!historyTrackId_.empty() && !historyTrackFinished_) {
+        playHistory_.record(PlayHistory::Event::End, historyTrackId_, player->duration());
+        historyTrackFinished_ = true;
+    }
+
+    if (next.isEmpty()) {
+        handleEndOfTrack();
+        return;
+    }
+
+    if (next == finished) {
+        // Повтор одного трека - плеер уже перезапустил его
+        if (!historyTrackId_.empty()) {
+            playHistory_.record(PlayHistory::Event::Start, historyTrackId_, 0);
+            historyTrackFinished_ = false;
+        }
+        updateUpNext();
+        return;
+    }
 
-        // Безопасный Автоматический переход к следующему треку
-        if (!playlist.next()) {
-            // Если следующий трек недоступен
+    // Плейлист догоняет плеер (prepareNext гарантирует, что next() попадет на тот же трек)
+    std::optional<Track> current;
+    if (playlist.next()) {
+        current = playlist.current();
+    }
+    QUrl expected = current ? QUrl::fromLocalFile(QString::fromStdString(current->path())) : QUrl();
+    if (expected != next) {
+        // Плейлист изменился, пока трек доигрывал - играем то, что выбрал плейлист
+        if (expected.isEmpty()) {
             player->stop();
-            controls->setPlaying(false);
         } else {
-            // ВМЕСТО вызова playCurrentTrack() используем логику с пропуском
-            auto current = playlist.current();
-            if (current) {
-                QString filePath = QString::fromStdString(current->path());
-
-                // Проверяем трек
-                if (!validateTrack(filePath)) {
-                    // Трек битый - обрабатываем в зависимости от настроек
-                    if (alwaysSkipBadTracks_) {
-                        // Автоматически пропускаем и ищем следующий валидный
-                        if (!navigateAutoSkip(true)) {
-                            player->stop();
-                            controls->setPlaying(false);
-                        }
-                    } else {
-                        // Показываем диалог
-                        showBadTrackDialog(filePath, true);
+            player->setSource(expected);
+            player->play();
+        }
+    }
+    controls->setPlaying(!expected.isEmpty());
+    uiScheduler_->markDirty(UiUpdateScheduler::NowPlaying | UiUpdateScheduler::ListHighlight |
+                            UiUpdateScheduler::Thumbnail);
+}
+
+// Окончание трека без заранее известного следующего: прежняя логика с проверкой трека
+void MainWindow::handleEndOfTrack() {
+    if (playlist.repeatMode() == Playlist::RepeatMode::One) {
+        // Режим повтора одного трека - перезапускаем текущий
+        if (!historyTrackId_.empty()) {
+            playHistory_.record(PlayHistory::Event::Start, historyTrackId_, 0);
+            historyTrackFinished_ = false;
+        }
+        player->setPosition(0);
+        player->play();
+        return;
+    }
+
+    // Безопасный Автоматический переход к следующему треку
+    if (!playlist.next()) {
+        // Если следующий трек недоступен
+        player->stop();
+        controls->setPlaying(false);
+    } else {
+        // ВМЕСТО вызова playCurrentTrack() используем логику с пропуском
+        auto current = playlist.current();
+        if (current) {
+            QString filePath = QString::fromStdString(current->path());
+
+            // Проверяем трек
+            if (!validateTrack(filePath)) {
+                // Трек битый - обрабатываем в зависимости от настроек
+                if (alwaysSkipBadTracks_) {
+                    // Автоматически пропускаем и ищем следующий валидный
+                    if (!navigateAutoSkip(true)) {
+                        player->stop();
+                        controls->setPlaying(false);
                     }
-                    return;
+                } else {
+                    // Показываем диалог
+                    showBadTrackDialog(filePath, true);
                 }
+                return;
+            }
 
-                // Трек валиден - воспроизводим
-                player->setSource(QUrl::fromLocalFile(filePath));
-                player->play();
-                controls->setPlaying(true);
-                updateUI();
-                highlightCurrentTrack();
-            } else {
-                player->stop();
-                controls->setPlaying(false);
+            // Трек валиден - воспроизводим
+            player->setSource(QUrl::fromLocalFile(filePath));
+            player->play();
+            controls->setPlaying(true);
+            uiScheduler_->markDirty(UiUpdateScheduler::NowPlaying);
+            uiScheduler_->markDirty(UiUpdateScheduler::ListHighlight);
+        } else {
+            player->stop();
+            controls->setPlaying(false);
+        }
+    }
+
+    uiScheduler_->markDirty(UiUpdateScheduler::Thumbnail);  // Обновляем кнопки в thumbnail toolbar
+}
+
+// Следующий трек сообщается плееру заранее - по окончании текущего он перейдет сам,
+// даже если GUI в этот момент занят
+void MainWindow::updateUpNext() {
+    QUrl next;
+    auto current = playlist.current();
+    if (current && player->source() == QUrl::fromLocalFile(QString::fromStdString(current->path()))) {
+        std::optional<size_t> index;
+        if (playlist.repeatMode() == Playlist::RepeatMode::One) {
+            next = player->source();
+        } else if ((index = playlist.prepareNext())) {
+            // Только быстрая проверка: глубокая (TrackValidator) блокирует поток на секунды.
+            // Если файл окажется битым, плеер сообщит InvalidMedia
+            QString filePath = QString::fromStdString(playlist.all()[*index].path());
+            if (ProbeRegistry::instance().isSupportedFile(filePath) && QFileInfo::exists(filePath) &&
+                !libraryAudit_->isKnownBad(filePath)) {
+                next = QUrl::fromLocalFile(filePath);
+                requestSeekIndex(filePath, TaskPriority::BulkScan);
+                if (!waveformStore_.load(filePath, trackIds_->id(filePath))) {
+                    requestWaveform(filePath, TaskPriority::BulkScan);
+                }
             }
         }
+        stageUpcoming(index);
     }
+    player->setNextSource(next);
+}
+
+// Визуализатор виден и получает звук, только когда включен
+void MainWindow::applyVisualizer() {
+    spectrumWidget_->setVisible(visualizerEnabled_);
+    player->setAudioTapEnabled(visualizerEnabled_);
+}
 
-    updateThumbnailButtons();  // Обновляем кнопки в thumbnail toolbar
+// Локальные копии: следующий трек первым, за ним еще несколько по порядку
+// (при shuffle порядок дальше следующего неизвестен), текущий - последним
+void MainWindow::stageUpcoming(const std::optional<size_t>& next) {
+    const auto& tracks = playlist.all();
+    QStringList paths;
+    if (next && *next < tracks.size()) {
+        paths << QString::fromStdString(tracks[*next].path());
+        if (!playlist.isShuffled()) {
+            for (size_t i = 1; i <= kStageAhead && *next + i < tracks.size(); ++i) {
+                paths << QString::fromStdString(tracks[*next + i].path());
+            }
+        }
+    }
+    if (auto current = playlist.current()) {
+        paths << QString::fromStdString(current->path());
+    }
+    stagingCache_.stage(paths);
 }
 
 // Обработчик двойного клика по треку в списке
@@ -912,10 +1524,10 @@ void MainWindow::onTrackListDoubleClicked(QListWidgetItem* item) {
 // Обработчик включения/выключения звука
 void MainWindow::onMuteToggled(bool muted) {
     if (muted) {
-        audioOutput->setVolume(0);  // Выключаем звук
+        player->setVolume(0);  // Выключаем звук
     } else {
         // Включаем звук с сохраненной громкостью
-        audioOutput->setVolume(volumeBeforeMute_ / 100.0);
+        player->setVolume(volumeBeforeMute_ / 100.0);
     }
 }
 
@@ -959,6 +1571,25 @@ QString MainWindow::simpleHighlight(const QString& text, const QString& searchTe
 // -----------------------------------------------------------------
 
 void MainWindow::onSearchTextChanged(const QString& text) {
+    // Структурированный запрос: artist:"Daft Punk" rating>=4 -live
+    if (SearchQuery::looksStructured(text)) {
+        SearchQuery query = SearchQuery::parse(text);
+        if (query.isValid()) {
+            searchEdit->setToolTip(QString());
+            applyStructuredSearch(query);
+            return;
+        }
+        // Ошибка разбора - подсказываем и ищем как обычную строку
+        searchEdit->setToolTip("Ошибка в запросе: " + query.error());
+    } else {
+        searchEdit->setToolTip(QString());
+    }
+
+    if (fuzzySearch_ && !text.trimmed().isEmpty()) {
+        applyFuzzySearch(text);
+        return;
+    }
+
     for (int i = 0; i < trackList->count(); ++i) {
         QListWidgetItem* item = trackList->item(i);
 
@@ -968,6 +1599,7 @@ void MainWindow::onSearchTextChanged(const QString& text) {
             original = item->text();
             item->setData(Qt::UserRole, original);
         }
+        item->setData(HtmlDelegate::HighlightRangesRole, QVariant()); // Сбрасываем подсветку по участкам
 
         // Проверяем совпадение
         bool shouldShow = text.isEmpty() ||
@@ -985,7 +1617,229 @@ void MainWindow::onSearchTextChanged(const QString& text) {
     }
 
     // После фильтрации сохраняем выделение текущего трека
-    highlightCurrentTrack();
+    uiScheduler_->markDirty(UiUpdateScheduler::ListHighlight);
+}
+
+// Актуализация поискового индекса (строится лениво - только когда нужен)
+void MainWindow::ensureSearchIndex() {
+    if (searchIndexDirty_ || searchIndex_.size() != playlist.size()) {
+        searchIndexToken_.cancel();  // Фоновая сборка больше не нужна
+        searchIndex_.rebuild(playlist.all());
+        searchIndexDirty_ = false;
+    }
+}
+
+// Хэши встроенных обложек всей библиотеки - в пуле потоков.
+// После этого трек альбома, чья обложка уже на экране или в кэше, не читается с диска
+void MainWindow::scanCovers() {
+    coverScanToken_.cancel();
+    TrackLibrary::SnapshotPtr snapshot = playlist.snapshot();
+    coverScanToken_ = TaskScheduler::instance().run(
+        TaskPriority::BulkScan, this,
+        [snapshot](const CancellationToken& token) {
+            std::vector<std::pair<QString, CoverStore::CoverId>> covers;
+            covers.reserve(snapshot->tracks.size());
+            for (const Track& track : snapshot->tracks) {
+                if (token.isCancelled()) break;
+                const QString path = QString::fromStdString(track.path());
+                covers.emplace_back(path, CoverStore::hashCover(path));
+            }
+            return covers;
+        },
+        [this](std::vector<std::pair<QString, CoverStore::CoverId>> covers) {
+            for (const auto& cover : covers) {
+                coverStore_.setTrackCover(cover.first, cover.second);
+            }
+        });
+}
+
+// Чтение тегов открывает и разбирает каждый файл - на большой библиотеке это секунды,
+// поэтому плейлист сначала заполняется по именам файлов, а теги подставляются потом
+void MainWindow::readTagsAsync(const QStringList& paths) {
+    tagScanToken_.cancel();
+    if (paths.isEmpty()) return;
+    tagScanToken_ = TaskScheduler::instance().run(
+        TaskPriority::BulkScan, this,
+        [paths](const CancellationToken& token) {
+            std::unordered_map<std::string, Playlist::Tags> tags;
+            for (const QString& path : paths) {
+                if (token.isCancelled()) break;
+                const ProbeResult probe = ProbeRegistry::instance().probe(path, false);
+                if (probe.artist.isEmpty() && probe.title.isEmpty() && probe.album.isEmpty()) continue;
+                tags.emplace(path.toStdString(),
+                             Playlist::Tags{probe.artist.toStdString(), probe.title.toStdString(),
+                                            probe.album.toStdString()});
+            }
+            return tags;
+        },
+        [this](std::unordered_map<std::string, Playlist::Tags> tags) {
+            // Пустые поля тега - прежние значения из имени файла
+            std::unordered_map<std::string, Playlist::Tags> applied;
+            for (Track& track : originalTracks_) {
+                auto it = tags.find(track.path());
+                if (it == tags.end()) continue;
+                Playlist::Tags t = std::move(it->second);
+                if (t.artist.empty()) t.artist = track.artist();
+                if (t.title.empty()) t.title = track.title();
+                if (t.album.empty()) t.album = track.album();
+                if (t.artist == track.artist() && t.title == track.title() && t.album == track.album()) continue;
+                track.setTags(t.artist, t.title, t.album);
+                applied.emplace(track.path(), std::move(t));
+            }
+            if (applied.empty()) return;
+            playlist.setTags(applied);
+
+            // Строки списка - в порядке плейлиста
+            const std::vector<Track>& tracks = playlist.all();
+            for (size_t i = 0; i < tracks.size() && int(i) < trackList->count(); ++i) {
+                if (!applied.count(tracks[i].path())) continue;
+                const QString text = QString("%1. %2 - %3")
+                                         .arg(i + 1)
+                                         .arg(QString::fromStdString(tracks[i].artist()))
+                                         .arg(QString::fromStdString(tracks[i].title()));
+                QListWidgetItem* item = trackList->item(int(i));
+                item->setText(text);
+                item->setData(Qt::UserRole, text);
+            }
+
+            searchIndexDirty_ = true;
+            rebuildSearchIndexAsync();
+            onSearchTextChanged(searchEdit->text());  // Фильтр - по новым полям
+            uiScheduler_->markDirty(UiUpdateScheduler::NowPlaying);
+        });
+}
+
+// Досчитанные отпечатки: треки получают идентификаторы, рейтинги и журнал
+// переходят с путей (или прежних отпечатков) на них. Перенесенный файл
+// находит свой рейтинг только сейчас - до подсчета его путь был незнаком
+void MainWindow::applyTrackIds() {
+    std::unordered_map<std::string, std::string> ids;
+    std::vector<std::pair<std::string, std::string>> moves;
+    for (const Track& track : playlist.all()) {
+        const std::string id = trackIds_->id(QString::fromStdString(track.path())).toStdString();
+        if (id.empty() || id == track.contentId()) continue;
+        ids.emplace(track.path(), id);
+        moves.emplace_back(track.getID(), id);
+    }
+    if (ids.empty()) return;
+
+    for (Track& track : originalTracks_) {
+        auto it = ids.find(track.path());
+        if (it != ids.end()) track.setContentId(it->second);
+    }
+    for (const auto& move : moves) {
+        if (move.first == historyTrackId_) historyTrackId_ = move.second;
+    }
+
+    playlist.setContentIds(ids);
+    playlist.loadRatings();
+    playlist.saveRatings();  // Файл рейтингов - уже по отпечаткам
+    playHistory_.relink(moves);
+    applyMusicInfo();
+    if (similarMode_ != Playlist::SimilarMode::Off) rebuildSimilarity();
+
+    searchIndexDirty_ = true;
+    rebuildSearchIndexAsync();
+    uiScheduler_->markDirty(UiUpdateScheduler::NowPlaying);
+}
+
+// Фоновая сборка индекса по снимку библиотеки: к первому поиску он обычно уже готов
+void MainWindow::rebuildSearchIndexAsync() {
+    searchIndexToken_.cancel();
+    TrackLibrary::SnapshotPtr snapshot = playlist.snapshot();
+    searchIndexToken_ = TaskScheduler::instance().run(
+        TaskPriority::BulkScan, this,
+        [snapshot](const CancellationToken&) {
+            SearchIndex index;
+            index.rebuild(snapshot->tracks);
+            return index;
+        },
+        [this, version = snapshot->version](SearchIndex index) {
+            // Библиотека успела измениться (сортировка, рейтинг) - индекс устарел
+            if (playlist.snapshot()->version != version) return;
+            searchIndex_ = std::move(index);
+            searchIndexDirty_ = false;
+        });
+}
+
+// Нечёткий поиск: показываем найденные треки и подсвечиваем совпавшие участки
+void MainWindow::applyFuzzySearch(const QString& text) {
+    ensureSearchIndex();
+
+    std::vector<SearchIndex::Hit> hits = searchIndex_.fuzzySearch(text);
+
+    // Если есть более точные совпадения - отбрасываем сильно опечатанные
+    if (!hits.empty()) {
+        const int maxErrors = hits.front().errors + 1;
+        hits.erase(std::find_if(hits.begin(), hits.end(),
+                                [maxErrors](const SearchIndex::Hit& hit) { return hit.errors > maxErrors; }),
+                   hits.end());
+    }
+
+    showSearchHits(hits);
+}
+
+// Структурированный запрос: компилируется в предикаты над колонками индекса
+void MainWindow::applyStructuredSearch(const SearchQuery& query) {
+    ensureSearchIndex();
+    showSearchHits(query.run(searchIndex_));
+}
+
+// Показ результатов поиска: остальные треки скрываются, найденные участки подсвечиваются
+void MainWindow::showSearchHits(const std::vector<SearchIndex::Hit>& hits) {
+    // Скрываем все элементы и возвращаем им исходный текст
+    for (int i = 0; i < trackList->count(); ++i) {
+        QListWidgetItem* item = trackList->item(i);
+        QString original = item->data(Qt::UserRole).toString();
+        if (original.isEmpty()) {
+            original = item->text();
+            item->setData(Qt::UserRole, original);
+        }
+        if (item->text() != original) {
+            item->setText(original);
+        }
+        item->setData(HtmlDelegate::HighlightRangesRole, QVariant());
+        item->setHidden(true);
+    }
+
+    const std::vector<Track>& tracks = playlist.all();
+    for (const SearchIndex::Hit& hit : hits) {
+        QListWidgetItem* item = trackList->item(static_cast<int>(hit.track));
+        if (!item || hit.track >= tracks.size()) continue;
+        item->setHidden(false);
+
+        // Переводим позиции в полях трека в позиции строки "N. Исполнитель - Название"
+        QString original = item->data(Qt::UserRole).toString();
+        QString artist = QString::fromStdString(tracks[hit.track].artist());
+        QString title = QString::fromStdString(tracks[hit.track].title());
+        int artistPos = original.indexOf(". ") + 2;
+        int titlePos = artistPos + artist.size() + 3;
+        if (original.mid(artistPos, artist.size()) != artist || original.mid(titlePos) != title) {
+            continue;  // Нестандартный текст элемента - показываем без подсветки
+        }
+
+        QVariantList ranges;
+        for (const SearchIndex::Range& range : hit.ranges) {
+            if (range.field == SearchIndex::Artist) {
+                ranges.append(QPoint(artistPos + range.start, range.length));
+            } else if (range.field == SearchIndex::Title) {
+                ranges.append(QPoint(titlePos + range.start, range.length));
+            }
+            // Альбом в списке не отображается - совпадение в нём только учитывается
+        }
+        item->setData(HtmlDelegate::HighlightRangesRole, ranges);
+    }
+
+    uiScheduler_->markDirty(UiUpdateScheduler::ListHighlight);
+
+    // Если текущий трек отфильтрован - прокручиваем к первому (самому релевантному) результату
+    QListWidgetItem* currentItem = trackList->item(static_cast<int>(playlist.currentIndex()));
+    if (!hits.empty() && (!currentItem || currentItem->isHidden())) {
+        QListWidgetItem* bestItem = trackList->item(static_cast<int>(hits.front().track));
+        if (bestItem) {
+            trackList->scrollToItem(bestItem, QAbstractItemView::PositionAtTop);
+        }
+    }
 }
 
 // Обработчик сортировки по алфавиту
@@ -1012,6 +1866,8 @@ void MainWindow::onSortAlphabeticalClicked() {
         applySorting(sortedTracks, "А-Я");
         isAlphabeticalSort_ = true;
         isReverseSort_ = false;
+        isBpmSort_ = false;
+        isKeySort_ = false;
     } else {
         // Второе нажатие - сортировка Я-А
         std::vector<Track> reversedTracks = originalTracks_;
@@ -1031,6 +1887,8 @@ void MainWindow::onSortAlphabeticalClicked() {
         applySorting(reversedTracks, "Я-А");
         isAlphabeticalSort_ = false;
         isReverseSort_ = true;
+        isBpmSort_ = false;
+        isKeySort_ = false;
     }
 
     updateSortButtonsStyle();  // Обновляем внешний вид кнопок
@@ -1043,6 +1901,8 @@ void MainWindow::onSortStandardClicked() {
     applySorting(originalTracks_, "Стандарт");
     isAlphabeticalSort_ = false;
     isReverseSort_ = false;
+    isBpmSort_ = false;
+    isKeySort_ = false;
     updateSortButtonsStyle();
 }
 
@@ -1056,6 +1916,39 @@ void MainWindow::onSortReverseClicked() {
     applySorting(reversedTracks, "Реверс");
     isAlphabeticalSort_ = false;
     isReverseSort_ = true;
+    isBpmSort_ = false;
+    isKeySort_ = false;
+    updateSortButtonsStyle();
+}
+
+// Сортировка по звучанию: первое нажатие - по темпу, второе - по тональности
+// (соседи на круге Camelot сводятся гармонично). Треки без анализа - в конце
+void MainWindow::onSortMusicClicked() {
+    if (originalTracks_.empty()) return;
+
+    const bool byKey = isBpmSort_;
+    std::vector<Track> sortedTracks = originalTracks_;
+    if (!byKey) {
+        std::stable_sort(sortedTracks.begin(), sortedTracks.end(), [](const Track& a, const Track& b) {
+            const bool knownA = a.bpm() > 0.0f, knownB = b.bpm() > 0.0f;
+            if (knownA != knownB) return knownA;
+            return a.bpm() < b.bpm();
+        });
+    } else {
+        std::stable_sort(sortedTracks.begin(), sortedTracks.end(), [](const Track& a, const Track& b) {
+            const int keyA = AudioFeatures::camelotOrder(a.key());
+            const int keyB = AudioFeatures::camelotOrder(b.key());
+            if ((keyA < 0) != (keyB < 0)) return keyB < 0;
+            if (keyA != keyB) return keyA < keyB;
+            return a.bpm() < b.bpm();  // В одной тональности - по темпу
+        });
+    }
+
+    applySorting(sortedTracks, byKey ? "Тональность" : "Темп");
+    isAlphabeticalSort_ = false;
+    isReverseSort_ = false;
+    isBpmSort_ = !byKey;
+    isKeySort_ = byKey;
     updateSortButtonsStyle();
 }
 
@@ -1072,11 +1965,13 @@ void MainWindow::applySorting(const std::vector<Track>& tracks, const QString& s
     // Очищаем плейлист и список
     playlist.clear();
     trackList->clear();
+    searchIndexDirty_ = true;  // Порядок треков изменился - индекс поиска устарел
 
     // Заполняем заново в отсортированном порядке
+    playlist.assign(tracks);  // Одной новой версией библиотеки
+    rebuildSearchIndexAsync();
     for (size_t i = 0; i < tracks.size(); ++i) {
         const Track& track = tracks[i];
-        playlist.add(track);  // Добавляем в плейлист
 
         // Создаем элемент списка
         QString displayText = QString("%1. %2 - %3")
@@ -1097,7 +1992,9 @@ void MainWindow::applySorting(const std::vector<Track>& tracks, const QString& s
 
     trackList->scrollToTop();  // Прокручиваем вверх
 
-    updateUI();  // Обновляем UI без автоматической прокрутки
+    // Трек тот же - обложку не трогаем; порядок сменился - только выделение (без прокрутки)
+    uiScheduler_->markDirty(UiUpdateScheduler::Selection);
+    updateUpNext();  // Порядок сменился - следующий трек тоже
     onSearchTextChanged(searchEdit->text());  // Применяем текущий фильтр поиска
 }
 
@@ -1126,8 +2023,10 @@ void MainWindow::updateSortButtonsStyle() {
 
     // Устанавливаем стили в зависимости от состояния
     sortAlphabeticalBtn->setStyleSheet(isAlphabeticalSort_ ? activeStyle : inactiveStyle);
-    sortStandardBtn->setStyleSheet(!isAlphabeticalSort_ && !isReverseSort_ ? activeStyle : inactiveStyle);
+    sortStandardBtn->setStyleSheet(!isAlphabeticalSort_ && !isReverseSort_ && !isBpmSort_ && !isKeySort_
+                                       ? activeStyle : inactiveStyle);
     sortReverseBtn->setStyleSheet(isReverseSort_ ? activeStyle : inactiveStyle);
+    sortMusicBtn->setStyleSheet(isBpmSort_ || isKeySort_ ? activeStyle : inactiveStyle);
 
     // Обновляем подсказки
     if (isAlphabeticalSort_) {
@@ -1135,10 +2034,15 @@ void MainWindow::updateSortButtonsStyle() {
     } else {
         sortAlphabeticalBtn->setToolTip("Сортировка по алфавиту");
     }
+    sortMusicBtn->setToolTip(isBpmSort_ ? "Сортировка по темпу - нажмите для сортировки по тональности"
+                                        : "Сортировка по темпу");
 }
 
 // Деструктор главного окна - вызывается при уничтожении объекта MainWindow
 MainWindow::~MainWindow() {
+    saveSession();  // Последний снимок сессии при выходе
+    delete player;  // Останавливает поток воспроизведения
+    player = nullptr;
     cleanupThumbnailToolBar();  // Очищаем ресурсы thumbnail toolbar при закрытии приложения
 }
 
@@ -1308,12 +2212,19 @@ bool MainWindow::nativeEvent(const QByteArray &eventType, void *message, qintptr
 // Обработчик события показа окна (переопределенный метод QWidget)
 void MainWindow::showEvent(QShowEvent* event) {
     QMainWindow::showEvent(event);  // Вызываем реализацию базового класса
+    uiScheduler_->setSuspended(isMinimized());
 
     // Инициализируем thumbnail toolbar после показа окна
     // Используем таймер чтобы дать окну полностью отобразиться
     if (!thumbnailToolbarInitialized) {
         QTimer::singleShot(100, this, &MainWindow::setupThumbnailToolBar);  // Задержка 100 мс
     }
+
+    // Первый показ: тяжелая инициализация - после отрисовки первого кадра
+    if (!deferredStartupScheduled_) {
+        deferredStartupScheduled_ = true;
+        QTimer::singleShot(0, this, &MainWindow::runDeferredStartup);
+    }
 }
 
 #ifdef Q_OS_WIN  // Следующие методы только для Windows
@@ -1470,24 +2381,29 @@ bool MainWindow::navigateWithSkip(bool forward) {
         return navigateAutoSkip(forward);
     } else {
         qDebug() << "Используем навигацию с диалогом";
-        // Сначала пытаемся перейти один раз
-        bool navigationSuccess;
-        if (forward) {
-            navigationSuccess = playlist.next();
-        } else {
-            navigationSuccess = playlist.prev(0, true);
-        }
+        // Переходим один раз; треки, битые по проверке библиотеки, проходим молча
+        QString filePath;
+        for (size_t skipped = 0; ; ++skipped) {
+            bool navigationSuccess;
+            if (forward) {
+                navigationSuccess = playlist.next();
+            } else {
+                navigationSuccess = playlist.prev(0, true);
+            }
 
-        if (!navigationSuccess) {
-            return false;
-        }
+            if (!navigationSuccess) {
+                return false;
+            }
 
-        auto current = playlist.current();
-        if (!current) {
-            return false;
-        }
+            auto current = playlist.current();
+            if (!current) {
+                return false;
+            }
 
-        QString filePath = QString::fromStdString(current->path());
+            filePath = QString::fromStdString(current->path());
+            if (!libraryAudit_->isKnownBad(filePath)) break;
+            if (skipped + 1 >= playlist.size()) return false;  // Битые все
+        }
 
         // Проверяем трек
         if (validateTrack(filePath)) {
@@ -1495,8 +2411,8 @@ bool MainWindow::navigateWithSkip(bool forward) {
             player->setSource(QUrl::fromLocalFile(filePath));
             player->play();
             controls->setPlaying(true);
-            updateUI();
-            highlightCurrentTrack();
+            uiScheduler_->markDirty(UiUpdateScheduler::NowPlaying);
+            uiScheduler_->markDirty(UiUpdateScheduler::ListHighlight);
             return true;
         } else {
             // Трек битый - показываем диалог
@@ -1546,8 +2462,8 @@ bool MainWindow::navigateAutoSkip(bool forward) {
             player->setSource(QUrl::fromLocalFile(filePath));
             player->play();
             controls->setPlaying(true);
-            updateUI();
-            highlightCurrentTrack();
+            uiScheduler_->markDirty(UiUpdateScheduler::NowPlaying);
+            uiScheduler_->markDirty(UiUpdateScheduler::ListHighlight);
             return true;
         } else {
             // Трек битый - логируем и продолжаем поиск
@@ -1603,8 +2519,8 @@ bool MainWindow::navigateWithDialog(bool forward) {
             player->setSource(QUrl::fromLocalFile(filePath));
             player->play();
             controls->setPlaying(true);
-            updateUI();
-            highlightCurrentTrack();
+            uiScheduler_->markDirty(UiUpdateScheduler::NowPlaying);
+            uiScheduler_->markDirty(UiUpdateScheduler::ListHighlight);
             return true;
         } else {
             // Трек битый - показываем диалог ТОЛЬКО ПРИ ПЕРВОМ БИТОМ ТРЕКЕ
@@ -1625,6 +2541,141 @@ bool MainWindow::navigateWithDialog(bool forward) {
     return false;
 }
 
+// Проверка всей библиотеки с единым отчетом
+void MainWindow::showLibraryAudit() {
+    QStringList paths;
+    for (const Track& track : playlist.all()) {
+        paths << QString::fromStdString(track.path());
+    }
+    LibraryAuditDialog dialog(libraryAudit_, paths, this);
+    dialog.exec();
+    updateUpNext();  // Следующий трек мог оказаться битым
+}
+
+// Копии треков: отмеченные скрываются, "вернуть" - пересканирование без фильтра
+void MainWindow::showDuplicates() {
+    QStringList paths;
+    for (const Track& track : playlist.all()) {
+        paths << QString::fromStdString(track.path());
+    }
+    DuplicatesDialog dialog(duplicateFinder_, paths, int(hiddenTracks_.size()), this);
+    const int result = dialog.exec();
+    if (result == QDialog::Accepted) {
+        hideTracks(dialog.checkedPaths());
+    } else if (result == DuplicatesDialog::RestoreHidden) {
+        hiddenTracks_.clear();
+        saveSettings();
+        if (!libraryRoot_.isEmpty()) scanFolder(libraryRoot_);
+    }
+}
+
+// Скрытие без пересканирования: текущий порядок и рейтинги сохраняются
+void MainWindow::hideTracks(const QStringList& paths) {
+    if (paths.isEmpty()) return;
+    for (const QString& path : paths) hiddenTracks_.insert(path);
+    saveSettings();
+
+    auto isHidden = [this](const Track& track) {
+        return hiddenTracks_.contains(QString::fromStdString(track.path()));
+    };
+    originalTracks_.erase(std::remove_if(originalTracks_.begin(), originalTracks_.end(), isHidden),
+                          originalTracks_.end());
+    std::vector<Track> visible;
+    visible.reserve(playlist.size());
+    for (const Track& track : playlist.all()) {
+        if (!isHidden(track)) visible.push_back(track);
+    }
+    applySorting(visible, "Без копий");
+}
+
+// Shuffle по звучанию работает поверх обычного shuffle: включение режима включает и его
+void MainWindow::setSimilarMode(Playlist::SimilarMode mode) {
+    similarMode_ = mode;
+    playlist.setSimilarMode(mode);
+    saveSettings();
+    if (mode == Playlist::SimilarMode::Off) return;
+
+    if (!playlist.isShuffled()) onShuffleClicked();
+    rebuildSimilarity();
+    startFeatureAnalysis();
+}
+
+void MainWindow::startFeatureAnalysis() {
+    if (featureStore_->isRunning()) return;
+    QStringList paths;
+    for (const Track& track : playlist.all()) {
+        paths << QString::fromStdString(track.path());
+    }
+    featureStore_->start(paths);
+}
+
+// Темп и тональность посчитанных треков - в плейлист, исходный порядок и колонки поиска
+void MainWindow::applyMusicInfo() {
+    publishAudibleRanges();  // Те же признаки - границы звука для плеера
+    std::unordered_map<std::string, Playlist::MusicInfo> infoById;
+    for (const Track& track : playlist.all()) {
+        const std::string& id = track.contentId();
+        if (id.empty() || infoById.count(id)) continue;
+        const AudioFeatures features = featureStore_->features(QString::fromStdString(id));
+        if (features.isValid()) infoById.emplace(id, Playlist::MusicInfo(features.bpm(), features.key()));
+    }
+    if (playlist.setMusicInfo(infoById) == 0) return;
+
+    for (Track& track : originalTracks_) {
+        auto it = infoById.find(track.contentId());
+        if (it != infoById.end()) track.setMusicInfo(it->second.first, it->second.second);
+    }
+    searchIndexDirty_ = true;
+    rebuildSearchIndexAsync();
+    uiScheduler_->markDirty(UiUpdateScheduler::NowPlaying);
+}
+
+// Плеер читает таблицу только при загрузке трека: новая - целиком, вместо старой
+void MainWindow::publishAudibleRanges() {
+    if (!trimSilence_) {
+        player->setAudibleRanges(nullptr);
+        return;
+    }
+    auto ranges = std::make_shared<PlaybackController::AudibleRanges>();
+    for (const Track& track : playlist.all()) {
+        const AudioFeatures features = featureStore_->features(QString::fromStdString(track.contentId()));
+        if (!features.hasAudibleRange()) continue;
+        ranges->insert(QString::fromStdString(track.path()),
+                       {qint64(features.audibleStartMs()), qint64(features.audibleEndMs())});
+    }
+    player->setAudibleRanges(std::move(ranges));
+}
+
+// Строки индекса - треки плейлиста с посчитанными признаками, по одной на идентификатор
+void MainWindow::rebuildSimilarity() {
+    std::vector<AudioFeatures::Vector> rows;
+    std::unordered_map<std::string, uint32_t> rowById;
+    for (const Track& track : playlist.all()) {
+        const std::string& id = track.contentId();
+        if (id.empty() || rowById.count(id)) continue;
+        const AudioFeatures features = featureStore_->features(QString::fromStdString(id));
+        if (!features.isValid()) continue;
+        rowById.emplace(id, uint32_t(rows.size()));
+        rows.push_back(features.vector());
+    }
+    playlist.setSimilarity(rows.empty() ? nullptr : std::make_shared<const SimilarityIndex>(rows),
+                           std::move(rowById));
+}
+
+// Эквалайзер: изменения слышны сразу, сохраняются при закрытии
+void MainWindow::showEqualizerDialog() {
+    EqualizerDialog dialog(player->dsp().settings(), equalizerEnabled_, this);
+    connect(&dialog, &EqualizerDialog::settingsChanged, this, [this](const DspChain::Settings& settings) {
+        player->dsp().setSettings(settings);  // Без блокировок - звук не прерывается
+    });
+    connect(&dialog, &EqualizerDialog::enabledChanged, this, [this](bool enabled) {
+        equalizerEnabled_ = enabled;
+        player->setDspEnabled(enabled);
+    });
+    dialog.exec();
+    saveSettings();
+}
+
 // Показать диалог для битого трека
 void MainWindow::showBadTrackDialog(const QString& filePath, bool wasForward) {
     BadTrackDialog dialog(this);
@@ -1711,6 +2762,15 @@ void MainWindow::saveSettings() {
     settings.setValue("repeatMode", static_cast<int>(savedRepeatMode_));
     settings.setValue("alwaysSkipBadTracks", alwaysSkipBadTracks_);
     settings.setValue("volumeBeforeMute", volumeBeforeMute_);
+    settings.setValue("fuzzySearch", fuzzySearch_);
+    settings.setValue("weightedShuffle", weightedShuffle_);
+    settings.setValue("similarMode", static_cast<int>(similarMode_));
+    settings.setValue("stagingCacheMb", stagingCacheMb_);
+    settings.setValue("visualizer", visualizerEnabled_);
+    settings.setValue("trimSilence", trimSilence_);
+    settings.setValue("equalizerEnabled", equalizerEnabled_);
+    EqualizerDialog::writeSettings(settings, "equalizer", player->dsp().settings());
+    settings.setValue("hiddenTracks", QStringList(hiddenTracks_.cbegin(), hiddenTracks_.cend()));
     settings.setValue("windowGeometry", saveGeometry());
     settings.setValue("windowState", saveState());
 
@@ -1724,11 +2784,30 @@ void MainWindow::saveSettings() {
 // Загрузка настроек из файла
 void MainWindow::loadSettings() {
     QSettings settings("AlexMusic", "Player");
-    savedShuffleState_ = settings.value("shuffleState", false).toBool();
-    savedRepeatMode_ = static_cast<Playlist::RepeatMode>(
-        settings.value("repeatMode", 0).toInt());
+    loadPlaybackModes();
     alwaysSkipBadTracks_ = settings.value("alwaysSkipBadTracks", false).toBool();
     volumeBeforeMute_ = settings.value("volumeBeforeMute", 70).toInt();
+    fuzzySearch_ = settings.value("fuzzySearch", false).toBool();
+    weightedShuffle_ = settings.value("weightedShuffle", false).toBool();
+    playlist.setWeightedShuffle(weightedShuffle_);
+    similarMode_ = static_cast<Playlist::SimilarMode>(
+        qBound(0, settings.value("similarMode", 0).toInt(), static_cast<int>(Playlist::SimilarMode::Smooth)));
+    playlist.setSimilarMode(similarMode_);
+    stagingCacheMb_ = settings.value("stagingCacheMb", kDefaultStagingMb).toInt();
+    stagingCache_.setBudget(qint64(stagingCacheMb_) * 1024 * 1024);
+    visualizerEnabled_ = settings.value("visualizer", true).toBool();
+    applyVisualizer();
+    trimSilence_ = settings.value("trimSilence", false).toBool();
+    publishAudibleRanges();  // Здесь же - после заполнения плейлиста в loadLibrary
+    player->dsp().setSettings(EqualizerDialog::readSettings(settings, "equalizer"));
+    equalizerEnabled_ = settings.value("equalizerEnabled", false).toBool();
+    player->setDspEnabled(equalizerEnabled_);
+    const QStringList hidden = settings.value("hiddenTracks").toStringList();
+    hiddenTracks_ = QSet<QString>(hidden.cbegin(), hidden.cend());
+
+    fuzzySearchBtn->blockSignals(true);
+    fuzzySearchBtn->setChecked(fuzzySearch_);
+    fuzzySearchBtn->blockSignals(false);
 
     // Восстанавливаем геометрию окна
     if (settings.contains("windowGeometry")) {
@@ -1739,7 +2818,7 @@ void MainWindow::loadSettings() {
     }
 
     // Применяем настройки громкости
-    audioOutput->setVolume(volumeBeforeMute_ / 100.0);
+    player->setVolume(volumeBeforeMute_ / 100.0);
     controls->setVolume(volumeBeforeMute_);
 
     // Загружаем настройки в диалог
@@ -1771,9 +2850,12 @@ bool MainWindow::eventFilter(QObject* watched, QEvent* event) {
 }
 
 void MainWindow::showSettingsDialog() {
+    ensureSettingsDialog();
+
     // Загружаем текущие настройки в диалог
     settingsDialog->setAlwaysSkipBadTracks(alwaysSkipBadTracks_);
     settingsDialog->setDefaultVolume(volumeBeforeMute_);
+    settingsDialog->setStagingCacheMb(stagingCacheMb_);
 
     if (settingsDialog->exec() == QDialog::Accepted) {
         // Сохраняем новые настройки
@@ -1794,10 +2876,13 @@ void MainWindow::showSettingsDialog() {
         }
 
         volumeBeforeMute_ = newVolume;
+        stagingCacheMb_ = settingsDialog->stagingCacheMb();
 
         // Применяем настройки
-        audioOutput->setVolume(volumeBeforeMute_ / 100.0);
+        player->setVolume(volumeBeforeMute_ / 100.0);
         controls->setVolume(volumeBeforeMute_);
+        stagingCache_.setBudget(qint64(stagingCacheMb_) * 1024 * 1024);
+        updateUpNext();  // Включенный кэш сразу копирует ближайшие треки
 
         // Сохраняем в файл
         saveSettings();
@@ -1824,6 +2909,14 @@ void MainWindow::createMenuBar() {
     });
     fileMenu->addAction(openFolderAction);
 
+    QAction* auditAction = new QAction("🩺 Проверка библиотеки...", this);
+    connect(auditAction, &QAction::triggered, this, &MainWindow::showLibraryAudit);
+    fileMenu->addAction(auditAction);
+
+    QAction* duplicatesAction = new QAction("🧬 Копии треков...", this);
+    connect(duplicatesAction, &QAction::triggered, this, &MainWindow::showDuplicates);
+    fileMenu->addAction(duplicatesAction);
+
     fileMenu->addSeparator();
 
     QAction* exitAction = new QAction("🚪 Выход", this);
@@ -1867,6 +2960,61 @@ void MainWindow::createMenuBar() {
     });
     settingsMenu->addAction(autoSkipAction);
 
+    // Взвешенный shuffle: чаще треки с высоким рейтингом и давно не игравшие
+    weightedShuffleAction = settingsMenu->addAction("Shuffle с учетом рейтинга");
+    weightedShuffleAction->setCheckable(true);
+    weightedShuffleAction->setChecked(weightedShuffle_);
+    weightedShuffleAction->setToolTip("Треки с высоким рейтингом и давно не игравшие выпадают чаще");
+    connect(weightedShuffleAction, &QAction::triggered, this, [this](bool checked) {
+        weightedShuffle_ = checked;
+        playlist.setWeightedShuffle(checked);
+        saveSettings();
+    });
+
+    // Shuffle по звучанию: следующий трек подбирается по признакам текущего
+    similarMenu_ = settingsMenu->addMenu("Shuffle по звучанию");
+    QActionGroup* similarGroup = new QActionGroup(similarMenu_);
+    const std::pair<const char*, Playlist::SimilarMode> similarModes[] = {
+        {"Выключен", Playlist::SimilarMode::Off},
+        {"Самый похожий на текущий", Playlist::SimilarMode::Similar},
+        {"Плавные переходы", Playlist::SimilarMode::Smooth},
+    };
+    for (const auto& entry : similarModes) {
+        QAction* action = similarMenu_->addAction(entry.first);
+        action->setCheckable(true);
+        action->setChecked(similarMode_ == entry.second);
+        action->setData(static_cast<int>(entry.second));
+        similarGroup->addAction(action);
+        similarActions_ << action;
+        connect(action, &QAction::triggered, this, [this, mode = entry.second]() { setSimilarMode(mode); });
+    }
+    similarMenu_->setToolTipsVisible(true);
+    similarActions_.last()->setToolTip("Случайный из ближайших по темпу, тембру и тональности");
+
+    // Визуализатор: выключенный скрыт, и звук для него не копируется
+    visualizerAction_ = settingsMenu->addAction("Визуализация спектра");
+    visualizerAction_->setCheckable(true);
+    visualizerAction_->setChecked(visualizerEnabled_);
+    connect(visualizerAction_, &QAction::triggered, this, [this](bool checked) {
+        visualizerEnabled_ = checked;
+        applyVisualizer();
+        saveSettings();
+    });
+
+    // Пропуск тишины: границы звука известны по фоновому анализу треков
+    trimSilenceAction_ = settingsMenu->addAction("Пропускать тишину в начале и конце");
+    trimSilenceAction_->setCheckable(true);
+    trimSilenceAction_->setChecked(trimSilence_);
+    connect(trimSilenceAction_, &QAction::triggered, this, [this](bool checked) {
+        trimSilence_ = checked;
+        publishAudibleRanges();
+        saveSettings();
+    });
+
+    QAction* equalizerAction = settingsMenu->addAction("🎚 Эквалайзер");
+    equalizerAction->setShortcut(QKeySequence("Ctrl+E"));
+    connect(equalizerAction, &QAction::triggered, this, &MainWindow::showEqualizerDialog);
+
     // Меню "Справка"
     helpMenu = menuBar->addMenu("Справка");
 
@@ -1892,15 +3040,20 @@ void MainWindow::showHelpDialog() {
 <b>AlexMusic - Простой музыкальный плеер</b>
 
 <b>Основные возможности:</b><br>
-• Воспроизведение MP3 файлов<br>
+• Воспроизведение MP3, FLAC, Ogg, M4A и WAV файлов<br>
 • Управление плейлистами<br>
 • Поиск и сортировка треков<br>
+• Нечёткий поиск с опечатками (кнопка ≈)<br>
+• Shuffle с учетом рейтинга (меню Настройки)<br>
+• Запросы вида artist:"Daft Punk" rating>=4 album:discovery -live<br>
+• Темп и тональность (анализ в фоне): bpm>=120 bpm<130 key:Am, сортировка кнопкой ♩<br>
+• Пропуск тишины в начале и конце треков (меню Настройки)<br>
 • Рейтинг треков (звездочки)<br>
 • Поддержка обложек альбомов<br>
 
 <b>Установка папки с музыкой:</b><br>
 1. Нажмите кнопку "Выбрать папку с музыкой"<br>
-2. Выберите папку с MP3 файлами<br>
+2. Выберите папку с музыкой<br>
 3. Плеер автоматически отсканирует все треки<br>
 
 <b>Обработка повреждённых треков:</b><br>
@@ -1939,6 +3092,7 @@ void MainWindow::showHotkeysDialog() {
 • Ctrl+G — К текущему треку<br>
 • Ctrl+O — Открыть папку<br>
 • Ctrl+P — Настройки<br>
+• Ctrl+E — Эквалайзер<br>
 • F1 — Горячие клавиши<br>
 • Alt+F4 — Выход<br>
     )";
@@ -1953,7 +3107,7 @@ void MainWindow::showAboutDialog() {
 Простой и удобный музыкальный плеер для Windows.<br>
 
 <b>Основные функции:</b><br>
-• Поддержка MP3 файлов<br>
+• Поддержка MP3, FLAC, Ogg, M4A и WAV файлов<br>
 • Управление плейлистами<br>
 • Рейтинг треков<br>
 • Поиск и фильтрация<br>
@@ -1981,4 +3135,91 @@ void MainWindow::updateMenuBar() {
             break;
         }
     }
+
+    if (visualizerAction_) {
+        visualizerAction_->setChecked(visualizerEnabled_);
+    }
+    if (trimSilenceAction_) {
+        trimSilenceAction_->setChecked(trimSilence_);
+    }
+    if (weightedShuffleAction) {
+        weightedShuffleAction->setChecked(weightedShuffle_);
+    }
+    for (QAction* action : similarActions_) {
+        action->setChecked(action->data().toInt() == static_cast<int>(similarMode_));
+    }
+}
+
+// Режимы воспроизведения из настроек
+void MainWindow::loadPlaybackModes() {
+    QSettings settings("AlexMusic", "Player");
+    savedShuffleState_ = settings.value("shuffleState", false).toBool();
+    savedRepeatMode_ = static_cast<Playlist::RepeatMode>(
+        settings.value("repeatMode", 0).toInt());
+    controls->setShuffleState(savedShuffleState_);
+    controls->setRepeatState(static_cast<int>(savedRepeatMode_));
+}
+
+// Восстановление прошлой сессии до сканирования библиотеки: сразу загружаем
+// сохраненный трек и позицию, плейлист подхватит навигацию после сканирования
+QString MainWindow::restoreSession(const QString& defaultFolder) {
+    if (!sessionStore_.load(pendingSession_)) {
+        return defaultFolder;
+    }
+    sessionPending_ = true;
+
+    QString root = QString::fromStdString(pendingSession_.libraryRoot);
+    QString folder = (!root.isEmpty() && QDir(root).exists()) ? root : defaultFolder;
+
+    QString filePath = QString::fromStdString(pendingSession_.playlist.currentId);
+    if (!QFileInfo::exists(filePath)) {
+        return folder;
+    }
+
+    // Название и исполнитель - из имени файла, как при сканировании
+    QStringList parts = QFileInfo(filePath).baseName().split(" - ", Qt::SkipEmptyParts);
+    artistLabel->setText(parts.value(0, "Unknown Artist"));
+    albumLabel->setText(parts.value(1, QFileInfo(filePath).baseName()));
+
+    pendingSeek_ = pendingSession_.position;
+    player->setSource(QUrl::fromLocalFile(filePath));
+    if (pendingSession_.playing) {
+        player->play();
+        controls->setPlaying(true);
+    }
+    return folder;
+}
+
+// Применение сохраненной навигации к только что отсканированному плейлисту
+void MainWindow::applyPendingSession() {
+    sessionPending_ = false;
+    if (QDir(libraryRoot_) != QDir(QString::fromStdString(pendingSession_.libraryRoot))) {
+        return;  // Открыта другая папка - старая навигация к ней не относится
+    }
+    if (!playlist.restoreSession(pendingSession_.playlist)) {
+        qDebug() << "Сессия: сохраненный трек не найден в библиотеке";
+    }
+}
+
+// Запись снимка сессии
+void MainWindow::saveSession() {
+    seekIndexStore_.save();  // Кэш индексов перемотки - вместе с сессией
+    stagingCache_.save();
+
+    // Пока снимок не применен, плейлист еще не отражает сессию - не затираем ее
+    if (sessionPending_ || playlist.size() == 0) return;
+
+    SessionStore::Snapshot snapshot;
+    snapshot.libraryRoot = libraryRoot_.toStdString();
+    snapshot.position = player->position();
+    snapshot.playing = player->playbackState() == QMediaPlayer::PlayingState;
+    snapshot.playlist = playlist.session();
+
+    // Если играет не текущий трек плейлиста (например, после открытия другой папки) - позиция не его
+    auto current = playlist.current();
+    if (!current || player->source() != QUrl::fromLocalFile(QString::fromStdString(current->path()))) {
+        snapshot.position = 0;
+        snapshot.playing = false;
+    }
+    sessionStore_.save(snapshot);
 }
@@ -2,18 +2,37 @@
 
 #include <QMainWindow>      // Основное окно приложения
 #include <QMediaPlayer>     // Медиаплеер Qt
-#include <QAudioOutput>     // Аудиовыход
 #include <QLabel>           // Текстовая метка
 #include <QListWidget>      // Список элементов
 #include <QLineEdit>        // Поле ввода текста
 #include <QPushButton>      // Кнопка
 #include <QSettings>
+#include <QTimer>           // Периодическое сохранение сессии
+#include <QSet>
 
 #include "Playlist.h"       // Наш класс плейлиста
 #include "PlayerControls.h" // Наш класс элементов управления
+#include "PlaybackController.h" // Плеер в отдельном потоке
 #include "TrackValidator.h"
 #include "SettingsDialog.h"
 #include "BadTrackDialog.h"
+#include "SearchIndex.h"
+#include "SearchQuery.h"
+#include "PlayHistory.h"
+#include "SessionStore.h"
+#include "StartupProfiler.h"
+#include "UiUpdateScheduler.h"
+#include "TaskScheduler.h"
+#include "SeekIndexStore.h"
+#include "CoverStore.h"
+#include "LibraryAudit.h"
+#include "StagingCache.h"
+#include "SpectrumWidget.h"
+#include "WaveformStore.h"
+#include "EqualizerDialog.h"
+#include "TrackIdStore.h"
+#include "DuplicateFinder.h"
+#include "FeatureStore.h"
 
 
 // Главное окно приложения
@@ -31,6 +50,9 @@ protected:
     bool nativeEvent(const QByteArray &eventType, void *message, qintptr *result) override;
     // Обработчик события показа окна
     void showEvent(QShowEvent* event) override;
+    // Скрытие и сворачивание окна - обновления интерфейса приостанавливаются
+    void hideEvent(QHideEvent* event) override;
+    void changeEvent(QEvent* event) override;
 
      bool eventFilter(QObject* watched, QEvent* event) override;
 
@@ -46,10 +68,13 @@ private slots:
     void onVolumeChanged(int volume); // Изменение громкости
     void onPositionChanged(qint64 position); // Изменение позиции трека
     void onDurationChanged(qint64 duration); // Изменение длительности трека
+    void flushUi(unsigned regions);  // Перерисовка накопленных областей за кадр
     void onMediaStatusChanged(QMediaPlayer::MediaStatus status); // Изменение статуса медиа
+    void onTrackFinished(const QUrl& finished, const QUrl& next); // Трек доигран (next - куда уже перешел плеер)
     void onTrackListDoubleClicked(QListWidgetItem* item); // Двойной клик по треку в списке
     void onMuteToggled(bool muted); // Включение/выключение звука
     void onRatingChanged(int rating); // Изменение рейтинга трека
+    void onSourceChanged(const QUrl& source); // Смена трека в плеере - запись в историю
 
     // Слоты для поиска и фильтрации
     void onSearchTextChanged(const QString& text); // Изменение текста поиска
@@ -59,6 +84,7 @@ private slots:
     void onSortAlphabeticalClicked();  // Сортировка по алфавиту
     void onSortStandardClicked();      // Стандартная сортировка
     void onSortReverseClicked();       // Обратная сортировка
+    void onSortMusicClicked();         // Сортировка по темпу, затем по тональности
 
     void onScrollToCurrentClicked();   // Прокрутка к текущему треку
 
@@ -70,7 +96,11 @@ private:
 
     void scanFolder(const QString& path);  // Сканирование папки с музыкой
     void playCurrentTrack();               // Воспроизведение текущего трека
-    void updateUI();                       // Обновление интерфейса
+    void updateUI();                       // Обновление интерфейса (всех частей панели)
+    void updateCover();                    // Обложка - при смене трека или размера
+    void updateTrackText();                // Название, исполнитель, статистика
+    void updateRatingStars();              // Звезды рейтинга
+    void updateListSelection();            // Выделение текущего трека в списке
     void restartCurrentTrack();            // Перезапуск текущего трека
     void setupRatingStars();               // Настройка звезд рейтинга
 
@@ -94,8 +124,7 @@ private:
 
     // Основные объекты приложения    
     Playlist playlist;                // Плейлист
-    QMediaPlayer* player;             // Медиаплеер Qt
-    QAudioOutput* audioOutput;        // Аудиовыход
+    PlaybackController* player;       // Воспроизведение (в отдельном потоке)
 
     // Элементы интерфейса
     QPushButton* settingsBtn;
@@ -107,10 +136,35 @@ private:
     QLabel* genreLabel;               // Метка жанра (в данный момент не используется)
     QListWidget* trackList;           // Список треков
     PlayerControls* controls;         // Панель управления
+    UiUpdateScheduler* uiScheduler_ = nullptr; // Обновление интерфейса не чаще раза за кадр
+
+    // Что сейчас показано в панели "сейчас играет" - для пропуска неизменившихся частей
+    QString shownCoverKey_;           // Трек, чья обложка на экране
+    QSize shownCoverSize_;            // Размер, под который она масштабирована
+    double shownRating_ = -1.0;       // Рейтинг, отображаемый звездами
+
+    CoverStore coverStore_{QSize(250, 250)}; // Обложки по содержимому (размер - как у coverLabel)
+    CancellationToken coverScanToken_; // Фоновый подсчет хэшей обложек
+    CancellationToken tagScanToken_;   // Фоновое чтение тегов
+    void readTagsAsync(const QStringList& paths); // Теги файлов без "Исполнитель - Название" в имени
+    void scanCovers();                // Привязка треков к обложкам при сканировании
+    void applyTrackIds();             // Новые отпечатки -> треки, рейтинги, журнал
 
     // Элементы поиска и фильтрации
     QLineEdit* searchEdit;            // Поле ввода для поиска
     QPushButton* clearSearchBtn;      // Кнопка очистки поиска
+    QPushButton* fuzzySearchBtn;      // Переключатель нечёткого поиска
+
+    // Нечёткий поиск
+    SearchIndex searchIndex_;         // Свёрнутые поля треков для поиска с опечатками
+    bool searchIndexDirty_ = true;    // Индекс нужно перестроить (сменился состав/порядок)
+    bool fuzzySearch_ = false;        // Включён ли нечёткий поиск
+    void applyFuzzySearch(const QString& text); // Фильтрация и подсветка по нечёткому поиску
+    void applyStructuredSearch(const SearchQuery& query); // Запрос вида artist:"..." rating>=4
+    void showSearchHits(const std::vector<SearchIndex::Hit>& hits); // Показ и подсветка результатов
+    void ensureSearchIndex();         // Перестраивает индекс, если он устарел
+    void rebuildSearchIndexAsync();   // Сборка индекса в пуле по снимку библиотеки
+    CancellationToken searchIndexToken_; // Текущая фоновая сборка индекса
 
     QPushButton* scrollToCurrentBtn;  // Кнопка прокрутки к текущему треку
 
@@ -118,23 +172,109 @@ private:
     QPushButton* sortAlphabeticalBtn; // Сортировка А-Я
     QPushButton* sortStandardBtn;     // Стандартная сортировка
     QPushButton* sortReverseBtn;      // Обратная сортировка
+    QPushButton* sortMusicBtn;        // Сортировка по темпу / тональности
 
     // Создание меню
     QMenuBar* menuBar;
     QMenu* fileMenu;
     QMenu* settingsMenu;
     QMenu* helpMenu;
+    QAction* weightedShuffleAction = nullptr; // Пункт "Shuffle с учетом рейтинга"
+    QMenu* similarMenu_ = nullptr;            // Подменю "Shuffle по звучанию" (в заголовке - ход анализа)
+    QList<QAction*> similarActions_;          // Его режимы (data - Playlist::SimilarMode)
+    QAction* visualizerAction_ = nullptr;     // Пункт "Визуализация спектра"
+    QAction* trimSilenceAction_ = nullptr;    // Пункт "Пропускать тишину в начале и конце"
+    SpectrumWidget* spectrumWidget_ = nullptr;
+    bool visualizerEnabled_ = true;
+    bool trimSilence_ = false;        // Треки играются от первого до последнего слышимого отсчета
+    void applyVisualizer();                   // Показ визуализатора и отвод звука для него
+    bool equalizerEnabled_ = false;           // Звук через DspChain (DspPlayer)
+    void showEqualizerDialog();
 
     // Данные для сортировки
     std::vector<Track> originalTracks_; // Оригинальный порядок треков
     bool isAlphabeticalSort_ = false;   // Флаг алфавитной сортировки
     bool isReverseSort_ = false;        // Флаг обратной сортировки
+    bool isBpmSort_ = false;            // Флаг сортировки по темпу
+    bool isKeySort_ = false;            // Флаг сортировки по тональности (круг Camelot)
 
     // ЭЛЕМЕНТЫ ДЛЯ РЕЙТИНГА
     QPushButton* starButtons[5];      // Массив из 5 кнопок-звезд
 
     int volumeBeforeMute_ = 70;       // Громкость до отключения звука
 
+    // История прослушиваний
+    PlayHistory playHistory_;         // Журнал запусков/пропусков (history.log)
+    std::string historyTrackId_;      // Трек, для которого записан последний старт
+    qint64 lastPosition_ = 0;         // Последняя известная позиция (для записи пропуска)
+    bool historyTrackFinished_ = false; // Трек дослушан до конца - пропуск не пишем
+
+    // Восстановление сессии
+    SessionStore sessionStore_;       // Снимок сессии (session.txt)
+    SessionStore::Snapshot pendingSession_; // Загруженный снимок, ждущий окончания сканирования
+    bool sessionPending_ = false;     // Снимок еще не применен к плейлисту
+    qint64 pendingSeek_ = -1;         // Позиция, на которую перейти после загрузки трека
+    QString libraryRoot_;             // Текущая папка библиотеки
+    QTimer* sessionTimer_ = nullptr;  // Периодическое сохранение сессии
+    QString restoreSession(const QString& defaultFolder); // Запуск трека из снимка; возвращает папку библиотеки
+    void applyPendingSession();       // Применение навигации из снимка после сканирования
+    void saveSession();               // Запись снимка текущей сессии
+
+    void handleEndOfTrack();          // Выбор следующего трека, когда плеер не перешел сам
+    void updateUpNext();              // Сообщить плееру следующий трек заранее
+
+    LibraryAudit* libraryAudit_ = nullptr; // Проверка целостности библиотеки (audit.txt)
+    TrackIdStore* trackIds_ = nullptr;     // Идентификаторы треков по содержимому (trackids.txt)
+    DuplicateFinder* duplicateFinder_ = nullptr; // Акустические отпечатки (fingerprints.txt)
+    FeatureStore* featureStore_ = nullptr; // Признаки звучания (features.txt)
+    static constexpr int kMusicInfoStep = 64; // Треков анализа между обновлениями темпа и тональности
+    QSet<QString> hiddenTracks_;           // Скрытые копии - в плейлист не попадают
+    void showLibraryAudit();          // Диалог проверки с отчетом
+    void showDuplicates();            // Копии треков: поиск и скрытие
+    void setSimilarMode(Playlist::SimilarMode mode); // Режим подбора по звучанию из меню
+    void startFeatureAnalysis();      // Фоновый анализ треков без признаков
+    void rebuildSimilarity();         // Индекс похожих по признакам треков плейлиста
+    void applyMusicInfo();            // Темп и тональность из признаков -> треки и поиск
+    void publishAudibleRanges();      // Границы звука из признаков -> плеер (пропуск тишины)
+    void hideTracks(const QStringList& paths);  // Убрать файлы из плейлиста (не с диска)
+
+    // Перемотка: индекс кадров MP3 и схлопывание повторов клавиш
+    SeekIndexStore seekIndexStore_;   // Кэш индексов перемотки (seekindex.txt)
+    SeekIndexStore::IndexPtr currentSeekIndex_; // Индекс играющего трека (может отсутствовать)
+    QSet<QString> seekIndexPending_;  // Файлы, для которых индекс уже строится
+    QTimer* seekTimer_ = nullptr;     // Задержка команды перемотки при автоповторе клавиш
+    qint64 seekTarget_ = -1;          // Цель еще не отправленной перемотки
+    void seekTo(qint64 position, bool coalesce); // Перемотка с выравниванием по кадру
+    qint64 seekBase() const;          // Позиция, от которой отсчитывается следующий шаг
+    void requestSeekIndex(const QString& path, TaskPriority priority); // Построение индекса в пуле
+
+    // Локальные копии треков с сетевых дисков: текущий и несколько следующих
+    static constexpr int kDefaultStagingMb = 1024;  // Бюджет кэша копий по умолчанию
+    static constexpr size_t kStageAhead = 3;        // Треков после следующего
+    StagingCache stagingCache_;
+    void stageUpcoming(const std::optional<size_t>& next); // Копирование треков по порядку игры
+
+    // Обзор формы волны под полосой перемотки (папка peaks)
+    WaveformStore waveformStore_;
+    QSet<QString> waveformPending_;   // Файлы, для которых обзор уже строится
+    CancellationToken waveformToken_; // Общий для всех построений - отмена при выходе
+    void requestWaveform(const QString& path, TaskPriority priority); // Декодирование трека в пуле
+
+    // Поэтапный запуск: окно показывается сразу, тяжелые этапы - после первого кадра
+    StartupProfiler startupProfiler_; // Время этапов запуска
+    QString startupFolder_;           // Папка библиотеки при запуске
+    bool startupInProgress_ = true;   // До первого кадра обложка не загружается
+    bool deferredStartupScheduled_ = false;
+    bool libraryFromCache_ = false;   // Плейлист загружен из кэша и еще не сверен с диском
+    void runDeferredStartup();        // Отложенные этапы: обложка, сканирование, диалог настроек
+    void ensureSettingsDialog();      // Создание диалога настроек при первом обращении
+    static QStringList collectTracks(const QString& path); // Обход папки (потокобезопасен)
+    void loadLibrary(const QString& path, const QStringList& files); // Заполнение плейлиста
+    void rescanLibrary(const QString& path, const QStringList& files); // Сверка списка из кэша с диском
+    CancellationToken scanToken_;     // Фоновое сканирование при запуске
+    bool loadLibraryCache(const QString& path, QStringList& files) const;
+    void saveLibraryCache(const QString& path, const QStringList& files) const;
+
     // Для thumbnail toolbar
     void* taskbarList = nullptr;      // Указатель на ITaskbarList3 (COM интерфейс)
     bool thumbnailToolbarInitialized = false; // Флаг инициализации
@@ -157,11 +297,15 @@ private:
 
     // Сохраненные состояния режимов
     bool savedShuffleState_ = false;
+    bool weightedShuffle_ = false;    // Взвешенный shuffle (рейтинг и давность проигрывания)
+    Playlist::SimilarMode similarMode_ = Playlist::SimilarMode::Off; // Shuffle по звучанию
+    int stagingCacheMb_ = kDefaultStagingMb; // Бюджет локальных копий сетевых треков (0 - выключено)
     Playlist::RepeatMode savedRepeatMode_ = Playlist::RepeatMode::None;
 
     // методы для сохранения/загрузки настроек:
     void saveSettings();
     void loadSettings();
+    void loadPlaybackModes();  // Shuffle и повтор из настроек - на кнопки, до первого loadLibrary
 
     // Методы для работы с битыми треками
     bool validateTrack(const QString& filePath);  // Проверка трека
@@ -0,0 +1,30 @@
+// MappedFile.cpp
+#include "MappedFile.h"
+
+MappedFile::MappedFile(const QString& path) : file_(path) {
+    if (file_.open(QIODevice::ReadOnly)) {
+        size_ = file_.size();
+    }
+}
+
+MappedFile::~MappedFile() {
+    file_.close();  // Снимает все отображения файла
+}
+
+ByteView MappedFile::map(qint64 offset, qint64 length) {
+    if (!isOpen() || offset < 0 || length <= 0 || offset >= size_) return {};
+    length = qMin(length, size_ - offset);
+
+    uchar* data = file_.map(offset, length);
+    if (!data) return {};
+    return {data, static_cast<size_t>(length)};
+}
+
+void MappedFile::unmap(ByteView view) {
+    if (view.data) file_.unmap(const_cast<uchar*>(view.data));
+}
+
+ByteView MappedFile::tail(qint64 length) {
+    length = qMin(length, size_);
+    return map(size_ - length, length);
+}
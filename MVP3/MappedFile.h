@@ -0,0 +1,47 @@
+// MappedFile.h
+#pragma once
+#include <QFile>
+#include <QString>
+
+#include <cstddef> // size_t
+
+// Непрерывный участок байтов без владения (указывает в отображенную память)
+struct ByteView {
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+
+    bool empty() const { return size == 0; }
+    // Подучасток с проверкой границ: за пределами - пустой
+    ByteView mid(size_t offset, size_t length) const {
+        if (offset > size) return {};
+        return {data + offset, length < size - offset ? length : size - offset};
+    }
+};
+
+// Доступ к файлу через отображение в память: читаются только нужные
+// участки (начало с тегом, хвост), данные разбираются на месте без копий.
+// Отображения живут, пока жив объект
+class MappedFile {
+public:
+    explicit MappedFile(const QString& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return file_.isOpen(); }
+    QString fileName() const { return file_.fileName(); }
+    qint64 size() const { return size_; }
+
+    // Участок файла; обрезается по концу файла, пустой при ошибке
+    ByteView map(qint64 offset, qint64 length);
+    ByteView head(qint64 length) { return map(0, length); }
+    ByteView tail(qint64 length);
+    ByteView all() { return map(0, size_); }
+    // Снятие отображения до удаления объекта (проход по файлу кусками)
+    void unmap(ByteView view);
+
+private:
+    QFile file_;
+    qint64 size_ = 0;
+};
@@ -0,0 +1,113 @@
+// Mp3Audit.cpp
+#include "Mp3Audit.h"
+#include "Mp3Frame.h" // Разбор заголовков кадров
+#include <cstring>    // std::memcmp
+
+namespace {
+// CRC-16 MPEG audio: полином 0x8005, начальное значение 0xFFFF
+uint16_t crc16(uint16_t crc, const unsigned char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= uint16_t(data[i]) << 8;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) ? uint16_t((crc << 1) ^ 0x8005) : uint16_t(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// Конец звуковых данных: без ID3v1 ("TAG", 128 байт) и APEv2 в хвосте файла
+size_t audioEnd(const unsigned char* data, size_t size) {
+    size_t end = size;
+    if (end >= 128 && std::memcmp(data + end - 128, "TAG", 3) == 0) {
+        end -= 128;
+    }
+    if (end >= 32 && std::memcmp(data + end - 32, "APETAGEX", 8) == 0) {
+        const unsigned char* footer = data + end - 32;
+        size_t tagSize = size_t(footer[12]) | (size_t(footer[13]) << 8) |
+                         (size_t(footer[14]) << 16) | (size_t(footer[15]) << 24);
+        if (footer[23] & 0x80) tagSize += 32;  // Есть еще и заголовок тега
+        end = tagSize <= end ? end - tagSize : 0;
+    }
+    return end;
+}
+}
+
+Mp3Audit::Result Mp3Audit::check(const unsigned char* data, size_t size) {
+    Result result;
+    if (!data || size == 0) {
+        result.issues |= Unreadable;
+        return result;
+    }
+
+    const size_t end = audioEnd(data, size);
+
+    // Тег ID3v2: заявленный размер за концом файла - поток ищем сразу за заголовком
+    size_t pos = mp3Id3v2Size(data, size);
+    if (pos > end) {
+        result.issues |= BogusId3Size;
+        pos = 10;
+    }
+
+    Mp3FrameHeader first;
+    size_t start = mp3FindSync(data, end, pos, first);
+    if (start >= end && pos > 10) {
+        // За тегом звука нет - возможно, размер тега завышен и поток внутри него
+        start = mp3FindSync(data, end, 10, first);
+        if (start < end) result.issues |= BogusId3Size;
+    }
+    if (start >= end) {
+        result.issues |= NoAudio;
+        return result;
+    }
+    pos = start;
+    if (mp3IsInfoFrame(data + pos, first)) {
+        pos += first.frameSize;
+    }
+
+    uint64_t samples = 0;
+    Mp3FrameHeader h;
+    while (pos < end) {
+        if (pos + 4 > end || !Mp3FrameHeader::parse(data + pos, h) || !first.sameStream(h)) {
+            // Посреди потока не кадр - ищем следующий
+            size_t resync = mp3FindSync(data, end, pos + 1, h);
+            if (resync >= end) {
+                // До конца только мусор: хвост меньше кадра - это обрыв, иначе потеря синхронизации
+                if (end - pos < first.frameSize) result.issues |= TruncatedTail;
+                else result.issues |= SyncLost;
+                ++result.syncErrors;
+                break;
+            }
+            result.issues |= SyncLost;
+            ++result.syncErrors;
+            pos = resync;
+            continue;
+        }
+        if (pos + h.frameSize > end) {
+            result.issues |= TruncatedTail;
+            break;
+        }
+
+        // CRC Layer III: байты 2-3 заголовка и side info, сумма - сразу за заголовком
+        if (h.hasCrc && h.layer == 3 && h.frameSize >= 6 + h.sideInfoSize) {
+            const unsigned char* frame = data + pos;
+            uint16_t crc = crc16(0xFFFF, frame + 2, 2);
+            crc = crc16(crc, frame + 6, h.sideInfoSize);
+            ++result.crcChecked;
+            if (crc != ((uint16_t(frame[4]) << 8) | frame[5])) {
+                ++result.crcErrors;
+                result.issues |= CrcMismatch;
+            }
+        }
+
+        ++result.frames;
+        samples += h.samplesPerFrame;
+        pos += h.frameSize;
+    }
+
+    if (result.frames == 0) {
+        result.issues |= NoAudio;
+    } else {
+        result.durationMs = static_cast<int64_t>(samples * 1000 / first.sampleRate);
+    }
+    return result;
+}
@@ -0,0 +1,37 @@
+// Mp3Audit.h
+#pragma once
+#include <cstddef> // size_t
+#include <cstdint> // int64_t, uint32_t
+
+// Глубокая проверка целостности MP3 по содержимому файла: проход по
+// цепочке кадров с восстановлением синхронизации, CRC-16 кадров Layer III
+// (если кодировщик их записал), обрезанный хвост, поврежденный размер
+// ID3v2 и отсутствие звука
+class Mp3Audit {
+public:
+    // Найденные проблемы (битовая маска)
+    enum Issue : unsigned {
+        Unreadable    = 1,   // Файл не открылся или пустой
+        NoAudio       = 2,   // Ни одного кадра звука
+        BogusId3Size  = 4,   // Размер тега ID3v2 не сходится с файлом
+        TruncatedTail = 8,   // Последний кадр обрезан
+        SyncLost      = 16,  // Мусор посреди потока - синхронизацию пришлось искать заново
+        CrcMismatch   = 32   // Не совпала контрольная сумма кадра
+    };
+    // Проблемы, при которых трек не воспроизвести - навигация его пропускает
+    static constexpr unsigned BrokenMask = Unreadable | NoAudio;
+
+    struct Result {
+        unsigned issues = 0;
+        uint32_t frames = 0;       // Кадров звука
+        uint32_t crcChecked = 0;   // Кадров с CRC
+        uint32_t crcErrors = 0;
+        uint32_t syncErrors = 0;   // Разрывов цепочки кадров
+        int64_t durationMs = 0;
+
+        bool isBroken() const { return (issues & BrokenMask) != 0; }
+        bool isClean() const { return issues == 0; }
+    };
+
+    static Result check(const unsigned char* data, size_t size);
+};
@@ -0,0 +1,79 @@
+// Mp3Frame.cpp
+#include "Mp3Frame.h"
+#include <cstring> // std::memcmp
+
+namespace {
+// Битрейты, кбит/с: [MPEG1 L1, L2, L3, MPEG2/2.5 L1, L2/L3][индекс]
+const uint16_t kBitrates[5][16] = {
+    {0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448, 0},
+    {0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 0},
+    {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0},
+    {0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256, 0},
+    {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0},
+};
+const uint32_t kSampleRates[3] = {44100, 48000, 32000};  // Для MPEG1
+}
+
+bool Mp3FrameHeader::parse(const unsigned char* p, Mp3FrameHeader& h) {
+    if (p[0] != 0xFF || (p[1] & 0xE0) != 0xE0) return false;
+
+    int versionBits = (p[1] >> 3) & 3;
+    int layerBits = (p[1] >> 1) & 3;
+    int bitrateIndex = p[2] >> 4;
+    int rateIndex = (p[2] >> 2) & 3;
+    if (versionBits == 1 || layerBits == 0 || bitrateIndex == 0 || bitrateIndex == 15 || rateIndex == 3) {
+        return false;  // Зарезервированные значения и free format не поддерживаем
+    }
+
+    h.version = versionBits == 3 ? 1 : (versionBits == 2 ? 2 : 25);
+    h.layer = 4 - layerBits;
+    h.mono = ((p[3] >> 6) & 3) == 3;
+    h.hasCrc = (p[1] & 1) == 0;
+    h.sampleRate = kSampleRates[rateIndex] / (h.version == 1 ? 1 : (h.version == 2 ? 2 : 4));
+
+    int table = h.version == 1 ? h.layer - 1 : (h.layer == 1 ? 3 : 4);
+    uint32_t bitrate = kBitrates[table][bitrateIndex] * 1000u;
+    uint32_t padding = (p[2] >> 1) & 1;
+
+    if (h.layer == 1) {
+        h.samplesPerFrame = 384;
+        h.frameSize = (12 * bitrate / h.sampleRate + padding) * 4;
+    } else {
+        h.samplesPerFrame = (h.layer == 3 && h.version != 1) ? 576 : 1152;
+        h.frameSize = h.samplesPerFrame / 8 * bitrate / h.sampleRate + padding;
+    }
+    h.sideInfoSize = h.layer != 3 ? 0 : (h.version == 1 ? (h.mono ? 17 : 32) : (h.mono ? 9 : 17));
+    return h.frameSize > 4;
+}
+
+bool Mp3FrameHeader::sameStream(const Mp3FrameHeader& other) const {
+    return version == other.version && layer == other.layer && sampleRate == other.sampleRate;
+}
+
+size_t mp3Id3v2Size(const unsigned char* data, size_t size) {
+    if (size < 10 || std::memcmp(data, "ID3", 3) != 0) return 0;
+    size_t tagSize = (size_t(data[6] & 0x7F) << 21) | (size_t(data[7] & 0x7F) << 14) |
+                     (size_t(data[8] & 0x7F) << 7) | size_t(data[9] & 0x7F);
+    return 10 + tagSize + ((data[5] & 0x10) ? 10 : 0);  // Плюс футер
+}
+
+bool mp3IsInfoFrame(const unsigned char* p, const Mp3FrameHeader& h) {
+    size_t sideInfo = h.version == 1 ? (h.mono ? 17 : 32) : (h.mono ? 9 : 17);
+    if (h.frameSize >= 4 + sideInfo + 4) {
+        const unsigned char* tag = p + 4 + sideInfo;
+        if (std::memcmp(tag, "Xing", 4) == 0 || std::memcmp(tag, "Info", 4) == 0) return true;
+    }
+    return h.frameSize >= 40 && std::memcmp(p + 36, "VBRI", 4) == 0;
+}
+
+size_t mp3FindSync(const unsigned char* data, size_t size, size_t pos, Mp3FrameHeader& header) {
+    for (; pos + 4 <= size; ++pos) {
+        if (!Mp3FrameHeader::parse(data + pos, header)) continue;
+        size_t next = pos + header.frameSize;
+        Mp3FrameHeader second;
+        if (next + 4 <= size && Mp3FrameHeader::parse(data + next, second) && header.sameStream(second)) {
+            return pos;
+        }
+    }
+    return size;
+}
@@ -0,0 +1,33 @@
+// Mp3Frame.h
+#pragma once
+#include <cstddef> // size_t
+#include <cstdint> // uint32_t
+
+// Заголовок кадра MPEG audio (Layer I-III) и служебные функции разбора
+// потока MP3: общие для индекса перемотки и проверки целостности
+struct Mp3FrameHeader {
+    int version = 0;            // 1 - MPEG1, 2 - MPEG2, 25 - MPEG2.5
+    int layer = 0;              // 1, 2, 3
+    bool mono = false;
+    bool hasCrc = false;        // За заголовком идет CRC-16
+    uint32_t sampleRate = 0;
+    uint32_t samplesPerFrame = 0;
+    uint32_t frameSize = 0;     // Вместе с заголовком
+    uint32_t sideInfoSize = 0;  // Layer III: размер side info после заголовка (и CRC)
+
+    // Разбор 4 байт заголовка; false - не заголовок или free format
+    static bool parse(const unsigned char* p, Mp3FrameHeader& header);
+    // Тот же поток: версия, слой и частота совпадают
+    bool sameStream(const Mp3FrameHeader& other) const;
+};
+
+// Размер тега ID3v2 в начале файла, как он записан в заголовке (0 - тега нет);
+// может быть больше файла, если тег поврежден
+size_t mp3Id3v2Size(const unsigned char* data, size_t size);
+
+// Служебный кадр Xing/Info/VBRI в начале VBR файлов - без звука
+bool mp3IsInfoFrame(const unsigned char* frame, const Mp3FrameHeader& header);
+
+// Первый кадр начиная с pos, за которым сразу идет еще один кадр того же
+// потока (защита от ложной синхронизации); size - если не найден
+size_t mp3FindSync(const unsigned char* data, size_t size, size_t pos, Mp3FrameHeader& header);
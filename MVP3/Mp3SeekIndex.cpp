@@ -0,0 +1,115 @@
+// Mp3SeekIndex.cpp
+#include "Mp3SeekIndex.h"
+#include "Mp3Frame.h" // Разбор заголовков кадров
+#include <algorithm> // std::min
+#include <sstream>
+#include <stdexcept> // Ошибки std::stoul/stoll при разборе
+
+bool Mp3SeekIndex::build(const unsigned char* data, size_t size) {
+    *this = Mp3SeekIndex();
+
+    // Первый кадр: за ним должен сразу идти еще один корректный кадр,
+    // иначе случайные байты 0xFF в мусоре перед потоком дадут ложную синхронизацию
+    // Размер тега за концом файла - тег поврежден, поток ищем сразу за его заголовком
+    size_t tagEnd = mp3Id3v2Size(data, size);
+    if (tagEnd >= size) tagEnd = std::min<size_t>(10, size);
+    Mp3FrameHeader first;
+    size_t pos = mp3FindSync(data, size, tagEnd, first);
+    if (pos + 4 > size) return false;
+
+    sampleRate_ = first.sampleRate;
+    samplesPerFrame_ = first.samplesPerFrame;
+    if (mp3IsInfoFrame(data + pos, first)) {
+        pos += first.frameSize;
+    }
+
+    // Проход по цепочке кадров до конца потока (тег ID3v1/APE или обрыв)
+    Mp3FrameHeader h;
+    while (pos + 4 <= size && Mp3FrameHeader::parse(data + pos, h) && first.sameStream(h)) {
+        if (pos + h.frameSize > size) break;  // Обрезанный последний кадр не считаем
+        if (frameCount_ % kStride == 0) {
+            offsets_.push_back(static_cast<int64_t>(pos));
+        }
+        ++frameCount_;
+        pos += h.frameSize;
+    }
+    return isValid();
+}
+
+double Mp3SeekIndex::frameDurationMs() const {
+    return sampleRate_ ? 1000.0 * samplesPerFrame_ / sampleRate_ : 0.0;
+}
+
+int64_t Mp3SeekIndex::durationMs() const {
+    return sampleRate_ ? int64_t(frameCount_) * samplesPerFrame_ * 1000 / sampleRate_ : 0;
+}
+
+int64_t Mp3SeekIndex::frameStartMs(int64_t positionMs) const {
+    if (!isValid() || positionMs <= 0) return 0;
+    int64_t frame = positionMs * sampleRate_ / (int64_t(samplesPerFrame_) * 1000);
+    frame = std::min<int64_t>(frame, frameCount_ - 1);
+    return frame * samplesPerFrame_ * 1000 / sampleRate_;
+}
+
+Mp3SeekIndex::SeekPoint Mp3SeekIndex::seekPoint(int64_t positionMs) const {
+    SeekPoint point;
+    if (!isValid() || offsets_.empty()) return point;
+
+    // Времена опорных точек возрастают с шагом kStride кадров - двоичный поиск
+    // по номеру точки без хранения самих времен
+    const int64_t strideMs1000 = int64_t(kStride) * samplesPerFrame_ * 1000;
+    auto timeOf = [&](size_t i) { return int64_t(i) * strideMs1000 / sampleRate_; };
+    size_t lo = 0, hi = offsets_.size();
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (timeOf(mid) <= positionMs) lo = mid; else hi = mid;
+    }
+    point.timeMs = timeOf(lo);
+    point.offset = offsets_[lo];
+    return point;
+}
+
+std::string Mp3SeekIndex::serialize() const {
+    std::ostringstream out;
+    out << sampleRate_ << ',' << samplesPerFrame_ << ',' << frameCount_ << ';';
+    int64_t previous = 0;
+    for (size_t i = 0; i < offsets_.size(); ++i) {
+        out << (i ? "," : "") << offsets_[i] - previous;  // Приращения короче абсолютных смещений
+        previous = offsets_[i];
+    }
+    return out.str();
+}
+
+bool Mp3SeekIndex::parse(const std::string& line, Mp3SeekIndex& index) {
+    index = Mp3SeekIndex();
+    std::istringstream iss(line);
+    std::string rate, samples, frames, offsets;
+    if (!std::getline(iss, rate, ',') || !std::getline(iss, samples, ',') ||
+        !std::getline(iss, frames, ';')) {
+        return false;
+    }
+    std::getline(iss, offsets);
+
+    try {
+        index.sampleRate_ = static_cast<uint32_t>(std::stoul(rate));
+        index.samplesPerFrame_ = static_cast<uint32_t>(std::stoul(samples));
+        index.frameCount_ = static_cast<uint32_t>(std::stoul(frames));
+        std::istringstream list(offsets);
+        std::string item;
+        int64_t offset = 0;
+        while (std::getline(list, item, ',')) {
+            offset += std::stoll(item);
+            index.offsets_.push_back(offset);
+        }
+    } catch (const std::exception&) {
+        index = Mp3SeekIndex();
+        return false;
+    }
+
+    // Число опорных точек должно соответствовать числу кадров
+    if (!index.isValid() || index.offsets_.size() != (index.frameCount_ + kStride - 1) / kStride) {
+        index = Mp3SeekIndex();
+        return false;
+    }
+    return true;
+}
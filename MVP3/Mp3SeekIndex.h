@@ -0,0 +1,46 @@
+// Mp3SeekIndex.h
+#pragma once
+#include <cstddef> // size_t
+#include <cstdint> // int64_t, uint32_t
+#include <string>
+#include <vector>
+
+// Индекс кадров MP3 для точной перемотки в VBR файлах.
+// Строится одним проходом по заголовкам кадров: у всех кадров файла
+// одинаковая длительность, поэтому время кадра вычисляется по его номеру,
+// а смещения в файле хранятся для каждого kStride-го кадра (опорные точки).
+// Поиск кадра по времени - O(1), опорной точки - двоичным поиском по таблице.
+// По опорной точке DspPlayer начинает декодирование с нужного места файла
+class Mp3SeekIndex {
+public:
+    static constexpr uint32_t kStride = 32;  // Кадров между опорными точками (~0.8 с)
+
+    // Опорная точка: начало кадра во времени и в файле
+    struct SeekPoint {
+        int64_t timeMs = 0;
+        int64_t offset = 0;
+    };
+
+    // Разбор содержимого файла; false - если это не поток MPEG audio
+    bool build(const unsigned char* data, size_t size);
+
+    bool isValid() const { return frameCount_ > 0 && sampleRate_ > 0; }
+    uint32_t frameCount() const { return frameCount_; }
+    double frameDurationMs() const;
+    int64_t durationMs() const;  // Точная длительность по числу кадров
+
+    // Начало кадра, в который попадает позиция (с ограничением длительностью)
+    int64_t frameStartMs(int64_t positionMs) const;
+    // Ближайшая опорная точка не позже позиции
+    SeekPoint seekPoint(int64_t positionMs) const;
+
+    // Одна строка для кэша без '|': "частота,сэмплов_в_кадре,кадров;смещения_приращениями"
+    std::string serialize() const;
+    static bool parse(const std::string& line, Mp3SeekIndex& index);
+
+private:
+    uint32_t sampleRate_ = 0;
+    uint32_t samplesPerFrame_ = 0;
+    uint32_t frameCount_ = 0;
+    std::vector<int64_t> offsets_;  // Смещение кадра i * kStride
+};
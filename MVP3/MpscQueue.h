@@ -0,0 +1,58 @@
+// MpscQueue.h
+#pragma once
+#include <atomic>
+#include <optional>
+#include <utility> // std::move
+
+// Неблокирующая очередь "много производителей - один потребитель"
+// (узловая очередь Вьюкова). push() можно вызывать из любых потоков
+// без блокировок, pop() - только из одного потока-потребителя
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() {
+        Node* stub = new Node();
+        head_.store(stub, std::memory_order_relaxed);
+        tail_ = stub;
+    }
+
+    ~MpscQueue() {
+        while (pop()) {}
+        delete tail_;
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T value) {
+        Node* node = new Node(std::move(value));
+        // Захватываем место в голове и связываем предыдущий узел с новым
+        Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // Следующий элемент или nullopt, если очередь пуста (или производитель
+    // еще не успел связать только что добавленный узел)
+    std::optional<T> pop() {
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (!next) return std::nullopt;
+
+        std::optional<T> value(std::move(*next->value));
+        next->value.reset();
+        tail_ = next;  // next становится новой заглушкой
+        delete tail;
+        return value;
+    }
+
+private:
+    struct Node {
+        Node() = default;
+        explicit Node(T v) : value(std::move(v)) {}
+        std::atomic<Node*> next{nullptr};
+        std::optional<T> value;
+    };
+
+    std::atomic<Node*> head_;  // Куда добавляют производители
+    Node* tail_;               // Откуда читает потребитель
+};
@@ -0,0 +1,90 @@
+// PcmDecoder.cpp
+#include "PcmDecoder.h"
+#include <QAudioBuffer>
+#include <QAudioDecoder>
+#include <QEventLoop>
+#include <QTimer>
+#include <QUrl>
+
+#include <vector>
+
+namespace {
+const int kDecodeTimeoutMs = 120000; // Зависший декодер не держит поток пула вечно
+
+// Среднее каналов одного формата отсчетов
+template <typename Sample, typename Convert>
+void mixDown(const QAudioBuffer& buffer, int channels, std::vector<float>& mono, Convert convert) {
+    const Sample* data = buffer.constData<Sample>();
+    const float scale = 1.0f / channels;
+    for (size_t i = 0; i < mono.size(); ++i) {
+        float sum = 0.0f;
+        for (int c = 0; c < channels; ++c) sum += convert(data[i * channels + c]);
+        mono[i] = sum * scale;
+    }
+}
+
+// Блок декодера -> моно float; false - формат отсчетов не поддерживается
+bool toMono(const QAudioBuffer& buffer, std::vector<float>& mono) {
+    const QAudioFormat format = buffer.format();
+    const int channels = format.channelCount();
+    if (channels <= 0 || buffer.frameCount() <= 0) return false;
+
+    mono.resize(static_cast<size_t>(buffer.frameCount()));  // Емкость растет только до самого большого блока
+    switch (format.sampleFormat()) {
+    case QAudioFormat::Float:
+        mixDown<float>(buffer, channels, mono, [](float x) { return x; });
+        return true;
+    case QAudioFormat::Int16:
+        mixDown<qint16>(buffer, channels, mono, [](qint16 x) { return x / 32768.0f; });
+        return true;
+    case QAudioFormat::Int32:
+        mixDown<qint32>(buffer, channels, mono, [](qint32 x) { return x / 2147483648.0f; });
+        return true;
+    case QAudioFormat::UInt8:
+        mixDown<quint8>(buffer, channels, mono, [](quint8 x) { return (x - 128) / 128.0f; });
+        return true;
+    default:
+        return false;
+    }
+}
+}
+
+bool PcmDecoder::decodeMono(const QString& path, const CancellationToken& token, const Sink& sink) {
+    QAudioDecoder decoder;
+    QEventLoop loop;
+    QTimer timeout;
+    timeout.setSingleShot(true);
+
+    std::vector<float> mono;
+    bool failed = false;
+
+    QObject::connect(&decoder, &QAudioDecoder::bufferReady, &loop, [&]() {
+        const QAudioBuffer buffer = decoder.read();
+        if (token.isCancelled()) {
+            failed = true;
+            decoder.stop();
+            loop.quit();
+            return;
+        }
+        if (toMono(buffer, mono)) {
+            sink(mono.data(), mono.size(), static_cast<uint32_t>(buffer.format().sampleRate()));
+        }
+    });
+    QObject::connect(&decoder, &QAudioDecoder::finished, &loop, &QEventLoop::quit);
+    QObject::connect(&decoder, qOverload<QAudioDecoder::Error>(&QAudioDecoder::error), &loop,
+                     [&](QAudioDecoder::Error) {
+                         failed = true;
+                         loop.quit();
+                     });
+    QObject::connect(&timeout, &QTimer::timeout, &loop, [&]() {
+        failed = true;
+        decoder.stop();
+        loop.quit();
+    });
+
+    decoder.setSource(QUrl::fromLocalFile(path));
+    decoder.start();
+    timeout.start(kDecodeTimeoutMs);
+    loop.exec();
+    return !failed;
+}
@@ -0,0 +1,22 @@
+// PcmDecoder.h
+#pragma once
+#include <QString>
+
+#include <cstddef>    // size_t
+#include <cstdint>    // uint32_t
+#include <functional>
+
+#include "TaskScheduler.h" // CancellationToken
+
+// Декодирование трека целиком в моно float - общий вход фонового анализа
+// (обзор формы волны, акустический отпечаток). QAudioDecoder работает через
+// события, поэтому вызов крутит собственный цикл в текущем потоке - только
+// в пуле. Блоки неподдерживаемого формата отсчетов пропускаются
+class PcmDecoder {
+public:
+    // Блок декодера: отсчеты -1..1 (среднее каналов), их число и частота
+    using Sink = std::function<void(const float* samples, size_t count, uint32_t sampleRate)>;
+
+    // false - ошибка декодера, зависание или отмена
+    static bool decodeMono(const QString& path, const CancellationToken& token, const Sink& sink);
+};
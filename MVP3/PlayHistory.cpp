@@ -0,0 +1,222 @@
+// PlayHistory.cpp
+#include "PlayHistory.h"
+#include <QSaveFile> // Атомарная перезапись журнала
+#include <algorithm> // std::max
+#include <chrono>   // Текущее время
+#include <sstream>  // Разбор строк журнала
+
+namespace {
+// Сколько последних событий хранится в памяти и переживает сжатие
+const size_t kTailSize = 1000;
+// Порог сырых событий, после которого журнал сжимается
+const size_t kCompactThreshold = 5000;
+}
+
+PlayHistory::PlayHistory(std::string filePath)
+    : filePath_(std::move(filePath)), tail_(kTailSize) {}
+
+PlayHistory::~PlayHistory() {
+    if (out_.is_open()) {
+        out_.close();
+    }
+}
+
+int64_t PlayHistory::now() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+// Строки журнала:
+//   S|плейкаунт|скипы|последний запуск|trackId  - итоговая строка после сжатия
+//   B|время|позиция|trackId                      - старт (E - конец, K - пропуск)
+bool PlayHistory::parseLine(const std::string& line, Record& r, Stats& summary, bool& isSummary) {
+    if (line.size() < 3 || line[1] != '|') return false;
+
+    std::istringstream iss(line.substr(2));
+    char sep = 0;
+    isSummary = line[0] == 'S';
+
+    if (isSummary) {
+        if (!(iss >> summary.playCount >> sep >> summary.skipCount >> sep
+                  >> summary.lastPlayed >> sep)) {
+            return false;
+        }
+    } else {
+        if (line[0] != static_cast<char>(Event::Start) && line[0] != static_cast<char>(Event::End) &&
+            line[0] != static_cast<char>(Event::Skip)) {
+            return false;
+        }
+        r.event = static_cast<Event>(line[0]);
+        if (!(iss >> r.timestamp >> sep >> r.position >> sep)) {
+            return false;
+        }
+    }
+
+    std::getline(iss, r.trackId);
+    return !r.trackId.empty();
+}
+
+void PlayHistory::writeRecord(std::ostream& out, const Record& r) {
+    out << static_cast<char>(r.event) << '|' << r.timestamp << '|' << r.position << '|'
+        << r.trackId << '\n';
+}
+
+void PlayHistory::apply(const Record& r) {
+    Stats& s = stats_[r.trackId];
+    switch (r.event) {
+    case Event::Start:
+        ++s.playCount;
+        s.lastPlayed = r.timestamp;
+        break;
+    case Event::Skip:
+        ++s.skipCount;
+        break;
+    case Event::End:
+        break;
+    }
+    tail_.push(r);
+}
+
+void PlayHistory::load() {
+    stats_.clear();
+    tail_.clear();
+    eventsSinceCompaction_ = 0;
+
+    std::ifstream file(filePath_);
+    if (file.is_open()) {
+        std::string line;
+        while (std::getline(file, line)) {
+            Record r;
+            Stats summary;
+            bool isSummary = false;
+            if (!parseLine(line, r, summary, isSummary)) {
+                continue;  // Оборванная при сбое строка - пропускаем
+            }
+
+            if (isSummary) {
+                stats_[r.trackId] = summary;
+            } else {
+                apply(r);
+                ++eventsSinceCompaction_;
+            }
+        }
+        file.close();
+    }
+
+    if (eventsSinceCompaction_ > kCompactThreshold) {
+        compact();
+    }
+}
+
+bool PlayHistory::openForAppend() {
+    if (!out_.is_open()) {
+        out_.open(filePath_, std::ios::app);
+    }
+    return out_.is_open();
+}
+
+void PlayHistory::record(Event event, const std::string& trackId, int64_t positionMs) {
+    if (trackId.empty()) return;
+
+    Record r;
+    r.timestamp = now();
+    r.event = event;
+    r.position = positionMs;
+    r.trackId = trackId;
+    apply(r);
+
+    if (openForAppend()) {
+        writeRecord(out_, r);
+        out_.flush();  // Событие не должно потеряться при аварийном выходе
+        ++eventsSinceCompaction_;
+    }
+
+    // Периодическое сжатие: сырых событий заметно больше, чем треков
+    if (eventsSinceCompaction_ > kCompactThreshold && eventsSinceCompaction_ > 2 * stats_.size()) {
+        compact();
+    }
+}
+
+PlayHistory::Stats PlayHistory::stats(const std::string& trackId) const {
+    auto it = stats_.find(trackId);
+    return it != stats_.end() ? it->second : Stats();
+}
+
+std::vector<std::string> PlayHistory::recentStarts(size_t maxCount) const {
+    std::vector<std::string> result;
+    for (size_t i = tail_.size(); i-- > 0 && result.size() < maxCount;) {
+        const Record& r = tail_.at(i);
+        if (r.event == Event::Start) {
+            result.push_back(r.trackId);
+        }
+    }
+    return std::vector<std::string>(result.rbegin(), result.rend());
+}
+
+void PlayHistory::compact() {
+    if (out_.is_open()) {
+        out_.close();
+    }
+
+    // Итоговые строки отражают счетчики ДО событий хвоста - иначе при
+    // повторной загрузке хвост учелся бы дважды
+    std::unordered_map<std::string, Stats> base = stats_;
+    for (size_t i = 0; i < tail_.size(); ++i) {
+        const Record& r = tail_.at(i);
+        Stats& s = base[r.trackId];
+        if (r.event == Event::Start) --s.playCount;
+        if (r.event == Event::Skip) --s.skipCount;
+    }
+
+    // Файл подменяется целиком только после успешной записи - журнал не бывает
+    // наполовину записанным, и сбой посреди сжатия оставляет прежний
+    std::ostringstream tmp;
+    for (const auto& entry : base) {
+        const Stats& s = entry.second;
+        if (s.playCount <= 0 && s.skipCount <= 0 && s.lastPlayed == 0) continue;
+        tmp << "S|" << s.playCount << '|' << s.skipCount << '|' << s.lastPlayed << '|'
+            << entry.first << '\n';
+    }
+    for (size_t i = 0; i < tail_.size(); ++i) {
+        writeRecord(tmp, tail_.at(i));
+    }
+
+    const std::string data = tmp.str();
+    QSaveFile file(QString::fromStdString(filePath_));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) return;
+    file.write(data.data(), static_cast<qint64>(data.size()));
+    if (file.commit()) {
+        eventsSinceCompaction_ = tail_.size();
+    }
+}
+
+void PlayHistory::relink(const std::vector<std::pair<std::string, std::string>>& moves) {
+    std::unordered_map<std::string, std::string> target;
+    for (const auto& move : moves) {
+        auto it = stats_.find(move.first);
+        if (move.first == move.second || it == stats_.end()) continue;
+
+        const Stats from = it->second;
+        Stats& to = stats_[move.second];
+        to.playCount += from.playCount;
+        to.skipCount += from.skipCount;
+        to.lastPlayed = std::max(to.lastPlayed, from.lastPlayed);
+        stats_.erase(move.first);
+        target.emplace(move.first, move.second);
+    }
+    if (target.empty()) return;
+
+    // События хвоста - тоже под новыми идентификаторами (иначе сжатие вычтет их не у того трека)
+    std::vector<Record> tail;
+    tail.reserve(tail_.size());
+    for (size_t i = 0; i < tail_.size(); ++i) {
+        Record r = tail_.at(i);
+        auto it = target.find(r.trackId);
+        if (it != target.end()) r.trackId = it->second;
+        tail.push_back(std::move(r));
+    }
+    tail_.clear();
+    for (const Record& r : tail) tail_.push(r);
+
+    compact();
+}
@@ -0,0 +1,71 @@
+// PlayHistory.h
+#pragma once
+#include <cstdint>       // int64_t
+#include <fstream>       // Файл журнала
+#include <string>
+#include <unordered_map> // Счетчики по трекам
+#include <utility>       // std::pair
+#include <vector>
+
+#include "RingBuffer.h"  // Хвост последних событий
+
+// Журнал прослушиваний: каждое событие (старт, конец, пропуск) дописывается
+// в конец текстового файла. Агрегированные счетчики держатся в памяти и
+// доступны за O(1). Когда журнал разрастается, он сжимается: счетчики
+// записываются итоговыми строками, из сырых событий остается только хвост
+class PlayHistory {
+public:
+    enum class Event : char { Start = 'B', End = 'E', Skip = 'K' };
+
+    // Агрегированная статистика трека
+    struct Stats {
+        int playCount = 0;        // Сколько раз трек запускался
+        int skipCount = 0;        // Сколько раз его пропустили, не дослушав
+        int64_t lastPlayed = 0;   // Время последнего запуска (мс с эпохи), 0 - никогда
+    };
+
+    // Одна запись журнала
+    struct Record {
+        int64_t timestamp = 0;    // мс с эпохи
+        Event event = Event::Start;
+        int64_t position = 0;     // Позиция в треке, мс
+        std::string trackId;      // Идентификатор трека (Track::getID)
+    };
+
+    explicit PlayHistory(std::string filePath);
+    ~PlayHistory();
+
+    // Загрузка журнала с диска (и сжатие, если он слишком большой)
+    void load();
+
+    // Дописывает событие в журнал и обновляет счетчики
+    void record(Event event, const std::string& trackId, int64_t positionMs);
+
+    // Статистика трека за O(1); нулевая, если трек ни разу не играл
+    Stats stats(const std::string& trackId) const;
+
+    // Последние запуски (самый свежий - последним), не больше maxCount
+    std::vector<std::string> recentStarts(size_t maxCount) const;
+
+    // Переписывает журнал: итоговые строки + хвост последних событий
+    void compact();
+
+    // Перенос истории на новые идентификаторы (старый -> новый; счетчики
+    // складываются) с перезаписью журнала. Так записи по путям переходят на
+    // отпечатки содержимого, когда те посчитаны
+    void relink(const std::vector<std::pair<std::string, std::string>>& moves);
+
+    static int64_t now();
+
+private:
+    void apply(const Record& r);              // Учет события в счетчиках
+    static bool parseLine(const std::string& line, Record& r, Stats& summary, bool& isSummary);
+    static void writeRecord(std::ostream& out, const Record& r);
+    bool openForAppend();
+
+    std::string filePath_;
+    std::ofstream out_;                                // Открыт на дозапись
+    std::unordered_map<std::string, Stats> stats_;     // trackId -> счетчики
+    RingBuffer<Record> tail_;                          // Последние события
+    size_t eventsSinceCompaction_ = 0;                 // Сырых событий в файле
+};
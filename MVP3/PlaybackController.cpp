@@ -0,0 +1,389 @@
+// PlaybackController.cpp
+#include "PlaybackController.h"
+#include <QFileInfo> // Быстрая проверка следующего трека
+#include <QAudioBuffer>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+#include <QAudioBufferOutput> // Копия декодированного звука для визуализатора
+#endif
+#include <optional>
+
+#include "DspPlayer.h"
+#include "StagingCache.h"
+
+namespace {
+// Тишина короче не пропускается: лишняя перемотка ради долей секунды
+const qint64 kMinSilenceMs = 250;
+}
+
+PlaybackController::PlaybackController(QObject* parent) : QObject(parent) {
+    snapshot_ = std::make_shared<const State>();
+
+    // Контроллер вместе с плеером переезжает в собственный поток
+    thread_ = new QThread();
+    thread_->setObjectName("Playback");
+    moveToThread(thread_);
+    thread_->start(QThread::HighPriority);
+
+    QMetaObject::invokeMethod(this, &PlaybackController::initPlayer, Qt::BlockingQueuedConnection);
+}
+
+PlaybackController::~PlaybackController() {
+    // Плеер удаляется в своем потоке, затем поток останавливается
+    QMetaObject::invokeMethod(this, [this]() {
+        delete player_;
+        delete audioOutput_;
+        delete dspPlayer_;
+        dspPlayer_ = nullptr;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+        delete bufferOutput_;
+        bufferOutput_ = nullptr;
+#endif
+        player_ = nullptr;
+        audioOutput_ = nullptr;
+    }, Qt::BlockingQueuedConnection);
+
+    thread_->quit();
+    thread_->wait();
+    delete thread_;
+}
+
+// Оба плеера подключены всегда, но состояние меняет только активный:
+// выключенный в момент переключения сообщает о своей остановке
+template <typename Backend>
+void PlaybackController::connectBackend(Backend* backend) {
+    auto active = [this, backend]() {
+        return dspActive_ ? static_cast<QObject*>(backend) == dspPlayer_
+                          : static_cast<QObject*>(backend) == player_;
+    };
+    connect(backend, &Backend::sourceChanged, this, [this, active](const QUrl& source) {
+        if (!active()) return;
+        // Наружу - исходный путь, даже если играет локальная копия
+        const QUrl logical = source.isEmpty() ? QUrl() : logicalSource_;
+        if (switching_ && logical == state_.source) return;  // Смена плеера, а не трека
+        state_.source = logical;
+        publish();
+        emit sourceChanged(state_.source);
+    });
+    connect(backend, &Backend::positionChanged, this, [this, active](qint64 position) {
+        if (active()) onPosition(position);
+    });
+    connect(backend, &Backend::durationChanged, this, [this, active](qint64 duration) {
+        if (!active()) return;
+        state_.duration = duration;
+        publish();
+        emit durationChanged(duration);
+    });
+    connect(backend, &Backend::playbackStateChanged, this, [this, active](QMediaPlayer::PlaybackState state) {
+        if (!active()) return;
+        state_.playbackState = state;
+        publish();
+        emit playbackStateChanged(state);
+    });
+    connect(backend, &Backend::mediaStatusChanged, this, [this, active](QMediaPlayer::MediaStatus status) {
+        if (active()) onMediaStatus(status);
+    });
+}
+
+template <typename Fn>
+void PlaybackController::withBackend(Fn fn) {
+    if (dspActive_) {
+        fn(*dspPlayer_);
+    } else {
+        fn(*player_);
+    }
+}
+
+void PlaybackController::initPlayer() {
+    player_ = new QMediaPlayer();
+    audioOutput_ = new QAudioOutput();
+    player_->setAudioOutput(audioOutput_);
+    connectBackend(player_);
+
+    dspPlayer_ = new DspPlayer(dsp_);
+    connectBackend(dspPlayer_);
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+    // Подключается к плееру, только пока визуализатор включен
+    bufferOutput_ = new QAudioBufferOutput();
+    connect(bufferOutput_, &QAudioBufferOutput::audioBufferReceived, this, &PlaybackController::onAudioBuffer);
+#endif
+}
+
+std::shared_ptr<const PlaybackController::State> PlaybackController::state() const {
+    return std::atomic_load(&snapshot_);
+}
+
+void PlaybackController::publish() {
+    std::atomic_store(&snapshot_, std::make_shared<const State>(state_));
+}
+
+// Команды
+
+void PlaybackController::setSource(const QUrl& source) { post({Command::SetSource, source}); }
+void PlaybackController::play() { post({Command::Play, {}}); }
+void PlaybackController::pause() { post({Command::Pause, {}}); }
+void PlaybackController::stop() { post({Command::Stop, {}}); }
+void PlaybackController::setPosition(qint64 position) { post({Command::Seek, {}, position}); }
+void PlaybackController::setNextSource(const QUrl& next) { post({Command::SetNext, next}); }
+
+void PlaybackController::setAudioTapEnabled(bool enabled) {
+    post({Command::SetTap, {}, enabled ? 1 : 0});
+}
+
+void PlaybackController::setDspEnabled(bool enabled) {
+    post({Command::SetDsp, {}, enabled ? 1 : 0});
+}
+
+void PlaybackController::setSeekIndex(const QUrl& source, std::shared_ptr<const Mp3SeekIndex> index) {
+    Command command{Command::SetSeekIndex, source};
+    command.seekIndex = std::move(index);
+    post(command);
+}
+
+void PlaybackController::setVolume(float volume) {
+    Command command{Command::SetVolume, {}};
+    command.volume = volume;
+    post(command);
+}
+
+void PlaybackController::post(Command command) {
+    commands_.push(std::move(command));
+    // Одно пробуждение на пачку команд
+    if (!drainScheduled_.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, &PlaybackController::drain, Qt::QueuedConnection);
+    }
+}
+
+void PlaybackController::drain() {
+    // acquire - парная к exchange в post(): команды, положенные до флага, видны pop()
+    drainScheduled_.exchange(false, std::memory_order_acq_rel);
+
+    // Подряд идущие перемотки схлопываются в последнюю
+    std::optional<qint64> seek;
+    while (std::optional<Command> command = commands_.pop()) {
+        if (command->type == Command::Seek) {
+            seek = command->value;
+            continue;
+        }
+        if (seek) {
+            seekTo(*seek);
+            seek.reset();
+        }
+        apply(*command);
+    }
+    if (seek) {
+        seekTo(*seek);
+    }
+}
+
+// Перемотка по команде отменяет отложенную позицию загрузки (смена плеера, пропуск тишины),
+// иначе та перекрыла бы ее после загрузки трека
+void PlaybackController::seekTo(qint64 position) {
+    switchPosition_ = -1;
+    withBackend([position](auto& backend) { backend.setPosition(position); });
+}
+
+void PlaybackController::apply(const Command& command) {
+    switch (command.type) {
+    case Command::SetSource:
+        state_.nextSource.clear();  // Следующий трек относился к прежнему
+        switchPosition_ = -1;
+        load(command.url);
+        break;
+    case Command::Play:
+        withBackend([](auto& backend) { backend.play(); });
+        break;
+    case Command::Pause:
+        withBackend([](auto& backend) { backend.pause(); });
+        break;
+    case Command::Stop:
+        withBackend([](auto& backend) { backend.stop(); });
+        break;
+    case Command::Seek:
+        Q_UNREACHABLE();  // Перемотки схлопываются и выполняются в drain()
+        break;
+    case Command::SetVolume:
+        audioOutput_->setVolume(command.volume);
+        dspPlayer_->setVolume(command.volume);
+        break;
+    case Command::SetNext:
+        state_.nextSource = command.url;
+        publish();
+        break;
+    case Command::SetTap:
+        tapEnabled_ = command.value != 0;
+        updateTap();
+        break;
+    case Command::SetDsp:
+        switchBackend(command.value != 0);
+        break;
+    case Command::SetSeekIndex:
+        if (command.url != logicalSource_) break;  // Индекс уже сменившегося трека
+        seekIndex_ = command.seekIndex;
+        dspPlayer_->setSeekIndex(seekIndex_);
+        break;
+    }
+}
+
+void PlaybackController::updateTap() {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+    player_->setAudioBufferOutput(tapEnabled_ && !dspActive_ ? bufferOutput_ : nullptr);
+#endif
+    dspPlayer_->setAudioTap(tapEnabled_ && dspActive_ ? &tap_ : nullptr);
+}
+
+// Трек продолжается на другом плеере с той же позиции; GUI видит только
+// смену состояния загрузки, но не смену трека
+void PlaybackController::switchBackend(bool dsp) {
+    if (dsp == dspActive_) return;
+    const QMediaPlayer::PlaybackState playback = state_.playbackState;
+    const qint64 position = state_.position;
+
+    // Сначала смена активного - сигналы выгружаемого плеера уже не учитываются
+    dspActive_ = dsp;
+    if (dsp) {
+        player_->setSource(QUrl());
+    } else {
+        dspPlayer_->setSource(QUrl());
+    }
+    updateTap();
+    if (state_.source.isEmpty()) return;
+
+    switching_ = true;
+    load(state_.source);
+    switching_ = false;
+    switchPosition_ = position > 0 ? position : -1;  // Перемотка - после загрузки (см. onMediaStatus)
+    if (playback == QMediaPlayer::PlayingState) {
+        withBackend([](auto& backend) { backend.play(); });
+    } else if (playback == QMediaPlayer::PausedState) {
+        withBackend([](auto& backend) { backend.pause(); });
+    }
+}
+
+void PlaybackController::onMediaStatus(QMediaPlayer::MediaStatus status) {
+    state_.mediaStatus = status;
+
+    if (switchPosition_ >= 0 && (status == QMediaPlayer::LoadedMedia || status == QMediaPlayer::BufferedMedia)) {
+        const qint64 position = switchPosition_;
+        switchPosition_ = -1;
+        withBackend([position](auto& backend) { backend.setPosition(position); });
+    }
+
+    if (status != QMediaPlayer::EndOfMedia) {
+        publish();
+        emit mediaStatusChanged(status);
+        return;
+    }
+    if (rangeEnded_) {
+        publish();  // Трек уже завершен на конце звука - хвост тишины доигран впустую
+        return;
+    }
+    finishTrack();
+}
+
+void PlaybackController::onPosition(qint64 position) {
+    state_.position = position;
+    publish();
+    emit positionChanged(position);
+
+    // Конец звука: дальше только тишина - завершаем трек, как по концу файла.
+    // Перемотка назад снова делает трек незавершенным
+    if (range_.endMs <= 0 || state_.duration - range_.endMs < kMinSilenceMs) return;
+    if (position < range_.endMs) {
+        rangeEnded_ = false;
+    } else if (!rangeEnded_ && state_.playbackState == QMediaPlayer::PlayingState) {
+        rangeEnded_ = true;
+        finishTrack();
+    }
+}
+
+// Трек доигран - переходим к следующему, не дожидаясь GUI
+void PlaybackController::finishTrack() {
+    QUrl finished = state_.source;
+    QUrl next = state_.nextSource;
+    state_.nextSource.clear();
+    if (!next.isEmpty() && next != finished && !QFileInfo::exists(next.toLocalFile())) {
+        next.clear();  // Файл пропал - выбор остается за GUI
+    }
+    publish();
+
+    // Сначала итог трека, затем смена источника - GUI обработает их в этом порядке
+    emit trackFinished(finished, next);
+
+    if (next.isEmpty()) {
+        // Следующий выберет GUI; тишина в конце файла до него не звучит
+        if (rangeEnded_) withBackend([](auto& backend) { backend.pause(); });
+        return;
+    }
+    if (next == finished) {
+        const qint64 start = range_.startMs;
+        withBackend([start](auto& backend) { backend.setPosition(start); });  // Повтор одного трека
+    } else {
+        load(next);
+    }
+    withBackend([](auto& backend) { backend.play(); });
+}
+
+void PlaybackController::load(const QUrl& source) {
+    if (source != logicalSource_) seekIndex_.reset();  // Смена плеера сохраняет индекс трека
+    logicalSource_ = source;
+
+    // Границы звука нового трека; короткая тишина не пропускается
+    range_ = AudibleRange();
+    rangeEnded_ = false;
+    if (auto ranges = std::atomic_load(&ranges_)) {
+        const AudibleRange range = ranges->value(source.toLocalFile());
+        if (range.startMs >= kMinSilenceMs) range_.startMs = range.startMs;
+        if (range.endMs > range.startMs) range_.endMs = range.endMs;
+    }
+
+    QUrl playable = source;
+    StagingCache* staging = staging_.load(std::memory_order_acquire);
+    if (staging && source.isLocalFile()) {
+        const QString local = staging->localPath(source.toLocalFile());
+        if (!local.isEmpty()) playable = QUrl::fromLocalFile(local);
+    }
+    withBackend([&](auto& backend) { backend.setSource(playable); });
+    dspPlayer_->setSeekIndex(seekIndex_);  // setSource его сбрасывает
+    if (range_.startMs > 0 && !switching_) switchPosition_ = range_.startMs;  // Перемотка - после загрузки
+}
+
+namespace {
+// Кадры блока в кольцо: первый канал - левый, второй (если есть) - правый
+template <typename Sample, typename Convert>
+qsizetype tapFrames(AudioTap& tap, const QAudioBuffer& buffer, int channels, Convert convert) {
+    const Sample* data = buffer.constData<Sample>();
+    const qsizetype frames = qMin<qsizetype>(buffer.frameCount(), AudioTap::kCapacity);
+    const int right = channels > 1 ? 1 : 0;
+    for (qsizetype i = 0; i < frames; ++i) {
+        const Sample* frame = data + i * channels;
+        tap.put(static_cast<size_t>(i), convert(frame[0]), convert(frame[right]));
+    }
+    return frames;
+}
+}
+
+void PlaybackController::onAudioBuffer(const QAudioBuffer& buffer) {
+    const QAudioFormat format = buffer.format();
+    const int channels = format.channelCount();
+    if (channels <= 0 || buffer.frameCount() <= 0) return;
+
+    qsizetype frames = 0;
+    switch (format.sampleFormat()) {
+    case QAudioFormat::Float:
+        frames = tapFrames<float>(tap_, buffer, channels, [](float x) { return x; });
+        break;
+    case QAudioFormat::Int16:
+        frames = tapFrames<qint16>(tap_, buffer, channels, [](qint16 x) { return x / 32768.0f; });
+        break;
+    case QAudioFormat::Int32:
+        frames = tapFrames<qint32>(tap_, buffer, channels, [](qint32 x) { return x / 2147483648.0f; });
+        break;
+    case QAudioFormat::UInt8:
+        frames = tapFrames<quint8>(tap_, buffer, channels, [](quint8 x) { return (x - 128) / 128.0f; });
+        break;
+    default:
+        return;
+    }
+    tap_.commit(static_cast<size_t>(frames), static_cast<uint32_t>(format.sampleRate()));
+}
@@ -0,0 +1,158 @@
+// PlaybackController.h
+#pragma once
+#include <QObject>
+#include <QMediaPlayer>  // Медиаплеер Qt (живет в потоке контроллера)
+#include <QAudioOutput>  // Аудиовыход
+#include <QThread>
+#include <QUrl>
+#include <QHash>
+#include <QtGlobal>      // QT_VERSION_CHECK
+
+#include <atomic>
+#include <memory>        // std::shared_ptr для снимков состояния
+
+#include "MpscQueue.h"   // Неблокирующая очередь команд
+#include "AudioTap.h"    // PCM для визуализатора
+#include "DspChain.h"    // Эквалайзер, предусилитель и лимитер
+
+class QAudioBuffer;
+class QAudioBufferOutput;
+
+class StagingCache;
+class DspPlayer;
+class Mp3SeekIndex;
+
+// Управление воспроизведением в отдельном потоке.
+// QMediaPlayer и аудиовыход живут в собственном потоке контроллера, поэтому
+// долгая перерисовка или модальный диалог в GUI не задерживают переход
+// к следующему треку: GUI заранее сообщает следующий трек (setNextSource),
+// и по окончании текущего контроллер переключается сам, а GUI лишь
+// догоняет плейлист по сигналу trackFinished.
+// Методы-команды можно вызывать из любого потока - они кладутся в
+// неблокирующую очередь; геттеры читают последний опубликованный снимок.
+// Источники снаружи всегда исходные пути треков: локальная копия из
+// StagingCache подставляется только при передаче в QMediaPlayer.
+// С включенным эквалайзером вместо QMediaPlayer играет DspPlayer
+// (декодер -> DspChain -> QAudioSink) с тем же набором сигналов
+class PlaybackController : public QObject {
+    Q_OBJECT
+
+public:
+    // Неизменяемый снимок состояния плеера
+    struct State {
+        QUrl source;
+        qint64 position = 0;
+        qint64 duration = 0;
+        QMediaPlayer::PlaybackState playbackState = QMediaPlayer::StoppedState;
+        QMediaPlayer::MediaStatus mediaStatus = QMediaPlayer::NoMedia;
+        QUrl nextSource;  // Трек, на который контроллер перейдет сам
+    };
+
+    // Границы звука трека из анализа тишины, мс. Трек начинается с startMs
+    // и считается доигранным на endMs, как если бы файл там кончался
+    struct AudibleRange {
+        qint64 startMs = 0;
+        qint64 endMs = 0;  // 0 - до конца файла
+    };
+    using AudibleRanges = QHash<QString, AudibleRange>;  // По исходным путям
+
+    explicit PlaybackController(QObject* parent = nullptr);
+    ~PlaybackController() override;
+
+    // Команды (из любого потока)
+    void setSource(const QUrl& source);
+    void play();
+    void pause();
+    void stop();
+    void setPosition(qint64 position);
+    void setVolume(float volume);          // 0.0 - 1.0
+    void setNextSource(const QUrl& next);  // Пустой - по окончании трека решает GUI
+    // Отвод PCM в audioTap() (QAudioBufferOutput, Qt 6.8+); выключен - звук не копируется
+    void setAudioTapEnabled(bool enabled);
+    // Кэш локальных копий сетевых треков (должен жить дольше контроллера)
+    void setStagingCache(StagingCache* cache) { staging_.store(cache, std::memory_order_release); }
+    // Воспроизведение через цепочку обработки; переключение сохраняет трек и позицию
+    void setDspEnabled(bool enabled);
+    // Индекс кадров MP3 для трека source: DspPlayer перематывает по опорным
+    // точкам. Для другого трека, чем загружен, команда ничего не делает
+    void setSeekIndex(const QUrl& source, std::shared_ptr<const Mp3SeekIndex> index);
+    // Параметры цепочки меняются напрямую из любого потока, без команд
+    DspChain& dsp() { return dsp_; }
+    // Пропуск тишины в начале и конце треков (nullptr - выключен). Неизменяемая
+    // таблица читается только при загрузке трека - воспроизведение не замедляется
+    void setAudibleRanges(std::shared_ptr<const AudibleRanges> ranges) { std::atomic_store(&ranges_, std::move(ranges)); }
+
+    // Последнее опубликованное состояние (из любого потока)
+    std::shared_ptr<const State> state() const;
+    QUrl source() const { return state()->source; }
+    qint64 position() const { return state()->position; }
+    qint64 duration() const { return state()->duration; }
+    QMediaPlayer::PlaybackState playbackState() const { return state()->playbackState; }
+    QMediaPlayer::MediaStatus mediaStatus() const { return state()->mediaStatus; }
+    const AudioTap& audioTap() const { return tap_; }  // Читается из любого потока
+
+signals:
+    // Испускаются в потоке контроллера; в GUI доставляются через очередь событий
+    void sourceChanged(const QUrl& source);
+    void positionChanged(qint64 position);
+    void durationChanged(qint64 duration);
+    void playbackStateChanged(QMediaPlayer::PlaybackState state);
+    void mediaStatusChanged(QMediaPlayer::MediaStatus status);  // Кроме EndOfMedia - см. trackFinished
+    // Трек доигран. next - трек, на который контроллер уже переключился сам
+    // (равен finished при повторе одного трека); пустой - следующий выбирает GUI
+    void trackFinished(const QUrl& finished, const QUrl& next);
+
+private:
+    struct Command {
+        enum Type { SetSource, Play, Pause, Stop, Seek, SetVolume, SetNext, SetTap, SetDsp, SetSeekIndex } type;
+        QUrl url;
+        qint64 value = 0;
+        float volume = 0.0f;
+        std::shared_ptr<const Mp3SeekIndex> seekIndex;
+    };
+
+    void post(Command command);      // Постановка команды и пробуждение потока
+    void drain();                    // Выполнение накопленных команд (поток контроллера)
+    void apply(const Command& command);
+    void seekTo(qint64 position);    // Перемотка активного плеера по команде
+    void initPlayer();               // Создание плеера в потоке контроллера
+    template <typename Backend>
+    void connectBackend(Backend* backend); // Сигналы плеера -> состояние (от активного плеера)
+    template <typename Fn>
+    void withBackend(Fn fn);         // Команда активному плееру
+    void switchBackend(bool dsp);    // Перенос трека, позиции и состояния на другой плеер
+    void updateTap();                // Отвод звука - от активного плеера
+    void onMediaStatus(QMediaPlayer::MediaStatus status);
+    void onPosition(qint64 position);  // Позиция плеера -> состояние, конец звука трека
+    void finishTrack();                // Трек доигран: переход к следующему
+    void publish();                  // Публикация нового снимка
+    void load(const QUrl& source);   // Передача источника плееру (с подстановкой копии)
+    void onAudioBuffer(const QAudioBuffer& buffer); // Блок PCM -> audioTap (поток контроллера)
+
+    QThread* thread_ = nullptr;
+    QMediaPlayer* player_ = nullptr;
+    QAudioOutput* audioOutput_ = nullptr;
+    QAudioBufferOutput* bufferOutput_ = nullptr;  // Только Qt 6.8+
+    AudioTap tap_;
+    bool tapEnabled_ = false;
+
+    DspChain dsp_;
+    DspPlayer* dspPlayer_ = nullptr;
+    bool dspActive_ = false;         // Играет DspPlayer
+    bool switching_ = false;         // Тот же трек на другом плеере - не смена трека
+    qint64 switchPosition_ = -1;     // Позиция для нового плеера после загрузки трека
+
+    std::atomic<StagingCache*> staging_{nullptr};
+    QUrl logicalSource_;             // Исходный путь того, что сейчас загружено в плеер
+    std::shared_ptr<const Mp3SeekIndex> seekIndex_;  // Индекс кадров logicalSource_ (если есть)
+
+    std::shared_ptr<const AudibleRanges> ranges_;  // std::atomic_load/store
+    AudibleRange range_;             // Границы звука загруженного трека (пропускаемые)
+    bool rangeEnded_ = false;        // Конец звука пройден - трек уже завершен
+
+    MpscQueue<Command> commands_;
+    std::atomic<bool> drainScheduled_{false};
+
+    State state_;                            // Рабочая копия (поток контроллера)
+    std::shared_ptr<const State> snapshot_;  // Опубликованный снимок (std::atomic_load/store)
+};
@@ -3,6 +3,11 @@
 #include <QVBoxLayout>   // Вертикальная компоновка
 #include <QMouseEvent>   // События мыши
 #include <QStyle>        // Стили Qt
+#include <QPainter>      // Рисование обзора формы волны
+#include <QResizeEvent>
+
+#include <algorithm>     // std::max, std::min
+#include <cstdlib>       // std::abs
 
 // Реализация обработчика мыши для ClickableSlider
 void ClickableSlider::mousePressEvent(QMouseEvent* event) {
@@ -18,6 +23,77 @@ void ClickableSlider::mousePressEvent(QMouseEvent* event) {
     QSlider::mousePressEvent(event);
 }
 
+void ClickableSlider::setWaveform(std::shared_ptr<const WaveformPeaks> peaks) {
+    waveform_ = std::move(peaks);
+    renderWaveform();
+    update();
+}
+
+void ClickableSlider::resizeEvent(QResizeEvent* event) {
+    QSlider::resizeEvent(event);
+    renderWaveform();
+}
+
+// Каждый пиксель ширины - огибающая min/max (светлее) и RMS (плотнее) своих столбцов.
+// Высота нормируется по самому громкому месту, чтобы тихие записи тоже были видны
+void ClickableSlider::renderWaveform() {
+    playedWaveform_ = QPixmap();
+    pendingWaveform_ = QPixmap();
+    if (!waveform_ || !waveform_->isValid() || width() <= 0 || height() <= 0) return;
+
+    const auto& buckets = waveform_->buckets();
+    int loudest = 1;
+    for (const WaveformPeaks::Bucket& bucket : buckets) {
+        loudest = std::max({loudest, std::abs(int(bucket.min)), std::abs(int(bucket.max))});
+    }
+
+    const qreal ratio = devicePixelRatioF();
+    const int w = width();
+    const qreal middle = height() / 2.0;
+    const qreal scale = (middle - 1.0) / loudest;
+
+    auto render = [&](QColor color) {
+        QPixmap pixmap(QSize(w, height()) * ratio);
+        pixmap.setDevicePixelRatio(ratio);
+        pixmap.fill(Qt::transparent);
+        QPainter painter(&pixmap);
+        QColor envelope = color;
+        envelope.setAlpha(110);
+
+        const size_t count = buckets.size();
+        for (int x = 0; x < w; ++x) {
+            const size_t first = size_t(x) * count / w;
+            const size_t last = std::max(first + 1, size_t(x + 1) * count / w);
+            int low = 0, high = 0, rms = 0;
+            for (size_t i = first; i < last && i < count; ++i) {
+                low = std::min(low, int(buckets[i].min));
+                high = std::max(high, int(buckets[i].max));
+                rms = std::max(rms, int(buckets[i].rms));
+            }
+            painter.fillRect(QRectF(x, middle - high * scale, 1.0, (high - low) * scale + 1.0), envelope);
+            const qreal rmsHeight = rms / 255.0 * 127.0 * scale;
+            painter.fillRect(QRectF(x, middle - rmsHeight, 1.0, 2.0 * rmsHeight + 1.0), color);
+        }
+        return pixmap;
+    };
+    playedWaveform_ = render(QColor("#0078d4"));
+    pendingWaveform_ = render(QColor("#888888"));
+}
+
+void ClickableSlider::paintEvent(QPaintEvent* event) {
+    if (!playedWaveform_.isNull()) {
+        QPainter painter(this);
+        const int played = QStyle::sliderPositionFromValue(minimum(), maximum(), value(), width());
+        const qreal ratio = playedWaveform_.devicePixelRatio();
+        // Две части готовых картинок: до ползунка и после
+        painter.drawPixmap(QRectF(0, 0, played, height()), playedWaveform_,
+                           QRectF(0, 0, played * ratio, height() * ratio));
+        painter.drawPixmap(QRectF(played, 0, width() - played, height()), pendingWaveform_,
+                           QRectF(played * ratio, 0, (width() - played) * ratio, height() * ratio));
+    }
+    QSlider::paintEvent(event);  // Желоб и ручка поверх обзора
+}
+
 // Конструктор PlayerControls
 PlayerControls::PlayerControls(QWidget* parent) : QWidget(parent) {
     // Создание кнопок с иконками-эмодзи
@@ -42,6 +118,7 @@ PlayerControls::PlayerControls(QWidget* parent) : QWidget(parent) {
     // Создание слайдера прогресса
     progressSlider = new ClickableSlider(Qt::Horizontal);
     progressSlider->setRange(0, 1000);  // Диапазон 0-1000
+    progressSlider->setMinimumHeight(32); // Место под обзор формы волны
 
     // Создание слайдера громкости
     volumeSlider = new QSlider(Qt::Horizontal);
@@ -172,27 +249,52 @@ void PlayerControls::setPlaying(bool playing) {
 
 // Установка позиции трека и обновление слайдера
 void PlayerControls::setPosition(qint64 position, qint64 duration) {
+    updateProgress(position, duration);
+    updateTimeLabel(position, duration);
+}
+
+// Обновление ползунка прогресса
+void PlayerControls::updateProgress(qint64 position, qint64 duration) {
     // Проверяем валидность длительности
     if (duration <= 0) {
-        qDebug() << "Предупреждение: трек с нулевой длительностью";
+        // Предупреждаем один раз на трек, а не на каждый тик позиции
+        if (!zeroDurationWarned_) {
+            qDebug() << "Предупреждение: трек с нулевой длительностью";
+            zeroDurationWarned_ = true;
+        }
         // Не обновляем UI для невалидных треков
         return;
     }
+    zeroDurationWarned_ = false;
 
     duration_ = duration;
 
-    progressSlider->blockSignals(true);
-    if (duration > 0) {
-        int value = static_cast<int>((position * 1000.0) / duration);
+    int value = static_cast<int>((position * 1000.0) / duration);
+    if (progressSlider->value() != value) {
+        progressSlider->blockSignals(true);
         progressSlider->setValue(value);
-    } else {
-        progressSlider->setValue(0);
+        progressSlider->blockSignals(false);
     }
-    progressSlider->blockSignals(false);
+}
+
+// Обновление метки времени - только когда меняется отображаемая секунда
+void PlayerControls::updateTimeLabel(qint64 position, qint64 duration) {
+    if (duration <= 0) return;
+
+    qint64 second = position / 1000;
+    qint64 durationSeconds = duration / 1000;
+    if (second == shownSecond_ && durationSeconds == shownDuration_) return;
+    shownSecond_ = second;
+    shownDuration_ = durationSeconds;
 
     timeLabel->setText(formatTime(position) + " / " + formatTime(duration));
 }
 
+// Обзор формы волны текущего трека под ползунком
+void PlayerControls::setWaveform(std::shared_ptr<const WaveformPeaks> peaks) {
+    progressSlider->setWaveform(std::move(peaks));
+}
+
 // Установка громкости
 void PlayerControls::setVolume(int volume) {
     volumeSlider->blockSignals(true);  // Блокировка сигналов
@@ -5,6 +5,11 @@
 #include <QSlider>      // Ползунок
 #include <QLabel>       // Текстовая метка
 #include <QtGlobal>     // Основные определения Qt
+#include <QPixmap>      // Готовая картинка обзора формы волны
+
+#include <memory>       // std::shared_ptr
+
+#include "WaveformPeaks.h" // Обзор трека под ползунком прогресса
 
 // Предварительное объявление класса для избежания циклических включений
 class ClickableSlider;
@@ -19,10 +24,13 @@ public:
 
     // Сетторы для установки состояния элементов управления
     void setPlaying(bool playing);      // состояние воспроизведения
-    void setPosition(qint64 position, qint64 duration); // позицию трека
+    void setPosition(qint64 position, qint64 duration); // позицию трека (ползунок и время)
+    void updateProgress(qint64 position, qint64 duration);  // только ползунок
+    void updateTimeLabel(qint64 position, qint64 duration); // только метка времени
     void setVolume(int volume);         // громкость
     void setRepeatState(int state);     // состояние повтора
     void setShuffleState(bool shuffled); // состояние перемешивания
+    void setWaveform(std::shared_ptr<const WaveformPeaks> peaks); // обзор трека (nullptr - убрать)
 
     // Геттеры для получения текущего состояния
     bool isShuffleEnabled() const { return isShuffled_; } // состояние перемешивания
@@ -73,6 +81,9 @@ private:
     int repeatState_ = 0;      // Текущее состояние повтора (0-2)
     bool isShuffled_ = false;  // Флаг перемешивания
     qint64 duration_ = 0;      // Длительность текущего трека в мс
+    qint64 shownSecond_ = -1;  // Позиция (в секундах) на метке времени
+    qint64 shownDuration_ = -1; // Длительность (в секундах) на метке времени
+    bool zeroDurationWarned_ = false; // Предупреждение о нулевой длительности уже выведено
     bool isMuted_ = false;     // Флаг отключения звука
     int volumeBeforeMute_ = 70; // Громкость до отключения звука
 
@@ -89,7 +100,19 @@ class ClickableSlider : public QSlider {
 public:
     using QSlider::QSlider;  // Наследуем конструкторы базового класса
 
+    // Форма волны трека фоном ползунка: сыгранная часть - синяя, остальная - серая
+    void setWaveform(std::shared_ptr<const WaveformPeaks> peaks);
+
 protected:
     // Переопределяем обработчик события нажатия мыши
     void mousePressEvent(QMouseEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+
+private:
+    void renderWaveform();  // Перестройка картинок обзора под текущий размер
+
+    std::shared_ptr<const WaveformPeaks> waveform_;
+    QPixmap playedWaveform_;   // Картинки рисуются один раз - при смене трека или размера,
+    QPixmap pendingWaveform_;  // а при движении ползунка только копируются частями
 };
@@ -4,18 +4,51 @@
 #include <sstream>       // Строковые потоки
 #include <QDir>          // Работа с директориями Qt
 #include <QCoreApplication> // Основной класс приложения Qt
+#include <algorithm>     // std::min
+#include <unordered_map> // Идентификатор -> индекс при восстановлении сессии
+#include <atomic>        // Версия рейтингов для фоновой записи
+#include <mutex>
+#include "TaskScheduler.h" // Фоновая запись рейтингов
+
+namespace {
+// Вес трека без рейтинга - как у "средних" 2-3 звезд
+const double kUnratedWeight = 2.5;
+// Множитель веса для недавно сыгранных треков
+const double kRecentPenalty = 0.05;
+// Сколько последних треков считаются "недавно сыгранными" (не больше половины плейлиста)
+const size_t kRecentWindow = 50;
+// Плавные переходы: следующий трек - случайный из стольких ближайших по звучанию
+const size_t kSmoothNeighbours = 12;
+
+// Фоновая запись ratings.txt: файл не читается во время записи,
+// а из нескольких ожидающих записей выполняется только последняя
+std::mutex ratingsFileMutex;
+std::atomic<uint64_t> latestRatingsVersion{0};
+}
 // #include "TrackValidator.h"
 // #include "BadTrackDialog.h"
 
+// Добавление одного трека (новая версия библиотеки)
+void Playlist::add(const Track& t) {
+    library_.modify([&t](TrackLibrary::Tracks& tracks) { tracks.push_back(t); });
+    samplerDirty_ = true;
+}
+
+// Замена всех треков одной версией
+void Playlist::assign(std::vector<Track> tracks) {
+    library_.assign(std::move(tracks));
+    samplerDirty_ = true;
+}
+
 void Playlist::clear() {
-    tracks_.clear(); // Очищаем вектор треков
+    library_.clear(); // Очищаем список треков
     currentIndex_ = 0; // Сбрасываем текущий индекс
     skipInvalidTracks_ = false; // Сбрасываем флаг при очистке
 
     // Очистка стека истории назад
-    while (!backStack_.empty()) backStack_.pop();
+    backStack_.clear();
     // Очистка стека истории вперед
-    while (!forwardStack_.empty()) forwardStack_.pop();
+    forwardStack_.clear();
 
     // Очищаем shuffle очередь
     shuffleQueue_.clear();
@@ -26,12 +59,18 @@ void Playlist::clear() {
     // сброс флагов режимов
     shuffle_ = false;
     repeatMode_ = RepeatMode::None;
+
+    // Веса взвешенного shuffle (сам режим - настройка пользователя и сохраняется)
+    shuffleSampler_.clear();
+    samplerDirty_ = true;
+    recentlyPlayed_.clear();
+    isRecent_.clear();
 }
 
 // Возвращает текущий трек или std::nullopt если плейлист пуст
 std::optional<Track> Playlist::current() const {
-    if (currentIndex_ >= tracks_.size()) return std::nullopt;
-    return tracks_[currentIndex_]; // Возврат трека по текущему индексу
+    if (currentIndex_ >= tracks().size()) return std::nullopt;
+    return tracks()[currentIndex_]; // Возврат трека по текущему индексу
 }
 
 // Безопасная навигация с пропуском битых треков
@@ -61,13 +100,13 @@ bool Playlist::safeNavigate(bool forward, int maxAttempts) {
 
 // Внутренний метод next без рекурсии
 bool Playlist::nextInternal() {
-    if (tracks_.empty()) return false;
+    if (tracks().empty()) return false;
 
     if (repeatMode_ == RepeatMode::One) {
         if (shuffle_) {
             return navigateInShuffleQueue(1);
         } else {
-            size_t nextIdx = (currentIndex_ + 1) % tracks_.size();
+            size_t nextIdx = (currentIndex_ + 1) % tracks().size();
             return setCurrent(nextIdx);
         }
     }
@@ -76,13 +115,13 @@ bool Playlist::nextInternal() {
         return navigateInShuffleQueue(1);
     }
 
-    size_t nextIdx = (currentIndex_ + 1) % tracks_.size();
+    size_t nextIdx = (currentIndex_ + 1) % tracks().size();
     return setCurrent(nextIdx);
 }
 
 // Внутренний метод prev без рекурсии
 bool Playlist::prevInternal(qint64 currentPosition) {
-    if (tracks_.empty()) return false;
+    if (tracks().empty()) return false;
 
     if (shouldRestartTrack(currentPosition)) {
         return true;
@@ -101,7 +140,7 @@ bool Playlist::prevInternal(qint64 currentPosition) {
     }
 
     // Циклический переход
-    size_t prevIdx = (currentIndex_ == 0) ? tracks_.size() - 1 : currentIndex_ - 1;
+    size_t prevIdx = (currentIndex_ == 0) ? tracks().size() - 1 : currentIndex_ - 1;
     return setCurrent(prevIdx);
 }
 
@@ -110,9 +149,38 @@ bool Playlist::next() {
     return safeNavigate(true);
 }
 
+// Заранее выбранный следующий трек (для перехода без участия GUI)
+std::optional<size_t> Playlist::prepareNext() {
+    if (tracks().size() < 2) return std::nullopt;
+
+    if (!shuffle_) {
+        return (currentIndex_ + 1) % tracks().size();
+    }
+
+    // Следующая позиция очереди уже известна (например, после шага назад)
+    const int target = currentQueuePosition_ + 1;
+    auto it = shuffleQueue_.find(target);
+    if (it != shuffleQueue_.end()) {
+        if (it->second == currentIndex_) return std::nullopt;  // next() выберет замену сам
+        return it->second;
+    }
+
+    // Выбираем так же, как это сделал бы next(), и запоминаем в очереди
+    std::vector<size_t> excluded = {currentIndex_};
+    for (const auto& pair : shuffleQueue_) {
+        excluded.push_back(pair.second);
+    }
+    size_t index = pickShuffleTrack(excluded);
+    if (index == currentIndex_ || index >= tracks().size()) return std::nullopt;
+
+    shuffleQueue_[target] = index;
+    maxPositivePosition_ = std::max(maxPositivePosition_, target);
+    return index;
+}
+
 // Изменяем сигнатуру и логику метода prev
 bool Playlist::prev(qint64 currentPosition, bool skipThreeSecondRule) {
-    if (tracks_.empty()) return false;
+    if (tracks().empty()) return false;
 
     // Проверяем правило 3 секунд, если не отключено
     if (!skipThreeSecondRule && shouldRestartTrack(currentPosition)) {
@@ -148,7 +216,7 @@ bool Playlist::standardPrevLogic(qint64 currentPosition) {
     if (repeatMode_ == RepeatMode::One) {
         // От первого трека плейлиста назад = последний трек
         // От любого другого трека назад = предыдущий трек
-        size_t prevIdx = (currentIndex_ == 0) ? tracks_.size() - 1 : currentIndex_ - 1;
+        size_t prevIdx = (currentIndex_ == 0) ? tracks().size() - 1 : currentIndex_ - 1;
         return setCurrent(prevIdx);
     }
 
@@ -164,32 +232,32 @@ bool Playlist::standardPrevLogic(qint64 currentPosition) {
 
     // Если истории нет (начало навигации) - циклический переход
     // От первого трека назад = последний трек папки
-    size_t prevIdx = (currentIndex_ == 0) ? tracks_.size() - 1 : currentIndex_ - 1;
+    size_t prevIdx = (currentIndex_ == 0) ? tracks().size() - 1 : currentIndex_ - 1;
     return setCurrent(prevIdx);
 }
 
 // Генерирует случайный индекс трека (исключая текущий)
 size_t Playlist::getRandomTrackIndex() const {
-    if (tracks_.size() <= 1) return 0;
+    if (tracks().size() <= 1) return 0;
 
     // Создание равномерного распределения
-    std::uniform_int_distribution<size_t> dist(0, tracks_.size() - 1);
+    std::uniform_int_distribution<size_t> dist(0, tracks().size() - 1);
     size_t randomIndex;
 
     // Генерируем случайный индекс пока не получим отличный от текущего
     do {
         randomIndex = dist(rng_);
-    } while (randomIndex == currentIndex_ && tracks_.size() > 1);
+    } while (randomIndex == currentIndex_ && tracks().size() > 1);
 
     return randomIndex;
 }
 
 // Генерирует случайный индекс исключая указанные треки
 size_t Playlist::getRandomTrackIndexExcluding(const std::vector<size_t>& excluded) const {
-    if (tracks_.empty()) return 0;
-    if (tracks_.size() <= excluded.size()) return 0;
+    if (tracks().empty()) return 0;
+    if (tracks().size() <= excluded.size()) return 0;
 
-    std::uniform_int_distribution<size_t> dist(0, tracks_.size() - 1);
+    std::uniform_int_distribution<size_t> dist(0, tracks().size() - 1);
     size_t randomIndex;
 
     // Генерируем пока не найдем трек не в списке исключенных
@@ -249,18 +317,21 @@ bool Playlist::navigateInShuffleQueue(int direction) {
                 }
             }
 
-            size_t alternativeIndex = getRandomTrackIndexExcluding(excluded);
+            size_t alternativeIndex = pickShuffleTrack(excluded);
             if (alternativeIndex != currentIndex_) {
                 shuffleQueue_[targetPosition] = alternativeIndex;
                 currentQueuePosition_ = targetPosition;
                 currentIndex_ = alternativeIndex;
+                markPlayed(currentIndex_);
                 return true;
             }
             return false;
         }
 
+        // Переход по уже известной позиции очереди (история назад/вперед) - без новых выборок
         currentQueuePosition_ = targetPosition;
         currentIndex_ = it->second;
+        markPlayed(currentIndex_);
         return true;
     }
 
@@ -270,7 +341,7 @@ bool Playlist::navigateInShuffleQueue(int direction) {
         excluded.push_back(pair.second);
     }
 
-    size_t randomTrackIndex = getRandomTrackIndexExcluding(excluded);
+    size_t randomTrackIndex = pickShuffleTrack(excluded);
     if (randomTrackIndex == currentIndex_) {
         qDebug() << "Shuffle: не удалось найти уникальный трек";
         return false;
@@ -279,6 +350,7 @@ bool Playlist::navigateInShuffleQueue(int direction) {
     shuffleQueue_[targetPosition] = randomTrackIndex;
     currentQueuePosition_ = targetPosition;
     currentIndex_ = randomTrackIndex;
+    markPlayed(currentIndex_);
 
     if (targetPosition > maxPositivePosition_) {
         maxPositivePosition_ = targetPosition;
@@ -312,6 +384,131 @@ void Playlist::setShuffle(bool enabled) {
     shuffle_ = enabled;
 }
 
+// Включение/выключение взвешенного shuffle
+void Playlist::setWeightedShuffle(bool enabled) {
+    if (weightedShuffle_ == enabled) return;
+    weightedShuffle_ = enabled;
+    samplerDirty_ = true;  // Веса строятся лениво при первой выборке
+}
+
+// Вес трека: рейтинг (без рейтинга - средний вес) с понижением для недавно сыгранных
+double Playlist::shuffleWeight(size_t index) const {
+    if (index >= tracks().size()) return 0.0;
+
+    double rating = tracks()[index].rating();
+    double weight = rating > 0.0 ? rating : kUnratedWeight;
+    if (index < isRecent_.size() && isRecent_[index]) {
+        weight *= kRecentPenalty;
+    }
+    return weight;
+}
+
+// Полная перестройка alias-таблицы - O(n), только при смене состава плейлиста
+void Playlist::rebuildShuffleSampler() {
+    isRecent_.resize(tracks().size(), false);
+
+    std::vector<double> weights(tracks().size());
+    for (size_t i = 0; i < tracks().size(); ++i) {
+        weights[i] = shuffleWeight(i);
+    }
+    shuffleSampler_.assign(weights);
+    samplerDirty_ = false;
+}
+
+// Отмечает трек сыгранным: понижает его вес, самому старому из недавних возвращает
+void Playlist::markPlayed(size_t index) {
+    if (!weightedShuffle_ || index >= tracks().size()) return;
+    if (samplerDirty_) rebuildShuffleSampler();
+    if (isRecent_[index]) return;
+
+    isRecent_[index] = true;
+    recentlyPlayed_.push_back(index);
+    shuffleSampler_.setWeight(index, shuffleWeight(index));
+
+    const size_t window = std::min(kRecentWindow, tracks().size() / 2);
+    while (recentlyPlayed_.size() > window) {
+        size_t oldest = recentlyPlayed_.front();
+        recentlyPlayed_.pop_front();
+        isRecent_[oldest] = false;
+        shuffleSampler_.setWeight(oldest, shuffleWeight(oldest));
+    }
+}
+
+// Случайный трек пропорционально весу (O(1)), отличный от текущего
+size_t Playlist::getWeightedRandomTrackIndex() {
+    if (tracks().size() <= 1) return 0;
+    if (samplerDirty_) rebuildShuffleSampler();
+
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        size_t index = shuffleSampler_.sample(rng_);
+        if (index < tracks().size() && index != currentIndex_) {
+            return index;
+        }
+    }
+
+    // Веса вырождены (например, весь плейлист - один трек с весом) - обычный случайный
+    return getRandomTrackIndex();
+}
+
+// Выбор следующего трека shuffle. Во взвешенном режиме повторы допустимы -
+// их сдерживает штраф за недавнее проигрывание
+size_t Playlist::pickShuffleTrack(const std::vector<size_t>& excluded) {
+    if (similarMode_ != SimilarMode::Off) {
+        const size_t count = similarMode_ == SimilarMode::Similar ? 1 : kSmoothNeighbours;
+        const std::vector<size_t> similar = similarTracks(currentIndex_, count, excluded);
+        if (!similar.empty()) {
+            std::uniform_int_distribution<size_t> dist(0, similar.size() - 1);
+            return similar[dist(rng_)];
+        }
+    }
+    return weightedShuffle_ ? getWeightedRandomTrackIndex() : getRandomTrackIndexExcluding(excluded);
+}
+
+void Playlist::setSimilarity(std::shared_ptr<const SimilarityIndex> index,
+                             std::unordered_map<std::string, uint32_t> rowById) {
+    similarity_ = std::move(index);
+    similarRowById_ = std::move(rowById);
+    similarVersion_ = UINT64_MAX;  // Таблицы строк перестроятся при первом запросе
+}
+
+// Строки индекса <-> треки текущей версии библиотеки (порядок меняется сортировкой)
+void Playlist::updateSimilarRows() const {
+    if (similarVersion_ == library_.version()) return;
+    similarVersion_ = library_.version();
+
+    similarRowByTrack_.assign(tracks().size(), -1);
+    similarTrackByRow_.assign(similarity_ ? similarity_->size() : 0, -1);
+    if (!similarity_) return;
+    for (size_t i = 0; i < tracks().size(); ++i) {
+        auto it = similarRowById_.find(tracks()[i].getID());
+        if (it == similarRowById_.end() || it->second >= similarTrackByRow_.size()) continue;
+        similarRowByTrack_[i] = it->second;
+        if (similarTrackByRow_[it->second] < 0) similarTrackByRow_[it->second] = int64_t(i);
+    }
+}
+
+std::vector<size_t> Playlist::similarTracks(size_t index, size_t count, const std::vector<size_t>& excluded) const {
+    std::vector<size_t> result;
+    if (!similarity_ || index >= tracks().size()) return result;
+    updateSimilarRows();
+    const int64_t row = similarRowByTrack_[index];
+    if (row < 0) return result;
+
+    // Исключаются уже звучавшие в очереди и строки, чьих треков в плейлисте нет
+    std::vector<uint8_t> skip(similarity_->size(), 0);
+    for (size_t r = 0; r < skip.size(); ++r) {
+        if (similarTrackByRow_[r] < 0) skip[r] = 1;
+    }
+    for (size_t track : excluded) {
+        if (track < similarRowByTrack_.size() && similarRowByTrack_[track] >= 0) skip[similarRowByTrack_[track]] = 1;
+    }
+
+    for (const SimilarityIndex::Match& match : similarity_->nearest(uint32_t(row), count, &skip)) {
+        result.push_back(size_t(similarTrackByRow_[match.first]));
+    }
+    return result;
+}
+
 // Сброс истории shuffle
 void Playlist::resetShuffleHistory() {
     shuffleQueue_.clear();
@@ -331,13 +528,21 @@ bool Playlist::shouldRestartTrack(qint64 currentPosition) const {
 
 // рейтинг текущему треку
 bool Playlist::setCurrentTrackRating(double rating) {
-    if (currentIndex_ >= tracks_.size()) return false;
+    if (currentIndex_ >= tracks().size()) return false;
 
     // Проверяем что рейтинг в допустимом диапазоне (0.0 - 5.0)
     if (rating < 0.0 || rating > 5.0) return false;
 
-    // Устанавливаем рейтинг текущему треку
-    tracks_[currentIndex_].setTrackRating(rating);
+    // Устанавливаем рейтинг текущему треку (новой версией библиотеки)
+    const size_t index = currentIndex_;
+    library_.modify([index, rating](TrackLibrary::Tracks& tracks) {
+        tracks[index].setTrackRating(rating);
+    });
+
+    // Частичная перестройка весов: только блок этого трека
+    if (!samplerDirty_) {
+        shuffleSampler_.setWeight(currentIndex_, shuffleWeight(currentIndex_));
+    }
 
     // Сохранение рейтинга в файл
     saveRatings();
@@ -351,12 +556,14 @@ void Playlist::loadRatings() {
     QString appDir = QCoreApplication::applicationDirPath();
     QString ratingsFile = appDir + "/ratings.txt"; // Формирование пути к файлу
 
-    // Открытие файла для чтения
+    // Открытие файла для чтения (не во время фоновой записи)
+    std::lock_guard<std::mutex> lock(ratingsFileMutex);
     std::ifstream file(ratingsFile.toStdString());
     if (!file.is_open()) {
         return;
     }
 
+    std::unordered_map<std::string, double> ratings;
     std::string line;
     // Читаем файл построчно
     while (std::getline(file, line)) {
@@ -364,54 +571,117 @@ void Playlist::loadRatings() {
         std::string trackPath;
         double rating;
 
-        // Разбираем строку: путь|рейтинг
+        // Разбираем строку: идентификатор|рейтинг (в старых файлах - путь|рейтинг)
         if (std::getline(iss, trackPath, '|') && (iss >> rating)) {
-            // Ищем трек с таким путем и устанавливаем рейтинг
-            for (auto& track : tracks_) {
-                if (track.path() == trackPath) {
-                    track.setTrackRating(rating);
-                    break;
-                }
-            }
+            ratings[trackPath] = rating;
         }
     }
-
     file.close();
+
+    // Все рейтинги - одной новой версией библиотеки. Сначала по отпечатку
+    // содержимого, затем по пути - для записей, сделанных до отпечатков
+    library_.modify([&ratings](TrackLibrary::Tracks& tracks) {
+        for (auto& track : tracks) {
+            auto it = ratings.find(track.getID());
+            if (it == ratings.end()) it = ratings.find(track.path());
+            if (it != ratings.end()) {
+                track.setTrackRating(it->second);
+            }
+        }
+    });
+    samplerDirty_ = true;  // Рейтинги сменились массово - веса перестроим при выборке
 }
 
 // сохранение рейтингов в файл
 void Playlist::saveRatings() {
     QString appDir = QCoreApplication::applicationDirPath();
-    QString ratingsFile = appDir + "/ratings.txt";
+    std::string ratingsFile = (appDir + "/ratings.txt").toStdString();
 
-    // Открываем файл для записи
-    std::ofstream file(ratingsFile.toStdString());
-    if (!file.is_open()) {
-        return; // Не удалось создать файл
+    // Частые клики по звездам: пишется только последняя версия
+    const uint64_t version = ++latestRatingsVersion;
+
+    // Снимок библиотеки неизменяем - файл собирается и пишется целиком в фоне
+    TaskScheduler::instance().submit(TaskPriority::Maintenance,
+        [ratingsFile, snapshot = library_.snapshot(), version](const CancellationToken&) {
+            std::lock_guard<std::mutex> lock(ratingsFileMutex);
+            if (version != latestRatingsVersion.load()) return;  // Уже есть более свежие рейтинги
+
+            // Открываем файл для записи
+            std::ofstream file(ratingsFile);
+            if (!file.is_open()) {
+                return; // Не удалось создать файл
+            }
+
+            // Сохранение только треков с ненулевым рейтингом
+            for (const auto& track : snapshot->tracks) {
+                if (track.rating() > 0.0) {
+                    file << track.getID() << "|" << track.rating() << "\n";
+                }
+            }
+        });
+}
+
+size_t Playlist::setContentIds(const std::unordered_map<std::string, std::string>& idsByPath) {
+    size_t changed = 0;
+    for (const Track& track : tracks()) {
+        auto it = idsByPath.find(track.path());
+        if (it != idsByPath.end() && it->second != track.contentId()) ++changed;
     }
+    if (changed == 0) return 0;  // Без новой версии библиотеки
+
+    library_.modify([&idsByPath](TrackLibrary::Tracks& tracks) {
+        for (auto& track : tracks) {
+            auto it = idsByPath.find(track.path());
+            if (it != idsByPath.end()) track.setContentId(it->second);
+        }
+    });
+    return changed;
+}
 
-    // Сохранение только треков с ненулевым рейтингом
-    for (const auto& track : tracks_) {
-        if (track.rating() > 0.0) {
-            file << track.path() << "|" << track.rating() << "\n";
+void Playlist::setTags(const std::unordered_map<std::string, Tags>& tagsByPath) {
+    if (tagsByPath.empty()) return;
+    library_.modify([&tagsByPath](TrackLibrary::Tracks& tracks) {
+        for (auto& track : tracks) {
+            auto it = tagsByPath.find(track.path());
+            if (it != tagsByPath.end()) track.setTags(it->second.artist, it->second.title, it->second.album);
         }
+    });
+}
+
+size_t Playlist::setMusicInfo(const std::unordered_map<std::string, MusicInfo>& infoById) {
+    auto differs = [&infoById](const Track& track) {
+        auto it = infoById.find(track.contentId());
+        return it != infoById.end() && (it->second.first != track.bpm() || it->second.second != track.key());
+    };
+    size_t changed = 0;
+    for (const Track& track : tracks()) {
+        if (differs(track)) ++changed;
     }
+    if (changed == 0) return 0;  // Без новой версии библиотеки
 
-    file.close();
+    library_.modify([&infoById, &differs](TrackLibrary::Tracks& tracks) {
+        for (auto& track : tracks) {
+            if (!differs(track)) continue;
+            const MusicInfo& info = infoById.at(track.contentId());
+            track.setMusicInfo(info.first, info.second);
+        }
+    });
+    return changed;
 }
 
 // Установка текущего трека по индексу
 bool Playlist::setCurrent(size_t i, bool resetShuffle) {
-    if (i >= tracks_.size()) return false;
+    if (i >= tracks().size()) return false;
 
     // Сохранение текущего трека в историю если shuffle включен
-    if (currentIndex_ < tracks_.size() && shuffle_) {
+    if (currentIndex_ < tracks().size() && shuffle_) {
         backStack_.push(currentIndex_);
     }
     // Очищение истории вперед при смене трека
-    while (!forwardStack_.empty()) forwardStack_.pop();
+    forwardStack_.clear();
 
     currentIndex_ = i; // Установка нового индекса
+    markPlayed(i);
 
     // Если нужно сбросить shuffle - устанавление якоря
     if (resetShuffle) {
@@ -435,7 +705,7 @@ bool Playlist::setCurrent(size_t i, bool resetShuffle) {
 
 // Установка текущего трека как якоря - трека отсчета - для shuffle
 void Playlist::setCurrentAsShuffleAnchor() {
-    if (tracks_.empty()) return;
+    if (tracks().empty()) return;
 
     shuffleAnchorIndex_ = currentIndex_;
 
@@ -446,20 +716,107 @@ void Playlist::setCurrentAsShuffleAnchor() {
         shuffleQueue_[0] = currentIndex_;
 
         // Очистка истории навигации
-        while (!backStack_.empty()) backStack_.pop();
-        while (!forwardStack_.empty()) forwardStack_.pop();
+        backStack_.clear();
+        forwardStack_.clear();
     }
 }
 
 // Проверка возможности перехода
 bool Playlist::canNavigate(bool forward) const {
-    if (tracks_.empty()) return false;
+    if (tracks().empty()) return false;
 
     if (forward) {
         if (repeatMode_ == RepeatMode::One) return true;
-        return tracks_.size() > 1 || repeatMode_ == RepeatMode::None;
+        return tracks().size() > 1 || repeatMode_ == RepeatMode::None;
     } else {
         if (repeatMode_ == RepeatMode::One) return true;
-        return tracks_.size() > 1 || !backStack_.empty();
+        return tracks().size() > 1 || !backStack_.empty();
+    }
+}
+
+// Снимок состояния навигации
+Playlist::Session Playlist::session() const {
+    Session s;
+    if (currentIndex_ >= tracks().size()) return s;
+
+    s.currentId = tracks()[currentIndex_].path();
+    s.queuePosition = currentQueuePosition_;
+    for (const auto& entry : shuffleQueue_) {
+        if (entry.second < tracks().size()) {
+            s.shuffleQueue.emplace_back(entry.first, tracks()[entry.second].path());
+        }
+    }
+    for (size_t i = 0; i < backStack_.size(); ++i) {
+        s.backHistory.push_back(tracks()[backStack_.at(i)].path());
+    }
+    for (size_t i = 0; i < forwardStack_.size(); ++i) {
+        s.forwardHistory.push_back(tracks()[forwardStack_.at(i)].path());
+    }
+    return s;
+}
+
+// Восстановление состояния навигации
+bool Playlist::restoreSession(const Session& s) {
+    std::unordered_map<std::string, size_t> indexById;
+    indexById.reserve(tracks().size());
+    for (size_t i = 0; i < tracks().size(); ++i) {
+        indexById.emplace(tracks()[i].path(), i);
+    }
+
+    auto current = indexById.find(s.currentId);
+    if (current == indexById.end()) return false;
+    currentIndex_ = current->second;
+    markPlayed(currentIndex_);
+
+    backStack_.clear();
+    forwardStack_.clear();
+    for (const std::string& id : s.backHistory) {
+        auto it = indexById.find(id);
+        if (it != indexById.end()) backStack_.push(it->second);
+    }
+    for (const std::string& id : s.forwardHistory) {
+        auto it = indexById.find(id);
+        if (it != indexById.end()) forwardStack_.push(it->second);
+    }
+
+    // Очередь shuffle восстанавливается, только если режим включен (он - настройка пользователя)
+    if (shuffle_) {
+        shuffleQueue_.clear();
+        for (const auto& entry : s.shuffleQueue) {
+            auto it = indexById.find(entry.second);
+            if (it != indexById.end()) shuffleQueue_[entry.first] = it->second;
+        }
+        currentQueuePosition_ = s.queuePosition;
+        shuffleQueue_[currentQueuePosition_] = currentIndex_;  // Курсор всегда указывает на текущий
+
+        // Пропуски в очереди допустимы - такие позиции будут выбраны заново
+        minNegativePosition_ = std::min(0, shuffleQueue_.begin()->first);
+        maxPositivePosition_ = std::max(0, shuffleQueue_.rbegin()->first);
+    }
+    return true;
+}
+
+// История из снимка сессии точнее (в ней и переходы назад), поэтому журнал
+// используется, только когда ее нет: первый запуск со снимком или снимок потерян
+void Playlist::seedBackHistory(const std::vector<std::string>& recentIds) {
+    if (!backStack_.empty() || recentIds.empty() || currentIndex_ >= tracks().size()) return;
+
+    std::unordered_map<std::string, size_t> indexById;
+    indexById.reserve(tracks().size());
+    for (size_t i = 0; i < tracks().size(); ++i) {
+        indexById.emplace(tracks()[i].getID(), i);
+    }
+
+    // От свежих к старым: повторы подряд и текущий трек в конце журнала пропускаются
+    std::vector<size_t> picked;
+    size_t newer = currentIndex_;
+    for (auto id = recentIds.rbegin(); id != recentIds.rend() && picked.size() < HistoryCapacity; ++id) {
+        auto it = indexById.find(*id);
+        if (it == indexById.end() || it->second == newer) continue;
+        picked.push_back(it->second);
+        newer = it->second;
+    }
+    for (auto index = picked.rbegin(); index != picked.rend(); ++index) {
+        backStack_.push(*index);
     }
 }
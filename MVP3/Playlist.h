@@ -1,11 +1,17 @@
 #pragma once
 #include "Track.h"
 #include <vector>   // Контейнер вектор для хранения треков
-#include <stack>    // Стек для истории навигации
+#include "RingBuffer.h" // Ограниченная история навигации
 #include <optional> // Для optional значений (может содержать значение или быть пустым)
 #include <random>   // Для генерации случайных чисел
 #include <QtGlobal> // Основные определения Qt
 #include <map>      // Ассоциативный массив для shuffle очереди (для режима случайного порядка треков)
+#include <deque>    // Очередь недавно сыгранных треков (для взвешенного shuffle)
+#include <unordered_map> // Рейтинги и отпечатки по ключам
+#include "WeightedSampler.h" // Выборка по весам за O(1)
+#include "TrackLibrary.h"    // Треки - неизменяемыми версиями
+#include "SimilarityIndex.h" // Похожие по звучанию треки
+#include <memory>   // Общий неизменяемый индекс похожих
 
 // управляет списком воспроизведения
 class Playlist {
@@ -14,13 +20,18 @@ public:
     enum class RepeatMode { None, One, /*All */};
 
     // Добавление трека в плейлист
-    void add(const Track& t) { tracks_.push_back(t); }
+    void add(const Track& t);
+    // Замена всех треков одной версией (вместо цепочки add при загрузке папки)
+    void assign(std::vector<Track> tracks);
     void clear(); // Очищает плейлист
 
     // текущий трек или nullopt - если плейлист пуст
     std::optional<Track> current() const;
 
     bool next(); // Переход к следующему треку
+    // Трек, на который перейдет next(), без перехода. В shuffle режиме
+    // следующая позиция очереди выбирается заранее, и next() попадет именно на нее
+    std::optional<size_t> prepareNext();
     // Удаляем старый метод или делаем его private
     // bool prev(qint64 currentPosition = 0); // УДАЛИТЬ ЭТУ СТРОКУ
 
@@ -32,17 +43,36 @@ public:
     bool canGoForward() const { return !forwardStack_.empty(); }
 
     // Возвращают: все треки плейлиста
-    const std::vector<Track>& all() const { return tracks_; }
+    const std::vector<Track>& all() const { return library_.tracks(); }
+    // Согласованный снимок треков для чтения из других потоков
+    TrackLibrary::SnapshotPtr snapshot() const { return library_.snapshot(); }
     // индекс текущего трека
     size_t currentIndex() const { return currentIndex_; }
     // количество треков в плейлисте
-    size_t size() const { return tracks_.size(); }
+    size_t size() const { return tracks().size(); }
 
     // Включает/выключает случайное воспроизведение
     void setShuffle(bool enabled);
     // Проверяет включен ли shuffle режим
     bool isShuffled() const { return shuffle_; }
 
+    // Взвешенный shuffle: треки с высоким рейтингом и давно не игравшие выпадают чаще
+    void setWeightedShuffle(bool enabled);
+    bool isWeightedShuffle() const { return weightedShuffle_; }
+
+    // Подбор следующего трека в shuffle по звучанию: Similar - ближайший
+    // к текущему из еще не звучавших, Smooth - случайный из ближайших
+    // соседей (плавные переходы). Треки без признаков - обычный shuffle
+    enum class SimilarMode { Off, Similar, Smooth };
+    void setSimilarMode(SimilarMode mode) { similarMode_ = mode; }
+    SimilarMode similarMode() const { return similarMode_; }
+    // Индекс похожих и его строки по идентификаторам треков (getID)
+    void setSimilarity(std::shared_ptr<const SimilarityIndex> index,
+                       std::unordered_map<std::string, uint32_t> rowById);
+    // Индексы треков плейлиста, похожих на трек index, от самого похожего
+    std::vector<size_t> similarTracks(size_t index, size_t count,
+                                      const std::vector<size_t>& excluded = {}) const;
+
     // Устанавливает режим повтора
     void setRepeatMode(RepeatMode mode) { repeatMode_ = mode; }
     // Возвращает текущий режим повтора
@@ -59,6 +89,17 @@ public:
     void loadRatings(); // Загружает рейтинги из файла
     void saveRatings(); // Сохраняет рейтинги в файл
 
+    // Отпечатки содержимого по путям; возвращает, у скольких треков идентификатор сменился
+    size_t setContentIds(const std::unordered_map<std::string, std::string>& idsByPath);
+    // Исполнитель, название и альбом из тегов по путям (одной новой версией библиотеки)
+    struct Tags {
+        std::string artist, title, album;
+    };
+    void setTags(const std::unordered_map<std::string, Tags>& tagsByPath);
+    // Темп и тональность по идентификаторам содержимого; возвращает, у скольких треков они сменились
+    using MusicInfo = std::pair<float, int>;
+    size_t setMusicInfo(const std::unordered_map<std::string, MusicInfo>& infoById);
+
     // Устанавливает текущий трек (трек отсчета) как якорь для shuffle
     void setCurrentAsShuffleAnchor();
     // Устанавливает текущий трек по индексу
@@ -69,11 +110,33 @@ public:
     // Проверка возможности перехода в направлении с учетом битых треков
     bool canNavigate(bool forward) const;
 
+    // Состояние навигации для восстановления сессии; треки - по путям (сессия
+    // относится к открытой папке, а текущий трек запускается до сканирования),
+    // поэтому оно переживает пересканирование и смену порядка
+    struct Session {
+        std::string currentId;                                 // Текущий трек
+        std::vector<std::pair<int, std::string>> shuffleQueue; // Позиция в очереди -> трек
+        int queuePosition = 0;                                 // Курсор shuffle очереди
+        std::vector<std::string> backHistory;                  // История назад (от старых к новым)
+        std::vector<std::string> forwardHistory;               // История вперед
+    };
+    Session session() const;
+    // Применяет сохраненное состояние; исчезнувшие треки пропускаются.
+    // false - если текущего трека сессии в плейлисте нет
+    bool restoreSession(const Session& session);
+    // Пустая история "назад" заполняется последними запусками из журнала
+    // прослушиваний (Track::getID, самый свежий - последним)
+    void seedBackHistory(const std::vector<std::string>& recentIds);
+
+    // История навигации ограничена: старые переходы затираются, полная история - в журнале PlayHistory
+    static constexpr size_t HistoryCapacity = 500;
+
 private:
-    std::vector<Track> tracks_;       // Вектор всех треков
+    TrackLibrary library_;            // Все треки (версии публикуются атомарно)
+    const std::vector<Track>& tracks() const { return library_.tracks(); }
     size_t currentIndex_ = 0;         // Индекс текущего трека
-    std::stack<size_t> backStack_;    // Стек истории назад
-    std::stack<size_t> forwardStack_; // Стек истории вперед
+    RingBuffer<size_t> backStack_{HistoryCapacity};    // Стек истории назад
+    RingBuffer<size_t> forwardStack_{HistoryCapacity}; // Стек истории вперед
 
     bool shuffle_ = false;                    // Флаг shuffle режима
     RepeatMode repeatMode_ = RepeatMode::None; // Текущий режим повтора трека
@@ -89,6 +152,29 @@ private:
     // Хэш-таблица для сохранения рейтингов: путь к файлу -> рейтинг
     std::unordered_map<std::string, double> savedRatings_;
 
+    // Взвешенный shuffle
+    bool weightedShuffle_ = false;        // Режим включен
+    WeightedSampler shuffleSampler_;      // Alias-таблица весов треков
+    bool samplerDirty_ = true;            // Состав треков или рейтинги сменились целиком
+    std::deque<size_t> recentlyPlayed_;   // Недавно сыгранные треки (их вес понижен)
+    std::vector<bool> isRecent_;          // Быстрая проверка "трек в recentlyPlayed_"
+
+    double shuffleWeight(size_t index) const;  // Вес трека для взвешенного shuffle
+    void rebuildShuffleSampler();              // Полная перестройка весов
+    void markPlayed(size_t index);             // Учет сыгранного трека (понижение веса)
+    size_t getWeightedRandomTrackIndex();      // Случайный трек с учетом весов
+    // Следующий трек shuffle: по звучанию, по весам или равномерно
+    size_t pickShuffleTrack(const std::vector<size_t>& excluded);
+
+    // Похожие треки
+    SimilarMode similarMode_ = SimilarMode::Off;
+    std::shared_ptr<const SimilarityIndex> similarity_;
+    std::unordered_map<std::string, uint32_t> similarRowById_;
+    mutable uint64_t similarVersion_ = UINT64_MAX;  // Версия библиотеки, под которую построены таблицы ниже
+    mutable std::vector<int64_t> similarRowByTrack_; // -1 - признаков нет
+    mutable std::vector<int64_t> similarTrackByRow_; // -1 - трека нет в плейлисте
+    void updateSimilarRows() const;
+
     // Вспомогательные методы
     // Генерирует случайный индекс исключая указанные треки
     size_t getRandomTrackIndexExcluding(const std::vector<size_t>& excluded) const;
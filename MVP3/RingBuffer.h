@@ -0,0 +1,38 @@
+// RingBuffer.h
+#pragma once
+#include <cstddef> // size_t
+#include <vector>  // Хранилище кольца
+
+// Ограниченный стек на кольцевом буфере: при переполнении
+// самый старый элемент затирается. Интерфейс как у std::stack
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity) : data_(capacity > 0 ? capacity : 1) {}
+
+    void push(const T& value) {
+        data_[(head_ + size_) % data_.size()] = value;
+        if (size_ < data_.size()) {
+            ++size_;
+        } else {
+            head_ = (head_ + 1) % data_.size();  // Затираем самый старый
+        }
+    }
+
+    // Последний добавленный элемент
+    const T& top() const { return data_[(head_ + size_ - 1) % data_.size()]; }
+    void pop() { if (size_ > 0) --size_; }
+
+    // Элемент по порядку добавления: 0 - самый старый
+    const T& at(size_t i) const { return data_[(head_ + i) % data_.size()]; }
+
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+    size_t capacity() const { return data_.size(); }
+    void clear() { head_ = 0; size_ = 0; }
+
+private:
+    std::vector<T> data_;
+    size_t head_ = 0;  // Индекс самого старого элемента
+    size_t size_ = 0;  // Сколько элементов хранится
+};
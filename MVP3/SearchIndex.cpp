@@ -0,0 +1,269 @@
+// SearchIndex.cpp
+#include "SearchIndex.h"
+#include <QChar>
+#include <algorithm> // std::sort, std::unique, std::set_intersection
+#include <cmath>     // std::lround
+#include <iterator>  // std::back_inserter
+
+namespace {
+// Вес поля при ранжировании: совпадение в названии важнее, чем в альбоме
+const int kFieldWeight[SearchIndex::FieldCount] = {
+    1,  // Artist
+    0,  // Title
+    3   // Album
+};
+
+// Штраф за вхождение не с начала слова и за каждую опечатку
+const int kMidWordPenalty = 5;
+const int kErrorPenalty = 100;
+
+bool isWordChar(char16_t c) {
+    return QChar(c).isLetterOrNumber();
+}
+}
+
+std::u16string SearchIndex::fold(const QString& text) {
+    std::u16string result;
+    result.reserve(text.size());
+
+    for (QChar c : text) {
+        if (c.isSurrogate()) {
+            result.push_back(c.unicode());  // Суррогатные пары оставляем как есть
+            continue;
+        }
+
+        QChar folded = c.toCaseFolded();
+        // Убираем диакритику: "é" -> "e", "ё" -> "е"
+        if (folded.decompositionTag() == QChar::Canonical) {
+            QString base = folded.decomposition();
+            if (!base.isEmpty() && !base.at(0).isSurrogate()) {
+                folded = base.at(0);
+            }
+        }
+        result.push_back(folded.unicode());
+    }
+    return result;
+}
+
+void SearchIndex::clear() {
+    text_.clear();
+    offsets_.clear();
+    signatures_.clear();
+    ratings_.clear();
+    ratingHistogram_.fill(0);
+    bpms_.clear();
+    keys_.clear();
+    bpmHistogram_.fill(0);
+    keyHistogram_.fill(0);
+    trigrams_.clear();
+    trigramsBuilt_ = false;
+}
+
+void SearchIndex::rebuild(const std::vector<Track>& tracks) {
+    clear();
+
+    offsets_.reserve(tracks.size() * FieldCount + 1);
+    signatures_.reserve(tracks.size());
+    ratings_.reserve(tracks.size());
+    bpms_.reserve(tracks.size());
+    keys_.reserve(tracks.size());
+
+    for (const Track& track : tracks) {
+        const std::string* fields[FieldCount] = {
+            &track.artist(), &track.title(), &track.album()
+        };
+
+        size_t trackStart = text_.size();
+        for (const std::string* field : fields) {
+            offsets_.push_back(static_cast<uint32_t>(text_.size()));
+            text_ += fold(QString::fromStdString(*field));
+        }
+        signatures_.push_back(FuzzyMatcher::signatureOf(text_.data() + trackStart,
+                                                        text_.size() - trackStart));
+        ratings_.push_back(track.rating());
+        ++ratingHistogram_[ratingBucket(track.rating())];
+        bpms_.push_back(track.bpm());
+        ++bpmHistogram_[bpmBucket(track.bpm())];
+        const bool knownKey = track.key() >= 0 && track.key() < KeyBuckets - 1;
+        keys_.push_back(static_cast<int8_t>(knownKey ? track.key() : -1));
+        ++keyHistogram_[knownKey ? track.key() : KeyBuckets - 1];
+    }
+    offsets_.push_back(static_cast<uint32_t>(text_.size()));
+}
+
+int SearchIndex::ratingBucket(double rating) {
+    long bucket = std::lround(rating * 2.0);
+    return static_cast<int>(qBound(0L, bucket, long(RatingBuckets - 1)));
+}
+
+int SearchIndex::bpmBucket(float bpm) {
+    if (bpm <= 0.0f) return 0;
+    return static_cast<int>(qBound(1L, std::lround(bpm / 10.0f), long(BpmBuckets - 1)));
+}
+
+void SearchIndex::setRating(size_t track, double rating) {
+    if (track >= ratings_.size()) return;
+    --ratingHistogram_[ratingBucket(ratings_[track])];
+    ratings_[track] = rating;
+    ++ratingHistogram_[ratingBucket(rating)];
+}
+
+void SearchIndex::buildTrigrams() const {
+    if (trigramsBuilt_) return;
+    trigramsBuilt_ = true;
+
+    std::vector<uint64_t> keys;
+    for (size_t track = 0; track < size(); ++track) {
+        keys.clear();
+        // Триграммы не пересекают границы полей
+        for (int f = 0; f < FieldCount; ++f) {
+            const char16_t* data = fieldData(track, static_cast<Field>(f));
+            size_t n = fieldLength(track, static_cast<Field>(f));
+            for (size_t i = 0; i + 3 <= n; ++i) {
+                keys.push_back(trigramKey(data + i));
+            }
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        // Треки обходятся по возрастанию - списки получаются отсортированными
+        for (uint64_t key : keys) {
+            trigrams_[key].push_back(static_cast<uint32_t>(track));
+        }
+    }
+}
+
+const SearchIndex::Postings* SearchIndex::postingsFor(const char16_t* p) const {
+    auto it = trigrams_.find(trigramKey(p));
+    return it != trigrams_.end() ? &it->second : nullptr;
+}
+
+size_t SearchIndex::trigramEstimate(const std::u16string& needle) const {
+    if (needle.size() < 3) return size();
+    buildTrigrams();
+
+    size_t best = size();
+    for (size_t i = 0; i + 3 <= needle.size(); ++i) {
+        const Postings* postings = postingsFor(needle.data() + i);
+        if (!postings) return 0;  // Такой триграммы нет ни у одного трека
+        best = std::min(best, postings->size());
+    }
+    return best;
+}
+
+std::vector<uint32_t> SearchIndex::trigramCandidates(const std::u16string& needle) const {
+    std::vector<uint32_t> result;
+    if (needle.size() < 3) {
+        result.resize(size());
+        for (size_t i = 0; i < result.size(); ++i) result[i] = static_cast<uint32_t>(i);
+        return result;
+    }
+    buildTrigrams();
+
+    // Собираем списки всех триграмм и пересекаем, начиная с самого короткого
+    std::vector<const Postings*> lists;
+    for (size_t i = 0; i + 3 <= needle.size(); ++i) {
+        const Postings* postings = postingsFor(needle.data() + i);
+        if (!postings) return result;
+        lists.push_back(postings);
+    }
+    std::sort(lists.begin(), lists.end(),
+              [](const Postings* a, const Postings* b) { return a->size() < b->size(); });
+
+    result = *lists.front();
+    std::vector<uint32_t> next;
+    for (size_t i = 1; i < lists.size() && !result.empty(); ++i) {
+        if (lists[i] == lists[i - 1]) continue;  // Повторяющаяся триграмма
+        next.clear();
+        std::set_intersection(result.begin(), result.end(),
+                              lists[i]->begin(), lists[i]->end(), std::back_inserter(next));
+        result.swap(next);
+    }
+    return result;
+}
+
+const char16_t* SearchIndex::fieldData(size_t track, Field field) const {
+    return text_.data() + offsets_[track * FieldCount + field];
+}
+
+size_t SearchIndex::fieldLength(size_t track, Field field) const {
+    size_t slot = track * FieldCount + field;
+    return offsets_[slot + 1] - offsets_[slot];
+}
+
+std::vector<SearchIndex::Hit> SearchIndex::fuzzySearch(const QString& query) const {
+    std::vector<Hit> hits;
+    if (isEmpty()) return hits;
+
+    // Разбиваем свёрнутый запрос на слова
+    std::vector<FuzzyMatcher> matchers;
+    const QStringList words = query.simplified().split(' ', Qt::SkipEmptyParts);
+    for (const QString& word : words) {
+        matchers.emplace_back(fold(word));
+    }
+    if (matchers.empty()) return hits;
+
+    const size_t count = signatures_.size();
+
+    // 1. Отсев по сигнатурам: плотный цикл без ветвлений по всем кандидатам сразу
+    std::vector<uint8_t> keep(count, 1);
+    for (const FuzzyMatcher& matcher : matchers) {
+        const uint64_t sig = matcher.signature();
+        const int maxErrors = matcher.maxErrors();
+        for (size_t i = 0; i < count; ++i) {
+            keep[i] &= FuzzyMatcher::popcount(sig & ~signatures_[i]) <= maxErrors;
+        }
+    }
+
+    // 2. Точная проверка оставшихся треков алгоритмом Майерса
+    for (size_t i = 0; i < count; ++i) {
+        if (!keep[i]) continue;
+
+        Hit hit;
+        hit.track = i;
+        bool allFound = true;
+
+        for (const FuzzyMatcher& matcher : matchers) {
+            int bestCost = -1;
+            Range bestRange{Title, 0, 0};
+            int bestErrors = 0;
+
+            for (int f = 0; f < FieldCount; ++f) {
+                Field field = static_cast<Field>(f);
+                const char16_t* data = fieldData(i, field);
+                FuzzyMatch match = matcher.find(data, fieldLength(i, field));
+                if (!match.found()) continue;
+
+                int cost = match.errors * kErrorPenalty + kFieldWeight[f];
+                if (match.start > 0 && isWordChar(data[match.start - 1])) {
+                    cost += kMidWordPenalty;
+                }
+                if (bestCost < 0 || cost < bestCost) {
+                    bestCost = cost;
+                    bestErrors = match.errors;
+                    bestRange = {field, match.start, match.end - match.start};
+                }
+            }
+
+            if (bestCost < 0) {
+                allFound = false;
+                break;
+            }
+            hit.cost += bestCost;
+            hit.errors += bestErrors;
+            hit.ranges.push_back(bestRange);
+        }
+
+        if (allFound) {
+            hits.push_back(std::move(hit));
+        }
+    }
+
+    // 3. Ранжирование: меньше ошибок и лучше поле - выше
+    std::sort(hits.begin(), hits.end(), [](const Hit& a, const Hit& b) {
+        if (a.cost != b.cost) return a.cost < b.cost;
+        return a.track < b.track;
+    });
+
+    return hits;
+}
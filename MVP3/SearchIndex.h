@@ -0,0 +1,100 @@
+// SearchIndex.h
+#pragma once
+#include <QString>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Track.h"
+#include "FuzzyMatcher.h"
+
+// Поисковый индекс библиотеки: свёрнутые (нижний регистр, без диакритики)
+// поля треков, сложенные подряд в один буфер, и сигнатуры для быстрого отсева
+class SearchIndex {
+public:
+    // Поля трека, по которым идёт поиск
+    enum Field { Artist = 0, Title, Album, FieldCount };
+
+    // Подсвечиваемый участок поля
+    struct Range {
+        Field field;
+        int start;
+        int length;
+    };
+
+    // Результат нечёткого поиска
+    struct Hit {
+        size_t track = 0;           // Индекс трека в плейлисте
+        int cost = 0;               // Чем меньше - тем релевантнее
+        int errors = 0;             // Суммарное число опечаток по всем словам запроса
+        std::vector<Range> ranges;  // Найденные участки (для подсветки)
+    };
+
+    // Перестраивает индекс по списку треков (порядок совпадает с плейлистом)
+    void rebuild(const std::vector<Track>& tracks);
+    void clear();
+
+    size_t size() const { return signatures_.size(); }
+    bool isEmpty() const { return signatures_.empty(); }
+
+    // Нечёткий поиск: каждое слово запроса должно найтись (с опечатками) хотя бы в одном поле.
+    // Результаты отсортированы по релевантности
+    std::vector<Hit> fuzzySearch(const QString& query) const;
+
+    // Свёртка строки для сравнения: длина сохраняется посимвольно,
+    // поэтому позиции в свёрнутой строке совпадают с позициями в исходной
+    static std::u16string fold(const QString& text);
+
+    // Колоночный доступ к полям (для предикатов SearchQuery)
+    const char16_t* fieldData(size_t track, Field field) const;
+    size_t fieldLength(size_t track, Field field) const;
+    double rating(size_t track) const { return ratings_[track]; }
+    float bpm(size_t track) const { return bpms_[track]; }   // 0 - не известен
+    int key(size_t track) const { return keys_[track]; }     // -1 - не известна
+
+    // Обновление рейтинга без перестройки индекса
+    void setRating(size_t track, double rating);
+
+    // Гистограмма рейтингов с шагом 0.5 (для оценки селективности)
+    static constexpr int RatingBuckets = 11;
+    const std::array<size_t, RatingBuckets>& ratingHistogram() const { return ratingHistogram_; }
+    static int ratingBucket(double rating);
+
+    // Гистограмма темпа с шагом 10 уд/мин (корзина 0 - темп не известен)
+    static constexpr int BpmBuckets = 26;
+    const std::array<size_t, BpmBuckets>& bpmHistogram() const { return bpmHistogram_; }
+    static int bpmBucket(float bpm);
+    // Число треков каждой тональности (последняя корзина - не известна)
+    static constexpr int KeyBuckets = 25;
+    const std::array<size_t, KeyBuckets>& keyHistogram() const { return keyHistogram_; }
+
+    // Триграммный индекс: треки, в полях которых могут встретиться все триграммы needle.
+    // Это надмножество ответа - подстроку всё равно нужно проверить
+    std::vector<uint32_t> trigramCandidates(const std::u16string& needle) const;
+    // Оценка числа кандидатов (длина самого короткого списка триграммы)
+    size_t trigramEstimate(const std::u16string& needle) const;
+
+private:
+    using Postings = std::vector<uint32_t>;
+
+    void buildTrigrams() const;  // Строится лениво, при первом запросе с индексируемым словом
+    static uint64_t trigramKey(const char16_t* p) {
+        return (uint64_t(p[0]) << 32) | (uint64_t(p[1]) << 16) | uint64_t(p[2]);
+    }
+    const Postings* postingsFor(const char16_t* p) const;
+
+    std::u16string text_;            // Свёрнутые поля всех треков подряд
+    std::vector<uint32_t> offsets_;  // Начало поля: track * FieldCount + field (+1 конечный)
+    std::vector<uint64_t> signatures_; // Сигнатура символов трека (все поля)
+    std::vector<double> ratings_;    // Колонка рейтингов
+    std::array<size_t, RatingBuckets> ratingHistogram_{};
+    std::vector<float> bpms_;        // Колонка темпа
+    std::vector<int8_t> keys_;       // Колонка тональностей
+    std::array<size_t, BpmBuckets> bpmHistogram_{};
+    std::array<size_t, KeyBuckets> keyHistogram_{};
+
+    mutable std::unordered_map<uint64_t, Postings> trigrams_; // Триграмма -> отсортированные треки
+    mutable bool trigramsBuilt_ = false;
+};
@@ -0,0 +1,296 @@
+// SearchQuery.cpp
+#include "SearchQuery.h"
+#include "AudioFeatures.h" // Названия тональностей
+#include <algorithm>   // std::stable_sort, std::remove_if
+#include <cmath>       // std::round
+#include <string_view> // Поиск подстроки без копирования поля
+
+namespace {
+const unsigned kAnyField = (1u << SearchIndex::Artist) | (1u << SearchIndex::Title) |
+                           (1u << SearchIndex::Album);
+const int kRatingField = -1;
+const int kBpmField = -2;
+const int kKeyField = -3;
+
+// Имя поля в запросе -> маска текстовых полей, k...Field для колонок или 0 (не поле)
+int fieldFromName(const QString& name) {
+    const QString key = name.toLower();
+    if (key == "artist" || key == "a" || key == "исполнитель") return 1 << SearchIndex::Artist;
+    if (key == "title" || key == "t" || key == "название") return 1 << SearchIndex::Title;
+    if (key == "album" || key == "al" || key == "альбом") return 1 << SearchIndex::Album;
+    if (key == "any" || key == "все") return kAnyField;
+    if (key == "rating" || key == "r" || key == "рейтинг") return kRatingField;
+    if (key == "bpm" || key == "tempo" || key == "темп") return kBpmField;
+    if (key == "key" || key == "тональность") return kKeyField;
+    return 0;
+}
+
+bool isOpChar(QChar c) {
+    return c == ':' || c == '=' || c == '<' || c == '>';
+}
+}
+
+bool SearchQuery::looksStructured(const QString& text) {
+    const QStringList tokens = text.split(' ', Qt::SkipEmptyParts);
+    for (const QString& token : tokens) {
+        if (token.startsWith('"')) return true;
+        if (token.size() > 1 && token.startsWith('-')) return true;
+
+        // поле:значение или rating>=4
+        QString body = token.startsWith('-') ? token.mid(1) : token;
+        for (int i = 1; i < body.size(); ++i) {
+            if (isOpChar(body.at(i))) {
+                if (fieldFromName(body.left(i)) != 0) return true;
+                break;
+            }
+        }
+    }
+    return false;
+}
+
+SearchQuery SearchQuery::parse(const QString& text) {
+    SearchQuery query;
+    const int n = text.size();
+    int i = 0;
+
+    // Чтение значения в кавычках; i указывает на открывающую кавычку
+    auto readQuoted = [&](QString& out) -> bool {
+        int close = text.indexOf('"', i + 1);
+        if (close < 0) {
+            query.error_ = "Не закрыта кавычка";
+            return false;
+        }
+        out = text.mid(i + 1, close - i - 1);
+        i = close + 1;
+        return true;
+    };
+    auto readWord = [&]() {
+        int start = i;
+        while (i < n && !text.at(i).isSpace()) ++i;
+        return text.mid(start, i - start);
+    };
+
+    while (i < n) {
+        if (text.at(i).isSpace()) {
+            ++i;
+            continue;
+        }
+
+        Predicate p;
+        p.fieldMask = kAnyField;
+
+        // Отрицание: -слово, -поле:значение
+        if (text.at(i) == '-' && i + 1 < n && !text.at(i + 1).isSpace()) {
+            p.negated = true;
+            ++i;
+        }
+
+        QString value;
+        if (text.at(i) == '"') {
+            // Фраза в кавычках ищется во всех полях
+            if (!readQuoted(value)) return query;
+        } else {
+            int start = i;
+            while (i < n && !text.at(i).isSpace() && !isOpChar(text.at(i)) && text.at(i) != '"') ++i;
+            QString fieldName = text.mid(start, i - start);
+            int field = fieldFromName(fieldName);
+
+            if (i < n && isOpChar(text.at(i)) && field != 0) {
+                // Оператор: ":" (содержит), "=", "<", "<=", ">", ">=" (также ":>=" и т.п.)
+                if (text.at(i) == ':') {
+                    ++i;
+                    p.op = Op::Contains;
+                }
+                if (i < n && (text.at(i) == '<' || text.at(i) == '>')) {
+                    bool less = text.at(i) == '<';
+                    ++i;
+                    bool orEqual = i < n && text.at(i) == '=';
+                    if (orEqual) ++i;
+                    p.op = less ? (orEqual ? Op::LessOrEqual : Op::Less)
+                                : (orEqual ? Op::GreaterOrEqual : Op::Greater);
+                } else if (i < n && text.at(i) == '=') {
+                    ++i;
+                    p.op = Op::Equals;
+                }
+
+                if (i < n && text.at(i) == '"') {
+                    if (!readQuoted(value)) return query;
+                } else {
+                    value = readWord();
+                }
+                if (value.isEmpty()) {
+                    query.error_ = QString("Не указано значение для поля \"%1\"").arg(fieldName);
+                    return query;
+                }
+
+                if (field == kRatingField || field == kBpmField) {
+                    bool ok = false;
+                    p.kind = field == kRatingField ? Kind::Rating : Kind::Bpm;
+                    p.number = QString(value).replace(',', '.').toDouble(&ok);
+                    if (!ok) {
+                        query.error_ = QString("%1 должен быть числом: \"%2\"")
+                                           .arg(field == kRatingField ? "Рейтинг" : "Темп")
+                                           .arg(value);
+                        return query;
+                    }
+                    if (p.op == Op::Contains) p.op = Op::Equals;
+                    query.predicates_.push_back(p);
+                    continue;
+                }
+
+                if (p.op != Op::Contains && p.op != Op::Equals) {
+                    query.error_ = "Сравнения <, >, <=, >= допустимы только для рейтинга и темпа";
+                    return query;
+                }
+
+                if (field == kKeyField) {
+                    p.kind = Kind::Key;
+                    p.number = AudioFeatures::keyFromName(value.toStdString());
+                    if (p.number < 0) {
+                        query.error_ = QString("Неизвестная тональность: \"%1\" (пример: C, F#m, Bb)").arg(value);
+                        return query;
+                    }
+                    p.op = Op::Equals;
+                    query.predicates_.push_back(p);
+                    continue;
+                }
+                p.fieldMask = static_cast<unsigned>(field);
+            } else {
+                // Обычное слово - ищется во всех полях целиком, вместе с ":" и прочим
+                i = start;
+                value = readWord();
+            }
+        }
+
+        p.needle = SearchIndex::fold(value);
+        if (!p.needle.empty()) {
+            query.predicates_.push_back(p);
+        }
+    }
+
+    return query;
+}
+
+bool SearchQuery::Predicate::testNumber(double value) const {
+    switch (op) {
+    case Op::Less: return value < number;
+    case Op::LessOrEqual: return value <= number;
+    case Op::Greater: return value > number;
+    case Op::GreaterOrEqual: return value >= number;
+    case Op::Contains:
+    case Op::Equals: return qFuzzyCompare(value + 1.0, number + 1.0);
+    }
+    return false;
+}
+
+bool SearchQuery::Predicate::testText(const SearchIndex& index, size_t track) const {
+    for (int f = 0; f < SearchIndex::FieldCount; ++f) {
+        if (!(fieldMask & (1u << f))) continue;
+
+        SearchIndex::Field field = static_cast<SearchIndex::Field>(f);
+        std::u16string_view data(index.fieldData(track, field), index.fieldLength(track, field));
+        if (op == Op::Equals ? data == needle : data.find(needle) != std::u16string_view::npos) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SearchQuery::Predicate::test(const SearchIndex& index, size_t track) const {
+    bool result = false;
+    switch (kind) {
+    case Kind::Text: result = testText(index, track); break;
+    case Kind::Rating: result = testNumber(index.rating(track)); break;
+    // Темп сравнивается целым (bpm:128 - от 127.5 до 128.5); не известный не подходит ни под что
+    case Kind::Bpm: result = index.bpm(track) > 0.0f && testNumber(std::round(index.bpm(track))); break;
+    case Kind::Key: result = index.key(track) == int(number); break;
+    }
+    return negated ? !result : result;
+}
+
+void SearchQuery::estimate(const SearchIndex& index, Predicate& p) const {
+    const double total = static_cast<double>(index.size());
+    double positive = 0.5;  // Без индекса - "примерно половина"
+
+    if (p.kind == Kind::Rating) {
+        // По гистограмме рейтингов: берём середину каждой корзины
+        size_t passed = 0;
+        const auto& histogram = index.ratingHistogram();
+        for (int bucket = 0; bucket < SearchIndex::RatingBuckets; ++bucket) {
+            if (p.testNumber(bucket / 2.0)) passed += histogram[bucket];
+        }
+        positive = passed / total;
+    } else if (p.kind == Kind::Bpm) {
+        // Так же по корзинам темпа; равенство - примерно десятая часть корзины
+        size_t passed = 0;
+        const auto& histogram = index.bpmHistogram();
+        for (int bucket = 1; bucket < SearchIndex::BpmBuckets; ++bucket) {
+            if (p.op == Op::Equals ? SearchIndex::bpmBucket(float(p.number)) == bucket : p.testNumber(bucket * 10.0)) {
+                passed += histogram[bucket];
+            }
+        }
+        positive = passed / total;
+        if (p.op == Op::Equals) positive *= 0.1;
+    } else if (p.kind == Kind::Key) {
+        positive = index.keyHistogram()[int(p.number)] / total;
+    } else if (p.needle.size() >= 3) {
+        positive = index.trigramEstimate(p.needle) / total;
+        if (p.op == Op::Equals) positive *= 0.5;
+    }
+
+    p.selectivity = p.negated ? 1.0 - positive : positive;
+}
+
+std::vector<SearchIndex::Hit> SearchQuery::run(const SearchIndex& index) const {
+    std::vector<SearchIndex::Hit> hits;
+    if (!isValid() || index.isEmpty()) return hits;
+
+    // План: самые избирательные предикаты проверяются первыми
+    std::vector<Predicate> plan = predicates_;
+    for (Predicate& p : plan) {
+        estimate(index, p);
+    }
+    std::stable_sort(plan.begin(), plan.end(), [](const Predicate& a, const Predicate& b) {
+        return a.selectivity < b.selectivity;
+    });
+
+    // Кандидаты: из триграммного индекса по лучшему текстовому предикату, иначе все треки
+    std::vector<uint32_t> rows;
+    auto seed = std::find_if(plan.begin(), plan.end(), [](const Predicate& p) {
+        return p.kind == Kind::Text && !p.negated && p.needle.size() >= 3;
+    });
+    if (seed != plan.end()) {
+        rows = index.trigramCandidates(seed->needle);
+    } else {
+        rows.resize(index.size());
+        for (size_t i = 0; i < rows.size(); ++i) rows[i] = static_cast<uint32_t>(i);
+    }
+
+    // Конвейер: каждый предикат уплотняет список кандидатов
+    for (const Predicate& p : plan) {
+        if (rows.empty()) break;
+        rows.erase(std::remove_if(rows.begin(), rows.end(),
+                                  [&](uint32_t row) { return !p.test(index, row); }),
+                   rows.end());
+    }
+
+    // Участки для подсветки: положительные текстовые условия в исполнителе и названии
+    hits.reserve(rows.size());
+    for (uint32_t row : rows) {
+        SearchIndex::Hit hit;
+        hit.track = row;
+        for (const Predicate& p : plan) {
+            if (p.kind != Kind::Text || p.negated) continue;
+            for (SearchIndex::Field field : {SearchIndex::Artist, SearchIndex::Title}) {
+                if (!(p.fieldMask & (1u << field))) continue;
+                std::u16string_view data(index.fieldData(row, field), index.fieldLength(row, field));
+                size_t pos = data.find(p.needle);
+                if (pos != std::u16string_view::npos) {
+                    hit.ranges.push_back({field, static_cast<int>(pos), static_cast<int>(p.needle.size())});
+                }
+            }
+        }
+        hits.push_back(std::move(hit));
+    }
+    return hits;
+}
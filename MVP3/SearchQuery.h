@@ -0,0 +1,55 @@
+// SearchQuery.h
+#pragma once
+#include <QString>
+#include <string>
+#include <vector>
+
+#include "SearchIndex.h"
+
+// Структурированный поисковый запрос, например:
+//   artist:"Daft Punk" rating>=4 album:discovery -live
+//   bpm>=120 bpm<130 key:Am
+// Разбирается один раз и компилируется в цепочку предикатов над колонками SearchIndex.
+// Предикаты упорядочиваются по оценке селективности, самый избирательный
+// текстовый предикат берёт кандидатов из триграммного индекса
+class SearchQuery {
+public:
+    // Разбор строки запроса. При ошибке isValid() == false, текст ошибки в error()
+    static SearchQuery parse(const QString& text);
+
+    // Похожа ли строка на структурированный запрос (поле:, сравнение, -слово, кавычки)
+    static bool looksStructured(const QString& text);
+
+    bool isValid() const { return error_.isEmpty(); }
+    QString error() const { return error_; }
+    bool isEmpty() const { return predicates_.empty(); }
+
+    // Выполнение над индексом. Результаты в порядке плейлиста, с участками для подсветки
+    std::vector<SearchIndex::Hit> run(const SearchIndex& index) const;
+
+private:
+    enum class Op { Contains, Equals, Less, LessOrEqual, Greater, GreaterOrEqual };
+
+    // Текстовые поля или колонка, которую проверяет предикат
+    enum class Kind { Text, Rating, Bpm, Key };
+
+    // Один скомпилированный предикат
+    struct Predicate {
+        Kind kind = Kind::Text;
+        unsigned fieldMask = 0;    // Текстовые поля: бит (1 << SearchIndex::Field)
+        std::u16string needle;     // Свёрнутая искомая строка
+        Op op = Op::Contains;
+        double number = 0.0;       // Значение для рейтинга, темпа или тональности
+        bool negated = false;      // Префикс "-"
+        double selectivity = 1.0;  // Оценка доли прошедших треков
+
+        bool test(const SearchIndex& index, size_t track) const;
+        bool testText(const SearchIndex& index, size_t track) const;
+        bool testNumber(double value) const;  // Сравнение рейтинга или темпа с number
+    };
+
+    void estimate(const SearchIndex& index, Predicate& p) const;
+
+    std::vector<Predicate> predicates_;
+    QString error_;
+};
@@ -0,0 +1,107 @@
+// SeekIndexStore.cpp
+#include "SeekIndexStore.h"
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>   // Атомарная запись кэша
+#include <QTextStream>
+
+#include "MappedFile.h"
+
+namespace {
+// Заголовок формата; при смене формата старый кэш просто игнорируется
+const char* const kHeader = "ALEXMUSIC-SEEKINDEX 3";
+
+qint64 modifiedMs(const QFileInfo& info) {
+    return info.lastModified().toMSecsSinceEpoch();
+}
+}
+
+SeekIndexStore::SeekIndexStore(QString filePath) : filePath_(std::move(filePath)) {}
+
+// Строка кэша: размер|время|индекс|путь. В первых трех полях '|' не бывает,
+// поэтому путь - весь остаток строки, даже если сам содержит '|'
+void SeekIndexStore::load() {
+    QFile file(filePath_);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return;
+
+    QTextStream in(&file);
+    if (in.readLine() != QLatin1String(kHeader)) return;
+
+    while (!in.atEnd()) {
+        const QString line = in.readLine();
+        const int sizeEnd = line.indexOf('|');
+        const int timeEnd = line.indexOf('|', sizeEnd + 1);
+        const int indexEnd = line.indexOf('|', timeEnd + 1);
+        if (sizeEnd < 0 || timeEnd < 0 || indexEnd < 0) continue;
+        const int pathStart = indexEnd + 1;
+
+        const QString path = line.mid(pathStart);
+        if (entries_.contains(path)) continue;  // Свежепостроенный индекс важнее
+
+        auto index = std::make_shared<Mp3SeekIndex>();
+        const QString body = line.mid(timeEnd + 1, indexEnd - timeEnd - 1);
+        if (!Mp3SeekIndex::parse(body.toStdString(), *index)) continue;
+
+        Entry entry;
+        entry.index = std::move(index);
+        entry.size = line.left(sizeEnd).toLongLong();
+        entry.modified = line.mid(sizeEnd + 1, timeEnd - sizeEnd - 1).toLongLong();
+        entries_.insert(path, entry);
+    }
+}
+
+void SeekIndexStore::save() {
+    if (!dirty_) return;
+
+    QSaveFile file(filePath_);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) return;
+
+    QTextStream out(&file);
+    out << kHeader << '\n';
+    for (auto it = entries_.cbegin(); it != entries_.cend(); ++it) {
+        out << it->size << '|' << it->modified << '|'
+            << QString::fromStdString(it->index->serialize()) << '|' << it.key() << '\n';
+    }
+    out.flush();
+    if (file.commit()) {
+        dirty_ = false;
+    }
+}
+
+SeekIndexStore::IndexPtr SeekIndexStore::find(const QString& path) const {
+    auto it = entries_.constFind(path);
+    if (it == entries_.cend()) return nullptr;
+
+    QFileInfo info(path);
+    if (!info.exists() || info.size() != it->size || modifiedMs(info) != it->modified) {
+        return nullptr;  // Файл заменили - индекс устарел
+    }
+    return it->index;
+}
+
+void SeekIndexStore::insert(const QString& path, const Entry& entry) {
+    if (!entry.index) return;
+    entries_.insert(path, entry);
+    dirty_ = true;
+}
+
+bool SeekIndexStore::isIndexable(const QString& path) {
+    return path.endsWith(".mp3", Qt::CaseInsensitive);
+}
+
+SeekIndexStore::Entry SeekIndexStore::build(const QString& path) {
+    Entry entry;
+    QFileInfo info(path);
+    MappedFile file(path);  // Заголовки кадров читаются прямо из отображения
+    ByteView data = file.all();
+    auto index = std::make_shared<Mp3SeekIndex>();
+    if (data.empty() || !index->build(data.data, data.size)) {
+        return entry;
+    }
+
+    entry.index = std::move(index);
+    entry.size = info.size();
+    entry.modified = modifiedMs(info);
+    return entry;
+}
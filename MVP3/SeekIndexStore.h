@@ -0,0 +1,43 @@
+// SeekIndexStore.h
+#pragma once
+#include <QHash>
+#include <QString>
+
+#include <memory> // std::shared_ptr
+
+#include "Mp3SeekIndex.h"
+
+// Кэш индексов перемотки (seekindex.txt рядом с library.txt).
+// Индекс действителен, пока у файла те же размер и время изменения.
+// Строится в пуле потоков при первом воспроизведении трека или заранее
+// для следующего; живет только в GUI потоке, кроме build()
+class SeekIndexStore {
+public:
+    using IndexPtr = std::shared_ptr<const Mp3SeekIndex>;
+
+    // Результат построения индекса вместе с отпечатком файла
+    struct Entry {
+        IndexPtr index;
+        qint64 size = -1;
+        qint64 modified = 0;  // мс с эпохи
+    };
+
+    explicit SeekIndexStore(QString filePath);
+
+    void load();   // Дополняет кэш записями из файла
+    void save();   // Пишет файл, только если кэш изменился
+
+    // Индекс файла, если он есть и файл с тех пор не менялся
+    IndexPtr find(const QString& path) const;
+    void insert(const QString& path, const Entry& entry);
+
+    // Индекс нужен только MP3 - остальные форматы хранят таблицу перемотки сами
+    static bool isIndexable(const QString& path);
+    // Чтение файла и построение индекса (из любого потока)
+    static Entry build(const QString& path);
+
+private:
+    QString filePath_;
+    QHash<QString, Entry> entries_;
+    bool dirty_ = false;
+};
@@ -0,0 +1,143 @@
+// SessionStore.cpp
+#include "SessionStore.h"
+#include <QSaveFile>     // Атомарная запись снимка
+#include <fstream>       // Файл сессии
+#include <sstream>       // Сборка и разбор строк
+#include <unordered_map> // Путь -> номер в таблице строк
+#include <stdexcept>     // Ошибки std::stoul при разборе
+
+namespace {
+// Заголовок формата; при смене формата старый файл просто игнорируется
+const char* const kHeader = "ALEXMUSIC-SESSION 1";
+
+// Разбор списка номеров "3,7,12" в пути из таблицы строк
+bool readIdList(const std::string& text, const std::vector<std::string>& ids,
+                std::vector<std::string>& out) {
+    std::istringstream iss(text);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        if (item.empty()) continue;
+        size_t n = std::stoul(item);
+        if (n >= ids.size()) return false;
+        out.push_back(ids[n]);
+    }
+    return true;
+}
+}
+
+SessionStore::SessionStore(std::string filePath) : filePath_(std::move(filePath)) {}
+
+std::string SessionStore::serialize(const Snapshot& s) {
+    // Таблица строк: каждый путь один раз
+    std::vector<const std::string*> table;
+    std::unordered_map<std::string, size_t> numbers;
+    auto number = [&](const std::string& id) {
+        auto it = numbers.find(id);
+        if (it != numbers.end()) return it->second;
+        numbers.emplace(id, table.size());
+        table.push_back(&id);
+        return table.size() - 1;
+    };
+
+    std::ostringstream refs;
+    refs << "cur|" << number(s.playlist.currentId) << '\n';
+    refs << "queue|" << s.playlist.queuePosition << '|';
+    for (size_t i = 0; i < s.playlist.shuffleQueue.size(); ++i) {
+        const auto& entry = s.playlist.shuffleQueue[i];
+        refs << (i ? "," : "") << entry.first << ':' << number(entry.second);
+    }
+    refs << "\nback|";
+    for (size_t i = 0; i < s.playlist.backHistory.size(); ++i) {
+        refs << (i ? "," : "") << number(s.playlist.backHistory[i]);
+    }
+    refs << "\nforward|";
+    for (size_t i = 0; i < s.playlist.forwardHistory.size(); ++i) {
+        refs << (i ? "," : "") << number(s.playlist.forwardHistory[i]);
+    }
+    refs << '\n';
+
+    std::ostringstream out;
+    out << kHeader << '\n';
+    out << "root|" << s.libraryRoot << '\n';
+    out << "pos|" << s.position << '|' << (s.playing ? 1 : 0) << '\n';
+    for (const std::string* id : table) {
+        out << "id|" << *id << '\n';
+    }
+    out << refs.str();
+    return out.str();
+}
+
+bool SessionStore::save(const Snapshot& snapshot) {
+    std::string data = serialize(snapshot);
+    if (data == lastSaved_) return true;  // Ничего не изменилось
+
+    // Файл подменяется целиком только после успешной записи - сбой посреди
+    // сохранения оставляет прежний снимок
+    QSaveFile file(QString::fromStdString(filePath_));
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    file.write(data.data(), static_cast<qint64>(data.size()));
+    if (!file.commit()) return false;
+
+    lastSaved_ = std::move(data);
+    return true;
+}
+
+bool SessionStore::load(Snapshot& snapshot) const {
+    std::ifstream file(filePath_, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    std::string line;
+    if (!std::getline(file, line) || line != kHeader) return false;
+
+    Snapshot s;
+    std::vector<std::string> ids;
+    bool hasCurrent = false;
+
+    try {
+        while (std::getline(file, line)) {
+            size_t bar = line.find('|');
+            if (bar == std::string::npos) continue;
+            const std::string key = line.substr(0, bar);
+            const std::string value = line.substr(bar + 1);
+
+            if (key == "root") {
+                s.libraryRoot = value;
+            } else if (key == "id") {
+                ids.push_back(value);
+            } else if (key == "pos") {
+                size_t bar2 = value.find('|');
+                s.position = std::stoll(value.substr(0, bar2));
+                s.playing = bar2 != std::string::npos && value.substr(bar2 + 1) == "1";
+            } else if (key == "cur") {
+                size_t n = std::stoul(value);
+                if (n >= ids.size()) return false;
+                s.playlist.currentId = ids[n];
+                hasCurrent = true;
+            } else if (key == "queue") {
+                size_t bar2 = value.find('|');
+                if (bar2 == std::string::npos) return false;
+                s.playlist.queuePosition = std::stoi(value.substr(0, bar2));
+
+                std::istringstream iss(value.substr(bar2 + 1));
+                std::string item;
+                while (std::getline(iss, item, ',')) {
+                    size_t colon = item.find(':');
+                    if (colon == std::string::npos) return false;
+                    size_t n = std::stoul(item.substr(colon + 1));
+                    if (n >= ids.size()) return false;
+                    s.playlist.shuffleQueue.emplace_back(std::stoi(item.substr(0, colon)), ids[n]);
+                }
+            } else if (key == "back") {
+                if (!readIdList(value, ids, s.playlist.backHistory)) return false;
+            } else if (key == "forward") {
+                if (!readIdList(value, ids, s.playlist.forwardHistory)) return false;
+            }
+        }
+    } catch (const std::exception&) {
+        return false;  // Испорченное число - файл считаем поврежденным
+    }
+
+    if (!hasCurrent) return false;
+    snapshot = std::move(s);
+    return true;
+}
@@ -0,0 +1,35 @@
+// SessionStore.h
+#pragma once
+#include <cstdint> // int64_t
+#include <string>
+
+#include "Playlist.h" // Playlist::Session
+
+// Снимок сессии плеера: папка библиотеки, трек, позиция и навигация.
+// Пишется при выходе и периодически во время работы, читается при старте
+// до сканирования библиотеки. Формат - компактный текст: каждый путь
+// записывается один раз, очередь и история ссылаются на него номером
+class SessionStore {
+public:
+    struct Snapshot {
+        std::string libraryRoot;   // Папка, из которой был загружен плейлист
+        int64_t position = 0;      // Позиция в текущем треке, мс
+        bool playing = false;      // Играл ли трек в момент сохранения
+        Playlist::Session playlist;
+    };
+
+    explicit SessionStore(std::string filePath);
+
+    // false - если файла нет или он поврежден
+    bool load(Snapshot& snapshot) const;
+
+    // Атомарная запись через временный файл; повторная запись того же
+    // содержимого пропускается
+    bool save(const Snapshot& snapshot);
+
+private:
+    static std::string serialize(const Snapshot& snapshot);
+
+    std::string filePath_;
+    std::string lastSaved_;  // Последнее записанное содержимое
+};
@@ -5,7 +5,7 @@
 SettingsDialog::SettingsDialog(QWidget* parent) : QDialog(parent) {
     setWindowTitle("Настройки AlexMusic");
     setModal(true);
-    resize(400, 280); // Уменьшаем высоту, убираем лишнее
+    resize(400, 340); // Уменьшаем высоту, убираем лишнее
 
     QVBoxLayout* mainLayout = new QVBoxLayout(this);
     mainLayout->setContentsMargins(20, 20, 20, 20);
@@ -45,6 +45,24 @@ SettingsDialog::SettingsDialog(QWidget* parent) : QDialog(parent) {
     badTracksGroup->setLayout(badTracksLayout);
     mainLayout->addWidget(badTracksGroup);
 
+    // Группа кэша треков с сетевых дисков
+    QGroupBox* stagingGroup = new QGroupBox("💾 Сетевые диски");
+    QHBoxLayout* stagingLayout = new QHBoxLayout;
+    stagingLayout->addWidget(new QLabel("Локальный кэш треков:"));
+    stagingCacheSpinBox = new QSpinBox;
+    stagingCacheSpinBox->setRange(0, 32768);
+    stagingCacheSpinBox->setSingleStep(256);
+    stagingCacheSpinBox->setSuffix(" МБ");
+    stagingCacheSpinBox->setSpecialValueText("Выключен");
+    stagingCacheSpinBox->setValue(1024);
+    stagingCacheSpinBox->setFixedWidth(110);
+    stagingCacheSpinBox->setToolTip("Текущий и следующие треки с сетевого диска заранее копируются\n"
+                                    "на локальный диск - воспроизведение начинается без задержки");
+    stagingLayout->addWidget(stagingCacheSpinBox);
+    stagingLayout->addStretch();
+    stagingGroup->setLayout(stagingLayout);
+    mainLayout->addWidget(stagingGroup);
+
     mainLayout->addStretch();
 
     // Кнопки
@@ -75,6 +93,7 @@ bool SettingsDialog::autoPlayNext() const { return autoPlayNextCheckBox->isCheck
 int SettingsDialog::autoSkipThreshold() const { return autoSkipThresholdSpinBox->value(); }
 bool SettingsDialog::showNotifications() const { return showNotificationsCheckBox->isChecked(); }
 int SettingsDialog::defaultVolume() const { return defaultVolumeSpinBox->value(); }
+int SettingsDialog::stagingCacheMb() const { return stagingCacheSpinBox->value(); }
 
 // Сеттеры
 void SettingsDialog::setAlwaysSkipBadTracks(bool skip) { skipBadTracksCheckBox->setChecked(skip); }
@@ -82,3 +101,4 @@ void SettingsDialog::setAutoPlayNext(bool autoPlay) { autoPlayNextCheckBox->setC
 void SettingsDialog::setAutoSkipThreshold(int seconds) { autoSkipThresholdSpinBox->setValue(seconds); }
 void SettingsDialog::setShowNotifications(bool show) { showNotificationsCheckBox->setChecked(show); }
 void SettingsDialog::setDefaultVolume(int volume) { defaultVolumeSpinBox->setValue(volume); }
+void SettingsDialog::setStagingCacheMb(int megabytes) { stagingCacheSpinBox->setValue(megabytes); }
@@ -21,6 +21,7 @@ public:
     int autoSkipThreshold() const; // в секундах
     bool showNotifications() const;
     int defaultVolume() const;
+    int stagingCacheMb() const;    // 0 - кэш выключен
 
     // Сеттеры
     void setAlwaysSkipBadTracks(bool skip);
@@ -28,6 +29,7 @@ public:
     void setAutoSkipThreshold(int seconds);
     void setShowNotifications(bool show);
     void setDefaultVolume(int volume);
+    void setStagingCacheMb(int megabytes);
 
 signals:
     void settingsChanged();
@@ -38,6 +40,7 @@ private:
     QCheckBox* showNotificationsCheckBox;
     QSpinBox* autoSkipThresholdSpinBox;
     QSpinBox* defaultVolumeSpinBox;
+    QSpinBox* stagingCacheSpinBox;
     QPushButton* saveButton;
     QPushButton* cancelButton;
 };
@@ -0,0 +1,96 @@
+// SimilarityIndex.cpp
+#include "SimilarityIndex.h"
+#include <algorithm> // std::upper_bound
+#include <cmath>
+#include <new>       // std::align_val_t
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h> // SSE2: 4 признака за инструкцию
+#define ALEXMUSIC_SIMILARITY_SSE2 1
+#endif
+
+namespace {
+const std::align_val_t kAlignment{64};
+const size_t kScalarDims = 8;  // Первые признаки вектора; дальше 12 классов хромы
+// Вес признака хромы: 12 * w^2 = 4 - тональность не перевешивает темп и тембр
+const float kChromaWeight = 0.57735f;
+
+static_assert(SimilarityIndex::kDims % 4 == 0, "Строка - целое число регистров SSE");
+
+float dot(const float* a, const float* b) {
+#ifdef ALEXMUSIC_SIMILARITY_SSE2
+    __m128 sum = _mm_mul_ps(_mm_load_ps(a), _mm_load_ps(b));
+    for (size_t i = 4; i < SimilarityIndex::kDims; i += 4) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(a + i), _mm_load_ps(b + i)));
+    }
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+#else
+    float sum = 0.0f;
+    for (size_t i = 0; i < SimilarityIndex::kDims; ++i) sum += a[i] * b[i];
+    return sum;
+#endif
+}
+}
+
+void SimilarityIndex::AlignedDelete::operator()(float* data) const {
+    ::operator delete[](data, kAlignment);
+}
+
+SimilarityIndex::SimilarityIndex(const std::vector<AudioFeatures::Vector>& rows)
+    : rows_(rows.size()),
+      data_(static_cast<float*>(::operator new[](std::max<size_t>(1, rows.size()) * kDims * sizeof(float), kAlignment))) {
+    // Среднее и разброс каждого признака по библиотеке
+    double mean[kDims] = {};
+    double spread[kDims] = {};
+    for (const auto& row : rows) {
+        for (size_t d = 0; d < kDims; ++d) mean[d] += row[d];
+    }
+    for (size_t d = 0; d < kDims; ++d) mean[d] /= std::max<size_t>(1, rows_);
+    for (const auto& row : rows) {
+        for (size_t d = 0; d < kDims; ++d) spread[d] += (row[d] - mean[d]) * (row[d] - mean[d]);
+    }
+
+    float scale[kDims];
+    for (size_t d = 0; d < kDims; ++d) {
+        const double deviation = std::sqrt(spread[d] / std::max<size_t>(1, rows_));
+        const float weight = d < kScalarDims ? 1.0f : kChromaWeight;
+        scale[d] = deviation > 1e-9 ? float(weight / deviation) : 0.0f;  // Одинаковый у всех - не различает
+    }
+
+    for (size_t r = 0; r < rows_; ++r) {
+        float* out = data_.get() + r * kDims;
+        double norm = 0.0;
+        for (size_t d = 0; d < kDims; ++d) {
+            out[d] = float((rows[r][d] - mean[d]) * scale[d]);
+            norm += double(out[d]) * out[d];
+        }
+        const float inverse = norm > 0.0 ? float(1.0 / std::sqrt(norm)) : 0.0f;
+        for (size_t d = 0; d < kDims; ++d) out[d] *= inverse;
+    }
+}
+
+std::vector<SimilarityIndex::Match> SimilarityIndex::nearest(uint32_t row, size_t k,
+                                                             const std::vector<uint8_t>* excluded) const {
+    std::vector<Match> best;  // По убыванию близости, не больше k
+    if (row >= rows_ || k == 0) return best;
+    best.reserve(k + 1);
+
+    const float* query = rowData(row);
+    const bool hasExcluded = excluded && excluded->size() >= rows_;
+    float threshold = -2.0f;  // Близость худшего из найденных, когда их уже k
+    for (uint32_t r = 0; r < rows_; ++r) {
+        if (r == row || (hasExcluded && (*excluded)[r])) continue;
+        const float similarity = dot(query, rowData(r));
+        if (similarity <= threshold) continue;
+
+        const Match match(r, similarity);
+        best.insert(std::upper_bound(best.begin(), best.end(), match,
+                                     [](const Match& a, const Match& b) { return a.second > b.second; }),
+                    match);
+        if (best.size() > k) best.pop_back();
+        if (best.size() == k) threshold = best.back().second;
+    }
+    return best;
+}
@@ -0,0 +1,40 @@
+// SimilarityIndex.h
+#pragma once
+#include <cstddef> // size_t
+#include <cstdint> // uint32_t, uint8_t
+#include <memory>  // std::unique_ptr
+#include <utility> // std::pair
+#include <vector>
+
+#include "AudioFeatures.h"
+
+// Поиск похожих треков перебором: строки признаков стандартизуются по всей
+// библиотеке (каждый признак - среднее 0, разброс 1; хрома в сумме весит
+// как четыре скалярных признака), нормируются и лежат одним выровненным
+// массивом. Косинусная близость - скалярное произведение 20 чисел (5 SSE
+// регистров), запрос - один проход по массиву: ~2 млн умножений на 100 тыс.
+// треков, доли миллисекунды без построения графа. Неизменяемый после сборки -
+// запросы из любых потоков
+class SimilarityIndex {
+public:
+    static constexpr size_t kDims = AudioFeatures::kDims;
+    using Match = std::pair<uint32_t, float>;  // Строка и близость (-1..1)
+
+    explicit SimilarityIndex(const std::vector<AudioFeatures::Vector>& rows);
+
+    size_t size() const { return rows_; }
+
+    // k ближайших к строке row, по убыванию близости; сама строка и строки
+    // с ненулевым excluded[строка] пропускаются (excluded может быть nullptr)
+    std::vector<Match> nearest(uint32_t row, size_t k, const std::vector<uint8_t>* excluded = nullptr) const;
+
+private:
+    struct AlignedDelete {
+        void operator()(float* data) const;
+    };
+
+    const float* rowData(uint32_t row) const { return data_.get() + size_t(row) * kDims; }
+
+    size_t rows_ = 0;
+    std::unique_ptr<float[], AlignedDelete> data_;  // rows_ * kDims, выровнено на 64 байта
+};
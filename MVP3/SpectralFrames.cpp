@@ -0,0 +1,67 @@
+// SpectralFrames.cpp
+#include "SpectralFrames.h"
+#include <algorithm> // std::max
+#include <cmath>
+
+namespace {
+const float kMinChromaFrequency = 110.0f;   // Ниже полутон уже бина БПФ
+const float kMaxChromaFrequency = 3520.0f;
+}
+
+SpectralFrames::SpectralFrames(Handler handler) : handler_(std::move(handler)) {}
+SpectralFrames::~SpectralFrames() = default;
+
+void SpectralFrames::start(uint32_t sampleRate) {
+    sampleRate_ = sampleRate;
+    decimation_ = std::max<size_t>(1, static_cast<size_t>(std::lround(double(sampleRate) / kAnalysisRate)));
+    analyzer_ = std::make_unique<SpectrumAnalyzer>(1);
+    window_.clear();
+    window_.reserve(kWindow);
+    firstWindow_ = true;
+
+    // Бин -> класс высоты тона по ближайшему полутону
+    const double binHz = double(sampleRate) / decimation_ / kWindow;
+    pitchClass_.assign(kWindow / 2, -1);
+    for (size_t k = 1; k < kWindow / 2; ++k) {
+        const double frequency = k * binHz;
+        if (frequency < kMinChromaFrequency || frequency > kMaxChromaFrequency) continue;
+        const long semitone = std::lround(12.0 * std::log2(frequency / 440.0));
+        pitchClass_[k] = static_cast<int>(((semitone % 12) + 12) % 12);
+    }
+}
+
+void SpectralFrames::add(const float* samples, size_t count, uint32_t sampleRate) {
+    if (sampleRate == 0) return;
+    if (sampleRate != sampleRate_) start(sampleRate);
+    sourceSamples_ += count;
+
+    for (size_t i = 0; i < count; ++i) {
+        decimationSum_ += samples[i];
+        if (++decimationCount_ < decimation_) continue;
+        window_.push_back(decimationSum_ / decimation_);
+        decimationSum_ = 0.0f;
+        decimationCount_ = 0;
+        if (window_.size() == kWindow) {
+            analyzeWindow();
+            window_.erase(window_.begin(), window_.begin() + kHop);
+        }
+    }
+}
+
+void SpectralFrames::analyzeWindow() {
+    Frame frame;
+    frame.samples = window_.data();
+    frame.fresh = firstWindow_ ? kWindow : kHop;
+    frame.power = &analyzer_->powerSpectrum(window_.data());
+    frame.rate = double(sampleRate_) / decimation_;
+    frame.binHz = frame.rate / kWindow;
+    firstWindow_ = false;
+
+    const std::vector<float>& power = *frame.power;
+    for (size_t k = 0; k < power.size(); ++k) {
+        if (pitchClass_[k] < 0) continue;
+        frame.chroma[pitchClass_[k]] += power[k];
+        frame.chromaEnergy += power[k];
+    }
+    handler_(frame);
+}
@@ -0,0 +1,56 @@
+// SpectralFrames.h
+#pragma once
+#include <array>
+#include <cstddef>    // size_t
+#include <cstdint>    // uint32_t, uint64_t
+#include <functional>
+#include <memory>     // std::unique_ptr
+#include <vector>
+
+#include "SpectrumAnalyzer.h"
+
+// Общий вход анализа трека целиком (отпечаток, признаки звучания): звук
+// прореживается до ~11 кГц (средним соседних отсчетов - для хромы, темпа и
+// тембра этого достаточно) и режется на окна БПФ с перекрытием половиной
+// окна. Для каждого окна вызывается обработчик со спектром мощности и
+// хромой - энергией 12 классов высоты тона (0 - ля)
+class SpectralFrames {
+public:
+    static constexpr uint32_t kAnalysisRate = 11025;
+    static constexpr size_t kWindow = SpectrumAnalyzer::kFftSize;
+    static constexpr size_t kHop = kWindow / 2;  // ~93 мс при 11 кГц
+
+    struct Frame {
+        const float* samples = nullptr;          // kWindow прореженных отсчетов
+        size_t fresh = 0;                        // Сколько из них новых (в конце окна)
+        const std::vector<float>* power = nullptr; // kWindow / 2 бинов
+        double binHz = 0.0;                      // Ширина бина
+        double rate = 0.0;                       // Частота прореженных отсчетов
+        std::array<float, 12> chroma{};          // Энергия классов высоты тона
+        float chromaEnergy = 0.0f;               // Сумма chroma
+    };
+    using Handler = std::function<void(const Frame& frame)>;
+
+    explicit SpectralFrames(Handler handler);
+    ~SpectralFrames();
+
+    void add(const float* samples, size_t count, uint32_t sampleRate);  // Моно, -1..1
+
+    uint32_t sampleRate() const { return sampleRate_; }          // Исходная частота
+    uint64_t sourceSamples() const { return sourceSamples_; }    // Исходных отсчетов всего
+
+private:
+    void start(uint32_t sampleRate);  // Прореживание и классы бинов под частоту
+    void analyzeWindow();
+
+    Handler handler_;
+    std::unique_ptr<SpectrumAnalyzer> analyzer_;
+    uint32_t sampleRate_ = 0;
+    size_t decimation_ = 1;           // Исходных отсчетов на прореженный
+    float decimationSum_ = 0.0f;
+    size_t decimationCount_ = 0;
+    std::vector<float> window_;       // Прореженные отсчеты текущего окна
+    bool firstWindow_ = true;
+    std::vector<int> pitchClass_;     // Класс высоты тона бина; -1 - вне диапазона
+    uint64_t sourceSamples_ = 0;
+};
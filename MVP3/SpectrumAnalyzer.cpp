@@ -0,0 +1,172 @@
+// SpectrumAnalyzer.cpp
+#include "SpectrumAnalyzer.h"
+#include <algorithm> // std::max, std::min
+#include <cmath>
+
+namespace {
+const size_t kHalf = SpectrumAnalyzer::kFftSize / 2;  // Длина комплексного БПФ
+const double kPi = 3.14159265358979323846;
+const float kMinFrequency = 40.0f;    // Нижняя граница первой полосы, Гц
+const float kMaxFrequency = 16000.0f; // Верхняя граница последней полосы, Гц
+const float kSpectrumFloorDb = -72.0f;
+const float kLevelFloorDb = -60.0f;
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer(size_t bandCount)
+    : bandCount_(std::max<size_t>(bandCount, 1)),
+      window_(kFftSize), bitReverse_(kHalf),
+      twiddleRe_(kHalf), twiddleIm_(kHalf),
+      splitRe_(kHalf), splitIm_(kHalf),
+      re_(kHalf), im_(kHalf), power_(kHalf),
+      bandEdges_(bandCount_ + 1) {
+    double windowSum = 0.0;
+    for (size_t i = 0; i < kFftSize; ++i) {
+        window_[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * kPi * i / (kFftSize - 1)));
+        windowSum += window_[i];
+    }
+    // Амплитуда синуса в бине: A * sum(w) / 2
+    windowGain_ = static_cast<float>(2.0 / windowSum);
+
+    size_t bits = 0;
+    while ((size_t(1) << bits) < kHalf) ++bits;
+    for (size_t i = 0; i < kHalf; ++i) {
+        size_t reversed = 0;
+        for (size_t b = 0; b < bits; ++b) {
+            if (i & (size_t(1) << b)) reversed |= size_t(1) << (bits - 1 - b);
+        }
+        bitReverse_[i] = reversed;
+    }
+
+    // Этап с половиной блока half использует half множителей с индекса half - 1
+    for (size_t half = 1; half < kHalf; half <<= 1) {
+        for (size_t j = 0; j < half; ++j) {
+            const double angle = -kPi * j / half;
+            twiddleRe_[half - 1 + j] = static_cast<float>(std::cos(angle));
+            twiddleIm_[half - 1 + j] = static_cast<float>(std::sin(angle));
+        }
+    }
+
+    // Разделение: X[k] = (Z[k] + Z*[M-k]) / 2 - i/2 * e^(-2 pi i k / N) * (Z[k] - Z*[M-k])
+    for (size_t k = 0; k < kHalf; ++k) {
+        const double angle = -2.0 * kPi * k / kFftSize;
+        splitRe_[k] = static_cast<float>(std::cos(angle));
+        splitIm_[k] = static_cast<float>(std::sin(angle));
+    }
+}
+
+SpectrumAnalyzer::Frame SpectrumAnalyzer::makeFrame() const {
+    Frame frame;
+    frame.bands.assign(bandCount_, 0.0f);
+    return frame;
+}
+
+float SpectrumAnalyzer::toUnit(float amplitude, float floorDb) {
+    if (amplitude <= 0.0f) return 0.0f;
+    const float db = 20.0f * std::log10(amplitude);
+    return std::clamp(1.0f - db / floorDb, 0.0f, 1.0f);
+}
+
+void SpectrumAnalyzer::analyze(const float* left, const float* right, uint32_t sampleRate, Frame& frame) {
+    if (sampleRate == 0 || frame.bands.size() != bandCount_) return;
+
+    // Уровни каналов
+    const float* channels[2] = {left, right};
+    for (int c = 0; c < 2; ++c) {
+        float peak = 0.0f;
+        float sum = 0.0f;
+        const float* x = channels[c];
+        for (size_t i = 0; i < kFftSize; ++i) {
+            peak = std::max(peak, std::fabs(x[i]));
+            sum += x[i] * x[i];
+        }
+        frame.peak[c] = toUnit(peak, kLevelFloorDb);
+        frame.rms[c] = toUnit(std::sqrt(sum / kFftSize), kLevelFloorDb);
+    }
+
+    // Моно сумма с окном, упакованная в комплексный вход: четные отсчеты - re, нечетные - im
+    for (size_t k = 0; k < kHalf; ++k) {
+        const size_t i = 2 * k;
+        const size_t target = bitReverse_[k];
+        re_[target] = 0.5f * (left[i] + right[i]) * window_[i];
+        im_[target] = 0.5f * (left[i + 1] + right[i + 1]) * window_[i + 1];
+    }
+    fft();
+    computePower();
+
+    if (sampleRate != bandRate_) updateBands(sampleRate);
+    for (size_t b = 0; b < bandCount_; ++b) {
+        float strongest = 0.0f;
+        for (size_t k = bandEdges_[b]; k < bandEdges_[b + 1]; ++k) {
+            strongest = std::max(strongest, power_[k]);
+        }
+        frame.bands[b] = toUnit(std::sqrt(strongest), kSpectrumFloorDb);
+    }
+}
+
+const std::vector<float>& SpectrumAnalyzer::powerSpectrum(const float* mono) {
+    for (size_t k = 0; k < kHalf; ++k) {
+        const size_t i = 2 * k;
+        const size_t target = bitReverse_[k];
+        re_[target] = mono[i] * window_[i];
+        im_[target] = mono[i + 1] * window_[i + 1];
+    }
+    fft();
+    computePower();
+    return power_;
+}
+
+void SpectrumAnalyzer::computePower() {
+    const float scale = windowGain_;
+    for (size_t k = 0; k < kHalf; ++k) {
+        const size_t m = k == 0 ? 0 : kHalf - k;
+        const float evenRe = 0.5f * (re_[k] + re_[m]);
+        const float evenIm = 0.5f * (im_[k] - im_[m]);
+        const float oddRe = 0.5f * (im_[k] + im_[m]);
+        const float oddIm = -0.5f * (re_[k] - re_[m]);
+        const float xr = evenRe + splitRe_[k] * oddRe - splitIm_[k] * oddIm;
+        const float xi = evenIm + splitRe_[k] * oddIm + splitIm_[k] * oddRe;
+        power_[k] = (xr * xr + xi * xi) * scale * scale;
+    }
+}
+
+void SpectrumAnalyzer::fft() {
+    float* re = re_.data();
+    float* im = im_.data();
+    for (size_t half = 1; half < kHalf; half <<= 1) {
+        const float* wr = twiddleRe_.data() + half - 1;
+        const float* wi = twiddleIm_.data() + half - 1;
+        for (size_t block = 0; block < kHalf; block += 2 * half) {
+            float* __restrict ar = re + block;
+            float* __restrict ai = im + block;
+            float* __restrict br = re + block + half;
+            float* __restrict bi = im + block + half;
+            // Независимые итерации над соседними элементами - векторизуется
+            for (size_t j = 0; j < half; ++j) {
+                const float tr = br[j] * wr[j] - bi[j] * wi[j];
+                const float ti = br[j] * wi[j] + bi[j] * wr[j];
+                br[j] = ar[j] - tr;
+                bi[j] = ai[j] - ti;
+                ar[j] += tr;
+                ai[j] += ti;
+            }
+        }
+    }
+}
+
+void SpectrumAnalyzer::updateBands(uint32_t sampleRate) {
+    bandRate_ = sampleRate;
+    const float binHz = static_cast<float>(sampleRate) / kFftSize;
+    const float top = std::min(kMaxFrequency, sampleRate / 2.0f);
+    const float ratio = std::log(top / kMinFrequency);
+
+    size_t previous = 1;  // Бин 0 - постоянная составляющая
+    for (size_t b = 0; b <= bandCount_; ++b) {
+        const float frequency = kMinFrequency * std::exp(ratio * b / bandCount_);
+        size_t edge = static_cast<size_t>(frequency / binHz + 0.5f);
+        // В низких полосах меньше бина - каждой полосе хотя бы один
+        if (b > 0) edge = std::max(edge, previous + 1);
+        edge = std::min(std::max<size_t>(edge, 1), kHalf);
+        bandEdges_[b] = edge;
+        previous = edge;
+    }
+}
@@ -0,0 +1,61 @@
+// SpectrumAnalyzer.h
+#pragma once
+#include <cstddef> // size_t
+#include <cstdint> // uint32_t
+#include <vector>
+
+// Спектр и уровни для визуализатора: окно Ханна, вещественное БПФ на
+// 2048 отсчетов (через комплексное БПФ половинной длины), полосы с
+// логарифмической шкалой частот, пиковый и среднеквадратичный уровень
+// каждого канала. Все буферы выделяются в конструкторе, analyze() памяти
+// не выделяет. Данные БПФ лежат раздельными массивами (re/im), а поворотные
+// множители каждого этапа - подряд, поэтому внутренний цикл бабочек
+// компилятор векторизует (SSE/AVX/NEON) без ручных интринсиков.
+// Объект не потокобезопасен: один анализ за раз
+class SpectrumAnalyzer {
+public:
+    static constexpr size_t kFftSize = 2048;  // Отсчетов в окне (степень двойки)
+
+    // Результат анализа; значения нормированы в 0..1 по шкале децибел
+    struct Frame {
+        std::vector<float> bands;  // Уровни полос, от низких частот к высоким
+        float peak[2] = {0, 0};    // Пиковый уровень левого и правого каналов
+        float rms[2] = {0, 0};     // Среднеквадратичный уровень
+    };
+
+    explicit SpectrumAnalyzer(size_t bandCount);
+
+    size_t bandCount() const { return bandCount_; }
+    // Кадр с выделенной под полосы памятью - заполняется analyze()
+    Frame makeFrame() const;
+
+    // left/right - по kFftSize отсчетов в диапазоне -1..1
+    void analyze(const float* left, const float* right, uint32_t sampleRate, Frame& frame);
+
+    // Мощность бинов 0 .. kFftSize / 2 - 1 одного моно окна (kFftSize отсчетов)
+    // с той же нормировкой: для анализа трека целиком, а не для отображения
+    const std::vector<float>& powerSpectrum(const float* mono);
+
+    // Линейная амплитуда -> 0..1 (floorDb и ниже - 0, 0 дБ - 1)
+    static float toUnit(float amplitude, float floorDb);
+
+private:
+    void fft();                           // Комплексное БПФ длины kFftSize / 2 на месте
+    void computePower();                  // Упакованный вход -> power_ (после fft)
+    void updateBands(uint32_t sampleRate); // Границы полос в бинах для частоты дискретизации
+
+    size_t bandCount_;
+    uint32_t bandRate_ = 0;               // Частота, под которую посчитаны границы полос
+
+    std::vector<float> window_;           // Окно Ханна
+    float windowGain_ = 1.0f;             // Нормировка: синус полной шкалы -> 1.0
+    std::vector<size_t> bitReverse_;      // Перестановка входа
+    std::vector<float> twiddleRe_;        // Поворотные множители этапов подряд: 1, 2, 4, ...
+    std::vector<float> twiddleIm_;
+    std::vector<float> splitRe_;          // Множители разделения вещественного спектра
+    std::vector<float> splitIm_;
+    std::vector<float> re_;               // Рабочие массивы БПФ
+    std::vector<float> im_;
+    std::vector<float> power_;            // Мощность бинов 0 .. kFftSize / 2 - 1
+    std::vector<size_t> bandEdges_;       // bandCount_ + 1 границ в бинах
+};
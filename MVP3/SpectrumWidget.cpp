@@ -0,0 +1,145 @@
+// SpectrumWidget.cpp
+#include "SpectrumWidget.h"
+#include <QLinearGradient>
+#include <QPainter>
+
+#include <algorithm> // std::max
+
+#include "TaskScheduler.h" // Анализ идет в общем пуле потоков
+
+namespace {
+const float kBarFall = 0.04f;   // Спад полосы за кадр
+const float kPeakFall = 0.008f; // Спад отметки пика за кадр
+const qreal kMeterWidth = 8.0;
+const qreal kMeterGap = 4.0;
+}
+
+SpectrumWidget::SpectrumWidget(const AudioTap& tap, QWidget* parent)
+    : QWidget(parent), tap_(tap), analysis_(std::make_shared<Analysis>()),
+      bars_(kBands, 0.0f), barPeaks_(kBands, 0.0f) {
+    setMinimumHeight(60);
+    setAttribute(Qt::WA_OpaquePaintEvent);  // Фон рисуется целиком в paintEvent
+
+    timer_ = new QTimer(this);
+    timer_->setInterval(1000 / kFramesPerSecond);
+    connect(timer_, &QTimer::timeout, this, &SpectrumWidget::tick);
+}
+
+void SpectrumWidget::setPlaying(bool playing) {
+    playing_ = playing;
+    updateTimer();
+}
+
+void SpectrumWidget::showEvent(QShowEvent* event) {
+    QWidget::showEvent(event);
+    updateTimer();
+}
+
+void SpectrumWidget::hideEvent(QHideEvent* event) {
+    QWidget::hideEvent(event);
+    timer_->stop();  // Невидимый визуализатор не анализирует и не рисует
+}
+
+void SpectrumWidget::updateTimer() {
+    // Без воспроизведения таймер остановится сам, когда полосы опустятся
+    if (isVisible() && !timer_->isActive()) {
+        timer_->start();
+    }
+}
+
+void SpectrumWidget::tick() {
+    Analysis& analysis = *analysis_;
+
+    // Готовый кадр из пула - подтягиваем полосы, иначе (без звука) плавно опускаем
+    const bool fresh = analysis.ready.exchange(false, std::memory_order_acquire);
+    if (fresh || !playing_) {
+        for (int b = 0; b < kBands; ++b) {
+            const float target = fresh ? analysis.frame.bands[b] : 0.0f;
+            bars_[b] = std::max(target, bars_[b] - kBarFall);
+        }
+        for (int c = 0; c < 2; ++c) {
+            const float target = fresh ? analysis.frame.rms[c] : 0.0f;
+            levels_[c] = std::max(target, levels_[c] - kBarFall);
+            levelPeaks_[c] = std::max(fresh ? analysis.frame.peak[c] : 0.0f, levelPeaks_[c] - kPeakFall);
+        }
+    }
+    bool active = false;
+    for (int b = 0; b < kBands; ++b) {
+        barPeaks_[b] = std::max(bars_[b], barPeaks_[b] - kPeakFall);
+        active = active || barPeaks_[b] > 0.0f;
+    }
+    active = active || levelPeaks_[0] > 0.0f || levelPeaks_[1] > 0.0f;
+
+    // Следующий анализ - только если пришел новый звук и предыдущий уже закончен.
+    // frame пишется задачей, пока ready == false, и читается здесь после ready == true
+    const quint64 written = tap_.written();
+    if (playing_ && written != lastWritten_ && !analysis.busy.exchange(true, std::memory_order_acq_rel)) {
+        lastWritten_ = written;
+        std::shared_ptr<Analysis> shared = analysis_;
+        const AudioTap* tap = &tap_;
+        // Не Interactive: этот класс - для работы, которую пользователь ждет (обложка, проверка).
+        // Пропущенный под нагрузкой кадр визуализатора незаметен - следующий придет через 33 мс
+        TaskScheduler::instance().submit(TaskPriority::LookAhead, [shared, tap](const CancellationToken&) {
+            if (tap->read(shared->left.data(), shared->right.data(), SpectrumAnalyzer::kFftSize)) {
+                shared->analyzer.analyze(shared->left.data(), shared->right.data(), tap->sampleRate(), shared->frame);
+                shared->ready.store(true, std::memory_order_release);
+            }
+            shared->busy.store(false, std::memory_order_release);
+        });
+    }
+
+    update();
+    if (!playing_ && !active) {
+        timer_->stop();  // Все опустилось - до следующего воспроизведения кадры не нужны
+    }
+}
+
+void SpectrumWidget::paintEvent(QPaintEvent* event) {
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+
+    // Фон в стиле остальных панелей
+    painter.fillRect(rect(), palette().window());
+    painter.setBrush(QColor("#111"));
+    painter.drawRoundedRect(QRectF(rect()).adjusted(0.5, 0.5, -0.5, -0.5), 10, 10);
+
+    const QRectF area = QRectF(rect()).adjusted(10, 8, -10, -8);
+    const qreal metersWidth = 2 * kMeterWidth + kMeterGap;
+    const QRectF barsArea(area.left(), area.top(), area.width() - metersWidth - 10, area.height());
+
+    // Полосы спектра
+    QLinearGradient barGradient(0, barsArea.bottom(), 0, barsArea.top());
+    barGradient.setColorAt(0.0, QColor("#0078d4"));
+    barGradient.setColorAt(1.0, QColor("#00c8ff"));
+    const qreal slot = barsArea.width() / kBands;
+    for (int b = 0; b < kBands; ++b) {
+        const qreal x = barsArea.left() + b * slot;
+        const qreal height = bars_[b] * barsArea.height();
+        painter.fillRect(QRectF(x, barsArea.bottom() - height, slot - 1.0, height), barGradient);
+
+        if (barPeaks_[b] > 0.0f) {
+            const qreal peakY = barsArea.bottom() - barPeaks_[b] * barsArea.height();
+            painter.fillRect(QRectF(x, peakY - 2.0, slot - 1.0, 2.0), QColor(255, 255, 255, 150));
+        }
+    }
+
+    // Индикаторы уровня L/R: заливка - RMS, отметка - пик
+    QLinearGradient levelGradient(0, area.bottom(), 0, area.top());
+    levelGradient.setColorAt(0.0, QColor("#2ecc71"));
+    levelGradient.setColorAt(0.75, QColor("#f1c40f"));
+    levelGradient.setColorAt(1.0, QColor("#e74c3c"));
+    for (int c = 0; c < 2; ++c) {
+        const qreal x = area.right() - metersWidth + c * (kMeterWidth + kMeterGap);
+        painter.fillRect(QRectF(x, area.top(), kMeterWidth, area.height()), QColor("#222"));
+
+        const qreal height = levels_[c] * area.height();
+        painter.fillRect(QRectF(x, area.bottom() - height, kMeterWidth, height), levelGradient);
+
+        if (levelPeaks_[c] > 0.0f) {
+            const qreal peakY = area.bottom() - levelPeaks_[c] * area.height();
+            painter.fillRect(QRectF(x, peakY - 2.0, kMeterWidth, 2.0), QColor("#fff"));
+        }
+    }
+}
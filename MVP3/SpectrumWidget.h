@@ -0,0 +1,60 @@
+// SpectrumWidget.h
+#pragma once
+#include <QTimer>
+#include <QWidget>
+
+#include <atomic>
+#include <memory> // std::shared_ptr
+#include <vector>
+
+#include "AudioTap.h"
+#include "SpectrumAnalyzer.h"
+
+// Визуализатор: полосы спектра и индикаторы уровня L/R.
+// Данные берутся из AudioTap контроллера воспроизведения, анализ идет
+// задачей в пуле потоков - не чаще кадра и не больше одной задачи сразу;
+// GUI только забирает готовый кадр и рисует. Частота кадров ограничена,
+// таймер стоит, пока виджет скрыт или звук затих
+class SpectrumWidget : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit SpectrumWidget(const AudioTap& tap, QWidget* parent = nullptr);
+
+    // Идет воспроизведение: без него полосы плавно опускаются и таймер останавливается
+    void setPlaying(bool playing);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private:
+    static constexpr int kBands = 40;
+    static constexpr int kFramesPerSecond = 30;
+
+    // Общее с задачей анализа: все буферы выделены заранее
+    struct Analysis {
+        SpectrumAnalyzer analyzer{kBands};
+        std::vector<float> left = std::vector<float>(SpectrumAnalyzer::kFftSize);
+        std::vector<float> right = std::vector<float>(SpectrumAnalyzer::kFftSize);
+        SpectrumAnalyzer::Frame frame = analyzer.makeFrame();
+        std::atomic<bool> busy{false};   // Задача в пуле
+        std::atomic<bool> ready{false};  // frame посчитан и еще не забран
+    };
+
+    void tick();
+    void updateTimer();
+
+    const AudioTap& tap_;
+    std::shared_ptr<Analysis> analysis_;
+    QTimer* timer_ = nullptr;
+    quint64 lastWritten_ = 0;  // Позиция кольца при последнем анализе
+    bool playing_ = false;
+
+    // Показываемое состояние (с плавным спадом)
+    std::vector<float> bars_;
+    std::vector<float> barPeaks_;
+    float levels_[2] = {0, 0};
+    float levelPeaks_[2] = {0, 0};
+};
@@ -0,0 +1,295 @@
+// StagingCache.cpp
+#include "StagingCache.h"
+#include <QCryptographicHash> // Имя копии - хэш пути исходника
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStorageInfo>       // Тип файловой системы (сетевая или нет)
+#include <QTextStream>
+
+#ifdef Q_OS_WIN
+#include <windows.h>          // GetDriveTypeW - подключенные сетевые диски
+#endif
+#ifdef Q_OS_LINUX
+#include <fcntl.h>            // posix_fadvise - подсказки ядру о порядке чтения
+#endif
+
+namespace {
+// Заголовок формата; при смене формата старый индекс просто игнорируется
+const char* const kHeader = "ALEXMUSIC-STAGING 1";
+const char* const kIndexName = "index.txt";
+const qint64 kChunkSize = 1024 * 1024;  // Копирование крупными последовательными блоками
+
+qint64 modifiedMs(const QFileInfo& info) {
+    return info.lastModified().toMSecsSinceEpoch();
+}
+
+// Имя копии: хэш полного пути и исходное расширение (по нему плеер выбирает декодер)
+QString stagedName(const QString& path) {
+    const QByteArray hash = QCryptographicHash::hash(path.toUtf8(), QCryptographicHash::Sha1).toHex().left(20);
+    return QString::fromLatin1(hash) + "." + QFileInfo(path).suffix().toLower();
+}
+}
+
+StagingCache::StagingCache(QString directory, qint64 budgetBytes)
+    : directory_(std::move(directory)), budget_(budgetBytes) {}
+
+StagingCache::~StagingCache() {
+    cancel();
+}
+
+// Строка индекса: размер|время|обращение|копия|исходник
+void StagingCache::load() {
+    QMutexLocker lock(&mutex_);
+    QDir().mkpath(directory_);
+
+    QFile file(localFile(kIndexName));
+    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QTextStream in(&file);
+        if (in.readLine() == QLatin1String(kHeader)) {
+            while (!in.atEnd()) {
+                const QStringList fields = in.readLine().split('|');
+                if (fields.size() < 5) continue;
+
+                Entry entry;
+                entry.size = fields[0].toLongLong();
+                entry.modified = fields[1].toLongLong();
+                entry.lastUsed = fields[2].toULongLong();
+                entry.localName = fields[3];
+                const QString path = fields.mid(4).join('|');
+
+                // Копия недописана или удалена - запись не нужна
+                if (QFileInfo(localFile(entry.localName)).size() != entry.size) continue;
+                entries_.insert(path, entry);
+                used_ += entry.size;
+                clock_ = qMax(clock_, entry.lastUsed);
+            }
+        }
+    }
+
+    // Копии без записи в индексе (прерванная запись, смена формата) - мусор
+    QSet<QString> known;
+    for (const Entry& entry : std::as_const(entries_)) known.insert(entry.localName);
+    const QStringList files = QDir(directory_).entryList(QDir::Files);
+    for (const QString& name : files) {
+        if (name != kIndexName && !known.contains(name)) QFile::remove(localFile(name));
+    }
+
+    evictLocked(0);  // Бюджет могли уменьшить с прошлого запуска
+}
+
+void StagingCache::save() {
+    QMutexLocker lock(&mutex_);
+    if (!dirty_) return;
+
+    QSaveFile file(localFile(kIndexName));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) return;
+
+    QTextStream out(&file);
+    out << kHeader << '\n';
+    for (auto it = entries_.cbegin(); it != entries_.cend(); ++it) {
+        out << it->size << '|' << it->modified << '|' << it->lastUsed << '|'
+            << it->localName << '|' << it.key() << '\n';
+    }
+    out.flush();
+    if (file.commit()) {
+        dirty_ = false;
+    }
+}
+
+void StagingCache::setBudget(qint64 bytes) {
+    QMutexLocker lock(&mutex_);
+    budget_ = qMax<qint64>(0, bytes);
+    if (budget_ == 0) {
+        token_.cancel();
+        token_ = CancellationToken();
+        pending_.clear();  // Отмененные задачи не запустятся
+        pinned_.clear();
+    }
+    evictLocked(0);
+}
+
+qint64 StagingCache::budget() const {
+    QMutexLocker lock(&mutex_);
+    return budget_;
+}
+
+void StagingCache::cancel() {
+    QMutexLocker lock(&mutex_);
+    token_.cancel();
+    token_ = CancellationToken();
+    pending_.clear();
+}
+
+QString StagingCache::localPath(const QString& path) {
+    Entry entry;
+    {
+        QMutexLocker lock(&mutex_);
+        auto it = entries_.constFind(path);
+        if (it == entries_.cend()) return {};
+        entry = *it;
+    }
+
+    // Отпечатки проверяются без блокировки: обращение к сетевому диску может быть долгим
+    QFileInfo source(path);
+    QFileInfo copy(localFile(entry.localName));
+    const bool fresh = source.exists() && source.size() == entry.size &&
+                       modifiedMs(source) == entry.modified && copy.size() == entry.size;
+
+    QMutexLocker lock(&mutex_);
+    auto it = entries_.find(path);
+    if (it == entries_.end() || it->localName != entry.localName) return {};
+    if (!fresh) {
+        removeLocked(path);  // Исходник заменили - копия устарела
+        return {};
+    }
+    it->lastUsed = ++clock_;
+    dirty_ = true;
+    return localFile(entry.localName);
+}
+
+void StagingCache::stage(const QStringList& paths) {
+    QMutexLocker lock(&mutex_);
+    if (budget_ == 0) return;
+    pinned_ = QSet<QString>(paths.cbegin(), paths.cend());
+
+    for (int i = 0; i < paths.size(); ++i) {
+        const QString& path = paths[i];
+        if (entries_.contains(path) || pending_.contains(path) || localOnly_.contains(path)) continue;
+
+        pending_.insert(path);
+        // Самый срочный - трек, который заиграет следующим
+        const TaskPriority priority = i == 0 ? TaskPriority::LookAhead : TaskPriority::BulkScan;
+        TaskScheduler::instance().submit(
+            priority, [this, path](const CancellationToken& token) { copyFile(path, token); }, token_);
+    }
+}
+
+void StagingCache::copyFile(const QString& path, const CancellationToken& token) {
+    auto finish = [this, &path]() {
+        QMutexLocker lock(&mutex_);
+        pending_.remove(path);
+    };
+
+    if (!isRemote(path)) {
+        QMutexLocker lock(&mutex_);
+        pending_.remove(path);
+        localOnly_.insert(path);
+        return;
+    }
+
+    const QFileInfo before(path);
+    const qint64 size = before.size();
+    const qint64 modified = modifiedMs(before);
+    if (size <= 0 || size > budget()) {
+        finish();  // Не поместится даже в пустой кэш
+        return;
+    }
+
+    QFile source(path);
+    if (!source.open(QIODevice::ReadOnly)) {
+        finish();
+        return;
+    }
+#ifdef Q_OS_LINUX
+    // Чтение строго последовательное: ядро читает вперед крупнее и начинает сразу
+    posix_fadvise(source.handle(), 0, 0, POSIX_FADV_SEQUENTIAL);
+    posix_fadvise(source.handle(), 0, 0, POSIX_FADV_WILLNEED);
+#endif
+
+    const QString localName = stagedName(path);
+    QSaveFile target(localFile(localName));  // Недописанная копия не появится под своим именем
+    bool ok = target.open(QIODevice::WriteOnly);
+
+    QByteArray buffer(kChunkSize, Qt::Uninitialized);
+    while (ok) {
+        if (token.isCancelled()) {
+            ok = false;
+            break;
+        }
+        const qint64 read = source.read(buffer.data(), kChunkSize);
+        if (read < 0) ok = false;
+        if (read <= 0) break;
+        ok = target.write(buffer.constData(), read) == read;
+    }
+
+#ifdef Q_OS_LINUX
+    // Исходник прочитан один раз - страничный кэш ему больше не нужен
+    posix_fadvise(source.handle(), 0, 0, POSIX_FADV_DONTNEED);
+#endif
+    source.close();
+
+    // Файл меняли во время копирования - копия может быть несогласованной
+    const QFileInfo after(path);
+    ok = ok && after.size() == size && modifiedMs(after) == modified;
+    if (!ok) {
+        target.cancelWriting();
+        finish();
+        return;
+    }
+    if (!target.commit()) {
+        finish();
+        return;
+    }
+
+    QMutexLocker lock(&mutex_);
+    pending_.remove(path);
+    // Имя копии зависит только от пути: commit() уже заменил прежнюю копию этого трека
+    if (token.isCancelled() || budget_ == 0) {
+        if (entries_.contains(path)) {
+            removeLocked(path);  // Запись о прежней копии больше не верна - вместе с файлом
+        } else {
+            QFile::remove(localFile(localName));
+        }
+        return;
+    }
+    if (entries_.contains(path)) removeLocked(path, false);  // Файл - уже новая копия
+    evictLocked(size);
+
+    Entry entry;
+    entry.localName = localName;
+    entry.size = size;
+    entry.modified = modified;
+    entry.lastUsed = ++clock_;
+    entries_.insert(path, entry);
+    used_ += size;
+    dirty_ = true;
+}
+
+void StagingCache::evictLocked(qint64 incoming) {
+    while (!entries_.isEmpty() && used_ + incoming > budget_) {
+        auto victim = entries_.end();
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (pinned_.contains(it.key())) continue;
+            if (victim == entries_.end() || it->lastUsed < victim->lastUsed) victim = it;
+        }
+        if (victim == entries_.end()) break;  // Остались только нужные сейчас
+        removeLocked(victim.key());
+    }
+}
+
+void StagingCache::removeLocked(const QString& path, bool removeFile) {
+    auto it = entries_.find(path);
+    if (it == entries_.end()) return;
+    // Копию, открытую плеером, Windows не даст удалить - ее уберет load() при следующем запуске
+    if (removeFile) QFile::remove(localFile(it->localName));
+    used_ -= it->size;
+    entries_.erase(it);
+    dirty_ = true;
+}
+
+bool StagingCache::isRemote(const QString& path) {
+    const QString native = QDir::toNativeSeparators(path);
+    if (native.startsWith("\\\\")) return true;  // UNC путь \\сервер\ресурс
+#ifdef Q_OS_WIN
+    const QString root = native.left(3);  // "Z:\"
+    return GetDriveTypeW(reinterpret_cast<const wchar_t*>(root.utf16())) == DRIVE_REMOTE;
+#else
+    static const QSet<QByteArray> remoteTypes = {
+        "cifs", "smb3", "smbfs", "nfs", "nfs4", "fuse.sshfs", "afpfs", "9p", "davfs", "fuse.rclone"
+    };
+    return remoteTypes.contains(QStorageInfo(QFileInfo(path).absolutePath()).fileSystemType());
+#endif
+}
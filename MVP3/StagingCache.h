@@ -0,0 +1,71 @@
+// StagingCache.h
+#pragma once
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include "TaskScheduler.h" // Копирование идет в общем пуле потоков
+
+// Локальный кэш треков с сетевых дисков (NAS, SMB, NFS).
+// Холодный файл на сетевом ресурсе открывается плеером с задержкой и может
+// прерываться при чтении, поэтому текущий и несколько следующих треков
+// заранее копируются в локальную папку кэша, и плеер играет копию.
+// Копия действительна, пока у исходника те же размер и время изменения;
+// при превышении бюджета вытесняются давно не игравшие копии (LRU), кроме
+// тех, что нужны прямо сейчас. Индекс копий хранится в index.txt в папке кэша.
+// Все методы потокобезопасны: localPath() вызывается из потока воспроизведения
+class StagingCache {
+public:
+    StagingCache(QString directory, qint64 budgetBytes);
+    ~StagingCache();
+
+    StagingCache(const StagingCache&) = delete;
+    StagingCache& operator=(const StagingCache&) = delete;
+
+    void load();   // Индекс копий; файлы без записи в индексе удаляются
+    void save();   // Пишет индекс, только если он изменился
+
+    // 0 - кэш выключен, все копии удаляются
+    void setBudget(qint64 bytes);
+    qint64 budget() const;
+
+    // Путь к свежей локальной копии; пустой - играть исходник
+    QString localPath(const QString& path);
+
+    // Подготовить копии треков (первый - самый срочный). Копируются только
+    // файлы с сетевых дисков; копии из списка не вытесняются до следующего вызова
+    void stage(const QStringList& paths);
+
+    // Отмена всех копирований (при выходе: незапущенные задачи не стартуют)
+    void cancel();
+
+    // Файл лежит на сетевом диске
+    static bool isRemote(const QString& path);
+
+private:
+    struct Entry {
+        QString localName;     // Имя копии в папке кэша
+        qint64 size = -1;      // Отпечаток исходника
+        qint64 modified = 0;   // мс с эпохи
+        quint64 lastUsed = 0;  // Логическое время последнего обращения
+    };
+
+    void copyFile(const QString& path, const CancellationToken& token);
+    void evictLocked(qint64 incoming);        // Вытеснение до бюджета (под mutex_)
+    void removeLocked(const QString& path, bool removeFile = true); // Удаление копии (под mutex_)
+    QString localFile(const QString& localName) const { return directory_ + "/" + localName; }
+
+    QString directory_;
+    mutable QMutex mutex_;
+    QHash<QString, Entry> entries_;  // Исходник -> копия
+    QSet<QString> pending_;          // Копируются сейчас
+    QSet<QString> localOnly_;        // Уже на локальном диске - копировать незачем
+    QSet<QString> pinned_;           // Нужны сейчас - не вытесняются
+    qint64 budget_ = 0;
+    qint64 used_ = 0;
+    quint64 clock_ = 0;
+    bool dirty_ = false;
+    CancellationToken token_;        // Отменяет все копирования при выключении
+};
@@ -0,0 +1,26 @@
+// StartupProfiler.cpp
+#include "StartupProfiler.h"
+#include <QDebug>
+
+void StartupProfiler::mark(const QString& stage) {
+    qint64 now = timer_.elapsed();
+    stages_.push_back({stage, now - last_});
+    last_ = now;
+}
+
+void StartupProfiler::markFirstFrame() {
+    if (firstFrameMs_ >= 0) return;
+    mark("Первый кадр");
+    firstFrameMs_ = last_;
+}
+
+void StartupProfiler::report() const {
+    qDebug() << "Запуск: время по этапам";
+    for (const Stage& stage : stages_) {
+        qDebug().noquote() << QString("  %1: %2 мс").arg(stage.name, -28).arg(stage.durationMs);
+    }
+    if (firstFrameMs_ >= 0) {
+        qDebug().noquote() << QString("  До первого кадра: %1 мс").arg(firstFrameMs_);
+    }
+    qDebug().noquote() << QString("  Всего: %1 мс").arg(last_);
+}
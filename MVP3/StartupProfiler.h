@@ -0,0 +1,35 @@
+// StartupProfiler.h
+#pragma once
+#include <QElapsedTimer> // Замер времени этапов
+#include <QString>
+#include <vector>
+
+// Замер времени запуска по этапам: от создания окна до первого кадра
+// (time-to-first-frame) и дальше по отложенным задачам.
+// Каждый mark() записывает длительность этапа с предыдущей отметки
+class StartupProfiler {
+public:
+    StartupProfiler() { timer_.start(); last_ = 0; }
+
+    // Завершение этапа с именем stage
+    void mark(const QString& stage);
+
+    // Время первого кадра фиксируется отдельно - относительно начала запуска
+    void markFirstFrame();
+
+    // Отчет в отладочный вывод: этапы, их стоимость и время до первого кадра
+    void report() const;
+
+    qint64 elapsed() const { return timer_.elapsed(); }
+
+private:
+    struct Stage {
+        QString name;
+        qint64 durationMs;
+    };
+
+    QElapsedTimer timer_;
+    qint64 last_;                   // Момент предыдущей отметки
+    qint64 firstFrameMs_ = -1;      // Время до первого кадра, -1 - еще не было
+    std::vector<Stage> stages_;
+};
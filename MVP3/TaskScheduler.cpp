@@ -0,0 +1,164 @@
+// TaskScheduler.cpp
+#include "TaskScheduler.h"
+#include <QDebug>    // Исключение из задачи
+#include <algorithm> // std::max
+#include <exception>
+
+namespace {
+// При остановке пула из очередей выполняются только задачи этого класса
+const int kKeptOnShutdown = static_cast<int>(TaskPriority::Maintenance);
+
+// Номер потока пула, в котором выполняется код; -1 - поток не из пула
+thread_local int tlsWorkerIndex = -1;
+// Пул, которому принадлежит текущий поток
+thread_local const TaskScheduler* tlsOwner = nullptr;
+}
+
+TaskScheduler& TaskScheduler::instance() {
+    static TaskScheduler scheduler;
+    return scheduler;
+}
+
+TaskScheduler::TaskScheduler(unsigned threadCount) {
+    // Одно ядро остается GUI потоку
+    if (threadCount == 0) {
+        unsigned cores = std::thread::hardware_concurrency();
+        threadCount = std::max(1u, cores > 1 ? cores - 1 : 1u);
+    }
+
+    for (unsigned i = 0; i < threadCount; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        threads_.emplace_back(&TaskScheduler::workerLoop, this, static_cast<int>(i));
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    shutdown();
+}
+
+CancellationToken TaskScheduler::submit(TaskPriority priority, Work work, CancellationToken token) {
+    const int p = static_cast<int>(priority);
+    Task task{std::move(work), token};
+
+    if (tlsOwner == this && tlsWorkerIndex >= 0) {
+        // Подзадача из пула - в собственную очередь потока.
+        // Счетчик увеличивается до публикации, чтобы не уйти в минус при перехвате
+        {
+            std::lock_guard<std::mutex> lock(globalMutex_);
+            if (stopping_ && p != kKeptOnShutdown) return token;  // Пул останавливается
+            pending_.fetch_add(1, std::memory_order_relaxed);
+        }
+        Worker& self = *workers_[tlsWorkerIndex];
+        std::lock_guard<std::mutex> lock(self.mutex);
+        self.queues[p].push_back(std::move(task));
+    } else {
+        std::lock_guard<std::mutex> lock(globalMutex_);
+        if (stopping_) return token;  // Пул остановлен - задача не выполнится
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        global_[p].push_back(std::move(task));
+    }
+
+    wake_.notify_one();
+    return token;
+}
+
+bool TaskScheduler::takeTask(int index, Task& task) {
+    Worker& self = *workers_[index];
+    const int count = static_cast<int>(workers_.size());
+
+    for (int p = 0; p < PriorityCount; ++p) {
+        // 1. Свои задачи - с конца
+        {
+            std::lock_guard<std::mutex> lock(self.mutex);
+            if (!self.queues[p].empty()) {
+                task = std::move(self.queues[p].back());
+                self.queues[p].pop_back();
+                return true;
+            }
+        }
+        // 2. Общая очередь - по порядку поступления
+        {
+            std::lock_guard<std::mutex> lock(globalMutex_);
+            if (!global_[p].empty()) {
+                task = std::move(global_[p].front());
+                global_[p].pop_front();
+                return true;
+            }
+        }
+        // 3. Перехват у других потоков - самые старые задачи
+        for (int k = 1; k < count; ++k) {
+            Worker& victim = *workers_[(index + k) % count];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.queues[p].empty()) {
+                task = std::move(victim.queues[p].front());
+                victim.queues[p].pop_front();
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void TaskScheduler::workerLoop(int index) {
+    tlsWorkerIndex = index;
+    tlsOwner = this;
+
+    for (;;) {
+        Task task;
+        if (takeTask(index, task)) {
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            if (!task.token.isCancelled()) {
+                // Исключение из задачи не должно завершать процесс
+                try {
+                    task.work(task.token);
+                } catch (const std::exception& e) {
+                    qWarning() << "Фоновая задача завершилась с исключением:" << e.what();
+                } catch (...) {
+                    qWarning() << "Фоновая задача завершилась с неизвестным исключением";
+                }
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(globalMutex_);
+        wake_.wait(lock, [this] {
+            return stopping_ || pending_.load(std::memory_order_relaxed) > 0;
+        });
+        if (stopping_ && pending_.load(std::memory_order_relaxed) == 0) return;
+    }
+}
+
+size_t TaskScheduler::dropQueued(std::deque<Task> (&queues)[PriorityCount]) {
+    size_t dropped = 0;
+    for (int p = 0; p < PriorityCount; ++p) {
+        if (p == kKeptOnShutdown) continue;
+        dropped += queues[p].size();
+        queues[p].clear();
+    }
+    return dropped;
+}
+
+void TaskScheduler::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(globalMutex_);
+        if (stopping_) return;
+        stopping_ = true;
+
+        // Незапущенное сканирование и анализ выход не ждет: при следующем
+        // запуске они начнутся заново. Запись файлов выполняется до конца
+        size_t dropped = dropQueued(global_);
+        for (const auto& worker : workers_) {
+            std::lock_guard<std::mutex> workerLock(worker->mutex);
+            dropped += dropQueued(worker->queues);
+        }
+        pending_.fetch_sub(dropped, std::memory_order_relaxed);
+    }
+    wake_.notify_all();
+
+    // Потоки выходят, когда очереди опустеют
+    for (std::thread& thread : threads_) {
+        if (thread.joinable()) thread.join();
+    }
+}
@@ -0,0 +1,108 @@
+// TaskScheduler.h
+#pragma once
+#include <QCoreApplication> // Доставка результатов в GUI поток
+#include <QObject>
+#include <QPointer>         // Получатель результата может быть удален раньше
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>      // std::invoke_result_t
+#include <vector>
+
+// Токен отмены: копии разделяют один флаг. Задача проверяет его
+// перед запуском и (по желанию) во время работы
+class CancellationToken {
+public:
+    CancellationToken() : flag_(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() const { flag_->store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return flag_->load(std::memory_order_relaxed); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> flag_;
+};
+
+// Классы приоритета фоновых задач (меньше - важнее)
+enum class TaskPriority {
+    Interactive = 0,  // Нужно пользователю прямо сейчас: обложка, проверка формата
+    LookAhead   = 1,  // Упреждающая работа: проверка следующих треков
+    BulkScan    = 2,  // Массовая работа: сканирование и анализ библиотеки
+    Maintenance = 3   // Обслуживание: запись файлов, сжатие журналов
+};
+
+// Общий для всего приложения пул потоков с перехватом работы (work stealing).
+// У каждого потока свои очереди по приоритетам: свои задачи он берет с конца
+// (LIFO, горячий кэш), чужие и общие - с начала (FIFO). Всегда выполняется
+// самая приоритетная из доступных задач. Все фоновые подсистемы запускают
+// работу здесь, а не в собственных QThread - число потоков не превышает число ядер
+class TaskScheduler {
+public:
+    using Work = std::function<void(const CancellationToken&)>;
+
+    static TaskScheduler& instance();
+
+    explicit TaskScheduler(unsigned threadCount = 0);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    // Поставить задачу в очередь; возвращает ее токен отмены
+    CancellationToken submit(TaskPriority priority, Work work,
+                             CancellationToken token = CancellationToken());
+
+    // Задача с результатом: work выполняется в пуле, done(result) - в GUI потоке,
+    // если задачу не отменили и context еще существует
+    template <typename WorkFn, typename DoneFn>
+    CancellationToken run(TaskPriority priority, QObject* context, WorkFn work, DoneFn done,
+                          CancellationToken token = CancellationToken()) {
+        using Result = std::invoke_result_t<WorkFn&, const CancellationToken&>;
+        QPointer<QObject> guard(context);
+        return submit(priority, [guard, work, done](const CancellationToken& t) mutable {
+            auto result = std::make_shared<Result>(work(t));
+            QCoreApplication* app = QCoreApplication::instance();
+            if (t.isCancelled() || !app) return;
+            QMetaObject::invokeMethod(app, [guard, done, result, t]() mutable {
+                if (guard && !t.isCancelled()) done(std::move(*result));
+            }, Qt::QueuedConnection);
+        }, token);
+    }
+
+    // Остановить потоки: из очередей выполняются только задачи обслуживания
+    // (запись файлов), остальные отбрасываются; выполняющиеся - дожидаются
+    void shutdown();
+
+    unsigned threadCount() const { return static_cast<unsigned>(threads_.size()); }
+
+private:
+    static constexpr int PriorityCount = 4;
+
+    struct Task {
+        Work work;
+        CancellationToken token;
+    };
+
+    // Очереди одного потока
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> queues[PriorityCount];
+    };
+
+    void workerLoop(int index);
+    bool takeTask(int index, Task& task);  // Лучшая доступная задача для потока index
+    size_t dropQueued(std::deque<Task> (&queues)[PriorityCount]); // Очистка очередей при остановке
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+
+    std::mutex globalMutex_;                 // Общие очереди и ожидание работы
+    std::deque<Task> global_[PriorityCount]; // Задачи, поставленные не из пула
+    std::condition_variable wake_;
+    std::atomic<size_t> pending_{0};         // Задач в очередях
+    bool stopping_ = false;
+};
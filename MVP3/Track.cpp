@@ -3,14 +3,10 @@
 #include <QFileInfo>
 #include <QFile>
 #include <QImage>
-#include <QMediaMetaData>
-#include <QMediaPlayer>
-#include <QBuffer>
-#include <QEventLoop>
-#include <QTimer>
 #include <QCoreApplication>  // Добавьте эту строку
 
 #include "resource_finder.h"
+#include "Id3Reader.h"       // Обложка прямо из тега
 
 Track::Track(std::string path, std::string artist, std::string title,
              std::string album, double rating)
@@ -62,46 +58,15 @@ QImage Track::getCoverImage() const {
     return cover;
 }
 
+// Обложка из тега ID3 (APIC): тег читается через отображение файла,
+// без запуска медиаплеера и ожидания его метаданных
 QImage Track::extractCoverFromMP3() const {
-    QImage cover;
-
-    QMediaPlayer player;
-    player.setSource(QUrl::fromLocalFile(QString::fromStdString(path_)));
-
-    QEventLoop loop;
-    QTimer timer;
-    timer.setSingleShot(true);
-
-    QObject::connect(&player, &QMediaPlayer::metaDataChanged, [&]() {
-        QVariant coverData = player.metaData().value(QMediaMetaData::CoverArtImage);
-        if (coverData.isValid()) {
-            cover = coverData.value<QImage>();
-            if (!cover.isNull()) {
-                loop.quit();
-            }
-        }
-
-        if (cover.isNull()) {
-            QVariant thumbnailData = player.metaData().value(QMediaMetaData::ThumbnailImage);
-            if (thumbnailData.isValid()) {
-                cover = thumbnailData.value<QImage>();
-                if (!cover.isNull()) {
-                    loop.quit();
-                }
-            }
-        }
-    });
-
-    QObject::connect(&timer, &QTimer::timeout, &loop, &QEventLoop::quit);
-    timer.start(500);
-
-    loop.exec();
-
-    return cover;
+    Id3Reader reader(QString::fromStdString(path_));
+    return reader.cover();
 }
 
 // ИСПРАВЛЕННЫЙ МЕТОД
-QImage Track::loadDefaultCover() const {
+QImage Track::loadDefaultCover() {
     QString coverPath = ResourceFinder::findDefaultCover();
 
     if (!coverPath.isEmpty() && QFile::exists(coverPath)) {
@@ -118,5 +83,5 @@ QImage Track::loadDefaultCover() const {
 }
 
 std::string Track::getID() const {
-    return path_;
+    return contentId_.empty() ? path_ : contentId_;
 }
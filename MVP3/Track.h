@@ -18,11 +18,31 @@ public:
     // Сеттер для установки рейтинга трека
     void setTrackRating(double rating) { rating_ = rating; }
 
-    // Метод для получения уникального идентификатора трека (путь к файлу)
+    // Поля из тега файла (читается фоном после заполнения плейлиста по именам файлов)
+    void setTags(std::string artist, std::string title, std::string album) {
+        artist_ = std::move(artist);
+        title_ = std::move(title);
+        album_ = std::move(album);
+    }
+
+    // Отпечаток содержимого (TrackIdStore); пустой - еще не посчитан
+    const std::string& contentId() const { return contentId_; }
+    void setContentId(std::string id) { contentId_ = std::move(id); }
+
+    // Темп и тональность из анализа звучания (FeatureStore); 0 и -1 - еще не известны.
+    // Тональность - как AudioFeatures::key(): 0..11 мажор от до, 12..23 минор
+    float bpm() const { return bpm_; }
+    int key() const { return key_; }
+    void setMusicInfo(float bpm, int key) { bpm_ = bpm; key_ = key; }
+
+    // Уникальный идентификатор трека: отпечаток содержимого, пока его нет - путь к файлу.
+    // По нему хранятся рейтинги и журнал прослушиваний, поэтому перенос файла их не теряет
     std::string getID() const;
 
     // метод, получает обложку (либо из MP3, либо default.jpg)
     QImage getCoverImage() const;
+    // Загрузка обложки по умолчанию (картинка "default.jpg" или серый квадрат)
+    static QImage loadDefaultCover();
 
 private:
     // Приватные поля класса
@@ -31,10 +51,11 @@ private:
     std::string title_;    // Название трека
     std::string album_;    // Альбом
     double rating_;        // Рейтинг от 0.0 до 5.0
+    std::string contentId_; // Отпечаток звуковых данных
+    float bpm_ = 0.0f;      // Темп, ударов в минуту
+    int key_ = -1;          // Тональность
 
     // МЕТОД 1: извлечение обложки из MP3 файла
     QImage extractCoverFromMP3() const;
 
-    // МЕТОД 2: загрузка обложки по умолчанию (картинка "default.jpg")
-    QImage loadDefaultCover() const;
 };
@@ -0,0 +1,192 @@
+// TrackIdStore.cpp
+#include "TrackIdStore.h"
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>   // Атомарная запись кэша
+#include <QTextStream>
+
+#include <cstring> // std::memcmp
+#include <vector>
+
+#include "ContentHash.h"
+#include "MappedFile.h"
+#include "Mp3Frame.h"  // Размер тега ID3v2
+
+namespace {
+// Заголовок формата; при смене формата старый кэш просто игнорируется
+const char* const kHeader = "ALEXMUSIC-TRACKIDS 2";
+const int kBatchSize = 32;           // Файлов в одной задаче пула
+// Звуковые данные хэшируются целиком: одинаковые отпечатки считаются точными
+// копиями, и одну из них предлагается скрыть. Файл отображается кусками -
+// адресное пространство не растет с размером трека, а отмена проверяется между ними
+const qint64 kChunk = 4 * 1024 * 1024;
+
+qint64 modifiedMs(const QFileInfo& info) {
+    return info.lastModified().toMSecsSinceEpoch();
+}
+
+// Начало звуковых данных: после ID3v2 и (для FLAC) блоков метаданных
+qint64 payloadStart(MappedFile& file) {
+    ByteView head = file.head(10);
+    qint64 start = static_cast<qint64>(mp3Id3v2Size(head.data, head.size));
+    if (start >= file.size()) return 0;  // Тег больше файла - поврежден, берем все
+
+    ByteView magic = file.map(start, 4);
+    if (magic.size == 4 && std::memcmp(magic.data, "fLaC", 4) == 0) {
+        qint64 pos = start + 4;
+        for (;;) {
+            ByteView block = file.map(pos, 4);
+            if (block.size < 4) break;
+            const bool last = (block.data[0] & 0x80) != 0;
+            pos += 4 + ((qint64(block.data[1]) << 16) | (qint64(block.data[2]) << 8) | block.data[3]);
+            if (last || pos >= file.size()) break;
+        }
+        if (pos < file.size()) start = pos;
+    }
+    return start;
+}
+
+// Конец звуковых данных: без ID3v1 в последних 128 байтах
+qint64 payloadEnd(MappedFile& file) {
+    ByteView tail = file.tail(128);
+    if (tail.size == 128 && std::memcmp(tail.data, "TAG", 3) == 0) {
+        return file.size() - 128;
+    }
+    return file.size();
+}
+}
+
+TrackIdStore::TrackIdStore(QString filePath, QObject* parent)
+    : QObject(parent), filePath_(std::move(filePath)) {}
+
+// Строка кэша: размер|время|идентификатор|путь
+void TrackIdStore::load() {
+    QFile file(filePath_);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return;
+
+    QTextStream in(&file);
+    if (in.readLine() != QLatin1String(kHeader)) return;
+
+    while (!in.atEnd()) {
+        const QString line = in.readLine();
+        const QStringList parts = line.split('|');
+        if (parts.size() < 4) continue;
+
+        Entry entry;
+        entry.size = parts[0].toLongLong();
+        entry.modified = parts[1].toLongLong();
+        entry.id = parts[2];
+        entry.path = line.section('|', 3);  // Путь - остаток строки
+        if (entry.id.size() != 16 || entry.path.isEmpty()) continue;
+        entries_.insert(entry.path, entry);
+    }
+}
+
+void TrackIdStore::save() {
+    if (!dirty_) return;
+
+    QSaveFile file(filePath_);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) return;
+
+    QTextStream out(&file);
+    out << kHeader << '\n';
+    for (const Entry& entry : entries_) {
+        out << entry.size << '|' << entry.modified << '|' << entry.id << '|' << entry.path << '\n';
+    }
+    out.flush();
+    if (file.commit()) {
+        dirty_ = false;
+    }
+}
+
+void TrackIdStore::start(const QStringList& paths) {
+    cancel();
+    token_ = CancellationToken();
+    changed_ = 0;
+    if (paths.isEmpty()) {
+        emit finished(0);
+        return;
+    }
+
+    // Пачки по kBatchSize с известными записями: поток пула сам сверяет размер
+    // и время изменения и считает отпечаток, только если файл новый или менялся
+    for (int first = 0; first < paths.size(); first += kBatchSize) {
+        std::vector<Entry> batch;
+        batch.reserve(kBatchSize);
+        for (int i = first; i < qMin(first + kBatchSize, int(paths.size())); ++i) {
+            Entry entry = entries_.value(paths[i]);
+            entry.path = paths[i];
+            batch.push_back(std::move(entry));
+        }
+        ++pendingBatches_;
+        TaskScheduler::instance().run(
+            TaskPriority::BulkScan, this,
+            [batch](const CancellationToken& token) {
+                std::vector<Entry> changed;
+                for (const Entry& known : batch) {
+                    if (token.isCancelled()) break;
+                    QFileInfo info(known.path);
+                    if (!known.id.isEmpty() && info.size() == known.size && modifiedMs(info) == known.modified) {
+                        continue;  // Файл не менялся
+                    }
+                    Entry entry = compute(known.path, token);
+                    if (!entry.id.isEmpty()) changed.push_back(std::move(entry));
+                }
+                return changed;
+            },
+            [this](std::vector<Entry> changed) {
+                for (Entry& entry : changed) {
+                    const auto it = entries_.constFind(entry.path);
+                    if (it == entries_.cend() || it->id != entry.id) ++changed_;
+                    entries_.insert(entry.path, entry);
+                    dirty_ = true;
+                }
+                if (--pendingBatches_ == 0) {
+                    save();
+                    emit finished(changed_);
+                }
+            },
+            token_);
+    }
+}
+
+void TrackIdStore::cancel() {
+    if (!isRunning()) return;
+    token_.cancel();  // Результаты отмененных пачек не доставляются
+    pendingBatches_ = 0;
+    save();           // Уже посчитанное сохраняем
+}
+
+QString TrackIdStore::id(const QString& path) const {
+    auto it = entries_.constFind(path);
+    return it != entries_.cend() ? it->id : QString();
+}
+
+TrackIdStore::Entry TrackIdStore::compute(const QString& path, const CancellationToken& token) {
+    Entry entry;
+    entry.path = path;
+    QFileInfo info(path);
+    MappedFile file(path);
+    if (!file.isOpen() || file.size() <= 0) return entry;
+
+    const qint64 start = payloadStart(file);
+    const qint64 end = qMax(start, payloadEnd(file));
+    const qint64 length = end - start;
+
+    // Каждый кусок - затравка для следующего; длина входит в первый
+    uint64_t hash = uint64_t(length);
+    for (qint64 offset = start; offset < end; offset += kChunk) {
+        if (token.isCancelled()) return entry;
+        const qint64 size = qMin(kChunk, end - offset);
+        ByteView chunk = file.map(offset, size);
+        if (qint64(chunk.size) != size) return entry;
+        hash = xxh64(chunk.data, chunk.size, hash);
+        file.unmap(chunk);
+    }
+
+    entry.id = QString("%1").arg(qulonglong(hash), 16, 16, QChar('0'));
+    entry.size = info.size();
+    entry.modified = modifiedMs(info);
+    return entry;
+}
@@ -0,0 +1,56 @@
+// TrackIdStore.h
+#pragma once
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include "TaskScheduler.h" // Отпечатки считаются в общем пуле потоков
+
+// Идентификаторы треков по содержимому (trackids.txt рядом с library.txt).
+// Отпечаток - XXH64 звуковых данных без тегов (ID3v2 в начале, ID3v1 в
+// конце, блоки метаданных FLAC), поэтому правка тегов, переименование и
+// перенос файла его не меняют. Рейтинги, журнал прослушиваний и кэши
+// анализа ключуются этим идентификатором: перенесенный файл находит свои
+// данные поиском по хэш-таблице, без повторного анализа.
+// Отпечаток считается один раз и действителен, пока у файла те же размер и
+// время изменения; при сканировании библиотеки файлы проверяются пачками
+// параллельно, как при проверке целостности
+class TrackIdStore : public QObject {
+    Q_OBJECT
+
+public:
+    struct Entry {
+        QString path;
+        QString id;           // 16 шестнадцатеричных цифр; пустой - файл не прочитан
+        qint64 size = -1;
+        qint64 modified = 0;  // мс с эпохи
+    };
+
+    explicit TrackIdStore(QString filePath, QObject* parent = nullptr);
+
+    void load();
+    void save();
+
+    // Сверка файлов с кэшем и подсчет недостающих отпечатков (в фоне)
+    void start(const QStringList& paths);
+    void cancel();
+    bool isRunning() const { return pendingBatches_ > 0; }
+
+    // Известный идентификатор файла (без обращения к диску); пустой - еще не посчитан
+    QString id(const QString& path) const;
+
+    // Отпечаток одного файла (из любого потока); при отмене - пустой
+    static Entry compute(const QString& path, const CancellationToken& token = CancellationToken());
+
+signals:
+    void finished(int changed);  // changed - у скольких файлов идентификатор появился или сменился
+
+private:
+    QString filePath_;
+    QHash<QString, Entry> entries_;
+    CancellationToken token_;
+    int pendingBatches_ = 0;
+    int changed_ = 0;
+    bool dirty_ = false;
+};
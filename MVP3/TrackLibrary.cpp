@@ -0,0 +1,21 @@
+// TrackLibrary.cpp
+#include "TrackLibrary.h"
+
+TrackLibrary::TrackLibrary() : current_(std::make_shared<const Snapshot>()) {}
+
+void TrackLibrary::assign(Tracks tracks) {
+    auto next = std::make_shared<Snapshot>();
+    next->tracks = std::move(tracks);
+    publish(std::move(next));
+}
+
+void TrackLibrary::clear() {
+    if (current_->tracks.empty()) return;
+    publish(std::make_shared<Snapshot>());
+}
+
+void TrackLibrary::publish(std::shared_ptr<Snapshot> next) {
+    next->version = current_->version + 1;
+    // Старую версию освободит последний читатель, который ее держит
+    std::atomic_store(&current_, SnapshotPtr(std::move(next)));
+}
@@ -0,0 +1,51 @@
+// TrackLibrary.h
+#pragma once
+#include <cstdint> // uint64_t
+#include <memory>  // std::shared_ptr, std::atomic_load/atomic_store
+#include <vector>
+
+#include "Track.h"
+
+// Версионированная библиотека треков с неизменяемыми снимками (copy-on-write).
+// Писатель (GUI поток) не меняет опубликованные данные: каждое изменение
+// собирает новую версию и атомарно публикует ее. Читатели из любых потоков
+// (поиск, сканирование, фоновая запись) берут снимок за O(1) без блокировок
+// и работают с согласованными данными, пока держат ссылку на него
+class TrackLibrary {
+public:
+    using Tracks = std::vector<Track>;
+
+    // Одна опубликованная версия библиотеки
+    struct Snapshot {
+        uint64_t version = 0;
+        Tracks tracks;
+    };
+    using SnapshotPtr = std::shared_ptr<const Snapshot>;
+
+    TrackLibrary();
+
+    // Текущий снимок (из любого потока)
+    SnapshotPtr snapshot() const { return std::atomic_load(&current_); }
+
+    // Треки текущей версии - только для потока-писателя
+    const Tracks& tracks() const { return current_->tracks; }
+    uint64_t version() const { return current_->version; }
+
+    // Изменения (только поток-писатель): новая версия публикуется целиком
+    void assign(Tracks tracks);
+    void clear();
+
+    // Произвольное изменение копии: fn(Tracks&) правит черновик новой версии
+    template <typename Fn>
+    void modify(Fn&& fn) {
+        auto next = std::make_shared<Snapshot>();
+        next->tracks = current_->tracks;
+        fn(next->tracks);
+        publish(std::move(next));
+    }
+
+private:
+    void publish(std::shared_ptr<Snapshot> next);
+
+    SnapshotPtr current_;  // Меняется только через std::atomic_store
+};
@@ -5,6 +5,8 @@
 #include <QEventLoop>
 #include <QTimer>
 
+#include "FormatProbe.h" // Формат и длительность - по содержимому файла
+
 TrackValidator::TrackValidator(QObject* parent) : QObject(parent) {}
 
 bool TrackValidator::validateTrack(const QString& filePath) {
@@ -27,15 +29,21 @@ bool TrackValidator::validateTrack(const QString& filePath) {
         return false;
     }
 
-    // Проверяем расширение
-    if (!filePath.endsWith(".mp3", Qt::CaseInsensitive)) {
-        lastError_ = "Неверный формат файла (должен быть .mp3)";
-        qDebug() << "  Не MP3 файл";
+    // Проверяем формат по содержимому, а не по расширению
+    ProbeResult probe = ProbeRegistry::instance().probe(filePath);
+    if (probe.format == AudioFormat::Unknown) {
+        lastError_ = probe.error;
+        qDebug() << "  Формат не распознан:" << probe.error;
+        return false;
+    }
+    if (!probe.valid && probe.format != AudioFormat::Mp3) {
+        lastError_ = probe.error;
+        qDebug() << "  Поврежденный контейнер:" << probe.error;
         return false;
     }
 
     // Проверяем длительность
-    qint64 duration = getDuration(filePath);
+    qint64 duration = probe.valid ? probe.durationMs : playerDuration(filePath);
     qDebug() << "  Длительность:" << duration << "мс";
 
     if (duration <= 0) {
@@ -55,6 +63,16 @@ bool TrackValidator::validateTrack(const QString& filePath) {
 }
 
 qint64 TrackValidator::getDuration(const QString& filePath) {
+    // Длительность из заголовков контейнера (для MP3 - по цепочке кадров)
+    ProbeResult probe = ProbeRegistry::instance().probe(filePath);
+    if (probe.valid && probe.durationMs > 0) {
+        return probe.durationMs;
+    }
+    return playerDuration(filePath);
+}
+
+qint64 TrackValidator::playerDuration(const QString& filePath) {
+    // Разборщик не справился (нестандартный поток) - решает сам плеер
     QMediaPlayer player;
     QAudioOutput audioOutput;
     player.setAudioOutput(&audioOutput);
@@ -20,5 +20,8 @@ signals:
     void validationFailed(const QString& filePath, const QString& error);
 
 private:
+    // Длительность через QMediaPlayer - запасной путь, когда заголовки не разобрались
+    qint64 playerDuration(const QString& filePath);
+
     QString lastError_;
 };
@@ -0,0 +1,61 @@
+// UiUpdateScheduler.cpp
+#include "UiUpdateScheduler.h"
+#include <QGuiApplication> // Основной экран
+#include <QScreen>         // Частота обновления экрана
+#include <cmath>           // std::lround
+
+namespace {
+// Области, которые видны и при свернутом окне
+const unsigned kVisibleWhenSuspended = UiUpdateScheduler::Thumbnail;
+}
+
+UiUpdateScheduler::UiUpdateScheduler(QObject* parent) : QObject(parent) {
+    // Период кадра - по частоте основного экрана (обычно 60 Гц -> 16 мс)
+    if (QScreen* screen = QGuiApplication::primaryScreen()) {
+        qreal rate = screen->refreshRate();
+        if (rate >= 10.0) {
+            frameIntervalMs_ = static_cast<int>(std::lround(1000.0 / rate));
+        }
+    }
+
+    frameTimer_.setSingleShot(true);
+    frameTimer_.setTimerType(Qt::PreciseTimer);
+    connect(&frameTimer_, &QTimer::timeout, this, &UiUpdateScheduler::onFrame);
+    sinceFlush_.start();
+}
+
+void UiUpdateScheduler::markDirty(unsigned regions) {
+    dirty_ |= regions;
+    schedule();
+}
+
+void UiUpdateScheduler::setSuspended(bool suspended) {
+    if (suspended_ == suspended) return;
+    suspended_ = suspended;
+
+    if (suspended_) {
+        // Остаются только области, видимые вне окна
+        if (!(dirty_ & kVisibleWhenSuspended)) frameTimer_.stop();
+    } else {
+        // Окно снова видно: один полный кадр с актуальным состоянием
+        markDirty(AllRegions);
+    }
+}
+
+void UiUpdateScheduler::schedule() {
+    unsigned pending = suspended_ ? (dirty_ & kVisibleWhenSuspended) : dirty_;
+    if (!pending || frameTimer_.isActive()) return;
+
+    // Не раньше, чем через период кадра после предыдущей перерисовки
+    qint64 wait = frameIntervalMs_ - sinceFlush_.elapsed();
+    frameTimer_.start(wait > 0 ? static_cast<int>(wait) : 0);
+}
+
+void UiUpdateScheduler::onFrame() {
+    unsigned regions = suspended_ ? (dirty_ & kVisibleWhenSuspended) : dirty_;
+    if (!regions) return;
+
+    dirty_ &= ~regions;  // Скрытые области копятся до разворачивания окна
+    sinceFlush_.restart();
+    emit flush(regions);
+}
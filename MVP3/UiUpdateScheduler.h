@@ -0,0 +1,53 @@
+// UiUpdateScheduler.h
+#pragma once
+#include <QObject>
+#include <QTimer>        // Таймер кадра
+#include <QElapsedTimer> // Время с последней отрисовки
+
+// Планировщик обновлений интерфейса: события плеера (тики позиции, смена трека,
+// навигация) только помечают области "грязными", а перерисовка выполняется
+// не чаще одного раза за кадр дисплея - сразу для всех накопленных областей.
+// Пока окно свернуто или скрыто, кадры не планируются вовсе
+class UiUpdateScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    // Области интерфейса, обновляемые независимо
+    enum Region : unsigned {
+        Progress      = 1u << 0,  // Ползунок прогресса
+        TimeLabel     = 1u << 1,  // Метка времени "мм:сс / мм:сс"
+        Cover         = 1u << 2,  // Обложка текущего трека
+        TrackText     = 1u << 3,  // Название, исполнитель, статистика прослушиваний
+        Rating        = 1u << 4,  // Звезды рейтинга
+        Selection     = 1u << 5,  // Выделение текущего трека в списке (без прокрутки)
+        ListHighlight = 1u << 6,  // Выделение текущего трека с прокруткой к нему
+        Thumbnail     = 1u << 7,  // Кнопки миниатюры на панели задач (Windows)
+        NowPlaying    = Cover | TrackText | Rating | Selection, // Вся панель "сейчас играет"
+        AllRegions    = (1u << 8) - 1
+    };
+
+    explicit UiUpdateScheduler(QObject* parent = nullptr);
+
+    // Пометить области для обновления в ближайшем кадре
+    void markDirty(unsigned regions);
+
+    // Окно свернуто/скрыто: обновляются только области, видимые вне окна (Thumbnail)
+    void setSuspended(bool suspended);
+    bool isSuspended() const { return suspended_; }
+
+signals:
+    // Перерисовка накопленных областей
+    void flush(unsigned regions);
+
+private slots:
+    void onFrame();
+
+private:
+    void schedule();
+
+    QTimer frameTimer_;         // Одноразовый таймер до следующего кадра
+    QElapsedTimer sinceFlush_;  // Время с последней перерисовки
+    int frameIntervalMs_ = 16;  // Период кадра по частоте обновления экрана
+    unsigned dirty_ = 0;        // Накопленные области
+    bool suspended_ = false;
+};
@@ -0,0 +1,149 @@
+// WaveformPeaks.cpp
+#include "WaveformPeaks.h"
+#include <algorithm> // std::min, std::max, std::clamp
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h> // SSE2: 4 отсчета за инструкцию
+#define ALEXMUSIC_WAVEFORM_SSE2 1
+#endif
+
+namespace {
+const size_t kBlockSize = 256;  // Отсчетов в мелком блоке
+
+struct Reduction {
+    float min;
+    float max;
+    float sumSquares;
+};
+
+// Минимум, максимум и сумма квадратов отрезка (count > 0)
+Reduction reduce(const float* x, size_t count) {
+    Reduction r{x[0], x[0], 0.0f};
+    size_t i = 0;
+#ifdef ALEXMUSIC_WAVEFORM_SSE2
+    if (count >= 4) {
+        __m128 vmin = _mm_set1_ps(x[0]);
+        __m128 vmax = vmin;
+        __m128 vsum = _mm_setzero_ps();
+        for (; i + 4 <= count; i += 4) {
+            const __m128 v = _mm_loadu_ps(x + i);
+            vmin = _mm_min_ps(vmin, v);
+            vmax = _mm_max_ps(vmax, v);
+            vsum = _mm_add_ps(vsum, _mm_mul_ps(v, v));
+        }
+        float mins[4], maxs[4], sums[4];
+        _mm_storeu_ps(mins, vmin);
+        _mm_storeu_ps(maxs, vmax);
+        _mm_storeu_ps(sums, vsum);
+        for (int lane = 0; lane < 4; ++lane) {
+            r.min = std::min(r.min, mins[lane]);
+            r.max = std::max(r.max, maxs[lane]);
+            r.sumSquares += sums[lane];
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        r.min = std::min(r.min, x[i]);
+        r.max = std::max(r.max, x[i]);
+        r.sumSquares += x[i] * x[i];
+    }
+    return r;
+}
+
+int8_t quantize(float value) {
+    return static_cast<int8_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 127.0f));
+}
+}
+
+WaveformPeaks::Builder::Builder() {
+    pending_.reserve(kBlockSize);
+}
+
+void WaveformPeaks::Builder::add(const float* samples, size_t count) {
+    while (count > 0) {
+        // Целый блок прямо из буфера декодера - без копирования
+        if (pending_.empty() && count >= kBlockSize) {
+            const Reduction r = reduce(samples, kBlockSize);
+            blocks_.push_back({r.min, r.max, r.sumSquares, kBlockSize});
+            samples += kBlockSize;
+            count -= kBlockSize;
+            continue;
+        }
+        const size_t take = std::min(count, kBlockSize - pending_.size());
+        pending_.insert(pending_.end(), samples, samples + take);
+        samples += take;
+        count -= take;
+        if (pending_.size() == kBlockSize) flush();
+    }
+}
+
+void WaveformPeaks::Builder::flush() {
+    if (pending_.empty()) return;
+    const Reduction r = reduce(pending_.data(), pending_.size());
+    blocks_.push_back({r.min, r.max, r.sumSquares, pending_.size()});
+    pending_.clear();
+}
+
+bool WaveformPeaks::Builder::finish(WaveformPeaks& peaks) {
+    flush();
+    if (blocks_.empty()) return false;
+
+    // Сведение мелких блоков к kBuckets столбцам; коротким трекам блок повторяется
+    peaks.buckets_.assign(kBuckets, Bucket());
+    const size_t total = blocks_.size();
+    for (size_t b = 0; b < kBuckets; ++b) {
+        const size_t first = b * total / kBuckets;
+        const size_t last = std::max(first + 1, (b + 1) * total / kBuckets);
+
+        float low = blocks_[first].min;
+        float high = blocks_[first].max;
+        double sumSquares = 0.0;
+        size_t count = 0;
+        for (size_t i = first; i < last; ++i) {
+            low = std::min(low, blocks_[i].min);
+            high = std::max(high, blocks_[i].max);
+            sumSquares += blocks_[i].sumSquares;
+            count += blocks_[i].count;
+        }
+        Bucket& bucket = peaks.buckets_[b];
+        bucket.min = quantize(low);
+        bucket.max = quantize(high);
+        const double rms = count > 0 ? std::sqrt(sumSquares / count) : 0.0;
+        bucket.rms = static_cast<uint8_t>(std::lround(std::clamp(rms, 0.0, 1.0) * 255.0));
+    }
+    blocks_.clear();
+    return true;
+}
+
+std::string WaveformPeaks::serialize() const {
+    std::string data;
+    data.reserve(4 + buckets_.size() * 3);
+    const uint32_t count = static_cast<uint32_t>(buckets_.size());
+    for (int shift = 0; shift < 32; shift += 8) {
+        data.push_back(static_cast<char>((count >> shift) & 0xFF));
+    }
+    for (const Bucket& bucket : buckets_) {
+        data.push_back(static_cast<char>(bucket.min));
+        data.push_back(static_cast<char>(bucket.max));
+        data.push_back(static_cast<char>(bucket.rms));
+    }
+    return data;
+}
+
+bool WaveformPeaks::parse(const std::string& data, WaveformPeaks& peaks) {
+    if (data.size() < 4) return false;
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data.data());
+    const uint32_t count = uint32_t(bytes[0]) | (uint32_t(bytes[1]) << 8) |
+                           (uint32_t(bytes[2]) << 16) | (uint32_t(bytes[3]) << 24);
+    if (count == 0 || count > 65536 || data.size() != 4 + size_t(count) * 3) return false;
+
+    peaks.buckets_.resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        const unsigned char* p = bytes + 4 + i * 3;
+        peaks.buckets_[i].min = static_cast<int8_t>(p[0]);
+        peaks.buckets_[i].max = static_cast<int8_t>(p[1]);
+        peaks.buckets_[i].rms = p[2];
+    }
+    return true;
+}
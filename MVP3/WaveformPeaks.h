@@ -0,0 +1,47 @@
+// WaveformPeaks.h
+#pragma once
+#include <cstddef> // size_t
+#include <cstdint> // int8_t, uint8_t
+#include <string>
+#include <vector>
+
+// Обзор формы волны трека для полосы перемотки: kBuckets столбцов
+// с минимумом, максимумом и RMS. Строится потоково по моно отсчетам
+// декодера: сначала мелкие блоки фиксированной длины (min/max/сумма
+// квадратов считаются SSE2, где он есть), в конце они сводятся к kBuckets.
+// Хранится компактно - 3 байта на столбец
+class WaveformPeaks {
+public:
+    static constexpr size_t kBuckets = 1024;
+
+    struct Bucket {
+        int8_t min = 0;   // -127..127
+        int8_t max = 0;
+        uint8_t rms = 0;  // 0..255
+    };
+
+    // Накопление отсчетов без знания длины трека
+    class Builder {
+    public:
+        Builder();
+        void add(const float* samples, size_t count);  // Моно, -1..1
+        bool finish(WaveformPeaks& peaks);              // false - отсчетов не было
+
+    private:
+        struct Block { float min; float max; float sumSquares; size_t count; };
+        void flush();
+
+        std::vector<float> pending_;  // Неполный мелкий блок
+        std::vector<Block> blocks_;
+    };
+
+    bool isValid() const { return !buckets_.empty(); }
+    const std::vector<Bucket>& buckets() const { return buckets_; }
+
+    // Двоичное представление: число столбцов (LE32), затем по 3 байта на столбец
+    std::string serialize() const;
+    static bool parse(const std::string& data, WaveformPeaks& peaks);
+
+private:
+    std::vector<Bucket> buckets_;
+};
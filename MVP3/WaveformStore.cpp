@@ -0,0 +1,90 @@
+// WaveformStore.cpp
+#include "WaveformStore.h"
+#include <QCryptographicHash> // Имя файла обзора - хэш пути трека
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include "PcmDecoder.h" // Декодирование трека в PCM
+
+namespace {
+// Заголовок файла; при смене формата старые файлы просто перестраиваются
+const quint32 kMagic = 0x46574D41;  // "AMWF"
+const quint16 kVersion = 1;
+
+qint64 modifiedMs(const QFileInfo& info) {
+    return info.lastModified().toMSecsSinceEpoch();
+}
+}
+
+WaveformStore::WaveformStore(QString directory) : directory_(std::move(directory)) {}
+
+QString WaveformStore::fileFor(const QString& path, const QString& contentId) const {
+    if (!contentId.isEmpty()) return directory_ + "/" + contentId + ".peaks";
+    const QByteArray hash = QCryptographicHash::hash(path.toUtf8(), QCryptographicHash::Sha1).toHex().left(20);
+    return directory_ + "/" + QString::fromLatin1(hash) + ".peaks";
+}
+
+// Файл: магия, версия, размер и время изменения трека, затем столбцы обзора
+WaveformStore::PeaksPtr WaveformStore::load(const QString& path, const QString& contentId) const {
+    QFile file(fileFor(path, contentId));
+    if (!file.open(QIODevice::ReadOnly)) return nullptr;
+
+    QDataStream in(&file);
+    in.setByteOrder(QDataStream::LittleEndian);
+    quint32 magic = 0;
+    quint16 version = 0;
+    qint64 size = -1;
+    qint64 modified = 0;
+    in >> magic >> version >> size >> modified;
+    if (in.status() != QDataStream::Ok || magic != kMagic || version != kVersion) return nullptr;
+
+    // Отпечаток сверен с файлом при сканировании - размер и время уже не важны
+    // (у перенесенного или перетегированного трека они другие)
+    QFileInfo info(path);
+    if (contentId.isEmpty() && (!info.exists() || info.size() != size || modifiedMs(info) != modified)) {
+        return nullptr;  // Трек заменили - обзор устарел
+    }
+
+    const QByteArray payload = file.read(file.size() - file.pos());
+    auto peaks = std::make_shared<WaveformPeaks>();
+    if (!WaveformPeaks::parse(payload.toStdString(), *peaks)) return nullptr;
+    return peaks;
+}
+
+bool WaveformStore::save(const QString& fileName, const WaveformPeaks& peaks, qint64 size, qint64 modified) const {
+    QDir().mkpath(directory_);
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    QDataStream out(&file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out << kMagic << kVersion << size << modified;
+    const std::string payload = peaks.serialize();
+    out.writeRawData(payload.data(), static_cast<int>(payload.size()));
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+WaveformStore::PeaksPtr WaveformStore::build(const QString& path, const QString& contentId,
+                                             const CancellationToken& token) const {
+    const QFileInfo before(path);
+    if (!before.exists()) return nullptr;
+
+    WaveformPeaks::Builder builder;
+    const bool decoded = PcmDecoder::decodeMono(path, token, [&builder](const float* samples, size_t count, uint32_t) {
+        builder.add(samples, count);
+    });
+
+    auto peaks = std::make_shared<WaveformPeaks>();
+    if (!decoded || !builder.finish(*peaks)) return nullptr;
+
+    // Файл меняли во время декодирования - обзор может не совпасть с ним
+    const QFileInfo after(path);
+    if (after.size() != before.size() || modifiedMs(after) != modifiedMs(before)) return nullptr;
+
+    save(fileFor(path, contentId), *peaks, before.size(), modifiedMs(before));
+    return peaks;
+}
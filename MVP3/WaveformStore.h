@@ -0,0 +1,35 @@
+// WaveformStore.h
+#pragma once
+#include <QString>
+
+#include <memory> // std::shared_ptr
+
+#include "TaskScheduler.h" // CancellationToken
+#include "WaveformPeaks.h"
+
+// Файлы обзоров формы волны (папка peaks рядом с library.txt, по файлу на трек).
+// Трек декодируется целиком один раз (QAudioDecoder в пуле потоков), дальше
+// открытие трека - чтение файла в несколько килобайт. Обзор действителен,
+// пока у трека те же размер и время изменения, а если известен отпечаток
+// содержимого (TrackIdStore) - по нему: перенесенный или переименованный
+// трек не декодируется заново. Методы можно вызывать из любого потока
+class WaveformStore {
+public:
+    using PeaksPtr = std::shared_ptr<const WaveformPeaks>;
+
+    explicit WaveformStore(QString directory);
+
+    // Обзор из файла; nullptr - его нет или трек с тех пор менялся.
+    // contentId - отпечаток содержимого; пустой - файл обзора ищется по пути
+    PeaksPtr load(const QString& path, const QString& contentId = QString()) const;
+
+    // Декодирование трека и запись файла обзора (долго - только в пуле)
+    PeaksPtr build(const QString& path, const QString& contentId, const CancellationToken& token) const;
+
+private:
+    // Имя файла - отпечаток содержимого или хэш пути трека
+    QString fileFor(const QString& path, const QString& contentId) const;
+    bool save(const QString& fileName, const WaveformPeaks& peaks, qint64 size, qint64 modified) const;
+
+    QString directory_;
+};
@@ -0,0 +1,103 @@
+// WeightedSampler.cpp
+#include "WeightedSampler.h"
+#include <algorithm> // std::min
+
+// Построение таблицы методом Воуза - O(n)
+void WeightedSampler::AliasTable::build(const double* weights, size_t n) {
+    prob.assign(n, 0.0);
+    alias.resize(n);
+
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) sum += weights[i];
+    if (n == 0 || sum <= 0.0) {
+        for (size_t i = 0; i < n; ++i) alias[i] = static_cast<uint32_t>(i);
+        return;
+    }
+
+    // Масштабируем так, чтобы средний вес был равен 1
+    std::vector<double> scaled(n);
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (size_t i = 0; i < n; ++i) {
+        scaled[i] = weights[i] * n / sum;
+        (scaled[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+    }
+
+    // Каждую "недобравшую" ячейку дополняем из "переполненной"
+    while (!small.empty() && !large.empty()) {
+        uint32_t s = small.back();
+        small.pop_back();
+        uint32_t l = large.back();
+
+        prob[s] = scaled[s];
+        alias[s] = l;
+
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+        if (scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // Остатки (из-за погрешности округления) - полные ячейки
+    for (uint32_t i : large) {
+        prob[i] = 1.0;
+        alias[i] = i;
+    }
+    for (uint32_t i : small) {
+        prob[i] = 1.0;
+        alias[i] = i;
+    }
+}
+
+void WeightedSampler::clear() {
+    weights_.clear();
+    blocks_.clear();
+    blockTotals_.clear();
+    top_ = AliasTable();
+    total_ = 0.0;
+}
+
+void WeightedSampler::assign(const std::vector<double>& weights) {
+    weights_ = weights;
+
+    const size_t blockCount = (weights_.size() + BlockSize - 1) / BlockSize;
+    blocks_.assign(blockCount, AliasTable());
+    blockTotals_.assign(blockCount, 0.0);
+
+    for (size_t b = 0; b < blockCount; ++b) {
+        size_t begin = b * BlockSize;
+        size_t n = std::min(BlockSize, weights_.size() - begin);
+        blocks_[b].build(weights_.data() + begin, n);
+        for (size_t i = begin; i < begin + n; ++i) {
+            blockTotals_[b] += weights_[i];
+        }
+    }
+
+    rebuildTop();
+}
+
+void WeightedSampler::setWeight(size_t index, double weight) {
+    if (index >= weights_.size() || weights_[index] == weight) return;
+    weights_[index] = weight;
+
+    // Перестраиваем только блок с изменённым весом
+    size_t b = index / BlockSize;
+    size_t begin = b * BlockSize;
+    size_t n = std::min(BlockSize, weights_.size() - begin);
+    blocks_[b].build(weights_.data() + begin, n);
+
+    // Сумму блока считаем заново, а не вычитанием - без накопления погрешности
+    blockTotals_[b] = 0.0;
+    for (size_t i = begin; i < begin + n; ++i) {
+        blockTotals_[b] += weights_[i];
+    }
+
+    rebuildTop();
+}
+
+void WeightedSampler::rebuildTop() {
+    top_.build(blockTotals_.data(), blockTotals_.size());
+    total_ = 0.0;
+    for (double blockTotal : blockTotals_) total_ += blockTotal;
+}
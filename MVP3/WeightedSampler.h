@@ -0,0 +1,60 @@
+// WeightedSampler.h
+#pragma once
+#include <cstdint> // uint32_t
+#include <random>  // Распределения для выборки
+#include <vector>  // Веса и таблицы
+
+// Выборка индекса с вероятностью, пропорциональной весу, за O(1)
+// (alias-таблицы Уолкера/Воуза).
+// Индексы разбиты на блоки по BlockSize: у каждого блока своя alias-таблица,
+// а верхняя таблица выбирает блок по его суммарному весу. Поэтому изменение
+// одного веса перестраивает только свой блок и верхний уровень - O(B + n/B),
+// а не всю таблицу целиком
+class WeightedSampler {
+public:
+    static constexpr size_t BlockSize = 256;
+
+    // Полная перестройка по новым весам - O(n)
+    void assign(const std::vector<double>& weights);
+    void clear();
+
+    // Изменение одного веса с частичной перестройкой
+    void setWeight(size_t index, double weight);
+
+    double weight(size_t index) const { return weights_[index]; }
+    size_t size() const { return weights_.size(); }
+    double totalWeight() const { return total_; }
+
+    // Случайный индекс; size() - если все веса нулевые
+    template <typename Rng>
+    size_t sample(Rng& rng) const {
+        if (total_ <= 0.0) return size();
+        size_t block = top_.draw(rng);
+        return block * BlockSize + blocks_[block].draw(rng);
+    }
+
+private:
+    // Одна alias-таблица: prob[i] - вероятность остаться в ячейке i, иначе alias[i]
+    struct AliasTable {
+        std::vector<double> prob;
+        std::vector<uint32_t> alias;
+
+        void build(const double* weights, size_t n);
+
+        template <typename Rng>
+        size_t draw(Rng& rng) const {
+            std::uniform_int_distribution<size_t> column(0, prob.size() - 1);
+            std::uniform_real_distribution<double> coin(0.0, 1.0);
+            size_t i = column(rng);
+            return coin(rng) < prob[i] ? i : alias[i];
+        }
+    };
+
+    void rebuildTop();
+
+    std::vector<double> weights_;      // Веса всех элементов
+    std::vector<AliasTable> blocks_;   // Таблицы внутри блоков
+    std::vector<double> blockTotals_;  // Суммарный вес каждого блока
+    AliasTable top_;                   // Таблица выбора блока
+    double total_ = 0.0;               // Суммарный вес
+};
@@ -3,6 +3,7 @@
 #include <QIcon>
 #include <QPixmap>
 #include "resource_finder.h"
+#include "TaskScheduler.h"
 
 int main(int argc, char *argv[]) {
     QApplication app(argc, argv);
@@ -24,5 +25,9 @@ int main(int argc, char *argv[]) {
     MainWindow window;
     window.show();
 
-    return app.exec();
+    int result = app.exec();
+
+    // Фоновые задачи (например, запись рейтингов) завершаются, пока окно и приложение живы
+    TaskScheduler::instance().shutdown();
+    return result;
 }